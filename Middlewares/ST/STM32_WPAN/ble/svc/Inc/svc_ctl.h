@@ -58,6 +58,24 @@ extern "C" {
 
   typedef SVCCTL_EvtAckStatus_t (*SVC_CTL_p_EvtHandler_t)(void *p_evt);
 
+  /**
+   * GATT event on an attribute, decoded by the ble_controller before it is reported to the handler of the range
+   * owning the attribute
+   */
+  typedef struct
+  {
+    void      *pckt;              /**< The user event received from the BLE core device */
+    uint16_t  Ecode;              /**< ACI_GATT_xxx_VSEVT_CODE */
+    uint16_t  ConnectionHandle;
+    uint16_t  AttrHandle;
+    uint16_t  AttrIndex;          /**< AttrHandle - StartHandle of the range */
+    uint16_t  Offset;             /**< 0 when the event has no offset */
+    uint16_t  DataLength;         /**< 0 when the event has no data */
+    uint8_t   *pData;             /**< NULL when the event has no data */
+  } SVCCTL_GattEvt_t;
+
+  typedef SVCCTL_EvtAckStatus_t (*SVC_CTL_p_GattEvtHandler_t)(SVCCTL_GattEvt_t *p_evt);
+
   /* Exported constants --------------------------------------------------------*/
   /* External variables --------------------------------------------------------*/
   /* Exported macros -----------------------------------------------------------*/
@@ -104,6 +122,23 @@ extern "C" {
    */
   void SVCCTL_RegisterCltHandler( SVC_CTL_p_EvtHandler_t pfBLE_SVC_Client_Event_Handler );
 
+  /**
+   * @brief  This API registers the range of attribute handles of a Service. A GATT event on an attribute of the range
+   *         (attribute modified, read, write and prepare write permit requests) is only reported to that handler,
+   *         with the attribute handle, connection handle and data already decoded. The ranges are searched with a
+   *         binary search instead of calling each Service handler in turn. When the handler does not acknowledge the
+   *         event, it is reported to the application.
+   *         The other GATT events are still reported to the handlers registered with SVCCTL_RegisterSvcHandler()
+   *         Up to BLE_CFG_SVC_MAX_NBR_RANGE ranges may be registered
+   *         This handler is called in the TL_BLE_HCI_UserEvtProc() context
+   *
+   * @param  StartHandle: First attribute handle of the range, usually the Service handle
+   * @param  EndHandle: Last attribute handle of the range
+   * @param  pfBLE_SVC_GattEvt_Handler: Handler of the GATT events on the attributes of the range
+   * @retval None
+   */
+  void SVCCTL_RegisterSvcHandleRange( uint16_t StartHandle, uint16_t EndHandle, SVC_CTL_p_GattEvtHandler_t pfBLE_SVC_GattEvt_Handler );
+
   /**
    * @brief  This API is used to resume the User Event Flow that has been stopped in return of SVCCTL_UserEvtRx()
    *
@@ -21,6 +21,19 @@
 #include "common_blesvc.h"
 #include "cmsis_compiler.h"
 
+/* Private defines -----------------------------------------------------------*/
+#define SVCCTL_EGID_EVT_MASK   0xFF00
+#define SVCCTL_GATT_EVT_TYPE   0x0C00
+#define SVCCTL_GAP_DEVICE_NAME_LENGTH 7
+
+/**
+ * Number of attribute handle ranges that may be registered with SVCCTL_RegisterSvcHandleRange()
+ * When set to 0, the GATT events are only reported to the handlers registered with SVCCTL_RegisterSvcHandler()
+ */
+#ifndef BLE_CFG_SVC_MAX_NBR_RANGE
+#define BLE_CFG_SVC_MAX_NBR_RANGE 0
+#endif
+
 /* Private typedef -----------------------------------------------------------*/
 typedef struct
 {
@@ -38,10 +51,20 @@ SVC_CTL_p_EvtHandler_t SVCCTL_CltHandlerTable[BLE_CFG_CLT_MAX_NBR_CB];
 uint8_t NbreOfRegisteredHandler;
 } SVCCTL_CltHandler_t;
 
-/* Private defines -----------------------------------------------------------*/
-#define SVCCTL_EGID_EVT_MASK   0xFF00
-#define SVCCTL_GATT_EVT_TYPE   0x0C00
-#define SVCCTL_GAP_DEVICE_NAME_LENGTH 7
+#if (BLE_CFG_SVC_MAX_NBR_RANGE > 0)
+typedef struct
+{
+uint16_t StartHandle;
+uint16_t EndHandle;
+SVC_CTL_p_GattEvtHandler_t pfHandler;
+} SVCCTL_HandleRange_t;
+
+typedef struct
+{
+SVCCTL_HandleRange_t SVCCTL_HandleRangeTab[BLE_CFG_SVC_MAX_NBR_RANGE]; /**< Sorted on StartHandle */
+uint8_t NbreOfRegisteredRange;
+} SVCCTL_HandleRouting_t;
+#endif
 
 /* Private macros ------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
@@ -51,12 +74,19 @@ uint8_t NbreOfRegisteredHandler;
 
 PLACE_IN_SECTION("BLE_DRIVER_CONTEXT") SVCCTL_EvtHandler_t SVCCTL_EvtHandler;
 PLACE_IN_SECTION("BLE_DRIVER_CONTEXT") SVCCTL_CltHandler_t SVCCTL_CltHandler;
+#if (BLE_CFG_SVC_MAX_NBR_RANGE > 0)
+PLACE_IN_SECTION("BLE_DRIVER_CONTEXT") SVCCTL_HandleRouting_t SVCCTL_HandleRouting;
+#endif
 
 /**
  * END of Section BLE_DRIVER_CONTEXT
  */
 
 /* Private functions ----------------------------------------------------------*/
+#if (BLE_CFG_SVC_MAX_NBR_RANGE > 0)
+static uint8_t SVCCTL_RouteGattEvt( void *pckt, evt_blecore_aci *blecore_evt, SVCCTL_EvtAckStatus_t *p_status );
+#endif
+
 /* Weak functions ----------------------------------------------------------*/
 void BVOPUS_STM_Init(void);
 
@@ -144,6 +174,9 @@ void SVCCTL_Init( void )
    */
   SVCCTL_EvtHandler.NbreOfRegisteredHandler = 0;
   SVCCTL_CltHandler.NbreOfRegisteredHandler = 0;
+#if (BLE_CFG_SVC_MAX_NBR_RANGE > 0)
+  SVCCTL_HandleRouting.NbreOfRegisteredRange = 0;
+#endif
 
   /**
    * Add and Initialize requested services
@@ -228,6 +261,148 @@ void SVCCTL_RegisterCltHandler( SVC_CTL_p_EvtHandler_t pfBLE_SVC_Client_Event_Ha
   return;
 }
 
+void SVCCTL_RegisterSvcHandleRange( uint16_t StartHandle, uint16_t EndHandle, SVC_CTL_p_GattEvtHandler_t pfBLE_SVC_GattEvt_Handler )
+{
+#if (BLE_CFG_SVC_MAX_NBR_RANGE > 0)
+  uint8_t index;
+
+  if (SVCCTL_HandleRouting.NbreOfRegisteredRange < BLE_CFG_SVC_MAX_NBR_RANGE)
+  {
+    /**
+     * Keep the table sorted on the start handle for the binary search
+     */
+    index = SVCCTL_HandleRouting.NbreOfRegisteredRange;
+    while ((index > 0) && (SVCCTL_HandleRouting.SVCCTL_HandleRangeTab[index - 1].StartHandle > StartHandle))
+    {
+      SVCCTL_HandleRouting.SVCCTL_HandleRangeTab[index] = SVCCTL_HandleRouting.SVCCTL_HandleRangeTab[index - 1];
+      index--;
+    }
+    SVCCTL_HandleRouting.SVCCTL_HandleRangeTab[index].StartHandle = StartHandle;
+    SVCCTL_HandleRouting.SVCCTL_HandleRangeTab[index].EndHandle = EndHandle;
+    SVCCTL_HandleRouting.SVCCTL_HandleRangeTab[index].pfHandler = pfBLE_SVC_GattEvt_Handler;
+    SVCCTL_HandleRouting.NbreOfRegisteredRange++;
+  }
+#else
+  (void)(StartHandle);
+  (void)(EndHandle);
+  (void)(pfBLE_SVC_GattEvt_Handler);
+#endif
+
+  return;
+}
+
+#if (BLE_CFG_SVC_MAX_NBR_RANGE > 0)
+/**
+ * @brief  Report a GATT event holding an attribute handle to the handler of the range owning the handle
+ * @param  pckt: The user event received from the BLE core device
+ * @param  blecore_evt: The GATT event
+ * @param  p_status: Status returned by the handler, when the event has been routed
+ * @retval 1 when the event has been routed, 0 when it shall be reported to all the registered handlers
+ */
+static uint8_t SVCCTL_RouteGattEvt( void *pckt, evt_blecore_aci *blecore_evt, SVCCTL_EvtAckStatus_t *p_status )
+{
+  SVCCTL_GattEvt_t gatt_evt;
+  SVCCTL_HandleRange_t *p_range;
+  uint8_t low;
+  uint8_t high;
+  uint8_t middle;
+
+  gatt_evt.pckt = pckt;
+  gatt_evt.Ecode = blecore_evt->ecode;
+  gatt_evt.Offset = 0;
+  gatt_evt.DataLength = 0;
+  gatt_evt.pData = NULL;
+
+  switch (blecore_evt->ecode)
+  {
+    case ACI_GATT_ATTRIBUTE_MODIFIED_VSEVT_CODE:
+    {
+      aci_gatt_attribute_modified_event_rp0 *p_evt = (aci_gatt_attribute_modified_event_rp0 *)blecore_evt->data;
+
+      gatt_evt.ConnectionHandle = p_evt->Connection_Handle;
+      gatt_evt.AttrHandle = p_evt->Attr_Handle;
+      gatt_evt.Offset = p_evt->Offset;
+      gatt_evt.DataLength = p_evt->Attr_Data_Length;
+      gatt_evt.pData = p_evt->Attr_Data;
+    }
+      break;
+
+    case ACI_GATT_READ_PERMIT_REQ_VSEVT_CODE:
+    {
+      aci_gatt_read_permit_req_event_rp0 *p_evt = (aci_gatt_read_permit_req_event_rp0 *)blecore_evt->data;
+
+      gatt_evt.ConnectionHandle = p_evt->Connection_Handle;
+      gatt_evt.AttrHandle = p_evt->Attribute_Handle;
+      gatt_evt.Offset = p_evt->Offset;
+    }
+      break;
+
+    case ACI_GATT_WRITE_PERMIT_REQ_VSEVT_CODE:
+    {
+      aci_gatt_write_permit_req_event_rp0 *p_evt = (aci_gatt_write_permit_req_event_rp0 *)blecore_evt->data;
+
+      gatt_evt.ConnectionHandle = p_evt->Connection_Handle;
+      gatt_evt.AttrHandle = p_evt->Attribute_Handle;
+      gatt_evt.DataLength = p_evt->Data_Length;
+      gatt_evt.pData = p_evt->Data;
+    }
+      break;
+
+    case ACI_GATT_PREPARE_WRITE_PERMIT_REQ_VSEVT_CODE:
+    {
+      aci_gatt_prepare_write_permit_req_event_rp0 *p_evt = (aci_gatt_prepare_write_permit_req_event_rp0 *)blecore_evt->data;
+
+      gatt_evt.ConnectionHandle = p_evt->Connection_Handle;
+      gatt_evt.AttrHandle = p_evt->Attribute_Handle;
+      gatt_evt.Offset = p_evt->Offset;
+      gatt_evt.DataLength = p_evt->Data_Length;
+      gatt_evt.pData = p_evt->Data;
+    }
+      break;
+
+    default:
+      /**
+       * No attribute handle in the event
+       */
+      return 0;
+  }
+
+  /**
+   * Binary search of the last range starting at or before the handle
+   */
+  low = 0;
+  high = SVCCTL_HandleRouting.NbreOfRegisteredRange;
+  while (low < high)
+  {
+    middle = (low + high) / 2;
+    if (SVCCTL_HandleRouting.SVCCTL_HandleRangeTab[middle].StartHandle <= gatt_evt.AttrHandle)
+    {
+      low = middle + 1;
+    }
+    else
+    {
+      high = middle;
+    }
+  }
+
+  if (low == 0)
+  {
+    return 0;
+  }
+
+  p_range = &SVCCTL_HandleRouting.SVCCTL_HandleRangeTab[low - 1];
+  if (gatt_evt.AttrHandle > p_range->EndHandle)
+  {
+    return 0;
+  }
+
+  gatt_evt.AttrIndex = gatt_evt.AttrHandle - p_range->StartHandle;
+  *p_status = p_range->pfHandler(&gatt_evt);
+
+  return 1;
+}
+#endif
+
 __WEAK SVCCTL_UserEvtFlowStatus_t SVCCTL_UserEvtRx( void *pckt )
 {
   hci_event_pckt *event_pckt;
@@ -248,6 +423,15 @@ __WEAK SVCCTL_UserEvtFlowStatus_t SVCCTL_UserEvtRx( void *pckt )
       switch ((blecore_evt->ecode) & SVCCTL_EGID_EVT_MASK)
       {
         case SVCCTL_GATT_EVT_TYPE:
+#if (BLE_CFG_SVC_MAX_NBR_RANGE > 0)
+          /**
+           * An event on an attribute of a registered range is only reported to the handler of that range
+           */
+          if (SVCCTL_RouteGattEvt(pckt, blecore_evt, &event_notification_status) != 0)
+          {
+            break;
+          }
+#endif
 #if (BLE_CFG_SVC_MAX_NBR_CB > 0)
           /* For Service event handler */
           for (index = 0; index < SVCCTL_EvtHandler.NbreOfRegisteredHandler; index++)
@@ -39,6 +39,14 @@ typedef enum
  */
 #define HCI_TL_DEFAULT_TIMEOUT (33000)
 
+/**
+ * Maximum number of user events reported in one call of hci_user_evt_proc()
+ * The default is to report the events one by one
+ */
+#ifndef BLE_CFG_HCI_EVT_BATCH_MAX
+#define BLE_CFG_HCI_EVT_BATCH_MAX (1)
+#endif
+
 /* Private macros ------------------------------------------------------------*/
 /* Public variables ---------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
@@ -55,6 +63,7 @@ PLACE_IN_SECTION("BLE_DRIVER_CONTEXT") HCI_TL_UserEventFlowStatus_t UserEventFlo
 
 static tHciContext hciContext;
 static tListNode HciCmdEventQueue;
+static HCI_TL_Stats_t HciStats;
 static void (* StatusNotCallBackFunction) (HCI_TL_CmdStatus_t status);
 static volatile HCI_TL_CmdRespStatus_t CmdRspStatusFlag;
 
@@ -81,15 +90,22 @@ void hci_user_evt_proc(void)
 {
   TL_EvtPacket_t *phcievtbuffer;
   tHCI_UserEvtRxParam UserEvtRxParam;
+  uint32_t evt_count;
+#ifdef BLE_CFG_HCI_EVT_BATCH_GET_TIME
+  uint32_t batch_start_time;
+#endif
 
   /**
    * Up to release version v1.2.0, a while loop was implemented to read out events from the queue as long as
    * it is not empty. However, in a bare metal implementation, this leads to calling in a "blocking" mode
    * hci_user_evt_proc() as long as events are received without giving the opportunity to run other tasks
    * in the background.
-   * From now, the events are reported one by one. When it is checked there is still an event pending in the queue,
-   * a request to the user is made to call again hci_user_evt_proc().
-   * This gives the opportunity to the application to run other background tasks between each event.
+   * From now, the events are reported by batches of up to BLE_CFG_HCI_EVT_BATCH_MAX (one by one by default).
+   * The batch is also stopped when the BLE_CFG_HCI_EVT_BATCH_BUDGET time is spent or when
+   * BLE_CFG_HCI_EVT_BATCH_YIELD() requests it, when defined.
+   * When it is checked there is still an event pending in the queue, a request to the user is made to call
+   * again hci_user_evt_proc().
+   * This gives the opportunity to the application to run other background tasks between each batch.
    */
 
   /**
@@ -97,7 +113,12 @@ void hci_user_evt_proc(void)
    * in case the user overwrite the header where the next/prev pointers are located
    */
 
-  if((LST_is_empty(&HciAsynchEventQueue) == FALSE) && (UserEventFlow != HCI_TL_UserEventFlow_Disable))
+#ifdef BLE_CFG_HCI_EVT_BATCH_GET_TIME
+  batch_start_time = BLE_CFG_HCI_EVT_BATCH_GET_TIME();
+#endif
+  evt_count = 0;
+
+  while((LST_is_empty(&HciAsynchEventQueue) == FALSE) && (UserEventFlow != HCI_TL_UserEventFlow_Disable))
   {
     LST_remove_head ( &HciAsynchEventQueue, (tListNode **)&phcievtbuffer );
 
@@ -123,7 +144,35 @@ void hci_user_evt_proc(void)
        * put back the event in the queue
        */
       LST_insert_head ( &HciAsynchEventQueue, (tListNode *)phcievtbuffer );
+      HciStats.FlowDisableCount++;
+    }
+
+    evt_count++;
+    if(evt_count >= BLE_CFG_HCI_EVT_BATCH_MAX)
+    {
+      break;
     }
+#if defined(BLE_CFG_HCI_EVT_BATCH_GET_TIME) || defined(BLE_CFG_HCI_EVT_BATCH_YIELD)
+    /**
+     * While CPU2 has run out of event buffers and uses a spare buffer, the batch is only limited by
+     * BLE_CFG_HCI_EVT_BATCH_MAX so that the buffers are given back as soon as possible
+     */
+    if(TL_MM_SpareEvtInUse() == 0)
+    {
+#ifdef BLE_CFG_HCI_EVT_BATCH_GET_TIME
+      if((uint32_t)(BLE_CFG_HCI_EVT_BATCH_GET_TIME() - batch_start_time) >= (uint32_t)(BLE_CFG_HCI_EVT_BATCH_BUDGET))
+      {
+        break;
+      }
+#endif
+#ifdef BLE_CFG_HCI_EVT_BATCH_YIELD
+      if(BLE_CFG_HCI_EVT_BATCH_YIELD() != 0)
+      {
+        break;
+      }
+#endif
+    }
+#endif
   }
 
   if((LST_is_empty(&HciAsynchEventQueue) == FALSE) && (UserEventFlow != HCI_TL_UserEventFlow_Disable))
@@ -135,6 +184,22 @@ void hci_user_evt_proc(void)
   return;
 }
 
+void hci_get_stats(HCI_TL_Stats_t *p_stats)
+{
+  *p_stats = HciStats;
+
+  return;
+}
+
+void hci_reset_stats(void)
+{
+  HciStats.EvtCount = 0;
+  HciStats.FlowDisableCount = 0;
+  HciStats.QueueDepthMax = 0;
+
+  return;
+}
+
 void hci_resume_flow( void )
 {
   UserEventFlow = HCI_TL_UserEventFlow_Enable;
@@ -272,6 +337,8 @@ static void NotifyCmdStatus(HCI_TL_CmdStatus_t hcicmdstatus)
 
 static void TlEvtReceived(TL_EvtPacket_t *hcievt)
 {
+  int queue_depth;
+
   if ( ((hcievt->evtserial.evt.evtcode) == TL_BLEEVT_CS_OPCODE) || ((hcievt->evtserial.evt.evtcode) == TL_BLEEVT_CC_OPCODE ) )
   {
     LST_insert_tail(&HciCmdEventQueue, (tListNode *)hcievt);
@@ -280,6 +347,12 @@ static void TlEvtReceived(TL_EvtPacket_t *hcievt)
   else
   {
     LST_insert_tail(&HciAsynchEventQueue, (tListNode *)hcievt);
+    queue_depth = LST_get_size(&HciAsynchEventQueue);
+    HciStats.EvtCount++;
+    if(queue_depth > HciStats.QueueDepthMax)
+    {
+      HciStats.QueueDepthMax = (uint16_t)queue_depth;
+    }
     hci_notify_asynch_evt((void*) &HciAsynchEventQueue); /**< Notify the application a full HCI event has been received */
   }
 
@@ -82,6 +82,13 @@ typedef struct
   void (* StatusNotCallBack) (HCI_TL_CmdStatus_t status);
 } HCI_TL_HciInitConf_t;
 
+typedef struct
+{
+  uint32_t EvtCount;          /**< Asynchronous events received */
+  uint32_t FlowDisableCount;  /**< Events put back in the queue because the application disabled the flow */
+  uint16_t QueueDepthMax;     /**< Most events waiting in the asynchronous event queue */
+} HCI_TL_Stats_t;
+
 /**
  * @brief  Register IO bus services.
  * @param  fops The HCI IO structure managing the IO BUS
@@ -110,6 +117,22 @@ void hci_notify_asynch_evt(void* pdata);
  */
 void hci_resume_flow(void);
 
+/**
+ * @brief  Read the statistics of the asynchronous event queue
+ *
+ * @param  p_stats: Filled with the statistics
+ * @retval None
+ */
+void hci_get_stats(HCI_TL_Stats_t *p_stats);
+
+/**
+ * @brief  Clear the statistics of the asynchronous event queue
+ *
+ * @param  None
+ * @retval None
+ */
+void hci_reset_stats(void);
+
 
 /**
  * @brief  This function is called when an ACI/HCI command is sent to the CPU2 and the response is waited.
@@ -182,6 +182,23 @@ typedef struct
   uint32_t TracesEvtPoolSize;
 } TL_MM_Config_t;
 
+/**
+ * Usage of the asynchronous event pool, as seen from CPU1
+ * A pool buffer is counted from the event notification up to its release to CPU2 in the FreeBufQueue
+ */
+typedef struct
+{
+  uint32_t EvtCount;          /**< Events received in the asynchronous event pool */
+  uint32_t SpareEvtCount;     /**< Events received in a spare buffer: CPU2 could not allocate a pool buffer */
+  uint32_t InUseBytes;        /**< Pool bytes held by CPU1 */
+  uint32_t InUseBytesMax;
+  uint16_t InUse;             /**< Pool buffers held by CPU1 */
+  uint16_t InUseMax;
+  uint8_t  SpareInUse;        /**< Spare buffers held by CPU1 */
+  uint8_t  LocalFreeBufMax;   /**< Most buffers released by the application and waiting for the IPCC channel */
+  uint8_t  FreeBufMax;        /**< Most buffers in the FreeBufQueue, not yet taken back by CPU2 */
+} TL_MM_Stats_t;
+
 typedef struct
 {
   uint8_t *p_ThreadOtCmdRspBuffer;
@@ -338,6 +355,9 @@ void TL_BLE_LLD_SendRspAck( void );
  ******************************************************************************/
 void TL_MM_Init( TL_MM_Config_t *p_Config );
 void TL_MM_EvtDone( TL_EvtPacket_t * hcievt );
+void TL_MM_GetStats( TL_MM_Stats_t *p_stats );
+void TL_MM_ResetStats( void );
+uint8_t TL_MM_SpareEvtInUse( void );
 
 /******************************************************************************
  * TRACES
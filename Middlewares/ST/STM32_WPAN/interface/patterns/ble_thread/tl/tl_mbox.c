@@ -63,6 +63,8 @@ PLACE_IN_SECTION("MB_MEM1") ALIGN(4) static tListNode  SystemEvtQueue;
 
 
 static tListNode  LocalFreeBufQueue;
+static TL_MM_Stats_t TL_MM_Stats;
+static uint8_t    LocalFreeBufNbr;
 static void (* BLE_IoBusEvtCallBackFunction) (TL_EvtPacket_t *phcievt);
 static void (* BLE_IoBusAclDataTxAck) ( void );
 static void (* SYS_CMD_IoBusCallBackFunction) (TL_EvtPacket_t *phcievt);
@@ -72,6 +74,9 @@ static void (* SYS_EVT_IoBusCallBackFunction) (TL_EvtPacket_t *phcievt);
 /* Global variables ----------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
 static void SendFreeBuf( void );
+static uint32_t PoolEvtSize( TL_EvtPacket_t *p_evt );
+static void EvtReceivedStats( TL_EvtPacket_t *p_evt );
+static void EvtReleasedStats( TL_EvtPacket_t *p_evt );
 static void OutputDbgTrace(TL_MB_PacketType_t packet_type, uint8_t* buffer);
 
 /* Public Functions Definition ------------------------------------------------------*/
@@ -152,6 +157,8 @@ void HW_IPCC_BLE_RxEvtNot(void)
   {
     LST_remove_head (&EvtQueue, (tListNode **)&phcievt);
 
+    EvtReceivedStats(phcievt);
+
     if ( ((phcievt->evtserial.evt.evtcode) == TL_BLEEVT_CS_OPCODE) || ((phcievt->evtserial.evt.evtcode) == TL_BLEEVT_CC_OPCODE ) )
     {
       OutputDbgTrace(TL_MB_BLE_CMD_RSP, (uint8_t*)phcievt);
@@ -239,6 +246,8 @@ void HW_IPCC_SYS_EvtNot( void )
   {
     LST_remove_head (&SystemEvtQueue, (tListNode **)&p_evt);
 
+    EvtReceivedStats(p_evt);
+
     OutputDbgTrace(TL_MB_SYS_ASYNCH_EVT, (uint8_t*)p_evt );
 
     SYS_EVT_IoBusCallBackFunction( p_evt );
@@ -594,6 +603,8 @@ void TL_MM_Init( TL_MM_Config_t *p_Config )
 
   LST_init_head (&FreeBufQueue);
   LST_init_head (&LocalFreeBufQueue);
+  memset(&TL_MM_Stats, 0, sizeof(TL_MM_Stats));
+  LocalFreeBufNbr = 0;
 
   p_mem_manager_table = TL_RefTable.p_mem_manager_table;
 
@@ -610,8 +621,19 @@ void TL_MM_Init( TL_MM_Config_t *p_Config )
 
 void TL_MM_EvtDone(TL_EvtPacket_t * phcievt)
 {
+  uint32_t primask_bit;
+
   LST_insert_tail(&LocalFreeBufQueue, (tListNode *)phcievt);
 
+  primask_bit = __get_PRIMASK();
+  __disable_irq();
+  LocalFreeBufNbr++;
+  if (LocalFreeBufNbr > TL_MM_Stats.LocalFreeBufMax)
+  {
+    TL_MM_Stats.LocalFreeBufMax = LocalFreeBufNbr;
+  }
+  __set_PRIMASK(primask_bit);
+
   OutputDbgTrace(TL_MB_MM_RELEASE_BUFFER, (uint8_t*)phcievt);
 
   HW_IPCC_MM_SendFreeBuf( SendFreeBuf );
@@ -622,16 +644,144 @@ void TL_MM_EvtDone(TL_EvtPacket_t * phcievt)
 static void SendFreeBuf( void )
 {
   tListNode *p_node;
+  uint32_t primask_bit;
+  int free_buf_nbr;
 
   while ( FALSE == LST_is_empty (&LocalFreeBufQueue) )
   {
     LST_remove_head( &LocalFreeBufQueue, (tListNode **)&p_node );
+    EvtReleasedStats( (TL_EvtPacket_t *)p_node );
     LST_insert_tail( (tListNode*)(TL_RefTable.p_mem_manager_table->pevt_free_buffer_queue), p_node );
   }
 
+  /**
+   * The IPCC channel is free: CPU2 does not access the FreeBufQueue
+   */
+  free_buf_nbr = LST_get_size( (tListNode*)(TL_RefTable.p_mem_manager_table->pevt_free_buffer_queue) );
+
+  primask_bit = __get_PRIMASK();
+  __disable_irq();
+  LocalFreeBufNbr = 0;
+  if (free_buf_nbr > TL_MM_Stats.FreeBufMax)
+  {
+    TL_MM_Stats.FreeBufMax = (uint8_t)free_buf_nbr;
+  }
+  __set_PRIMASK(primask_bit);
+
+  return;
+}
+
+/**
+ * @brief  Size of an event in the asynchronous event pool
+ * @param  p_evt: Event received from CPU2
+ * @retval Size in bytes, 0 when the event is not in the pool (spare or traces buffer)
+ */
+static uint32_t PoolEvtSize( TL_EvtPacket_t *p_evt )
+{
+  uint8_t *p_pool;
+
+  p_pool = TL_RefTable.p_mem_manager_table->blepool;
+  if ( ((uint8_t*)p_evt < p_pool) || ((uint8_t*)p_evt >= (p_pool + TL_RefTable.p_mem_manager_table->blepoolsize)) )
+  {
+    return 0;
+  }
+
+  return 4U * DIVC( (sizeof(TL_PacketHeader_t) + TL_EVT_HDR_SIZE + p_evt->evtserial.evt.plen), 4U );
+}
+
+static void EvtReceivedStats( TL_EvtPacket_t *p_evt )
+{
+  uint32_t primask_bit;
+  uint32_t size;
+
+  size = PoolEvtSize( p_evt );
+
+  primask_bit = __get_PRIMASK();
+  __disable_irq();
+  if (size != 0)
+  {
+    TL_MM_Stats.EvtCount++;
+    TL_MM_Stats.InUse++;
+    TL_MM_Stats.InUseBytes += size;
+    if (TL_MM_Stats.InUse > TL_MM_Stats.InUseMax)
+    {
+      TL_MM_Stats.InUseMax = TL_MM_Stats.InUse;
+    }
+    if (TL_MM_Stats.InUseBytes > TL_MM_Stats.InUseBytesMax)
+    {
+      TL_MM_Stats.InUseBytesMax = TL_MM_Stats.InUseBytes;
+    }
+  }
+  else if ( ((uint8_t*)p_evt == TL_RefTable.p_mem_manager_table->spare_ble_buffer) ||
+            ((uint8_t*)p_evt == TL_RefTable.p_mem_manager_table->spare_sys_buffer) )
+  {
+    TL_MM_Stats.SpareEvtCount++;
+    TL_MM_Stats.SpareInUse++;
+  }
+  __set_PRIMASK(primask_bit);
+
+  return;
+}
+
+static void EvtReleasedStats( TL_EvtPacket_t *p_evt )
+{
+  uint32_t primask_bit;
+  uint32_t size;
+
+  size = PoolEvtSize( p_evt );
+
+  primask_bit = __get_PRIMASK();
+  __disable_irq();
+  if ((size != 0) && (TL_MM_Stats.InUse != 0))
+  {
+    TL_MM_Stats.InUse--;
+    TL_MM_Stats.InUseBytes -= MIN(size, TL_MM_Stats.InUseBytes);
+  }
+  else if ( (((uint8_t*)p_evt == TL_RefTable.p_mem_manager_table->spare_ble_buffer) ||
+             ((uint8_t*)p_evt == TL_RefTable.p_mem_manager_table->spare_sys_buffer)) &&
+            (TL_MM_Stats.SpareInUse != 0) )
+  {
+    TL_MM_Stats.SpareInUse--;
+  }
+  __set_PRIMASK(primask_bit);
+
   return;
 }
 
+void TL_MM_GetStats( TL_MM_Stats_t *p_stats )
+{
+  uint32_t primask_bit;
+
+  primask_bit = __get_PRIMASK();
+  __disable_irq();
+  *p_stats = TL_MM_Stats;
+  __set_PRIMASK(primask_bit);
+
+  return;
+}
+
+void TL_MM_ResetStats( void )
+{
+  uint32_t primask_bit;
+
+  primask_bit = __get_PRIMASK();
+  __disable_irq();
+  TL_MM_Stats.EvtCount = 0;
+  TL_MM_Stats.SpareEvtCount = 0;
+  TL_MM_Stats.InUseMax = TL_MM_Stats.InUse;
+  TL_MM_Stats.InUseBytesMax = TL_MM_Stats.InUseBytes;
+  TL_MM_Stats.LocalFreeBufMax = LocalFreeBufNbr;
+  TL_MM_Stats.FreeBufMax = 0;
+  __set_PRIMASK(primask_bit);
+
+  return;
+}
+
+uint8_t TL_MM_SpareEvtInUse( void )
+{
+  return TL_MM_Stats.SpareInUse;
+}
+
 /******************************************************************************
  * TRACES
  ******************************************************************************/
@@ -249,12 +249,17 @@ size_t __write(int handle, const unsigned char * buf, size_t bufSize)
  * @param handle output handle (STDIO, STDERR...)
  * @param buf buffer to write
  * @param bufsize buffer size
- * @retval Number of elements written
+ * @retval Number of elements written, 0 when the trace queue is full and the trace is dropped
  */
 size_t DbgTraceWrite(int handle, const unsigned char * buf, size_t bufSize)
 {
   size_t chars_written = 0;
   uint8_t* buffer;
+#if (DBG_TRACE_USE_CIRCULAR_QUEUE != 0)
+  uint8_t* element;
+  uint16_t element_size;
+  uint16_t first_size;
+#endif
 
   BACKUP_PRIMASK();
 
@@ -277,12 +282,39 @@ size_t DbgTraceWrite(int handle, const unsigned char * buf, size_t bufSize)
 
 #if (DBG_TRACE_USE_CIRCULAR_QUEUE != 0)
     DISABLE_IRQ();      /**< Disable all interrupts by setting PRIMASK bit on Cortex*/
-    buffer=CircularQueue_Add(&MsgDbgTraceQueue,(uint8_t*)buf, bufSize,1);
+    /**
+     * The trace is copied in place in the queue. When it wraps at the end of the queue buffer, it is stored in two
+     * elements and only the first one is sent now, the second one is sent from DbgTrace_TxCpltCallback().
+     * The trace is queued whole or not at all : the first element is only committed when the second one fits
+     */
+    first_size = (uint16_t)MIN(bufSize, DBG_TRACE_MSG_QUEUE_SIZE);
+    buffer = CircularQueue_Reserve(&MsgDbgTraceQueue, &first_size);
+    if ((buffer != NULL) && (first_size < bufSize) && (CircularQueue_Room(&MsgDbgTraceQueue, 2) < bufSize))
+    {
+      (void)CircularQueue_Commit(&MsgDbgTraceQueue, 0);
+      buffer = NULL;
+    }
+    if (buffer != NULL)
+    {
+      memcpy(buffer, buf, first_size);
+      (void)CircularQueue_Commit(&MsgDbgTraceQueue, first_size);
+      if (first_size < bufSize)
+      {
+        element_size = (uint16_t)(bufSize - first_size);
+        element = CircularQueue_Reserve(&MsgDbgTraceQueue, &element_size);
+        memcpy(element, &buf[first_size], element_size);
+        (void)CircularQueue_Commit(&MsgDbgTraceQueue, element_size);
+      }
+    }
+    else
+    {
+      chars_written = 0;
+    }
     if (buffer && DbgTracePeripheralReady)
     {
       DbgTracePeripheralReady = RESET;
       RESTORE_PRIMASK();
-      DbgOutputTraces((uint8_t*)buffer, bufSize, DbgTrace_TxCpltCallback);
+      DbgOutputTraces((uint8_t*)buffer, first_size, DbgTrace_TxCpltCallback);
     }
     else
     {
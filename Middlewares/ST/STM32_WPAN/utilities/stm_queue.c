@@ -27,12 +27,34 @@
 /* Private typedef -------------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 #define MOD(X,Y) (((X) >= (Y)) ? ((X)-(Y)) : (X))
+#define ELEMENT_HEADER_SIZE(q) (((q)->elementSize == 0) ? 2 : 0)
 
 /* Private variables ---------------------------------------------------------*/
 /* Global variables ----------------------------------------------------------*/
 /* Extern variables ----------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
+static uint32_t CircularQueue_WritePos(queue_t *q);
+
 /* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Position of the next element to be added
+  * @param  q: pointer on queue structure to be handled
+  * @retval Position in the queue buffer of the header (or of the data for fixed size elements) of the next element
+  */
+static uint32_t CircularQueue_WritePos(queue_t *q)
+{
+  uint32_t curElementSize;
+
+  if (q->byteCount == 0)
+  {
+    return q->last;
+  }
+  curElementSize = (q->elementSize == 0) ? q->qBuff[q->last] + ((q->qBuff[MOD((q->last+1), q->queueMaxSize)])<<8) + 2 : q->elementSize;
+
+  return MOD((q->last + curElementSize), q->queueMaxSize);
+}
+
 /* Public functions ----------------------------------------------------------*/
 
 /**
@@ -54,6 +76,7 @@ int CircularQueue_Init(queue_t *q, uint8_t* queueBuffer, uint32_t queueSize, uin
   q->queueMaxSize = queueSize;
   q->elementSize = elementSize;
   q->optionFlags = optionFlags;
+  q->reservedSize = 0;
 
    if ((optionFlags & CIRCULAR_QUEUE_SPLIT_IF_WRAPPING_FLAG) && q-> elementSize)
    {
@@ -240,11 +263,18 @@ uint8_t* CircularQueue_Add(queue_t *q, uint8_t* x, uint16_t elementSize, uint32_
   * @param  q: pointer on queue structure  to be handled
   * @param  elementSize: Pointer to return Size of element to be removed  
   * @param  buffer: destination buffer where to copy element  
-  * @retval Pointer on removed element. NULL if queue was empty
+  * @retval Pointer on the copy (buffer). NULL if queue was empty
   */
 uint8_t* CircularQueue_Remove_Copy(queue_t *q, uint16_t* elementSize, uint8_t* buffer)
 {
-   return NULL;
+  uint8_t* ptr;
+
+  ptr = CircularQueue_Sense_Copy(q, elementSize, buffer);
+  if (ptr != NULL)
+  {
+    (void)CircularQueue_Remove(q, NULL);
+  }
+  return ptr;
 }
 
 
@@ -309,12 +339,29 @@ uint8_t* CircularQueue_Remove(queue_t *q, uint16_t* elementSize)
   * @param  q: pointer on queue structure  to be handled
   * @param  elementSize:  Pointer to return Size of element to be removed  
   * @param  buffer: destination buffer where to copy element
-  * @retval Pointer on sensed element. NULL if queue was empty
+  * @retval Pointer on the copy (buffer). NULL if queue was empty
   */
 
 uint8_t* CircularQueue_Sense_Copy(queue_t *q, uint16_t* elementSize, uint8_t* buffer)
 {
-    return NULL;
+  uint8_t* x;
+  uint16_t eltSize = 0;
+  uint32_t NbBytesToCopy;
+
+  x = CircularQueue_Sense(q, &eltSize);
+  if (x != NULL)
+  {
+    /* An element added without option may wrap at the end of the buffer: copy it in two parts at most */
+    NbBytesToCopy = MIN((q->queueMaxSize - (uint32_t)(x - q->qBuff)), eltSize);
+    memcpy(buffer, x, NbBytesToCopy);
+    memcpy(&buffer[NbBytesToCopy], q->qBuff, eltSize - NbBytesToCopy);
+    x = buffer;
+  }
+  if (elementSize != NULL)
+  {
+    *elementSize = eltSize;
+  }
+  return x;
 }
 
 
@@ -361,6 +408,179 @@ uint8_t* CircularQueue_Sense(queue_t *q, uint16_t* elementSize)
   return x;
 }
 
+/**
+  * @brief  Reserve room for one element to be written in place.
+  * @note   This function returns a contiguous span of the queue buffer where the caller builds the element, which is
+  *         added to the queue by CircularQueue_Commit(). Only one element may be reserved at a time and no element
+  *         shall be added with CircularQueue_Add() until it is committed.
+  *         When the element does not fit at the end of the buffer:
+  *         - with CIRCULAR_QUEUE_SPLIT_IF_WRAPPING_FLAG, only the room left at the end of the buffer is reserved. The
+  *           caller commits it and reserves again for the rest of the data
+  *         - with CIRCULAR_QUEUE_NO_WRAP_FLAG, the end of the buffer is skipped and the element is reserved at the
+  *           beginning of the buffer
+  *         - without option, NULL is returned: the element can only be added with CircularQueue_Add()
+  * @param  q: pointer on queue structure to be handled
+  * @param  elementSize: Size of the element to be reserved (ignored with fixed size elements), returns the size
+  *         reserved
+  * @retval Pointer on the reserved element. NULL if it does not fit in the queue
+  */
+uint8_t* CircularQueue_Reserve(queue_t *q, uint16_t* elementSize)
+{
+  uint32_t elemSizeStorageRoom = ELEMENT_HEADER_SIZE(q);
+  uint32_t writePos;
+  uint32_t dataPos;
+  uint32_t eltSize;
+  uint32_t skip = 0;
+
+  eltSize = (q->elementSize == 0) ? *elementSize : q->elementSize;
+  if (eltSize == 0)
+  {
+    return NULL;
+  }
+
+  /* The queue is empty: restart from the beginning of the buffer to get the largest contiguous span */
+  if (q->byteCount == 0)
+  {
+    q->first = 0;
+    q->last = 0;
+  }
+
+  writePos = CircularQueue_WritePos(q);
+  dataPos = MOD((writePos + elemSizeStorageRoom), q->queueMaxSize);
+  if ((dataPos + eltSize) > q->queueMaxSize)
+  {
+    if (q->optionFlags & CIRCULAR_QUEUE_SPLIT_IF_WRAPPING_FLAG)
+    {
+      eltSize = q->queueMaxSize - dataPos;
+    }
+    else if (q->optionFlags & CIRCULAR_QUEUE_NO_WRAP_FLAG)
+    {
+      skip = q->queueMaxSize - writePos;
+      writePos = 0;
+      dataPos = elemSizeStorageRoom;
+    }
+    else
+    {
+      return NULL;
+    }
+  }
+
+  /* The free room starts at writePos and wraps up to q->first */
+  if ((q->byteCount + skip + elemSizeStorageRoom + eltSize) > q->queueMaxSize)
+  {
+    return NULL;
+  }
+
+  q->reserved = writePos;
+  q->reservedSkip = skip;
+  q->reservedSize = eltSize;
+  *elementSize = eltSize;
+
+  return &q->qBuff[dataPos];
+}
+
+/**
+  * @brief  Add the element reserved by CircularQueue_Reserve() to the queue.
+  * @param  q: pointer on queue structure to be handled
+  * @param  elementSize: Number of bytes written in the reserved element, up to the size reserved (ignored with fixed
+  *         size elements). 0 cancels the reservation
+  * @retval 0 when the element has been added, -1 if no element was reserved or the size is larger than reserved
+  */
+int CircularQueue_Commit(queue_t *q, uint16_t elementSize)
+{
+  uint32_t elemSizeStorageRoom = ELEMENT_HEADER_SIZE(q);
+
+  if ((q->reservedSize == 0) || (elementSize > q->reservedSize))
+  {
+    return -1;
+  }
+  if (elementSize == 0)
+  {
+    q->reservedSize = 0;
+    return 0;
+  }
+  if (q->elementSize > 0)
+  {
+    elementSize = q->elementSize;
+  }
+
+  if (q->reservedSkip)
+  {
+    /* if element size are variable, invalidate end of buffer setting 0xFFFF size */
+    if (q->elementSize == 0)
+    {
+      q->qBuff[q->queueMaxSize - q->reservedSkip] = 0xFF;
+      q->qBuff[q->queueMaxSize - q->reservedSkip + 1] = 0xFF;
+    }
+    q->byteCount += q->reservedSkip;  /* invalid data at the end of buffer are take into account in byteCount */
+  }
+
+  if (q->elementSize == 0)
+  {
+    q->qBuff[q->reserved] = elementSize & 0xFF;
+    q->qBuff[MOD((q->reserved + 1), q->queueMaxSize)] = (elementSize & 0xFF00) >> 8;
+  }
+
+  q->last = q->reserved;
+  q->byteCount += elemSizeStorageRoom + elementSize;
+  q->elementCount++;
+  q->reservedSize = 0;
+
+  return 0;
+}
+
+/**
+  * @brief  Bytes of data that can still be added to the queue in a number of elements.
+  * @note   The element reserved and not committed yet is not counted. The result is exact with
+  *         CIRCULAR_QUEUE_SPLIT_IF_WRAPPING_FLAG, where the elements fill the buffer up to its end. With
+  *         CIRCULAR_QUEUE_NO_WRAP_FLAG, the end of the buffer skipped by an element is not available.
+  * @param  q: pointer on queue structure to be handled
+  * @param  nbElements: Number of elements the data is split in, each one with its header
+  * @retval Number of bytes, 0 if the headers alone do not fit
+  */
+uint32_t CircularQueue_Room(queue_t *q, uint32_t nbElements)
+{
+  uint32_t used = q->byteCount + (nbElements * ELEMENT_HEADER_SIZE(q));
+
+  return (used < q->queueMaxSize) ? (q->queueMaxSize - used) : 0;
+}
+
+/**
+  * @brief  Read the first element of the queue in place, without removing it.
+  * @note   Same as CircularQueue_Sense() but NULL is also returned when the element wraps at the end of the buffer,
+  *         which may only happen for an element added by CircularQueue_Add() without option. Use
+  *         CircularQueue_Sense_Copy() in that case.
+  * @param  q: pointer on queue structure to be handled
+  * @param  elementSize: Pointer to return Size of the element (ignored if NULL)
+  * @retval Pointer on the first element. NULL if queue was empty or the element is not contiguous
+  */
+uint8_t* CircularQueue_Peek(queue_t *q, uint16_t* elementSize)
+{
+  uint8_t* x;
+  uint16_t eltSize = 0;
+
+  x = CircularQueue_Sense(q, &eltSize);
+  if ((x != NULL) && (((uint32_t)(x - q->qBuff) + eltSize) > q->queueMaxSize))
+  {
+    x = NULL;
+  }
+  if (elementSize != NULL)
+  {
+    *elementSize = eltSize;
+  }
+  return x;
+}
+
+/**
+  * @brief  Remove the first element of the queue once it has been read with CircularQueue_Peek().
+  * @param  q: pointer on queue structure to be handled
+  * @retval 0 when the element has been removed, -1 if queue was empty
+  */
+int CircularQueue_Release(queue_t *q)
+{
+  return (CircularQueue_Remove(q, NULL) != NULL) ? 0 : -1;
+}
+
 /**
   * @brief   Check if queue is empty.
   * @note    This function is used to to check if the queue is empty.  
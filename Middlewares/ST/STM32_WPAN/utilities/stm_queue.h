@@ -40,6 +40,9 @@ typedef struct {
    uint32_t byteCount;      /* number of bytes in the queue */
    uint32_t elementCount;   /* number of element in the queue */
    uint8_t  optionFlags;     /* option to enable specific features */
+   uint32_t reserved;       /* position of the element reserved by CircularQueue_Reserve() */
+   uint32_t reservedSkip;   /* bytes left unused at the end of the buffer by the reservation */
+   uint16_t reservedSize;   /* size of the reserved element, 0 when no element is reserved */
 } queue_t;
 
 /* Exported constants --------------------------------------------------------*/
@@ -54,6 +57,11 @@ int CircularQueue_Empty(queue_t *q);
 int CircularQueue_NbElement(queue_t *q);
 uint8_t* CircularQueue_Remove_Copy(queue_t *q, uint16_t* elementSize, uint8_t* buffer);
 uint8_t* CircularQueue_Sense_Copy(queue_t *q, uint16_t* elementSize, uint8_t* buffer);
+uint8_t* CircularQueue_Reserve(queue_t *q, uint16_t* elementSize);
+int CircularQueue_Commit(queue_t *q, uint16_t elementSize);
+uint32_t CircularQueue_Room(queue_t *q, uint32_t nbElements);
+uint8_t* CircularQueue_Peek(queue_t *q, uint16_t* elementSize);
+int CircularQueue_Release(queue_t *q);
 
 
 #endif /* __STM_QUEUE_H */
@@ -0,0 +1,37 @@
+/**
+  ******************************************************************************
+  * @file    app_audio.h
+  * @author  MCD Application Team
+  * @brief   Header for app_audio.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_AUDIO_H
+#define __APP_AUDIO_H
+
+/* Includes ------------------------------------------------------------------*/
+
+/* Defines -------------------------------------------------------------------*/
+/* Midi channel used for the notes detected on the microphone */
+#define AUDIO_MIDI_CHANNEL              (1U)
+
+/* Number of processed blocks between two CPU budget reports */
+#define AUDIO_MIDI_REPORT_BLOCKS        (50U)
+
+/* Exported functions ------------------------------------------------------- */
+void AUDIO_MIDI_Init(void);
+void AUDIO_MIDI_Start(void);
+void AUDIO_MIDI_Stop(void);
+
+#endif /* __APP_AUDIO_H */
@@ -0,0 +1,61 @@
+/**
+  ******************************************************************************
+  * @file    app_boot_profile.h
+  * @author  MCD Application Team
+  * @brief   Header for app_boot_profile.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_BOOT_PROFILE_H
+#define __APP_BOOT_PROFILE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "app_conf.h"
+
+/* Defines -------------------------------------------------------------------*/
+#if (CFG_BOOT_PROFILE != 0)
+#define BOOT_PROFILE_PHASE(phase)       BOOT_PROFILE_Phase(phase)
+#define BOOT_PROFILE_CPU2_CMD_WAIT()    BOOT_PROFILE_Cpu2_Cmd(0)
+#define BOOT_PROFILE_CPU2_CMD_DONE()    BOOT_PROFILE_Cpu2_Cmd(1)
+#else
+#define BOOT_PROFILE_PHASE(phase)
+#define BOOT_PROFILE_CPU2_CMD_WAIT()
+#define BOOT_PROFILE_CPU2_CMD_DONE()
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+/* Startup phases, each one time stamped the first time it is reached */
+typedef enum
+{
+  BOOT_PROFILE_START,                   /*!< BOOT_PROFILE_Init(), system and timer server initialized */
+  BOOT_PROFILE_CPU2_START,              /*!< Transport layer initialized, CPU2 started */
+  BOOT_PROFILE_LCD,                     /*!< Screen and RGB LED initialized */
+  BOOT_PROFILE_SENSORS,                 /*!< Sensors initialized, VL53L0X calibrated */
+  BOOT_PROFILE_SONG,                    /*!< Active song parsed and its duration computed */
+  BOOT_PROFILE_APPE_END,                /*!< End of MX_APPE_Init(), the sequencer runs */
+  BOOT_PROFILE_CPU2_READY,              /*!< First system event of CPU2, its ready event */
+  BOOT_PROFILE_BLE_INIT,                /*!< APP_BLE_Init() started */
+  BOOT_PROFILE_GAP_GATT,                /*!< BLE stack, GAP and GATT initialized */
+  BOOT_PROFILE_SERVICES,                /*!< Midi service and application initialized */
+  BOOT_PROFILE_ADVERTISING,             /*!< First advertising started */
+  BOOT_PROFILE_PHASE_NBR,
+} Boot_Profile_Phase_t;
+
+/* Exported functions ------------------------------------------------------- */
+void BOOT_PROFILE_Init(void);
+void BOOT_PROFILE_Phase(Boot_Profile_Phase_t Phase);
+void BOOT_PROFILE_Cpu2_Cmd(uint8_t Done);
+void BOOT_PROFILE_Report(void);
+
+#endif /* __APP_BOOT_PROFILE_H */
@@ -175,8 +175,8 @@
 #define CONN_L(x) ((int)((x)/0.625f))
 #define CONN_P(x) ((int)((x)/1.25f))
 
-  /*  L2CAP Connection Update request parameters used for test only with smart Phone */
-#define L2CAP_REQUEST_NEW_CONN_PARAM             0
+  /*  L2CAP Connection Update requests issued by the connection parameters policy (app_conn_param.c) */
+#define L2CAP_REQUEST_NEW_CONN_PARAM             1
 
 #define L2CAP_INTERVAL_MIN              CONN_P(1000) /* 1s */
 #define L2CAP_INTERVAL_MAX              CONN_P(1000) /* 1s */
@@ -421,7 +421,26 @@
  * for a CC/CS event, In that case, the notification TL_BLE_HCI_ToNot() is called to indicate
  * to the application a HCI command did not receive its command event within 30s (Default HCI Timeout).
  */
-#define CFG_TLBLE_EVT_QUEUE_LENGTH 5
+#define CFG_TLBLE_EVT_QUEUE_LENGTH_DEFAULT 5
+
+/**
+ * Sizing profile of the BLE event pool (EvtPool in app_entry.c), in frames of TL_BLE_EVENT_FRAME_SIZE bytes
+ * 0 : CFG_TLBLE_EVT_QUEUE_LENGTH_DEFAULT frames
+ * 1 : CFG_TLBLE_EVT_POOL_PEAK_FRAMES frames plus CFG_TLBLE_EVT_POOL_MARGIN_FRAMES. The peak is printed by the MBOX
+ *     command on the debug UART, it shall be measured under the heaviest traffic (two centrals, file played with the
+ *     sensors enabled). The margin covers the events being written by CPU2 and the buffers not yet taken back.
+ *     The pool is too small when MBOX reports events received in a spare buffer.
+ */
+#define CFG_TLBLE_EVT_POOL_PROFILE 0
+#define CFG_TLBLE_EVT_POOL_MARGIN_FRAMES 1
+/* Not measured yet : the pool of the default profile, to be replaced by the peak printed by MBOX */
+#define CFG_TLBLE_EVT_POOL_PEAK_FRAMES (CFG_TLBLE_EVT_QUEUE_LENGTH_DEFAULT - CFG_TLBLE_EVT_POOL_MARGIN_FRAMES)
+
+#if (CFG_TLBLE_EVT_POOL_PROFILE == 1)
+#define CFG_TLBLE_EVT_QUEUE_LENGTH (CFG_TLBLE_EVT_POOL_PEAK_FRAMES + CFG_TLBLE_EVT_POOL_MARGIN_FRAMES)
+#else
+#define CFG_TLBLE_EVT_QUEUE_LENGTH CFG_TLBLE_EVT_QUEUE_LENGTH_DEFAULT
+#endif
 /**
  * This parameter should be set to fit most events received by the HCI layer. It defines the buffer size of each element
  * allocated in the queue of received events and can be used to optimize the amount of RAM allocated by the Memory Manager.
@@ -648,6 +667,30 @@ typedef enum
 /* USER CODE BEGIN Defines */
 #define CFG_LED_SUPPORTED         1
 #define CFG_BUTTON_SUPPORTED      1
+/* Microphone to Midi notes, needs the PDM2PCM library and the SAI HAL module */
+#define CFG_AUDIO_MIDI_SUPPORTED  0
+/* Binary traces (APP_TRACEn) for the timing critical paths, decoded by Tools/trace_decode.py */
+#define CFG_DEBUG_TRACE_BINARY    1
+/* Midi latency probes on the DWT cycle counter, reported with the LAT command on the trace UART */
+#define CFG_LATENCY_PROBES        0
+/* Worst case execution time of the timer server (hw_timerserver.c), loaded by the TSBENCH command (app_ts_bench.c) */
+#define CFG_HW_TS_BENCHMARK       0
+/* Startup phases time stamped on the DWT cycle counter, reported once advertising and with the BOOT command */
+#define CFG_BOOT_PROFILE          0
+/* Screen, sensors and song initialized while CPU2 starts (1), or before CPU2 is started as in the first releases (0) */
+#define CFG_BOOT_PARALLEL_INIT    1
+/* Time base of the sequencer task deadlines (UTIL_SEQ_SetTaskDeadline), in ms */
+#define CFG_SCH_DEADLINE_NOW()    HAL_GetTick()
+/* Time budget of a batch of HCI user events (BLE_CFG_HCI_EVT_BATCH_BUDGET in ble_conf.h), in us */
+#define CFG_HCI_EVT_BATCH_BUDGET_US   300
+/* Baud rate of the trace UART, also used by the host control frames (app_hostctl.c, Tools/hostctl.py) */
+#define CFG_HOSTCTL_BAUDRATE      115200
+/* Set to 1 to strike again, when the player resumes, the notes that were sounding when it was paused */
+#define CFG_MIDI_RESTRIKE_ON_RESUME 0
+/* Set to 0 to send each note of the song when it is due rather than up to one connection interval ahead */
+#define CFG_MIDI_LOOKAHEAD 1
+/* Set to 0 to keep the RGB LED off when notes are sent, 1 flashes it on each Note On */
+#define CFG_LED_MIDI_NOTES 1
 #define PUSH_BUTTON_SW_EXTI_IRQHandler                      EXTI15_10_IRQHandler
 
 /* USER CODE END Defines */
@@ -663,6 +706,12 @@ typedef enum
  * the requirement that a HCI/ACI command shall never be sent if there is already one pending
  */
 
+/**
+ * The tasks of the application are listed with their name in the reports (CFG_TASK_NAMES)
+ */
+#define CFG_TASK_ID(id, name)         id,
+#define CFG_TASK_NAME(id, name)       [id] = name,
+
 /**< Add in that list all tasks that may send a ACI/HCI command */
 typedef enum
 {
@@ -672,8 +721,20 @@ typedef enum
 #endif
   CFG_TASK_HCI_ASYNCH_EVT_ID,
   /* USER CODE BEGIN CFG_Task_Id_With_HCI_Cmd_t */
-  CFG_TASK_CHECK_DISTANCE,
-  CFG_TASK_MIDI_SEQ,
+#define CFG_TASK_LIST_WITH_HCI_CMD(TASK)                    \
+  TASK(CFG_TASK_CHECK_DISTANCE,         "distance")         \
+  TASK(CFG_TASK_MIDI_SEQ,               "midi seq")         \
+  TASK(CFG_TASK_AUDIO_MIDI,             "audio midi")       \
+  TASK(CFG_TASK_MIDI_TX,                "midi tx")          \
+  TASK(CFG_TASK_LINK_STATS,             "link stats")       \
+  TASK(CFG_TASK_LATENCY_REPORT,         "report")           \
+  TASK(CFG_TASK_TS_BENCH,               "ts bench")         \
+  TASK(CFG_TASK_HOSTCTL,                "host ctl")         \
+  TASK(CFG_TASK_SONG_XFER,              "song xfer")        \
+  TASK(CFG_TASK_EXT_FLASH,              "ext flash")        \
+  TASK(CFG_TASK_RECORDER,               "recorder")
+
+  CFG_TASK_LIST_WITH_HCI_CMD(CFG_TASK_ID)
   /* USER CODE END CFG_Task_Id_With_HCI_Cmd_t */
   CFG_LAST_TASK_ID_WITH_HCICMD,                                               /**< Shall be LAST in the list */
 } CFG_Task_Id_With_HCI_Cmd_t;
@@ -684,13 +745,36 @@ typedef enum
   CFG_FIRST_TASK_ID_WITH_NO_HCICMD = CFG_LAST_TASK_ID_WITH_HCICMD - 1,        /**< Shall be FIRST in the list */
   CFG_TASK_SYSTEM_HCI_ASYNCH_EVT_ID,
   /* USER CODE BEGIN CFG_Task_Id_With_NO_HCI_Cmd_t */
+#define CFG_TASK_LIST_WITH_NO_HCI_CMD(TASK)                 \
+  TASK(CFG_TASK_MIDI_DISPLAY,           "midi display")     \
+  TASK(CFG_TASK_LED,                    "led")              \
+  TASK(CFG_TASK_LCD_REFRESH,            "lcd refresh")      \
+  TASK(CFG_TASK_SETTINGS,               "settings")
 
+  CFG_TASK_LIST_WITH_NO_HCI_CMD(CFG_TASK_ID)
   /* USER CODE END CFG_Task_Id_With_NO_HCI_Cmd_t */
   CFG_LAST_TASK_ID_WITH_NO_HCICMD                                            /**< Shall be LAST in the list */
 } CFG_Task_Id_With_NO_HCI_Cmd_t;
 
 #define CFG_TASK_NBR    CFG_LAST_TASK_ID_WITH_NO_HCICMD
 
+#if (L2CAP_REQUEST_NEW_CONN_PARAM != 0 )
+#define CFG_TASK_NAME_CONN_UPDATE     CFG_TASK_NAME(CFG_TASK_CONN_UPDATE_REG_ID, "conn update")
+#else
+#define CFG_TASK_NAME_CONN_UPDATE
+#endif
+
+/**
+ * Initializer of a table of the task names indexed by task id
+ */
+#define CFG_TASK_NAMES                                                  \
+  CFG_TASK_NAME(CFG_TASK_ADV_CANCEL_ID,           "adv cancel")         \
+  CFG_TASK_NAME_CONN_UPDATE                                             \
+  CFG_TASK_NAME(CFG_TASK_HCI_ASYNCH_EVT_ID,       "hci event")          \
+  CFG_TASK_LIST_WITH_HCI_CMD(CFG_TASK_NAME)                             \
+  CFG_TASK_NAME(CFG_TASK_SYSTEM_HCI_ASYNCH_EVT_ID, "system hci")        \
+  CFG_TASK_LIST_WITH_NO_HCI_CMD(CFG_TASK_NAME)
+
 /**
  * This is the list of priority required by the application
  * Each Id shall be in the range 0..31
@@ -699,7 +783,12 @@ typedef enum
 {
   CFG_SCH_PRIO_0,
   /* USER CODE BEGIN CFG_SCH_Prio_Id_t */
-
+  /* CFG_SCH_PRIO_0 : Midi emission, set with a deadline, and the HCI events
+   * CFG_SCH_PRIO_1 : Distance sensor, connection parameters and external flash jobs
+   * CFG_SCH_PRIO_2 : LCD and reports, only run when nothing else is pending */
+  CFG_SCH_PRIO_1,
+  CFG_SCH_PRIO_2,
+  CFG_SCH_PRIO_NBR,
   /* USER CODE END CFG_SCH_Prio_Id_t */
 } CFG_SCH_Prio_Id_t;
 
@@ -727,6 +816,8 @@ typedef enum
   CFG_LPM_APP,
   CFG_LPM_APP_BLE,
   /* USER CODE BEGIN CFG_LPM_Id_t */
+  CFG_LPM_APP_TRACE,
+  CFG_LPM_APP_LED,
 
   /* USER CODE END CFG_LPM_Id_t */
 } CFG_LPM_Id_t;
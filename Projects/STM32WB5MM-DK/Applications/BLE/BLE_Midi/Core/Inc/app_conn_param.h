@@ -0,0 +1,50 @@
+/**
+  ******************************************************************************
+  * @file    app_conn_param.h
+  * @author  MCD Application Team
+  * @brief   Header for app_conn_param.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_CONN_PARAM_H
+#define __APP_CONN_PARAM_H
+
+/* Includes ------------------------------------------------------------------*/
+
+/* Defines -------------------------------------------------------------------*/
+/* Latency target while Midi is flowing : connection interval up to 11.25 ms */
+#define CONN_PARAM_ACTIVE_INTERVAL_MIN  CONN_P(7.5)
+#define CONN_PARAM_ACTIVE_INTERVAL_MAX  CONN_P(11.25)
+
+/* Power saving parameters once idle */
+#define CONN_PARAM_IDLE_INTERVAL_MIN    CONN_P(120)
+#define CONN_PARAM_IDLE_INTERVAL_MAX    CONN_P(150)
+#define CONN_PARAM_IDLE_SLAVE_LATENCY   (4U)
+
+/* Time without Midi traffic before going back to the idle parameters, in ms */
+#define CONN_PARAM_IDLE_DELAY           (5000U)
+
+/* Period of the policy check, also the delay before retrying a refused request */
+#define CONN_PARAM_CHECK_PERIOD         (1*1000*1000/CFG_TS_TICK_VAL) /**< 1s */
+
+/* Exported functions ------------------------------------------------------- */
+void CONN_PARAM_Init(void);
+void CONN_PARAM_Activity(void);
+void CONN_PARAM_Connected(uint16_t Handle, uint16_t Interval, uint16_t Latency, uint16_t Timeout);
+void CONN_PARAM_Disconnected(uint16_t Handle);
+void CONN_PARAM_Update_Resp(uint16_t Handle, uint16_t Result);
+void CONN_PARAM_Update_Complete(uint8_t Status, uint16_t Handle, uint16_t Interval, uint16_t Latency, uint16_t Timeout);
+uint32_t CONN_PARAM_Get_Interval_Us(void);
+
+#endif /* __APP_CONN_PARAM_H */
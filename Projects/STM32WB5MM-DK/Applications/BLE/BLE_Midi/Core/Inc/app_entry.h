@@ -68,9 +68,9 @@ void Init_Exti(void);
 void Init_Smps(void);
 
 /* USER CODE BEGIN EF */
-  void LED_Deinit(void);
   void LED_On(aPwmLedGsData_TypeDef aPwmLedGsData);
   void LED_Off(void);
+  void APPE_Cycle_Counter_Init(void);
 /* USER CODE END EF */
 
 #ifdef __cplusplus
@@ -0,0 +1,67 @@
+/**
+  ******************************************************************************
+  * @file    app_ext_flash.h
+  * @author  MCD Application Team
+  * @brief   Header for app_ext_flash.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_EXT_FLASH_H
+#define __APP_EXT_FLASH_H
+
+/* Includes ------------------------------------------------------------------*/
+
+/* Defines -------------------------------------------------------------------*/
+/* Address of the S25FL128S in memory mapped mode, the functions below take offsets in the memory */
+#define EXT_FLASH_MAPPED_ADDRESS        (0x90000000U)
+
+/*
+ * Erase unit of SECTOR_ERASE_CMD. With the 4 KB parameter sectors at the bottom of the memory,
+ * the first 128 KB are not made of 64 KB sectors : only erase above EXT_FLASH_PARAM_SECTORS_END.
+ */
+#define EXT_FLASH_SECTOR_SIZE           (0x10000U)
+#define EXT_FLASH_PARAM_SECTORS_END     (0x20000U)
+#define EXT_FLASH_PAGE_SIZE             (256U)
+
+/* Worst case of a 64 KB sector erase (tSE) and of a page program (tPP 750 us), in ms */
+#define EXT_FLASH_SECTOR_ERASE_MAX_TIME (2600U)
+#define EXT_FLASH_PAGE_PROGRAM_MAX_TIME (2U)
+
+/* Program and erase jobs queued, a power of 2 */
+#define EXT_FLASH_JOB_QUEUE_SIZE        (8U)
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  EXT_FLASH_OK,
+  EXT_FLASH_BUSY,                       /*!< Job queue full, or jobs still queued */
+  EXT_FLASH_ERROR,                      /*!< QSPI error, or program / erase error reported by the memory */
+} Ext_Flash_Status_t;
+
+/*
+ * End of a job, called by the flash task in the order the jobs were queued.
+ * Offset and Size are the ones of the job, a new job may be queued from the callback.
+ */
+typedef void (*Ext_Flash_Callback_t)(Ext_Flash_Status_t Status, uint32_t Offset, uint32_t Size);
+
+/* Exported functions ------------------------------------------------------- */
+void EXT_FLASH_Init(void);
+Ext_Flash_Status_t EXT_FLASH_Memory_Mapped_Enable(void);
+Ext_Flash_Status_t EXT_FLASH_Memory_Mapped_Disable(void);
+uint8_t EXT_FLASH_Is_Memory_Mapped(void);
+uint8_t EXT_FLASH_Is_Idle(void);
+Ext_Flash_Status_t EXT_FLASH_Erase_Sector(uint32_t Offset, Ext_Flash_Callback_t Callback);
+Ext_Flash_Status_t EXT_FLASH_Program(uint32_t Offset, const uint8_t *pData, uint32_t Size, Ext_Flash_Callback_t Callback);
+
+#endif /* __APP_EXT_FLASH_H */
@@ -0,0 +1,92 @@
+/**
+  ******************************************************************************
+  * @file    app_hostctl.h
+  * @author  MCD Application Team
+  * @brief   Header for app_hostctl.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_HOSTCTL_H
+#define __APP_HOSTCTL_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "app_conf.h"
+
+/* Defines -------------------------------------------------------------------*/
+/* Circular DMA reception buffer, the events at half and full buffer leave 128 bytes to the task to read it */
+#define HOSTCTL_RX_DMA_SIZE             (256U)
+
+/* Largest data of a frame, after the type and the sequence number */
+#define HOSTCTL_DATA_MAX_SIZE           (250U)
+
+/* Largest encoded frame : type, sequence number, status, data, CRC and the COBS overhead */
+#define HOSTCTL_FRAME_MAX_SIZE          (HOSTCTL_DATA_MAX_SIZE + 6U)
+
+/*
+ * Frames are sent as 0x00, the COBS encoding of the payload and its CRC-16/CCITT-FALSE (little endian), 0x00.
+ * Outside of a frame the bytes are text commands ended by a carriage return, as typed on a terminal.
+ */
+#define HOSTCTL_DELIMITER               (0x00U)
+
+/* Request types, the response has the type of the request with HOSTCTL_RESPONSE set */
+#define HOSTCTL_TYPE_PING               (0x01U) /*!< Data echoed back */
+#define HOSTCTL_TYPE_TRANSPORT          (0x02U) /*!< One HOSTCTL_TRANSPORT_xxx byte, the play state is returned */
+#define HOSTCTL_TYPE_MIDI               (0x03U) /*!< Complete midi messages sent to the centrals */
+#define HOSTCTL_TYPE_STATS_GET          (0x04U) /*!< Number of words then HOSTCTL_STATS_xxx words, little endian */
+#define HOSTCTL_TYPE_STATS_RESET        (0x05U)
+#define HOSTCTL_TYPE_COMMAND            (0x06U) /*!< Text command, same as on the terminal */
+#define HOSTCTL_RESPONSE                (0x80U)
+
+#define HOSTCTL_TRANSPORT_PAUSE         (0x00U)
+#define HOSTCTL_TRANSPORT_PLAY          (0x01U)
+#define HOSTCTL_TRANSPORT_RESTART       (0x02U)
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  HOSTCTL_STATUS_OK,
+  HOSTCTL_STATUS_UNKNOWN,               /*!< Unknown request type */
+  HOSTCTL_STATUS_LENGTH,                /*!< Data length not valid for the request */
+  HOSTCTL_STATUS_MIDI,                  /*!< Incomplete or unsupported midi message, nothing sent */
+  HOSTCTL_STATUS_BUSY,                  /*!< Request not possible now */
+} HostCtl_Status_t;
+
+/* Words of the HOSTCTL_TYPE_STATS_GET response */
+typedef enum
+{
+  HOSTCTL_STATS_RX_BYTES,               /*!< Bytes received on the UART */
+  HOSTCTL_STATS_FRAMES,                 /*!< Valid frames */
+  HOSTCTL_STATS_CRC_ERRORS,
+  HOSTCTL_STATS_FRAMING_ERRORS,         /*!< Bad COBS encoding, frame too short or too long */
+  HOSTCTL_STATS_OVERRUNS,               /*!< Bytes overwritten by the DMA before being read */
+  HOSTCTL_STATS_UART_ERRORS,            /*!< Reception restarted after a UART error */
+  HOSTCTL_STATS_MIDI_MESSAGES,          /*!< Midi messages received from the host */
+  HOSTCTL_STATS_CPU_LOAD,               /*!< Per mille, 0 when CFG_LATENCY_PROBES is 0 */
+  HOSTCTL_STATS_MBOX_PEAK_BYTES,        /*!< Peak of the mailbox event pool held by CPU1 */
+  HOSTCTL_STATS_MBOX_SPARE_EVT,         /*!< Events received in a spare buffer */
+  HOSTCTL_STATS_HCI_QUEUE_MAX,          /*!< Peak of the HCI event queue */
+  HOSTCTL_STATS_PLAYING,
+  HOSTCTL_STATS_TICK,                   /*!< HAL_GetTick() */
+  HOSTCTL_STATS_ELAPSED_MS,             /*!< Song time played, following the tempo map */
+  HOSTCTL_STATS_REMAINING_MS,
+  HOSTCTL_STATS_PROGRESS,               /*!< Per mille of the song duration */
+  HOSTCTL_STATS_NBR,
+} HostCtl_Stats_Word_t;
+
+/* Exported functions ------------------------------------------------------- */
+void HOSTCTL_Init(void (*pTextCmdCb)(const char *pCmd));
+void HOSTCTL_Reset_Stats(void);
+void HOSTCTL_Uart_Tx_Done(void);
+
+#endif /* __APP_HOSTCTL_H */
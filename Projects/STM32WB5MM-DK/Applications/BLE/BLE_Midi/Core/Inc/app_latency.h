@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @file    app_latency.h
+  * @author  MCD Application Team
+  * @brief   Header for app_latency.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_LATENCY_H
+#define __APP_LATENCY_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "app_conf.h"
+
+/* Defines -------------------------------------------------------------------*/
+/* Histogram : 8 bins per power of two, exact up to 8 us, 12.5% wide above, up to 262 ms */
+#define LATENCY_BIN_SUB_BITS            (3U)
+#define LATENCY_BIN_NBR                 (128U)
+
+/* A stage not closed within this time is dropped (tick with no Midi to send) */
+#define LATENCY_TIMEOUT_US              (100000U)
+
+/* Period of the CPU load computation */
+#define LATENCY_LOAD_PERIOD             (1*1000*1000/CFG_TS_TICK_VAL) /**< 1s */
+
+#if (CFG_LATENCY_PROBES != 0)
+#define LATENCY_PROBE(probe)            LATENCY_Probe(probe)
+#else
+#define LATENCY_PROBE(probe)
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  LATENCY_PROBE_SEQ_TIMER,              /*!< Midi sequencer timer callback */
+  LATENCY_PROBE_SEQ_DISPATCH,           /*!< Midi sequencer task started by UTIL_SEQ_Run */
+  LATENCY_PROBE_UPDATE_ENTRY,           /*!< aci_gatt_update_char_value called */
+  LATENCY_PROBE_UPDATE_EXIT,            /*!< aci_gatt_update_char_value returned */
+  LATENCY_PROBE_TX_POOL_FULL,           /*!< Notification refused, no TX buffer */
+  LATENCY_PROBE_TX_POOL_AVAILABLE,      /*!< ACI_GATT_TX_POOL_AVAILABLE event */
+} Latency_Probe_t;
+
+typedef enum
+{
+  LATENCY_STAGE_TIMER_TO_DISPATCH,      /*!< Sequencer timer to Midi task start */
+  LATENCY_STAGE_DISPATCH_TO_UPDATE,     /*!< Midi task start to the first characteristic update */
+  LATENCY_STAGE_UPDATE,                 /*!< Duration of each characteristic update */
+  LATENCY_STAGE_TX_POOL_WAIT,           /*!< TX buffers full to TX pool available */
+  LATENCY_STAGE_END_TO_END,             /*!< Sequencer timer to the end of the first update */
+  LATENCY_STAGE_NBR,
+} Latency_Stage_t;
+
+typedef struct
+{
+  uint32_t              Count;          /*!< Measures since the last reset */
+  uint32_t              Min_Us;
+  uint32_t              Avg_Us;
+  uint32_t              Max_Us;
+  uint32_t              P99_Us;         /*!< Upper bound of the bin holding the 99th percentile */
+} Latency_Stats_t;
+
+/* Exported functions ------------------------------------------------------- */
+void LATENCY_Init(void);
+void LATENCY_Probe(Latency_Probe_t Probe);
+void LATENCY_Task_Dispatch(uint32_t TaskIdx);
+void LATENCY_Get_Stats(Latency_Stage_t Stage, Latency_Stats_t *pStats);
+uint16_t LATENCY_Get_Cpu_Load(void);
+void LATENCY_Reset(void);
+void LATENCY_Report(void);
+
+#endif /* __APP_LATENCY_H */
@@ -0,0 +1,48 @@
+/**
+  ******************************************************************************
+  * @file    app_lcd_text.h
+  * @author  MCD Application Team
+  * @brief   Header for app_lcd_text.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_LCD_TEXT_H
+#define __APP_LCD_TEXT_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32_lcd.h"
+
+/* Exported types ------------------------------------------------------------*/
+/*
+ * Font converted by Tools/lcd_font_convert.py : each character is Width columns of
+ * ((Height + 7) / 8) bytes, least significant bit on top, like the pages of the SSD1315.
+ */
+typedef struct
+{
+  const uint8_t *pColumns;
+  uint16_t Width;
+  uint16_t Height;                      /*!< 24 at most */
+} Lcd_Text_Font_t;
+
+/* Exported variables --------------------------------------------------------*/
+extern const Lcd_Text_Font_t Lcd_Font12;
+
+/* Exported functions ------------------------------------------------------- */
+void LCD_TEXT_Init(void);
+void LCD_TEXT_DisplayStringAt(uint32_t Xpos, uint32_t Ypos, const uint8_t *pText, Text_AlignModeTypdef Mode);
+void LCD_TEXT_DisplayStringAtLine(uint32_t Line, const uint8_t *pText);
+void LCD_TEXT_ClearStringLine(uint32_t Line);
+void LCD_TEXT_Refresh(void);
+
+#endif /* __APP_LCD_TEXT_H */
@@ -0,0 +1,55 @@
+/**
+  ******************************************************************************
+  * @file    app_led.h
+  * @author  MCD Application Team
+  * @brief   Header for app_led.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_LED_H
+#define __APP_LED_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32wb5mm_dk.h"
+
+/* Defines -------------------------------------------------------------------*/
+/*
+ * Single wire interface of the RGB LED driver, played by TIM17 channel 1 on the SDI pin : each
+ * slot of LED_PWM_SLOT_US starts with a pulse or stays low, a bit is LED_PWM_SLOTS_PER_BIT
+ * slots. The data is 1 when the second slot of the bit has a pulse.
+ */
+#define LED_PWM_SLOT_US                 (5U)
+#define LED_PWM_PULSE_US                (2U)
+#define LED_PWM_SLOTS_PER_BIT           (4U)
+
+/* Cycles with no pulse after the grayscale data, the driver latches them */
+#define LED_PWM_EOS_CYCLES              (8U)
+
+/* DMA writing the compare value of each slot at the timer update, see DMA1_Channel2_IRQHandler() */
+#define LED_PWM_DMA_CHANNEL             DMA1_Channel2
+#define LED_PWM_DMA_IRQn                DMA1_Channel2_IRQn
+#define LED_PWM_DMA_IT_PRIORITY         (6U)
+
+/* Flash of the LED on each Note On, the color gives the channel and the brightness the velocity */
+#define LED_NOTE_FLASH_DURATION         (60*1000/CFG_TS_TICK_VAL) /**< 60ms */
+#define LED_NOTE_MAX_GSDATA             PWM_LED_GSDATA_19_6
+
+/* Exported functions ------------------------------------------------------- */
+void LED_PWM_Init(void);
+void LED_PWM_Set(aPwmLedGsData_TypeDef aPwmLedGsData);
+void LED_PWM_Note(uint8_t Channel, uint8_t Velocity, uint32_t Timestamp);
+uint8_t LED_PWM_Busy(void);
+void LED_PWM_IRQHandler(void);
+
+#endif /* __APP_LED_H */
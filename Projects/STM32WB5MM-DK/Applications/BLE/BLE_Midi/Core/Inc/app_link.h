@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file    app_link.h
+  * @author  MCD Application Team
+  * @brief   Header for app_link.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_LINK_H
+#define __APP_LINK_H
+
+/* Includes ------------------------------------------------------------------*/
+
+/* Defines -------------------------------------------------------------------*/
+/* Data Length Extension : longest link layer payload and its air time on the 1M PHY */
+#define LINK_MAX_TX_OCTETS              (251U)
+#define LINK_MAX_TX_TIME                (2120U)         /* us */
+
+/* Values in use before any negotiation */
+#define LINK_DEFAULT_TX_OCTETS          (27U)
+#define LINK_DEFAULT_ATT_MTU            (23U)
+
+/* Period of the throughput computation */
+#define LINK_STATS_PERIOD               (1*1000*1000/CFG_TS_TICK_VAL) /**< 1s */
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint16_t              Handle;                 /*!< Connection handle */
+  uint8_t               Tx_Phy;                 /*!< 1 : LE 1M, 2 : LE 2M */
+  uint8_t               Rx_Phy;                 /*!< 1 : LE 1M, 2 : LE 2M */
+  uint16_t              Max_Tx_Octets;          /*!< Link layer payload, 27 without DLE */
+  uint16_t              Max_Rx_Octets;          /*!< Link layer payload, 27 without DLE */
+  uint16_t              Att_Mtu;                /*!< Negotiated ATT_MTU */
+  uint32_t              Tx_Bytes;               /*!< Notified bytes since the connection */
+  uint32_t              Tx_Notifications;       /*!< Notifications since the connection */
+  uint32_t              Bytes_Per_Sec;          /*!< Notified bytes during the last second */
+  uint32_t              Notifications_Per_Sec;  /*!< Notifications during the last second */
+} Link_Info_t;
+
+/* Exported functions ------------------------------------------------------- */
+void LINK_Init(void);
+void LINK_Connected(uint16_t Handle);
+void LINK_Disconnected(uint16_t Handle);
+void LINK_Phy_Update(uint16_t Handle, uint8_t Tx_Phy, uint8_t Rx_Phy);
+void LINK_Data_Length_Change(uint16_t Handle, uint16_t Max_Tx_Octets, uint16_t Max_Rx_Octets);
+void LINK_Mtu_Exchanged(uint16_t Handle, uint16_t Mtu);
+void LINK_Notified(uint16_t Handle, uint16_t Length);
+uint16_t LINK_Get_Payload_Size(uint16_t Handle);
+uint8_t LINK_Get_Connected_Nbr(void);
+const Link_Info_t * LINK_Get_Info(uint16_t Handle);
+
+#endif /* __APP_LINK_H */
@@ -25,12 +25,34 @@
 /* Defines -------------------------------------------------------------------*/
 #define MAX_EVENTS              (2000U)
 
+/* System real time and common messages used for the transport */
+#define MIDI_SONG_POSITION      (0xF2U)
+#define MIDI_TIMING_CLOCK       (0xF8U)
+#define MIDI_START              (0xFAU)
+#define MIDI_CONTINUE           (0xFBU)
+#define MIDI_STOP               (0xFCU)
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint8_t               Playing;                /*!< 0 when the player is paused */
+  uint16_t              Progress;               /*!< Per mille of the song duration */
+  uint32_t              Elapsed_Ms;             /*!< Song time of the last event sent */
+  uint32_t              Remaining_Ms;
+  uint32_t              Duration_Ms;            /*!< Song duration following the tempo map */
+} Midi_Player_State_t;
+
 /* Exported functions ------------------------------------------------------- */
+void MIDI_Load(void);
 void MIDI_Init(void);
 void Midi_Button_Switch_Mode(void);
 void Midi_Button_Restart(void);
+uint8_t Midi_Is_Playing(void);
+void Midi_Get_Player_State(Midi_Player_State_t *pState);
+void Midi_Reload_Song(void);
 void Midi_Start_Measures(void);
 void Midi_Stop_Measures(void);
+void Midi_Clock_Drain(void);
 
 #endif /* __APP_MIDI_H */
 
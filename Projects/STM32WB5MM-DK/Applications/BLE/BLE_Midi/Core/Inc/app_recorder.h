@@ -0,0 +1,46 @@
+/**
+  ******************************************************************************
+  * @file    app_recorder.h
+  * @author  MCD Application Team
+  * @brief   Header for app_recorder.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_RECORDER_H
+#define __APP_RECORDER_H
+
+/* Includes ------------------------------------------------------------------*/
+
+/* Defines -------------------------------------------------------------------*/
+/*
+ * Log of the takes, above the song store slots. The pages are written one after the other and the
+ * log wraps around : each sector is erased in turn, just before the write pointer enters it.
+ */
+#define RECORDER_LOG_OFFSET             (0x300000U)
+#define RECORDER_LOG_SIZE               (0x400000U)
+
+/* Pages filled in RAM while the previous ones are programmed, and while a sector is erased */
+#define RECORDER_PAGE_BUFFER_NBR        (8U)
+
+/* Standard midi file of a take : 1 tick per ms, 500 ticks per quarter note at 120 bpm */
+#define RECORDER_TICKS_PER_BEAT         (500U)
+
+/* Exported functions ------------------------------------------------------- */
+void RECORDER_Init(void);
+void RECORDER_Start(void);
+void RECORDER_Stop(void);
+void RECORDER_Save_Last_Take(void);
+void RECORDER_Midi_Event(const uint8_t *pMsg, uint8_t Length, uint32_t Timestamp);
+
+#endif /* __APP_RECORDER_H */
@@ -0,0 +1,52 @@
+/**
+  ******************************************************************************
+  * @file    app_settings.h
+  * @author  MCD Application Team
+  * @brief   Header for app_settings.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_SETTINGS_H
+#define __APP_SETTINGS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+/*
+ * Two sectors after the recorder log keep the settings records, one per page. A new record is
+ * written in the next page : the valid record with the highest sequence number is the current one.
+ * A sector is erased just before the first record written in it, the last record of the other
+ * sector stays intact.
+ */
+#define SETTINGS_OFFSET                 (0x700000U)
+#define SETTINGS_SIZE                   (0x20000U)
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint8_t               Tof_Calibrated;         /*!< The reference calibration of the VL53L0X below is valid */
+  uint8_t               Tof_Aperture_Spads;     /*!< Reference SPADs of type aperture */
+  uint8_t               Tof_Vhv_Settings;       /*!< VHV of the reference calibration */
+  uint8_t               Tof_Phase_Cal;          /*!< Phase of the reference calibration */
+  uint32_t              Tof_Ref_Spad_Count;     /*!< Number of reference SPADs */
+} Settings_t;
+
+/* Exported functions ------------------------------------------------------- */
+void SETTINGS_Load(void);
+void SETTINGS_Init(void);
+const Settings_t * SETTINGS_Get(void);
+void SETTINGS_Save(const Settings_t *pSettings);
+
+#endif /* __APP_SETTINGS_H */
@@ -0,0 +1,57 @@
+/**
+  ******************************************************************************
+  * @file    app_song_store.h
+  * @author  MCD Application Team
+  * @brief   Header for app_song_store.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_SONG_STORE_H
+#define __APP_SONG_STORE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "app_ext_flash.h"
+
+/* Defines -------------------------------------------------------------------*/
+/*
+ * Two slots of the external memory receive the uploaded midi files. The first page of a slot is a header
+ * programmed after the file has been written and verified : the valid slot with the highest sequence
+ * number is the active song. A new file is always written in the other slot, the active song stays
+ * intact until the new header is programmed. Without a valid slot, the file flashed with
+ * STM32CubeProgrammer at the start of the memory is played.
+ */
+#define SONG_STORE_LEGACY_OFFSET        (0x000000U)
+#define SONG_STORE_SLOT_0_OFFSET        (0x100000U)
+#define SONG_STORE_SLOT_1_OFFSET        (0x200000U)
+#define SONG_STORE_SLOT_SIZE            (0x100000U)
+#define SONG_STORE_SLOT_NBR             (2U)
+#define SONG_STORE_HEADER_SIZE          (EXT_FLASH_PAGE_SIZE)
+#define SONG_STORE_FILE_MAX_SIZE        (SONG_STORE_SLOT_SIZE - SONG_STORE_HEADER_SIZE)
+
+#define SONG_STORE_NO_SLOT              (0xFFU)
+
+/* Exported types ------------------------------------------------------------*/
+/* End of SONG_STORE_Commit(), EXT_FLASH_OK once the new song is active */
+typedef void (*Song_Store_Callback_t)(Ext_Flash_Status_t Status);
+
+/* Exported functions ------------------------------------------------------- */
+void SONG_STORE_Init(void);
+const uint8_t * SONG_STORE_Get_Song(uint32_t *pSize);
+uint32_t SONG_STORE_Get_Free_Slot(void);
+Ext_Flash_Status_t SONG_STORE_Open_Slot(uint32_t *pSlot_Offset);
+void SONG_STORE_Close_Slot(void);
+Ext_Flash_Status_t SONG_STORE_Commit(uint32_t Slot_Offset, uint32_t Size, uint32_t Crc, Song_Store_Callback_t Callback);
+uint32_t SONG_STORE_Crc32(uint32_t Crc, const uint8_t *pData, uint32_t Size);
+
+#endif /* __APP_SONG_STORE_H */
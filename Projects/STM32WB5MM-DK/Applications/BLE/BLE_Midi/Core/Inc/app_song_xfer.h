@@ -0,0 +1,74 @@
+/**
+  ******************************************************************************
+  * @file    app_song_xfer.h
+  * @author  MCD Application Team
+  * @brief   Header for app_song_xfer.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_SONG_XFER_H
+#define __APP_SONG_XFER_H
+
+/* Includes ------------------------------------------------------------------*/
+
+/* Defines -------------------------------------------------------------------*/
+/*
+ * Reception buffer. The client keeps at most SONG_XFER_WINDOW bytes written beyond the last
+ * SONG_XFER_REPORT_ACK offset, the radio keeps filling the buffer while a sector is erased.
+ */
+#define SONG_XFER_BUFFER_SIZE           (8192U)
+#define SONG_XFER_WINDOW                SONG_XFER_BUFFER_SIZE
+
+/* An acknowledge is notified each time this number of bytes more is programmed */
+#define SONG_XFER_ACK_STEP              (2048U)
+
+/*
+ * Control characteristic, little endian :
+ *   request  SONG_XFER_REQ_START  : file size (4), CRC-32 of the file (4)
+ *            response             : SONG_XFER_REQ_START | SONG_XFER_RESPONSE, status, window (2)
+ *   request  SONG_XFER_REQ_ABORT  : the end report follows
+ *   report   SONG_XFER_REPORT_ACK : bytes programmed (4)
+ *   report   SONG_XFER_REPORT_END : status, bytes programmed (4), duration in ms (4), bytes per second (4)
+ */
+#define SONG_XFER_REQ_START             (0x01U)
+#define SONG_XFER_REQ_ABORT             (0x02U)
+#define SONG_XFER_REPORT_ACK            (0x10U)
+#define SONG_XFER_REPORT_END            (0x11U)
+#define SONG_XFER_RESPONSE              (0x80U)
+
+/*
+ * Statistics characteristic, read only, little endian : number of stages (1), CPU load per mille (2), then for
+ * each Latency_Stage_t its count, min, average, max and 99th percentile in us (4 each). No stage is given when
+ * CFG_LATENCY_PROBES is 0.
+ */
+#define SONG_XFER_STATS_HEADER_SIZE     (3U)
+#define SONG_XFER_STATS_STAGE_SIZE      (20U)
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  SONG_XFER_STATUS_OK,
+  SONG_XFER_STATUS_BUSY,                /*!< Transfer in progress with another client, or take being recorded */
+  SONG_XFER_STATUS_SIZE,                /*!< File larger than a slot of the song store */
+  SONG_XFER_STATUS_PROTOCOL,            /*!< Bad request, or data beyond the window or the file size */
+  SONG_XFER_STATUS_FLASH,               /*!< Erase or program error */
+  SONG_XFER_STATUS_CRC,                 /*!< CRC of the file read back differs, the song is not changed */
+  SONG_XFER_STATUS_ABORTED,             /*!< Aborted by the client or disconnected */
+} Song_Xfer_Status_t;
+
+/* Exported functions ------------------------------------------------------- */
+void SONG_XFER_Init(void);
+void SONG_XFER_Disconnected(uint16_t ConnectionHandle);
+
+#endif /* __APP_SONG_XFER_H */
@@ -0,0 +1,97 @@
+/**
+  ******************************************************************************
+  * @file    app_trace.h
+  * @author  MCD Application Team
+  * @brief   Header for app_trace.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_TRACE_H
+#define __APP_TRACE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "app_conf.h"
+
+/* Defines -------------------------------------------------------------------*/
+/* Size of the RAM ring, in 32 bits words, shall be a power of 2 */
+#define TRACE_BUFFER_WORDS              (512U)
+
+/* Largest block handed to the UART at once, in 32 bits words */
+#define TRACE_DRAIN_MAX_WORDS           (64U)
+
+/* First byte of each record, never found in the text traces */
+#define TRACE_SYNC                      (0xA5U)
+
+/* Format strings are not loaded in the target : only their address is recorded and
+ * Tools/trace_decode.py reads the string back from the ELF file */
+#if defined(__GNUC__)
+#define TRACE_FMT_SECTION               __attribute__((section(".trace_fmt"), used))
+#else
+#define TRACE_FMT_SECTION
+#endif
+
+/*
+ * APP_TRACEn : record a trace with n 32 bits arguments in a few cycles, from tasks or interrupts.
+ * Arguments are printed with the printf conversions of the format, %s is only valid for
+ * constant strings. Falls back to APP_DBG_MSG when CFG_DEBUG_TRACE_BINARY is 0.
+ */
+#if (CFG_DEBUG_TRACE_BINARY != 0)
+#define APP_TRACE0(fmt)                                                         \
+  do {                                                                          \
+    static const char TRACE_FMT_SECTION trace_fmt[] = fmt;                      \
+    TRACE_Record(trace_fmt, 0, NULL);                                           \
+  } while(0)
+
+#define APP_TRACE1(fmt, a1)                                                     \
+  do {                                                                          \
+    static const char TRACE_FMT_SECTION trace_fmt[] = fmt;                      \
+    uint32_t trace_args[1] = {(uint32_t)(a1)};                                  \
+    TRACE_Record(trace_fmt, 1, trace_args);                                     \
+  } while(0)
+
+#define APP_TRACE2(fmt, a1, a2)                                                 \
+  do {                                                                          \
+    static const char TRACE_FMT_SECTION trace_fmt[] = fmt;                      \
+    uint32_t trace_args[2] = {(uint32_t)(a1), (uint32_t)(a2)};                  \
+    TRACE_Record(trace_fmt, 2, trace_args);                                     \
+  } while(0)
+
+#define APP_TRACE3(fmt, a1, a2, a3)                                             \
+  do {                                                                          \
+    static const char TRACE_FMT_SECTION trace_fmt[] = fmt;                      \
+    uint32_t trace_args[3] = {(uint32_t)(a1), (uint32_t)(a2), (uint32_t)(a3)};  \
+    TRACE_Record(trace_fmt, 3, trace_args);                                     \
+  } while(0)
+
+#define APP_TRACE4(fmt, a1, a2, a3, a4)                                         \
+  do {                                                                          \
+    static const char TRACE_FMT_SECTION trace_fmt[] = fmt;                      \
+    uint32_t trace_args[4] = {(uint32_t)(a1), (uint32_t)(a2),                   \
+                              (uint32_t)(a3), (uint32_t)(a4)};                  \
+    TRACE_Record(trace_fmt, 4, trace_args);                                     \
+  } while(0)
+#else
+#define APP_TRACE0(fmt)                         APP_DBG_MSG(fmt)
+#define APP_TRACE1(fmt, a1)                     APP_DBG_MSG(fmt, a1)
+#define APP_TRACE2(fmt, a1, a2)                 APP_DBG_MSG(fmt, a1, a2)
+#define APP_TRACE3(fmt, a1, a2, a3)             APP_DBG_MSG(fmt, a1, a2, a3)
+#define APP_TRACE4(fmt, a1, a2, a3, a4)         APP_DBG_MSG(fmt, a1, a2, a3, a4)
+#endif /* CFG_DEBUG_TRACE_BINARY */
+
+/* Exported functions ------------------------------------------------------- */
+void TRACE_Init(void);
+void TRACE_Record(const char *pFmt, uint8_t Nargs, const uint32_t *pArgs);
+void TRACE_Drain(void);
+
+#endif /* __APP_TRACE_H */
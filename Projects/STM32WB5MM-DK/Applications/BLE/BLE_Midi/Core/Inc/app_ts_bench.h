@@ -0,0 +1,38 @@
+/**
+  ******************************************************************************
+  * @file    app_ts_bench.h
+  * @author  MCD Application Team
+  * @brief   Header for app_ts_bench.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_TS_BENCH_H
+#define __APP_TS_BENCH_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "app_conf.h"
+
+/* Defines -------------------------------------------------------------------*/
+/* Timers added to the application ones, restarted at random for the duration */
+#define TS_BENCH_TIMER_NBR              (24U)
+#define TS_BENCH_MAX_TIMEOUT            (100*1000/CFG_TS_TICK_VAL)      /**< 100ms */
+#define TS_BENCH_DURATION               (5*1000*1000/CFG_TS_TICK_VAL)   /**< 5s */
+
+/* Exported functions ------------------------------------------------------- */
+void TS_BENCH_Init(void);
+void TS_BENCH_Start(void);
+void TS_BENCH_Reset(void);
+void TS_BENCH_Report(void);
+
+#endif /* __APP_TS_BENCH_H */
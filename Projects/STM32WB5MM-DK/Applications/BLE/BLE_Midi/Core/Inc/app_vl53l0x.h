@@ -32,6 +32,7 @@
 
 /* Exported functions ------------------------------------------------------- */
 void VL53L0X_PROXIMITY_Init(void);
+void VL53L0X_PROXIMITY_Calibrate(void);
 uint16_t VL53L0X_PROXIMITY_GetDistance(void);
 void VL53L0X_PROXIMITY_PrintValue(void);
 void VL53L0X_Start_Measure(void);
@@ -0,0 +1,86 @@
+/**
+  ******************************************************************************
+  * @file    audio_midi_dsp.h
+  * @author  MCD Application Team
+  * @brief   Header for audio_midi_dsp.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __AUDIO_MIDI_DSP_H
+#define __AUDIO_MIDI_DSP_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+/* Samples are right shifted by this amount during the in place pre-processing
+ * so that the energy and pitch accumulators stay in 32 bits products */
+#define AUDIO_DSP_PRESHIFT              (3U)
+
+/* Pitch search range, in samples (lag) */
+#define AUDIO_DSP_MIN_LAG               (8U)            /* 2 kHz at 16 kHz */
+#define AUDIO_DSP_MAX_LAG               (160U)          /* 100 Hz at 16 kHz */
+
+/* Range of notes the estimator can report */
+#define AUDIO_DSP_LOWEST_NOTE           (44U)           /* G#2 */
+#define AUDIO_DSP_HIGHEST_NOTE          (95U)           /* B6 */
+#define AUDIO_DSP_NOTE_NBR              (AUDIO_DSP_HIGHEST_NOTE - AUDIO_DSP_LOWEST_NOTE + 1U)
+
+/* Onset when the block energy is ONSET_RATIO times above the running average */
+#define AUDIO_DSP_ONSET_RATIO           (4U)
+/* Release when the block energy falls RELEASE_RATIO times below the onset one */
+#define AUDIO_DSP_RELEASE_RATIO         (16U)
+/* Absolute mean square gate, below it the block is considered as silence */
+#define AUDIO_DSP_NOISE_GATE            (64U)
+/* Minimum number of blocks between two onsets */
+#define AUDIO_DSP_REFRACTORY_BLOCKS     (3U)
+/* YIN threshold on the normalised difference, Q15 (0.15) */
+#define AUDIO_DSP_YIN_THRESHOLD_Q15     (4915U)
+
+#define AUDIO_DSP_EVT_NONE              (0U)
+#define AUDIO_DSP_EVT_NOTE_ON           (1U)
+#define AUDIO_DSP_EVT_NOTE_OFF          (2U)
+#define AUDIO_DSP_EVT_NOTE_CHANGE       (3U)    /* Note Off of PrevNote then Note On of Note */
+
+/* Exported types ----------------------------------------------------------- */
+typedef struct
+{
+  uint8_t       Event;          /*!< One of AUDIO_DSP_EVT_xxx */
+  uint8_t       Note;           /*!< Note to switch on (NOTE_ON / NOTE_CHANGE) or off (NOTE_OFF) */
+  uint8_t       PrevNote;       /*!< Note to switch off on NOTE_CHANGE */
+  uint8_t       Velocity;       /*!< Velocity derived from the onset energy */
+  uint32_t      Energy;         /*!< Mean square of the block (after pre-shift) */
+  uint32_t      LagQ4;          /*!< Estimated period in samples, Q4, 0 when unvoiced */
+} Audio_Dsp_Result_t;
+
+typedef struct
+{
+  uint32_t      SampleRate;                             /*!< Input sample rate in Hz */
+  uint32_t      AvgEnergy;                              /*!< Running energy average, Q4 */
+  uint32_t      OnsetEnergy;                            /*!< Energy of the block that triggered the sounding note */
+  int32_t       DcQ8;                                   /*!< DC offset tracker, Q8 */
+  uint8_t       Note;                                   /*!< Sounding note, 0 if none */
+  uint8_t       BlocksSinceOnset;                       /*!< Refractory counter */
+  uint8_t       Candidate;                              /*!< Pitch waiting to replace the sounding note */
+  uint8_t       CandidateCount;                         /*!< Number of blocks Candidate has been held */
+  uint32_t      NoteEdgeLagQ16[AUDIO_DSP_NOTE_NBR + 1]; /*!< Lag of the lower edge of each note, Q16 */
+  uint32_t      Diff[AUDIO_DSP_MAX_LAG + 1];            /*!< YIN difference function scratch */
+} Audio_Dsp_Context_t;
+
+/* Exported functions ------------------------------------------------------- */
+void    AUDIO_DSP_Init(Audio_Dsp_Context_t *pCtx, uint32_t SampleRate);
+void    AUDIO_DSP_Process(Audio_Dsp_Context_t *pCtx, int16_t *pPcm, uint32_t Size, Audio_Dsp_Result_t *pResult);
+void    AUDIO_DSP_Reset(Audio_Dsp_Context_t *pCtx);
+
+#endif /* __AUDIO_MIDI_DSP_H */
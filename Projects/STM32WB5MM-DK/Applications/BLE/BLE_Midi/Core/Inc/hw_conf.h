@@ -104,7 +104,15 @@
  * The user may define the maximum number of virtual timers supported.
  * It shall not exceed 255
  */
-#define CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER  6
+#define CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER  32
+
+/**
+ * When set to 1, the running timers are kept in a hierarchical timing wheel : the cost of HW_TS_Start(), HW_TS_Stop()
+ * and of the RTC wakeup interrupt does not depend on the number of running timers.
+ * When set to 0, they are kept in a list sorted on the time left, that is walked with the interrupts masked on each
+ * start, stop and timeout.
+ */
+#define CFG_HW_TS_TIMING_WHEEL  1
 
 /**
  * The user may define the priority in the NVIC of the RTC_WKUP interrupt handler that is used to manage the
@@ -164,6 +172,7 @@
 
 #define CFG_HW_USART1_ENABLED           1
 #define CFG_HW_USART1_DMA_TX_SUPPORTED  1
+#define CFG_HW_USART1_DMA_RX_SUPPORTED  1
 
 /**
  * UART1
@@ -209,4 +218,12 @@
 #define CFG_HW_USART1_TX_DMA_IRQn             DMA2_Channel4_IRQn
 #define CFG_HW_USART1_DMA_TX_IRQHandler       DMA2_Channel4_IRQHandler
 
+/** < Circular reception with idle line detection (HW_UART_Receive_DMA_Circular) */
+#define CFG_HW_USART1_DMA_RX_PREEMPTPRIORITY  0x0F
+#define CFG_HW_USART1_DMA_RX_SUBPRIORITY      0
+#define CFG_HW_USART1_RX_DMA_REQ              DMA_REQUEST_USART1_RX
+#define CFG_HW_USART1_RX_DMA_CHANNEL          DMA2_Channel5
+#define CFG_HW_USART1_RX_DMA_IRQn             DMA2_Channel5_IRQn
+#define CFG_HW_USART1_DMA_RX_IRQHandler       DMA2_Channel5_IRQHandler
+
 #endif /*HW_CONF_H */
@@ -76,11 +76,18 @@ extern "C" {
     hw_uart_to,
   } hw_status_t;
 
+  /**
+   * Position reported to the HW_UART_Receive_DMA_Circular() callback when the reception has been restarted after an
+   * error : the data received since the previous position is lost and the DMA writes again from the buffer start
+   */
+#define HW_UART_RX_RESTART      (0xFFFFU)
+
   void HW_UART_Init(hw_uart_id_t hw_uart_id);
   void HW_UART_Receive_IT(hw_uart_id_t hw_uart_id, uint8_t *pData, uint16_t Size, void (*Callback)(void));
   void HW_UART_Transmit_IT(hw_uart_id_t hw_uart_id, uint8_t *pData, uint16_t Size,  void (*Callback)(void));
   hw_status_t HW_UART_Transmit(hw_uart_id_t hw_uart_id, uint8_t *p_data, uint16_t size,  uint32_t timeout);
   hw_status_t HW_UART_Transmit_DMA(hw_uart_id_t hw_uart_id, uint8_t *p_data, uint16_t size, void (*Callback)(void));
+  hw_status_t HW_UART_Receive_DMA_Circular(hw_uart_id_t hw_uart_id, uint8_t *p_data, uint16_t size, void (*Callback)(uint16_t Pos));
   void HW_UART_Interrupt_Handler(hw_uart_id_t hw_uart_id);
   void HW_UART_DMA_Interrupt_Handler(hw_uart_id_t hw_uart_id);
 
@@ -125,6 +132,19 @@ extern "C" {
 
   typedef void (*HW_TS_pTimerCb_t)(void);
 
+  /**
+   * Worst case execution time of the timer server, in CPU cycles, recorded when CFG_HW_TS_BENCHMARK is set to 1.
+   * The time spent in the timer callbacks is not included
+   */
+  typedef struct
+  {
+    uint32_t IsrCount;
+    uint32_t IsrMaxCycles;
+    uint32_t StartMaxCycles;
+    uint32_t StopMaxCycles;
+    uint8_t  RunningMax;      /**< Highest number of timers running at the same time */
+  } HW_TS_Benchmark_t;
+
   /**
    * @brief  Initialize the timer server
    *         This API shall be called by the application before any timer is requested to the timer server. It
@@ -243,6 +263,24 @@ extern "C" {
    */
   void HW_TS_RTC_CountUpdated_AppNot(void);
 
+  /**
+   * @brief  Read the worst case execution times recorded since the last HW_TS_Benchmark_Reset()
+   *         Only available when CFG_HW_TS_BENCHMARK is set to 1
+   *
+   * @param  pBenchmark: Filled with the recorded values
+   * @retval None
+   */
+  void HW_TS_Benchmark_Get(HW_TS_Benchmark_t *pBenchmark);
+
+  /**
+   * @brief  Clear the worst case execution times
+   *         Only available when CFG_HW_TS_BENCHMARK is set to 1
+   *
+   * @param  None
+   * @retval None
+   */
+  void HW_TS_Benchmark_Reset(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -17,8 +17,8 @@
   */
   
 /* Define to prevent recursive inclusion -------------------------------------*/
-#ifndef __APP_MIDI_H
-#define __APP_MIDI_H
+#ifndef __SIMPLE_MIDI_PARSER_H
+#define __SIMPLE_MIDI_PARSER_H
 
 /* Includes ------------------------------------------------------------------*/
 
@@ -43,6 +43,12 @@
 #endif
 
 #define MAX_EVENTS              (2000U)
+#define MAX_TEMPO_EVENTS        (32U)
+/* Size of the track name buffer, end of string included */
+#define MAX_TRACKNAME_SIZE      (100U)
+
+/* Tempo used when the file does not set any (120 bpm) */
+#define MIDI_DEFAULT_TEMPO      (500000U)
 
 #define MIDI_PARSING_DONE       (0U)
 #define MIDI_PARSING_NO_FILE    (1U)
@@ -59,9 +65,16 @@ typedef struct
   uint8_t       Velocity;
 } Midi_Note_Event_t;
 
+typedef struct
+{
+  uint32_t      Tick;           /*!< Absolute position of the tempo change in ticks */
+  uint32_t      Tempo;          /*!< Tempo in microseconds per quarter note */
+} Midi_Tempo_Event_t;
+
 /* Exported functions ------------------------------------------------------- */
-uint8_t ParseMidi(uint8_t* flash, uint8_t* trackname, uint16_t* ticks_per_beat, 
-                  uint32_t* tempo, Midi_Note_Event_t* song, uint16_t* index);
+uint8_t ParseMidi(uint8_t* flash, uint32_t size, uint8_t* trackname, uint16_t* ticks_per_beat, 
+                  uint32_t* tempo, Midi_Note_Event_t* song, uint16_t* index,
+                  Midi_Tempo_Event_t* tempo_map, uint8_t* tempo_nbr);
 
-#endif /* __APP_MIDI_H */
+#endif /* __SIMPLE_MIDI_PARSER_H */
 
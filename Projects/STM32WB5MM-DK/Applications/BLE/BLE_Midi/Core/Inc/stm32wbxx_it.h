@@ -63,8 +63,11 @@ void DMA2_Channel4_IRQHandler(void);
 void IPCC_C1_RX_IRQHandler(void);
 void IPCC_C1_TX_IRQHandler(void);
 void RTC_WKUP_IRQHandler(void);
-void TIM1_TRG_COM_TIM17_IRQHandler(void);
 void PUSH_BUTTON_SW_EXTI_IRQHandler(void);
+#if (CFG_HW_USART1_DMA_RX_SUPPORTED == 1)
+void CFG_HW_USART1_DMA_RX_IRQHandler(void);
+#endif
+void DMA1_Channel2_IRQHandler(void);
 
 /* USER CODE END EFP */
 
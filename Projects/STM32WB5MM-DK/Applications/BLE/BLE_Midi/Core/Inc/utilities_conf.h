@@ -28,6 +28,7 @@ extern "C" {
 
 #include "cmsis_compiler.h"
 #include "string.h"
+#include "app_conf.h"
 
 /******************************************************************************
  * common
@@ -55,9 +56,18 @@ extern "C" {
 #define UTIL_SEQ_ENTER_CRITICAL_SECTION( )      UTILS_ENTER_CRITICAL_SECTION( )
 #define UTIL_SEQ_EXIT_CRITICAL_SECTION( )       UTILS_EXIT_CRITICAL_SECTION( )
 #define UTIL_SEQ_CONF_TASK_NBR                  (32)
-#define UTIL_SEQ_CONF_PRIO_NBR                  (2)
+#define UTIL_SEQ_CONF_PRIO_NBR                  CFG_SCH_PRIO_NBR
+#define UTIL_SEQ_CONF_EDF                       (1)
 #define UTIL_SEQ_MEMSET8( dest, value, size )   UTILS_MEMSET8( dest, value, size )
 
+#if (CFG_LATENCY_PROBES != 0)
+/* Midi latency probe on the task dispatch and task profiling, see app_latency.c */
+void LATENCY_Task_Dispatch( uint32_t TaskIdx );
+#define UTIL_SEQ_TASK_START_HOOK( task_idx )    LATENCY_Task_Dispatch( task_idx )
+#define UTIL_SEQ_CONF_PROFILING                 (1)
+#define UTIL_SEQ_PROFILING_GET_CYCLES( )        (DWT->CYCCNT)
+#endif
+
 #ifdef __cplusplus
 }
 #endif
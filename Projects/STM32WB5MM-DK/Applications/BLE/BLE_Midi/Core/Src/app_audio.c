@@ -0,0 +1,282 @@
+/**
+  ******************************************************************************
+  * @file    app_audio.c
+  * @author  MCD Application Team
+  * @brief   Microphone to Midi application file
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+#include "dbg_trace.h"
+#include "stm32_seq.h"
+#include "utilities_conf.h"
+#include "custom_app.h"
+#include "simple_midi_parser.h"
+#include "app_audio.h"
+
+#if (CFG_AUDIO_MIDI_SUPPORTED != 0)
+#include "stm32wb5mm_dk_audio.h"
+#include "audio_midi_dsp.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint8_t               Running;                /*!< Recording status */
+  volatile uint8_t      Ready;                  /*!< Bit field of the PCM buffers waiting for processing */
+  uint8_t               Next;                   /*!< Next PCM buffer to be filled */
+  uint32_t              Overruns;               /*!< Blocks dropped because the task was late */
+  uint32_t              Blocks;                 /*!< Blocks processed since the last report */
+  uint32_t              CyclesSum;              /*!< Cycles spent in processing since the last report */
+  uint32_t              CyclesMax;              /*!< Worst block since the last report */
+  Audio_Dsp_Context_t   Dsp;                    /*!< Onset and pitch detection state */
+} Audio_App_Context_t;
+
+/* Private defines -----------------------------------------------------------*/
+#define AUDIO_PCM_BLOCK_SIZE    ((AUDIO_IN_SAMPLING_FREQUENCY / 1000U) * N_MS_PER_INTERRUPT)
+/* Half of the SAI buffer is copied at each interrupt : PDM clock / 8 bytes per ms */
+#define AUDIO_PDM_BLOCK_SIZE    (((PDM_FREQ_16K / 8U) * N_MS_PER_INTERRUPT) / 2U)
+
+/* Private variables ---------------------------------------------------------*/
+static Audio_App_Context_t Audio_App_Context;
+static uint16_t PDM_Buffer[AUDIO_PDM_BLOCK_SIZE];
+static int16_t  PCM_Buffer[2][AUDIO_PCM_BLOCK_SIZE];
+
+/* Private function prototypes -----------------------------------------------*/
+static void Audio_Block_Ready(void);
+static void Audio_Midi_Process(void);
+static void Audio_Report(void);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Initialize the microphone and the note detection
+ */
+void AUDIO_MIDI_Init(void)
+{
+  BSP_AUDIO_Init_t AudioInit;
+
+  AudioInit.Device        = AUDIO_IN_DIGITAL_MIC;
+  AudioInit.SampleRate    = AUDIO_IN_SAMPLING_FREQUENCY;
+  AudioInit.BitsPerSample = AUDIO_RESOLUTION_16b;
+  AudioInit.ChannelsNbr   = AUDIO_IN_CHANNELS;
+  AudioInit.Volume        = AUDIO_VOLUME_INPUT;
+
+  if(BSP_AUDIO_IN_Init(0, &AudioInit) != BSP_ERROR_NONE)
+  {
+    APP_DBG_MSG("Audio in init failed\n\r");
+    return;
+  }
+
+  AUDIO_DSP_Init(&Audio_App_Context.Dsp, AUDIO_IN_SAMPLING_FREQUENCY);
+
+  UTIL_SEQ_RegTask(1<<CFG_TASK_AUDIO_MIDI, UTIL_SEQ_RFU, Audio_Midi_Process);
+
+  return;
+}
+
+/*
+ * @brief Start the microphone recording
+ */
+void AUDIO_MIDI_Start(void)
+{
+  if(Audio_App_Context.Running)
+  {
+    return;
+  }
+  AUDIO_DSP_Reset(&Audio_App_Context.Dsp);
+  Audio_App_Context.Ready = 0;
+  Audio_App_Context.Next = 0;
+  Audio_App_Context.Overruns = 0;
+  Audio_App_Context.Blocks = 0;
+  Audio_App_Context.CyclesSum = 0;
+  Audio_App_Context.CyclesMax = 0;
+
+  if(BSP_AUDIO_IN_Record(0, (uint8_t *)PDM_Buffer, sizeof(PDM_Buffer)) == BSP_ERROR_NONE)
+  {
+    Audio_App_Context.Running = 1;
+  }
+
+  return;
+}
+
+/*
+ * @brief Stop the microphone recording and release a sounding note
+ */
+void AUDIO_MIDI_Stop(void)
+{
+  if(!Audio_App_Context.Running)
+  {
+    return;
+  }
+  BSP_AUDIO_IN_Stop(0);
+  Audio_App_Context.Running = 0;
+  Audio_App_Context.Ready = 0;
+
+  if(Audio_App_Context.Dsp.Note != 0)
+  {
+    Midi_Send_Note(NOTE_OFF, AUDIO_MIDI_CHANNEL, Audio_App_Context.Dsp.Note, 0);
+    Audio_App_Context.Dsp.Note = 0;
+  }
+
+  return;
+}
+
+/*
+ * @brief Half of the SAI buffer has been received
+ */
+void BSP_AUDIO_IN_HalfTransfer_CallBack(uint32_t Instance)
+{
+  UNUSED(Instance);
+  Audio_Block_Ready();
+
+  return;
+}
+
+/*
+ * @brief Second half of the SAI buffer has been received
+ */
+void BSP_AUDIO_IN_TransferComplete_CallBack(uint32_t Instance)
+{
+  UNUSED(Instance);
+  Audio_Block_Ready();
+
+  return;
+}
+
+/*
+ * @brief Convert the PDM block to PCM in the free buffer and set the processing task
+ * @note  Called under the DMA interrupt, the PDM buffer is overwritten at the next one
+ */
+static void Audio_Block_Ready(void)
+{
+  uint8_t buffer = Audio_App_Context.Next;
+
+  if(Audio_App_Context.Ready & (1U << buffer))
+  {
+    /* The task did not process this buffer yet, drop the new block */
+    Audio_App_Context.Overruns++;
+    return;
+  }
+
+  BSP_AUDIO_IN_PDMToPCM(0, PDM_Buffer, (uint16_t *)PCM_Buffer[buffer]);
+  Audio_App_Context.Ready |= (1U << buffer);
+  Audio_App_Context.Next = buffer ^ 1U;
+  /* Shall be processed before the next block */
+  UTIL_SEQ_SetTaskDeadline(1<<CFG_TASK_AUDIO_MIDI, CFG_SCH_PRIO_0, CFG_SCH_DEADLINE_NOW() + N_MS_PER_INTERRUPT);
+
+  return;
+}
+
+/*
+ * @brief Run the detection on the pending PCM buffers and send the resulting notes
+ * @note  The PCM buffer is processed in place, there is no intermediate copy
+ */
+static void Audio_Midi_Process(void)
+{
+  Audio_Dsp_Result_t result;
+  uint8_t buffer;
+  uint32_t start;
+  uint32_t cycles;
+
+  /* Oldest buffer first */
+  buffer = Audio_App_Context.Next;
+  for(uint8_t i = 0; i < 2U; i++, buffer ^= 1U)
+  {
+    if((Audio_App_Context.Ready & (1U << buffer)) == 0)
+    {
+      continue;
+    }
+
+    start = DWT->CYCCNT;
+    AUDIO_DSP_Process(&Audio_App_Context.Dsp, PCM_Buffer[buffer], AUDIO_PCM_BLOCK_SIZE, &result);
+    cycles = DWT->CYCCNT - start;
+
+    /* Buffer can be filled again */
+    UTILS_ENTER_CRITICAL_SECTION();
+    Audio_App_Context.Ready &= ~(1U << buffer);
+    UTILS_EXIT_CRITICAL_SECTION();
+
+    switch(result.Event)
+    {
+      case AUDIO_DSP_EVT_NOTE_ON:
+        Midi_Send_Note(NOTE_ON, AUDIO_MIDI_CHANNEL, result.Note, result.Velocity);
+        break;
+
+      case AUDIO_DSP_EVT_NOTE_OFF:
+        Midi_Send_Note(NOTE_OFF, AUDIO_MIDI_CHANNEL, result.Note, 0);
+        break;
+
+      case AUDIO_DSP_EVT_NOTE_CHANGE:
+        Midi_Send_Note(NOTE_OFF, AUDIO_MIDI_CHANNEL, result.PrevNote, 0);
+        Midi_Send_Note(NOTE_ON, AUDIO_MIDI_CHANNEL, result.Note, result.Velocity);
+        break;
+
+      default:
+        break;
+    }
+
+    Audio_App_Context.CyclesSum += cycles;
+    if(cycles > Audio_App_Context.CyclesMax)
+    {
+      Audio_App_Context.CyclesMax = cycles;
+    }
+    Audio_App_Context.Blocks++;
+    if(Audio_App_Context.Blocks >= AUDIO_MIDI_REPORT_BLOCKS)
+    {
+      Audio_Report();
+    }
+  }
+
+  return;
+}
+
+/*
+ * @brief Report the processing cost against the block period
+ */
+static void Audio_Report(void)
+{
+  /* Cycles available for one block */
+  uint32_t budget = (SystemCoreClock / 1000U) * N_MS_PER_INTERRUPT;
+  uint32_t avg = Audio_App_Context.CyclesSum / Audio_App_Context.Blocks;
+
+  APP_DBG_MSG("Audio DSP : avg %lu max %lu cycles, %lu.%lu%% of %lu, overruns %lu\n\r",
+              avg, Audio_App_Context.CyclesMax,
+              (avg * 100U) / budget, ((avg * 1000U) / budget) % 10U,
+              budget, Audio_App_Context.Overruns);
+
+  Audio_App_Context.Blocks = 0;
+  Audio_App_Context.CyclesSum = 0;
+  Audio_App_Context.CyclesMax = 0;
+
+  return;
+}
+
+#else
+
+void AUDIO_MIDI_Init(void)
+{
+  return;
+}
+
+void AUDIO_MIDI_Start(void)
+{
+  return;
+}
+
+void AUDIO_MIDI_Stop(void)
+{
+  return;
+}
+
+#endif /* CFG_AUDIO_MIDI_SUPPORTED */
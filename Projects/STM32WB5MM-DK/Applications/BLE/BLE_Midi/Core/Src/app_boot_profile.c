@@ -0,0 +1,178 @@
+/**
+  ******************************************************************************
+  * @file    app_boot_profile.c
+  * @author  MCD Application Team
+  * @brief   Startup profiler : time of each startup phase from the reset, taken
+  *          with the DWT cycle counter, and time spent waiting for CPU2
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+#include "dbg_trace.h"
+#include "utilities_conf.h"
+#include "app_boot_profile.h"
+
+#if (CFG_BOOT_PROFILE != 0)
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint32_t              Cycles_Per_Us;
+  uint32_t              Start_Us;               /*!< Time from the reset to BOOT_PROFILE_START */
+  uint32_t              Stamps[BOOT_PROFILE_PHASE_NBR];
+  uint16_t              Phases;                 /*!< Phases time stamped */
+  uint32_t              Cpu2_Cmd_Stamp;         /*!< Last command sent to CPU2 */
+  uint32_t              Cpu2_Cmds;              /*!< Commands sent to CPU2 until the first advertising */
+  uint32_t              Cpu2_Wait_Cycles;       /*!< Time waiting for their responses */
+} Boot_Profile_Context_t;
+
+/* Private variables ---------------------------------------------------------*/
+static Boot_Profile_Context_t Boot_Profile_Context;
+
+static const char * const Boot_Profile_Names[BOOT_PROFILE_PHASE_NBR] =
+{
+  "start",
+  "cpu2 start",
+  "lcd",
+  "sensors",
+  "song",
+  "appe init end",
+  "cpu2 ready",
+  "ble init",
+  "gap gatt",
+  "services",
+  "advertising",
+};
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Time stamp the start of the profiling, the cycle counter runs (APPE_Cycle_Counter_Init)
+ */
+void BOOT_PROFILE_Init(void)
+{
+  Boot_Profile_Context.Cycles_Per_Us = SystemCoreClock / 1000000U;
+
+  /* The startup is measured from here, HAL_GetTick() gives the time since the reset */
+  Boot_Profile_Context.Start_Us = HAL_GetTick() * 1000U;
+  BOOT_PROFILE_Phase(BOOT_PROFILE_START);
+
+  return;
+}
+
+/*
+ * @brief Time stamp a startup phase, only the first time it is reached. The report is printed
+ *        once the device advertises.
+ * @note  Can be called from interrupt context, except for BOOT_PROFILE_ADVERTISING
+ *
+ * @param Phase         startup phase
+ */
+void BOOT_PROFILE_Phase(Boot_Profile_Phase_t Phase)
+{
+  uint32_t now = DWT->CYCCNT;
+  uint8_t first = 0;
+
+  UTILS_ENTER_CRITICAL_SECTION();
+  if((Boot_Profile_Context.Phases & (1U << Phase)) == 0)
+  {
+    Boot_Profile_Context.Stamps[Phase] = now;
+    Boot_Profile_Context.Phases |= (1U << Phase);
+    first = 1;
+  }
+  UTILS_EXIT_CRITICAL_SECTION();
+
+  if(first && (Phase == BOOT_PROFILE_ADVERTISING))
+  {
+    BOOT_PROFILE_Report();
+  }
+
+  return;
+}
+
+/*
+ * @brief Command sent to CPU2 or its response received, counted until the first advertising
+ *
+ * @param Done          0 when the command is sent, 1 when its response is received
+ */
+void BOOT_PROFILE_Cpu2_Cmd(uint8_t Done)
+{
+  uint32_t now = DWT->CYCCNT;
+
+  if(Done == 0)
+  {
+    Boot_Profile_Context.Cpu2_Cmd_Stamp = now;
+  }
+  else if((Boot_Profile_Context.Phases & (1U << BOOT_PROFILE_ADVERTISING)) == 0)
+  {
+    Boot_Profile_Context.Cpu2_Cmds++;
+    Boot_Profile_Context.Cpu2_Wait_Cycles += now - Boot_Profile_Context.Cpu2_Cmd_Stamp;
+  }
+
+  return;
+}
+
+/*
+ * @brief Print the time of each startup phase from the reset and the time spent waiting for CPU2
+ */
+void BOOT_PROFILE_Report(void)
+{
+  uint32_t cycles_per_us = Boot_Profile_Context.Cycles_Per_Us;
+  uint32_t start = Boot_Profile_Context.Stamps[BOOT_PROFILE_START];
+  uint32_t us;
+  int32_t ready_us;
+  uint8_t i;
+
+  APP_DBG_MSG("Boot (ms from reset)\n\r");
+  for(i = 0; i < BOOT_PROFILE_PHASE_NBR; i++)
+  {
+    if((Boot_Profile_Context.Phases & (1U << i)) == 0)
+    {
+      APP_DBG_MSG("%-18s        -\n\r", Boot_Profile_Names[i]);
+      continue;
+    }
+    us = Boot_Profile_Context.Start_Us + ((Boot_Profile_Context.Stamps[i] - start) / cycles_per_us);
+    APP_DBG_MSG("%-18s %4ld.%03ld\n\r", Boot_Profile_Names[i], us / 1000U, us % 1000U);
+  }
+
+  APP_DBG_MSG("Boot : %ld commands to CPU2, %ld us waiting for the responses\n\r",
+              Boot_Profile_Context.Cpu2_Cmds, Boot_Profile_Context.Cpu2_Wait_Cycles / cycles_per_us);
+
+  /* Before the end of MX_APPE_Init(), the CPU2 startup is hidden by the application init */
+  if((Boot_Profile_Context.Phases & (1U << BOOT_PROFILE_CPU2_READY)) &&
+     (Boot_Profile_Context.Phases & (1U << BOOT_PROFILE_APPE_END)))
+  {
+    ready_us = (int32_t)(Boot_Profile_Context.Stamps[BOOT_PROFILE_CPU2_READY] -
+                         Boot_Profile_Context.Stamps[BOOT_PROFILE_APPE_END]) / (int32_t)cycles_per_us;
+    APP_DBG_MSG("Boot : CPU2 ready %ld us %s the end of the application init\n\r",
+                (ready_us < 0) ? -ready_us : ready_us, (ready_us < 0) ? "before" : "after");
+  }
+
+  return;
+}
+
+#else
+
+void BOOT_PROFILE_Init(void)
+{
+  return;
+}
+
+void BOOT_PROFILE_Report(void)
+{
+  APP_DBG_MSG("Boot : CFG_BOOT_PROFILE is 0\n\r");
+
+  return;
+}
+
+#endif /* CFG_BOOT_PROFILE */
@@ -0,0 +1,444 @@
+/**
+  ******************************************************************************
+  * @file    app_conn_param.c
+  * @author  MCD Application Team
+  * @brief   Connection parameters policy, short interval while Midi is
+  *          flowing and power saving parameters when idle
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+#include "dbg_trace.h"
+#include "ble.h"
+#include "stm32_seq.h"
+#include "app_conn_param.h"
+
+#if (L2CAP_REQUEST_NEW_CONN_PARAM != 0)
+/* Private typedef -----------------------------------------------------------*/
+typedef enum
+{
+  CONN_PARAM_PROFILE_NONE,
+  CONN_PARAM_PROFILE_IDLE,
+  CONN_PARAM_PROFILE_ACTIVE,
+} Conn_Param_Profile_t;
+
+typedef struct
+{
+  uint16_t              Interval_Min;           /*!< Unit 1.25 ms */
+  uint16_t              Interval_Max;           /*!< Unit 1.25 ms */
+  uint16_t              Latency;                /*!< Connection events the peripheral may skip */
+  uint16_t              Timeout;                /*!< Supervision timeout, unit 10 ms */
+} Conn_Param_Set_t;
+
+typedef struct
+{
+  uint16_t              Handle;                 /*!< Connection handle, CONN_PARAM_NO_LINK when unused */
+  uint16_t              Interval;               /*!< Interval in use, unit 1.25 ms */
+  uint16_t              Latency;                /*!< Slave latency in use */
+  uint16_t              Timeout;                /*!< Supervision timeout in use, unit 10 ms */
+  uint8_t               Applied;                /*!< Profile the current parameters satisfy */
+  uint8_t               Level;                  /*!< Step of the active parameters fallback */
+  uint8_t               Requests;               /*!< Requests sent since the last profile change */
+  uint8_t               Pending;                /*!< A request is waiting for the central answer */
+} Conn_Param_Link_t;
+
+typedef struct
+{
+  uint8_t               Check_Timer_Id;         /*!< Policy check timer id */
+  volatile uint8_t      Profile;                /*!< Profile wanted by the application */
+  volatile uint32_t     Last_Activity;          /*!< HAL_GetTick of the last Midi activity */
+  Conn_Param_Link_t     Links[CFG_BLE_NUM_LINK];
+} Conn_Param_Context_t;
+
+/* Private defines -----------------------------------------------------------*/
+#define CONN_PARAM_NO_LINK              (0xFFFFU)
+
+/* Requests sent for one profile change before giving up with what the central granted */
+#define CONN_PARAM_MAX_REQUESTS         (4U)
+
+#define CONN_PARAM_ACTIVE_LEVELS        (sizeof(Active_Sets) / sizeof(Active_Sets[0]))
+
+/* Private variables ---------------------------------------------------------*/
+/* Active parameters, from the latency target to less demanding windows used when
+ * the central refuses the previous one (some centrals need a 15 ms window) */
+static const Conn_Param_Set_t Active_Sets[] =
+{
+  {CONN_PARAM_ACTIVE_INTERVAL_MIN, CONN_PARAM_ACTIVE_INTERVAL_MAX, 0, L2CAP_TIMEOUT_MULTIPLIER},
+  {CONN_P(11.25), CONN_P(15), 0, L2CAP_TIMEOUT_MULTIPLIER},
+  {CONN_P(15), CONN_P(30), 0, L2CAP_TIMEOUT_MULTIPLIER},
+};
+
+static const Conn_Param_Set_t Idle_Set =
+{
+  CONN_PARAM_IDLE_INTERVAL_MIN, CONN_PARAM_IDLE_INTERVAL_MAX, CONN_PARAM_IDLE_SLAVE_LATENCY, L2CAP_TIMEOUT_MULTIPLIER
+};
+
+static Conn_Param_Context_t Conn_Param_Context;
+
+/* Private function prototypes -----------------------------------------------*/
+static Conn_Param_Link_t *      Find_Link(uint16_t Handle);
+static const Conn_Param_Set_t * Wanted_Set(const Conn_Param_Link_t *pLink);
+static uint8_t                  Satisfies(const Conn_Param_Link_t *pLink, uint8_t Profile);
+static void                     Conn_Param_Check_cb(void);
+static void                     Conn_Param_Process(void);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Initialize the connection parameters policy
+ */
+void CONN_PARAM_Init(void)
+{
+  uint8_t i;
+
+  for(i = 0; i < CFG_BLE_NUM_LINK; i++)
+  {
+    Conn_Param_Context.Links[i].Handle = CONN_PARAM_NO_LINK;
+  }
+  Conn_Param_Context.Profile = CONN_PARAM_PROFILE_IDLE;
+
+  UTIL_SEQ_RegTask(1<<CFG_TASK_CONN_UPDATE_REG_ID, UTIL_SEQ_RFU, Conn_Param_Process);
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+        &Conn_Param_Context.Check_Timer_Id,
+        hw_ts_Repeated,
+        Conn_Param_Check_cb);
+
+  return;
+}
+
+/*
+ * @brief Report Midi activity, the short interval is requested if not already in use
+ * @note  Can be called from interrupt context
+ */
+void CONN_PARAM_Activity(void)
+{
+  Conn_Param_Context.Last_Activity = HAL_GetTick();
+  if(Conn_Param_Context.Profile != CONN_PARAM_PROFILE_ACTIVE)
+  {
+    Conn_Param_Context.Profile = CONN_PARAM_PROFILE_ACTIVE;
+    UTIL_SEQ_SetTask(1<<CFG_TASK_CONN_UPDATE_REG_ID, CFG_SCH_PRIO_1);
+  }
+
+  return;
+}
+
+/*
+ * @brief A central is connected
+ *
+ * @param Handle        connection handle
+ * @param Interval      connection interval, unit 1.25 ms
+ * @param Latency       slave latency
+ * @param Timeout       supervision timeout, unit 10 ms
+ */
+void CONN_PARAM_Connected(uint16_t Handle, uint16_t Interval, uint16_t Latency, uint16_t Timeout)
+{
+  Conn_Param_Link_t *pLink = Find_Link(CONN_PARAM_NO_LINK);
+
+  if(pLink == NULL)
+  {
+    return;
+  }
+  memset(pLink, 0, sizeof(Conn_Param_Link_t));
+  pLink->Handle = Handle;
+  pLink->Interval = Interval;
+  pLink->Latency = Latency;
+  pLink->Timeout = Timeout;
+  pLink->Applied = CONN_PARAM_PROFILE_NONE;
+
+  /* The first request is sent at the next check, leaving time to the central
+   * to run its own procedures after the connection */
+  HW_TS_Start(Conn_Param_Context.Check_Timer_Id, CONN_PARAM_CHECK_PERIOD);
+
+  return;
+}
+
+/*
+ * @brief A central is disconnected
+ *
+ * @param Handle        connection handle
+ */
+void CONN_PARAM_Disconnected(uint16_t Handle)
+{
+  Conn_Param_Link_t *pLink = Find_Link(Handle);
+  uint8_t i;
+
+  if(pLink != NULL)
+  {
+    pLink->Handle = CONN_PARAM_NO_LINK;
+  }
+  for(i = 0; i < CFG_BLE_NUM_LINK; i++)
+  {
+    if(Conn_Param_Context.Links[i].Handle != CONN_PARAM_NO_LINK)
+    {
+      return;
+    }
+  }
+  HW_TS_Stop(Conn_Param_Context.Check_Timer_Id);
+
+  return;
+}
+
+/*
+ * @brief Answer of the central to a connection parameters update request
+ *
+ * @param Handle        connection handle
+ * @param Result        0 when accepted, the update complete event follows
+ */
+void CONN_PARAM_Update_Resp(uint16_t Handle, uint16_t Result)
+{
+  Conn_Param_Link_t *pLink = Find_Link(Handle);
+
+  if(pLink == NULL)
+  {
+    return;
+  }
+  if(Result != 0)
+  {
+    APP_DBG_MSG("Conn 0x%x : parameters request refused\n\r", Handle);
+    pLink->Pending = 0;
+    /* Ask for a less demanding window at the next check */
+    if((Conn_Param_Context.Profile == CONN_PARAM_PROFILE_ACTIVE) && ((pLink->Level + 1U) < CONN_PARAM_ACTIVE_LEVELS))
+    {
+      pLink->Level++;
+    }
+  }
+
+  return;
+}
+
+/*
+ * @brief Connection parameters have been updated, by our request or by the central
+ *
+ * @param Status        HCI status of the procedure
+ * @param Handle        connection handle
+ * @param Interval      connection interval, unit 1.25 ms
+ * @param Latency       slave latency
+ * @param Timeout       supervision timeout, unit 10 ms
+ */
+void CONN_PARAM_Update_Complete(uint8_t Status, uint16_t Handle, uint16_t Interval, uint16_t Latency, uint16_t Timeout)
+{
+  Conn_Param_Link_t *pLink = Find_Link(Handle);
+  uint32_t interval_us;
+  uint32_t target_us;
+
+  if(pLink == NULL)
+  {
+    return;
+  }
+  pLink->Pending = 0;
+  if(Status != BLE_STATUS_SUCCESS)
+  {
+    APP_DBG_MSG("Conn 0x%x : parameters update failed, status 0x%x\n\r", Handle, Status);
+    return;
+  }
+  pLink->Interval = Interval;
+  pLink->Latency = Latency;
+  pLink->Timeout = Timeout;
+
+  interval_us = Interval * 1250U;
+  target_us = CONN_PARAM_ACTIVE_INTERVAL_MAX * 1250U;
+  APP_DBG_MSG("Conn 0x%x : interval %d.%02d ms (target %d.%02d ms %s), latency %d, timeout %d ms\n\r",
+              Handle,
+              interval_us / 1000U, (interval_us % 1000U) / 10U,
+              target_us / 1000U, (target_us % 1000U) / 10U,
+              (interval_us <= target_us) ? "met" : "missed",
+              Latency, Timeout * 10U);
+
+  if(Satisfies(pLink, Conn_Param_Context.Profile))
+  {
+    pLink->Applied = Conn_Param_Context.Profile;
+  }
+  else
+  {
+    pLink->Applied = CONN_PARAM_PROFILE_NONE;
+    /* Granted window is above the one requested, try a less demanding one */
+    if((Conn_Param_Context.Profile == CONN_PARAM_PROFILE_ACTIVE) && ((pLink->Level + 1U) < CONN_PARAM_ACTIVE_LEVELS))
+    {
+      pLink->Level++;
+    }
+  }
+
+  return;
+}
+
+/*
+ * @brief Longest connection interval of the centrals
+ * @note  The slave latency does not delay a notification : with data to send the peripheral
+ *        listens at every connection event
+ *
+ * @retval              interval in us, 0 with no central
+ */
+uint32_t CONN_PARAM_Get_Interval_Us(void)
+{
+  uint32_t interval_us = 0;
+  uint8_t i;
+
+  for(i = 0; i < CFG_BLE_NUM_LINK; i++)
+  {
+    const Conn_Param_Link_t *pLink = &Conn_Param_Context.Links[i];
+
+    if((pLink->Handle != CONN_PARAM_NO_LINK) && (((uint32_t)pLink->Interval * 1250U) > interval_us))
+    {
+      interval_us = (uint32_t)pLink->Interval * 1250U;
+    }
+  }
+
+  return interval_us;
+}
+
+/*
+ * @brief Get the link context of a connection handle
+ *
+ * @param Handle        connection handle, CONN_PARAM_NO_LINK to get a free context
+ *
+ * @retval              link context, NULL if not found
+ */
+static Conn_Param_Link_t * Find_Link(uint16_t Handle)
+{
+  uint8_t i;
+
+  for(i = 0; i < CFG_BLE_NUM_LINK; i++)
+  {
+    if(Conn_Param_Context.Links[i].Handle == Handle)
+    {
+      return &Conn_Param_Context.Links[i];
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * @brief Parameters to request for the current profile
+ *
+ * @param pLink         link context
+ *
+ * @retval              parameters set
+ */
+static const Conn_Param_Set_t * Wanted_Set(const Conn_Param_Link_t *pLink)
+{
+  if(Conn_Param_Context.Profile == CONN_PARAM_PROFILE_ACTIVE)
+  {
+    return &Active_Sets[pLink->Level];
+  }
+
+  return &Idle_Set;
+}
+
+/*
+ * @brief Check if the parameters in use match a profile
+ *
+ * @param pLink         link context
+ * @param Profile       profile to check
+ *
+ * @retval              1 if the parameters are good enough for the profile
+ */
+static uint8_t Satisfies(const Conn_Param_Link_t *pLink, uint8_t Profile)
+{
+  if(Profile == CONN_PARAM_PROFILE_ACTIVE)
+  {
+    return (pLink->Interval <= Active_Sets[pLink->Level].Interval_Max) && (pLink->Latency == 0);
+  }
+
+  /* Idle : anything at least as relaxed as requested */
+  return (pLink->Interval >= Idle_Set.Interval_Min);
+}
+
+/*
+ * @brief Periodic policy check
+ * @note  Called under the RTC interrupt
+ */
+static void Conn_Param_Check_cb(void)
+{
+  if((Conn_Param_Context.Profile == CONN_PARAM_PROFILE_ACTIVE)
+  && ((HAL_GetTick() - Conn_Param_Context.Last_Activity) > CONN_PARAM_IDLE_DELAY))
+  {
+    Conn_Param_Context.Profile = CONN_PARAM_PROFILE_IDLE;
+  }
+  UTIL_SEQ_SetTask(1<<CFG_TASK_CONN_UPDATE_REG_ID, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Request new connection parameters on the links not matching the profile
+ */
+static void Conn_Param_Process(void)
+{
+  static uint8_t last_profile = CONN_PARAM_PROFILE_IDLE;
+  uint8_t profile = Conn_Param_Context.Profile;
+  uint8_t i;
+
+  for(i = 0; i < CFG_BLE_NUM_LINK; i++)
+  {
+    Conn_Param_Link_t *pLink = &Conn_Param_Context.Links[i];
+    const Conn_Param_Set_t *pSet;
+    tBleStatus ret;
+
+    if(pLink->Handle == CONN_PARAM_NO_LINK)
+    {
+      continue;
+    }
+    if(profile != last_profile)
+    {
+      /* New profile : start again from the best parameters */
+      pLink->Level = 0;
+      pLink->Requests = 0;
+      pLink->Applied = CONN_PARAM_PROFILE_NONE;
+    }
+    if(Satisfies(pLink, profile))
+    {
+      pLink->Applied = profile;
+    }
+    if((pLink->Applied == profile) || pLink->Pending || (pLink->Requests >= CONN_PARAM_MAX_REQUESTS))
+    {
+      continue;
+    }
+
+    pSet = Wanted_Set(pLink);
+    ret = aci_l2cap_connection_parameter_update_req(pLink->Handle,
+                                                    pSet->Interval_Min, pSet->Interval_Max,
+                                                    pSet->Latency, pSet->Timeout);
+    pLink->Requests++;
+    if(ret != BLE_STATUS_SUCCESS)
+    {
+      APP_DBG_MSG("Conn 0x%x : aci_l2cap_connection_parameter_update_req failed, result 0x%x\n\r", pLink->Handle, ret);
+    }
+    else
+    {
+      pLink->Pending = 1;
+      APP_DBG_MSG("Conn 0x%x : %s parameters requested, interval %d to %d (x1.25 ms), latency %d\n\r",
+                  pLink->Handle, (profile == CONN_PARAM_PROFILE_ACTIVE) ? "active" : "idle",
+                  pSet->Interval_Min, pSet->Interval_Max, pSet->Latency);
+    }
+  }
+  last_profile = profile;
+
+  return;
+}
+
+#else /* L2CAP_REQUEST_NEW_CONN_PARAM */
+
+void CONN_PARAM_Activity(void)
+{
+  return;
+}
+
+uint32_t CONN_PARAM_Get_Interval_Us(void)
+{
+  return 0;
+}
+
+#endif /* L2CAP_REQUEST_NEW_CONN_PARAM */
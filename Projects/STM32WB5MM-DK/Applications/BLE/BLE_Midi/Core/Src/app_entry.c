@@ -35,6 +35,17 @@
 
 /* Private includes -----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "app_trace.h"
+#include "app_latency.h"
+#include "app_boot_profile.h"
+#include "app_ts_bench.h"
+#include "app_hostctl.h"
+#include "app_ext_flash.h"
+#include "app_recorder.h"
+#include "app_led.h"
+#include "app_lcd_text.h"
+#include "app_settings.h"
+#include "app_midi.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -48,9 +59,7 @@ EXTI_HandleTypeDef exti_handle;
 #define POOL_SIZE (CFG_TLBLE_EVT_QUEUE_LENGTH*4U*DIVC((sizeof(TL_PacketHeader_t) + TL_BLE_EVENT_FRAME_SIZE), 4U))
 
 /* USER CODE BEGIN PD */
-/* Section specific to button management using UART */
-#define C_SIZE_CMD_STRING       256U
-#define RX_BUFFER_SIZE          8U
+
 /* USER CODE END PD */
 
 /* Private macros ------------------------------------------------------------*/
@@ -65,10 +74,7 @@ PLACE_IN_SECTION("MB_MEM2") ALIGN(4) static uint8_t SystemSpareEvtBuffer[sizeof(
 PLACE_IN_SECTION("MB_MEM2") ALIGN(4) static uint8_t BleSpareEvtBuffer[sizeof(TL_PacketHeader_t) + TL_EVT_HDR_SIZE + 255];
 
 /* USER CODE BEGIN PV */
-/* Section specific to button management using UART */
-static uint8_t aRxBuffer[RX_BUFFER_SIZE];
-static uint8_t CommandString[C_SIZE_CMD_STRING];
-static uint16_t indexReceiveChar = 0;
+
 /* USER CODE END PV */
 
 /* Private functions prototypes-----------------------------------------------*/
@@ -89,11 +95,11 @@ static void Init_Rtc(void);
 
 /* USER CODE BEGIN PFP */
 static void Button_Init( void );
+static void Peripherals_Init( void );
 
 /* Section specific to button management using UART */
-static void RxUART_Init(void);
-static void RxCpltCallback(void);
-static void UartCmdExecute(void);
+static void UartCmdExecute(const char *pCmd);
+static void Mbox_Report(void);
 /* USER CODE END PFP */
 
 /* Functions Definition ------------------------------------------------------*/
@@ -127,37 +133,22 @@ void MX_APPE_Init(void)
 
 /* USER CODE BEGIN APPE_Init_1 */
   APPD_Init();
-  
-  BSP_LCD_Init(0, LCD_ORIENTATION_LANDSCAPE);
-  /* Set LCD Foreground Layer  */
-  UTIL_LCD_SetFuncDriver(&LCD_Driver); /* SetFunc before setting device */
-  UTIL_LCD_SetDevice(0);            /* SetDevice after funcDriver is set */
-  BSP_LCD_Clear(0,SSD1315_COLOR_BLACK);
-  BSP_LCD_DisplayOn(0);
-  BSP_LCD_Refresh(0);
-  UTIL_LCD_SetFont(&Font12);
-  /* Set the LCD Text Color */
-  UTIL_LCD_SetTextColor(SSD1315_COLOR_WHITE);
-  UTIL_LCD_SetBackColor(SSD1315_COLOR_BLACK);
-  BSP_LCD_Clear(0,SSD1315_COLOR_BLACK);
-  BSP_LCD_Refresh(0);
+  TRACE_Init();
+  APPE_Cycle_Counter_Init();
+  BOOT_PROFILE_Init();
+  LATENCY_Init();
+  TS_BENCH_Init();
 
-  //Switch RGB LED off
-  LED_Off();
-  
-  BSP_MOTION_SENSOR_Init(MOTION_SENSOR_ISM330DHCX_0, MOTION_ACCELERO | MOTION_GYRO);
-  BSP_MOTION_SENSOR_Enable(MOTION_SENSOR_ISM330DHCX_0, MOTION_ACCELERO | MOTION_GYRO);
-  
-  BSP_ENV_SENSOR_Init(ENV_SENSOR_STTS22H_0, ENV_TEMPERATURE);
-  BSP_ENV_SENSOR_Enable(ENV_SENSOR_STTS22H_0, ENV_TEMPERATURE);
-  
-  VL53L0X_PROXIMITY_Init();
-   
-  //Initialize user buttons
-  Button_Init();
+  /* Text commands and host control frames on the trace UART */
+  HOSTCTL_Init(UartCmdExecute);
 
-  RxUART_Init();
+  /* Program and erase jobs of the QSPI memory */
+  EXT_FLASH_Init();
 
+#if (CFG_BOOT_PARALLEL_INIT == 0)
+  /* Screen, sensors and song before CPU2 is started */
+  Peripherals_Init();
+#endif
 /* USER CODE END APPE_Init_1 */
   appe_Tl_Init();	/* Initialize all transport layers */
 
@@ -167,7 +158,19 @@ void MX_APPE_Init(void)
    * This system event is received with APPE_SysUserEvtRx()
    */
 /* USER CODE BEGIN APPE_Init_2 */
+  BOOT_PROFILE_PHASE(BOOT_PROFILE_CPU2_START);
+#if (CFG_BOOT_PARALLEL_INIT != 0)
+  /**
+   * CPU2 is started : the screen, the sensors and the song need no BLE, they are
+   * initialized while CPU2 starts its wireless stack
+   */
+  Peripherals_Init();
+#endif
+   
+  //Initialize user buttons
+  Button_Init();
 
+  BOOT_PROFILE_PHASE(BOOT_PROFILE_APPE_END);
 /* USER CODE END APPE_Init_2 */
 
    return;
@@ -201,35 +204,28 @@ void Init_Exti(void)
 
 /* USER CODE BEGIN FD */
 
-void LED_Deinit(void)
+void LED_On(aPwmLedGsData_TypeDef aPwmLedGsData)
 {
-  GPIO_InitTypeDef  GPIO_InitStructure = {0};
-  
-  /* RGB Led de-init */
-  BSP_PWM_LED_DeInit();
-
-  /* configure SPIx MOSI for LCD */
-  GPIO_InitStructure.Pin       = BUS_SPI1_MOSI_PIN;
-  GPIO_InitStructure.Mode      = GPIO_MODE_AF_PP;
-  GPIO_InitStructure.Pull      = GPIO_PULLDOWN;
-  GPIO_InitStructure.Speed     = GPIO_SPEED_FREQ_LOW;
-  GPIO_InitStructure.Alternate = BUS_SPI1_AF;
-  HAL_GPIO_Init(BUS_SPI1_GPIO_PORTA, &GPIO_InitStructure);
+  LED_PWM_Set(aPwmLedGsData);
 }
 
-
-void LED_On(aPwmLedGsData_TypeDef aPwmLedGsData)
+void LED_Off(void)
 {
-  BSP_PWM_LED_Init();
-  BSP_PWM_LED_On(aPwmLedGsData);
-  LED_Deinit();
+  aPwmLedGsData_TypeDef aPwmLedGsData = {PWM_LED_GSDATA_OFF, PWM_LED_GSDATA_OFF, PWM_LED_GSDATA_OFF};
+
+  LED_PWM_Set(aPwmLedGsData);
 }
 
-void LED_Off(void)
+/*
+ * @brief Start the DWT cycle counter, the time base of the latency probes, the startup profiler,
+ *        the timer server benchmark, the audio processing load and the HCI user events batch budget
+ */
+void APPE_Cycle_Counter_Init(void)
 {
-  BSP_PWM_LED_Init();
-  BSP_PWM_LED_Off();
-  LED_Deinit();
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  return;
 }
 /* USER CODE END FD */
 
@@ -576,6 +572,49 @@ static void APPE_SysEvtReadyProcessing(void * pPayload)
 }
 
 /* USER CODE BEGIN FD_LOCAL_FUNCTIONS */
+/*
+ * @brief Screen, RGB LED, sensors, settings and active song, none of them needs BLE. Before
+ *        or after CPU2 is started, following CFG_BOOT_PARALLEL_INIT
+ */
+static void Peripherals_Init( void )
+{
+  BSP_LCD_Init(0, LCD_ORIENTATION_LANDSCAPE);
+  /* Set LCD Foreground Layer  */
+  UTIL_LCD_SetFuncDriver(&LCD_Driver); /* SetFunc before setting device */
+  UTIL_LCD_SetDevice(0);            /* SetDevice after funcDriver is set */
+  BSP_LCD_Clear(0,SSD1315_COLOR_BLACK);
+  BSP_LCD_DisplayOn(0);
+  BSP_LCD_Refresh(0);
+  UTIL_LCD_SetFont(&Font12);
+  /* Set the LCD Text Color */
+  UTIL_LCD_SetTextColor(SSD1315_COLOR_WHITE);
+  UTIL_LCD_SetBackColor(SSD1315_COLOR_BLACK);
+  BSP_LCD_Clear(0,SSD1315_COLOR_BLACK);
+  BSP_LCD_Refresh(0);
+
+  //RGB LED played by TIM17 and DMA, switched off
+  LED_PWM_Init();
+  LCD_TEXT_Init();
+  BOOT_PROFILE_PHASE(BOOT_PROFILE_LCD);
+  
+  BSP_MOTION_SENSOR_Init(MOTION_SENSOR_ISM330DHCX_0, MOTION_ACCELERO | MOTION_GYRO);
+  BSP_MOTION_SENSOR_Enable(MOTION_SENSOR_ISM330DHCX_0, MOTION_ACCELERO | MOTION_GYRO);
+  
+  BSP_ENV_SENSOR_Init(ENV_SENSOR_STTS22H_0, ENV_TEMPERATURE);
+  BSP_ENV_SENSOR_Enable(ENV_SENSOR_STTS22H_0, ENV_TEMPERATURE);
+  
+  /* Settings saved in the mapped memory, the reference calibration of the VL53L0X */
+  SETTINGS_Load();
+  VL53L0X_PROXIMITY_Init();
+  BOOT_PROFILE_PHASE(BOOT_PROFILE_SENSORS);
+
+  /* Active song parsed before the BLE init, MIDI_Init() only registers the player tasks */
+  MIDI_Load();
+  BOOT_PROFILE_PHASE(BOOT_PROFILE_SONG);
+
+  return;
+}
+
 static void Button_Init( void )
 {
 #if (CFG_BUTTON_SUPPORTED == 1)
@@ -660,6 +699,8 @@ void UTIL_SEQ_EvtIdle(UTIL_SEQ_bm_t task_id_bm, UTIL_SEQ_bm_t evt_waited_bm)
 
 void shci_notify_asynch_evt(void* pdata)
 {
+  /* The first system event is the ready event */
+  BOOT_PROFILE_PHASE(BOOT_PROFILE_CPU2_READY);
   UTIL_SEQ_SetTask(1<<CFG_TASK_SYSTEM_HCI_ASYNCH_EVT_ID, CFG_SCH_PRIO_0);
   return;
 }
@@ -672,11 +713,20 @@ void shci_cmd_resp_release(uint32_t flag)
 
 void shci_cmd_resp_wait(uint32_t timeout)
 {
+  BOOT_PROFILE_CPU2_CMD_WAIT();
   UTIL_SEQ_WaitEvt(1<< CFG_IDLEEVT_SYSTEM_HCI_CMD_EVT_RSP_ID);
+  BOOT_PROFILE_CPU2_CMD_DONE();
   return;
 }
 
 /* USER CODE BEGIN FD_WRAP_FUNCTIONS */
+void UTIL_SEQ_PreIdle(void)
+{
+  /* Output the binary traces recorded by the tasks before going to sleep */
+  TRACE_Drain();
+  return;
+}
+
 void HAL_GPIO_EXTI_Callback( uint16_t GPIO_Pin )
 {
   switch (GPIO_Pin)
@@ -693,55 +743,106 @@ void HAL_GPIO_EXTI_Callback( uint16_t GPIO_Pin )
   return;
 }
 
-static void RxUART_Init(void)
-{
-  HW_UART_Receive_IT((hw_uart_id_t)CFG_DEBUG_TRACE_UART, aRxBuffer, 1U, RxCpltCallback);
-}
-
-static void RxCpltCallback(void)
-{
-  /* Filling buffer and wait for '\r' char */
-  if (indexReceiveChar < C_SIZE_CMD_STRING)
-  {
-    if (aRxBuffer[0] == '\r')
-    {
-      APP_DBG_MSG("received %s\n", CommandString);
-
-      UartCmdExecute();
-
-      /* Clear receive buffer and character counter*/
-      indexReceiveChar = 0;
-      memset(CommandString, 0, C_SIZE_CMD_STRING);
-    }
-    else
-    {
-      CommandString[indexReceiveChar++] = aRxBuffer[0];
-    }
-  }
-
-  /* Once a character has been sent, put back the device in reception mode */
-  HW_UART_Receive_IT((hw_uart_id_t)CFG_DEBUG_TRACE_UART, aRxBuffer, 1U, RxCpltCallback);
-}
-
-static void UartCmdExecute(void)
+/*
+ * @brief  Execute a text command received on the trace UART
+ * @note   Called in task context by app_hostctl.c
+ *
+ * @param  pCmd: command, without the carriage return
+ */
+static void UartCmdExecute(const char *pCmd)
 {
-  /* Parse received CommandString */
-  if(strcmp((char const*)CommandString, "SW1") == 0)
+  /* Parse received command */
+  if(strcmp(pCmd, "SW1") == 0)
   {
     APP_DBG_MSG("SW1 OK\n");
     exti_handle.Line = BUTTON_USER1_EXTI_LINE;
     HAL_EXTI_GenerateSWI(&exti_handle);
   }
-  else if (strcmp((char const*)CommandString, "SW2") == 0)
+  else if (strcmp(pCmd, "SW2") == 0)
   {
     APP_DBG_MSG("SW2 OK\n");
     exti_handle.Line = BUTTON_USER2_EXTI_LINE;
     HAL_EXTI_GenerateSWI(&exti_handle);
   }
+  else if (strcmp(pCmd, "LAT") == 0)
+  {
+    UTIL_SEQ_SetTask(1<<CFG_TASK_LATENCY_REPORT, CFG_SCH_PRIO_2);
+  }
+  else if (strcmp(pCmd, "LATRST") == 0)
+  {
+    APP_DBG_MSG("LATRST OK\n");
+    LATENCY_Reset();
+  }
+  else if (strcmp(pCmd, "TSBENCH") == 0)
+  {
+    TS_BENCH_Start();
+  }
+  else if (strcmp(pCmd, "MBOX") == 0)
+  {
+    Mbox_Report();
+  }
+  else if (strcmp(pCmd, "MBOXRST") == 0)
+  {
+    APP_DBG_MSG("MBOXRST OK\n");
+    TL_MM_ResetStats();
+    hci_reset_stats();
+  }
+  else if (strcmp(pCmd, "REC") == 0)
+  {
+    RECORDER_Start();
+  }
+  else if (strcmp(pCmd, "RECSTOP") == 0)
+  {
+    RECORDER_Stop();
+  }
+  else if (strcmp(pCmd, "RECSAVE") == 0)
+  {
+    RECORDER_Save_Last_Take();
+  }
+  else if (strcmp(pCmd, "TOFCAL") == 0)
+  {
+    VL53L0X_PROXIMITY_Calibrate();
+  }
+  else if (strcmp(pCmd, "BOOT") == 0)
+  {
+    BOOT_PROFILE_Report();
+  }
   else
   {
-    APP_DBG_MSG("NOT RECOGNIZED COMMAND : %s\n", CommandString);
+    APP_DBG_MSG("NOT RECOGNIZED COMMAND : %s\n", pCmd);
   }
 }
 
+
+/*
+ * @brief  Print the usage of the mailbox event pool and of the HCI event queue since the last MBOXRST
+ */
+static void Mbox_Report(void)
+{
+  TL_MM_Stats_t mm_stats;
+  HCI_TL_Stats_t hci_stats;
+  uint32_t frame_size;
+
+  TL_MM_GetStats(&mm_stats);
+  hci_get_stats(&hci_stats);
+  frame_size = 4U*DIVC((sizeof(TL_PacketHeader_t) + TL_BLE_EVENT_FRAME_SIZE), 4U);
+
+  APP_DBG_MSG("MBOX pool %lu bytes : %lu events, peak %d buffers %lu bytes, %lu in spare buffer\n",
+              (uint32_t)POOL_SIZE,
+              mm_stats.EvtCount,
+              mm_stats.InUseMax,
+              mm_stats.InUseBytesMax,
+              mm_stats.SpareEvtCount);
+  APP_DBG_MSG("MBOX release : %d waiting for IPCC, %d not taken back by CPU2\n",
+              mm_stats.LocalFreeBufMax,
+              mm_stats.FreeBufMax);
+  APP_DBG_MSG("MBOX HCI queue : %lu events, peak %d, %lu flow disabled\n",
+              hci_stats.EvtCount,
+              hci_stats.QueueDepthMax,
+              hci_stats.FlowDisableCount);
+  APP_DBG_MSG("MBOX CFG_TLBLE_EVT_POOL_PEAK_FRAMES %lu\n", DIVC(mm_stats.InUseBytesMax, frame_size));
+
+  return;
+}
+
 /* USER CODE END FD_WRAP_FUNCTIONS */
@@ -0,0 +1,590 @@
+/**
+  ******************************************************************************
+  * @file    app_ext_flash.c
+  * @author  MCD Application Team
+  * @brief   Program and erase jobs of the S25FL128S QSPI memory run under
+  *          interrupt, memory mapped mode
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+#include "stm32_seq.h"
+#include "app_ext_flash.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum
+{
+  EXT_FLASH_JOB_ERASE,
+  EXT_FLASH_JOB_PROGRAM,
+} Ext_Flash_Job_Type_t;
+
+typedef struct
+{
+  Ext_Flash_Job_Type_t  Type;
+  Ext_Flash_Status_t    Status;                 /*!< Set at the end of the job */
+  uint32_t              Offset;
+  const uint8_t         *pData;                 /*!< Program only, shall stay valid until the callback */
+  uint32_t              Size;                   /*!< Program only */
+  Ext_Flash_Callback_t  Callback;
+} Ext_Flash_Job_t;
+
+/*
+ * Steps of a page program or a sector erase, each one started by the interrupt of the previous one :
+ * write enable command, status polled until WEL is set, erase command or program command and data,
+ * status polled until WIP is cleared.
+ */
+typedef enum
+{
+  EXT_FLASH_STEP_IDLE,
+  EXT_FLASH_STEP_WRITE_ENABLE,
+  EXT_FLASH_STEP_WAIT_WEL,
+  EXT_FLASH_STEP_ERASE,
+  EXT_FLASH_STEP_TRANSMIT,
+  EXT_FLASH_STEP_WAIT_READY,
+} Ext_Flash_Step_t;
+
+typedef struct
+{
+  Ext_Flash_Job_t           Jobs[EXT_FLASH_JOB_QUEUE_SIZE];
+  uint8_t                   Head;               /*!< Next job queued, task */
+  volatile uint8_t          Current;            /*!< Job in progress, interrupt */
+  uint8_t                   Tail;               /*!< Next job to report, task */
+  volatile Ext_Flash_Step_t Step;
+  volatile uint8_t          Recover;            /*!< Error on the job in progress : status of the memory to clear */
+  uint8_t                   Watchdog_Timer_Id;
+  uint32_t                  Done;               /*!< Bytes of the program job already programmed */
+  uint32_t                  Length;             /*!< Bytes of the page in progress */
+  volatile uint32_t         Step_Tick;          /*!< HAL_GetTick() at the start of the page or of the erase */
+} Ext_Flash_Context_t;
+
+/* Private defines -----------------------------------------------------------*/
+/* Status register 1 of the S25FL128S */
+#define EXT_FLASH_SR1_WIP               (0x01U)         /* Write in progress */
+#define EXT_FLASH_SR1_WEL               (0x02U)         /* Write enable latch */
+
+#define EXT_FLASH_JOB_MASK              (EXT_FLASH_JOB_QUEUE_SIZE - 1U)
+
+/* Commands without data and the memory mapped mode setup */
+#define EXT_FLASH_COMMAND_TIMEOUT       (5U)            /* ms */
+
+/* Period of the check of the job in progress against its worst case time, while jobs are queued */
+#define EXT_FLASH_WATCHDOG_PERIOD       (10*1000/CFG_TS_TICK_VAL)       /**< 10ms */
+
+/* Private variables ---------------------------------------------------------*/
+extern QSPI_HandleTypeDef hqspi;
+
+static Ext_Flash_Context_t Ext_Flash_Context;
+
+/* Private function prototypes -----------------------------------------------*/
+static Ext_Flash_Status_t Job_Queue(Ext_Flash_Job_Type_t Type, uint32_t Offset, const uint8_t *pData, uint32_t Size,
+                                    Ext_Flash_Callback_t Callback);
+static void               Job_Start(void);
+static void               Job_End(Ext_Flash_Status_t Status);
+static void               Step_Write_Enable(void);
+static void               Step_Operation(void);
+static void               Step_Wait(uint8_t Mask, uint8_t Match, Ext_Flash_Step_t Step);
+static void               Command_Init(QSPI_CommandTypeDef *pCommand, uint8_t Instruction);
+static void               Ext_Flash_Recover(void);
+static void               Ext_Flash_Watchdog_cb(void);
+static void               Ext_Flash_Task(void);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Register the flash task and its watchdog timer
+ */
+void EXT_FLASH_Init(void)
+{
+  UTIL_SEQ_RegTask(1<<CFG_TASK_EXT_FLASH, UTIL_SEQ_RFU, Ext_Flash_Task);
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+        &Ext_Flash_Context.Watchdog_Timer_Id,
+        hw_ts_Repeated,
+        Ext_Flash_Watchdog_cb);
+
+  return;
+}
+
+/*
+ * @brief Map the memory at EXT_FLASH_MAPPED_ADDRESS, read with QUAD_OUT_FAST_READ_CMD
+ * @note  Called by MX_QUADSPI_Init() and after the writes
+ *
+ * @retval              EXT_FLASH_BUSY while jobs are queued
+ */
+Ext_Flash_Status_t EXT_FLASH_Memory_Mapped_Enable(void)
+{
+  QSPI_CommandTypeDef      sCommand;
+  QSPI_MemoryMappedTypeDef sMemMappedCfg;
+
+  if(hqspi.State == HAL_QSPI_STATE_BUSY_MEM_MAPPED)
+  {
+    return EXT_FLASH_OK;
+  }
+  if(!EXT_FLASH_Is_Idle())
+  {
+    return EXT_FLASH_BUSY;
+  }
+
+  Command_Init(&sCommand, QUAD_OUT_FAST_READ_CMD);
+  sCommand.AddressMode = QSPI_ADDRESS_1_LINE;
+  sCommand.DataMode    = QSPI_DATA_4_LINES;
+  sCommand.DummyCycles = DUMMY_CLOCK_CYCLES_READ;
+
+  sMemMappedCfg.TimeOutActivation = QSPI_TIMEOUT_COUNTER_DISABLE;
+
+  if(HAL_QSPI_MemoryMapped(&hqspi, &sCommand, &sMemMappedCfg) != HAL_OK)
+  {
+    return EXT_FLASH_ERROR;
+  }
+
+  return EXT_FLASH_OK;
+}
+
+/*
+ * @brief Leave the memory mapped mode to program or erase the memory
+ * @note  Nothing may read at EXT_FLASH_MAPPED_ADDRESS until EXT_FLASH_Memory_Mapped_Enable() :
+ *        the bus access would fault. Only the task context reads the memory (MIDI_Load(), song
+ *        store), so it is enough to call both functions from task context.
+ */
+Ext_Flash_Status_t EXT_FLASH_Memory_Mapped_Disable(void)
+{
+  if(hqspi.State != HAL_QSPI_STATE_BUSY_MEM_MAPPED)
+  {
+    return EXT_FLASH_OK;
+  }
+
+  /* Ends the read in progress (chip select released) and empties the prefetch FIFO */
+  if(HAL_QSPI_Abort(&hqspi) != HAL_OK)
+  {
+    return EXT_FLASH_ERROR;
+  }
+
+  return EXT_FLASH_OK;
+}
+
+/*
+ * @brief Memory mapped mode status
+ *
+ * @retval              0 when the memory cannot be read at EXT_FLASH_MAPPED_ADDRESS
+ */
+uint8_t EXT_FLASH_Is_Memory_Mapped(void)
+{
+  return (hqspi.State == HAL_QSPI_STATE_BUSY_MEM_MAPPED) ? 1 : 0;
+}
+
+/*
+ * @brief Job queue status
+ *
+ * @retval              1 when all the jobs are over and reported
+ */
+uint8_t EXT_FLASH_Is_Idle(void)
+{
+  return (Ext_Flash_Context.Tail == Ext_Flash_Context.Head) ? 1 : 0;
+}
+
+/*
+ * @brief Queue the erase of a 64 KB sector
+ * @note  The memory shall not be mapped until the end of the job
+ *
+ * @param Offset        any offset in the sector, above EXT_FLASH_PARAM_SECTORS_END
+ * @param Callback      called by the flash task at the end of the erase, may be NULL
+ *
+ * @retval              EXT_FLASH_BUSY when the queue is full, nothing is queued
+ */
+Ext_Flash_Status_t EXT_FLASH_Erase_Sector(uint32_t Offset, Ext_Flash_Callback_t Callback)
+{
+  if((Offset < EXT_FLASH_PARAM_SECTORS_END) || (Offset >= QSPI_END_ADDR))
+  {
+    return EXT_FLASH_ERROR;
+  }
+
+  return Job_Queue(EXT_FLASH_JOB_ERASE, Offset - (Offset % EXT_FLASH_SECTOR_SIZE), NULL, EXT_FLASH_SECTOR_SIZE, Callback);
+}
+
+/*
+ * @brief Queue the program of data, split in pages with QUAD_IN_FAST_PROG_CMD
+ * @note  The memory shall not be mapped until the end of the job. The jobs are run in order :
+ *        data queued after the erase of its sector is programmed once the sector is erased.
+ *
+ * @param Offset        offset in the memory
+ * @param pData         data to program, shall stay valid until the callback
+ * @param Size          number of bytes
+ * @param Callback      called by the flash task once all the data is programmed or on error, may be NULL
+ *
+ * @retval              EXT_FLASH_BUSY when the queue is full, nothing is queued
+ */
+Ext_Flash_Status_t EXT_FLASH_Program(uint32_t Offset, const uint8_t *pData, uint32_t Size, Ext_Flash_Callback_t Callback)
+{
+  if((Size == 0) || (Offset >= QSPI_END_ADDR) || (Size > (QSPI_END_ADDR - Offset)))
+  {
+    return EXT_FLASH_ERROR;
+  }
+
+  return Job_Queue(EXT_FLASH_JOB_PROGRAM, Offset, pData, Size, Callback);
+}
+
+/*
+ * @brief Status match : WEL set or WIP cleared, the next step is started
+ */
+void HAL_QSPI_StatusMatchCallback(QSPI_HandleTypeDef *hqspi)
+{
+  Ext_Flash_Job_t *p_job = &Ext_Flash_Context.Jobs[Ext_Flash_Context.Current & EXT_FLASH_JOB_MASK];
+
+  if(Ext_Flash_Context.Step == EXT_FLASH_STEP_WAIT_WEL)
+  {
+    Step_Operation();
+  }
+  else if(Ext_Flash_Context.Step == EXT_FLASH_STEP_WAIT_READY)
+  {
+    /* With a program or erase error the memory keeps WIP set : the watchdog ends the job */
+    if(p_job->Type == EXT_FLASH_JOB_PROGRAM)
+    {
+      Ext_Flash_Context.Done += Ext_Flash_Context.Length;
+    }
+    if((p_job->Type == EXT_FLASH_JOB_PROGRAM) && (Ext_Flash_Context.Done < p_job->Size))
+    {
+      Step_Write_Enable();
+    }
+    else
+    {
+      Job_End(EXT_FLASH_OK);
+    }
+  }
+
+  return;
+}
+
+/*
+ * @brief End of a command without data : write enable or sector erase
+ */
+void HAL_QSPI_CmdCpltCallback(QSPI_HandleTypeDef *hqspi)
+{
+  if(Ext_Flash_Context.Step == EXT_FLASH_STEP_WRITE_ENABLE)
+  {
+    Step_Wait(EXT_FLASH_SR1_WEL, EXT_FLASH_SR1_WEL, EXT_FLASH_STEP_WAIT_WEL);
+  }
+  else if(Ext_Flash_Context.Step == EXT_FLASH_STEP_ERASE)
+  {
+    Step_Wait(EXT_FLASH_SR1_WIP, 0, EXT_FLASH_STEP_WAIT_READY);
+  }
+
+  return;
+}
+
+/*
+ * @brief Data of the page sent to the memory, the programming starts
+ */
+void HAL_QSPI_TxCpltCallback(QSPI_HandleTypeDef *hqspi)
+{
+  if(Ext_Flash_Context.Step == EXT_FLASH_STEP_TRANSMIT)
+  {
+    Step_Wait(EXT_FLASH_SR1_WIP, 0, EXT_FLASH_STEP_WAIT_READY);
+  }
+
+  return;
+}
+
+/*
+ * @brief QSPI transfer error
+ */
+void HAL_QSPI_ErrorCallback(QSPI_HandleTypeDef *hqspi)
+{
+  if(Ext_Flash_Context.Step != EXT_FLASH_STEP_IDLE)
+  {
+    Job_End(EXT_FLASH_ERROR);
+  }
+
+  return;
+}
+
+/*
+ * @brief Add a job to the queue and start it when the memory is idle
+ */
+static Ext_Flash_Status_t Job_Queue(Ext_Flash_Job_Type_t Type, uint32_t Offset, const uint8_t *pData, uint32_t Size,
+                                    Ext_Flash_Callback_t Callback)
+{
+  Ext_Flash_Job_t *p_job;
+
+  if(hqspi.State == HAL_QSPI_STATE_BUSY_MEM_MAPPED)
+  {
+    return EXT_FLASH_ERROR;
+  }
+  if((uint8_t)(Ext_Flash_Context.Head - Ext_Flash_Context.Tail) >= EXT_FLASH_JOB_QUEUE_SIZE)
+  {
+    return EXT_FLASH_BUSY;
+  }
+
+  if(EXT_FLASH_Is_Idle())
+  {
+    HW_TS_Start(Ext_Flash_Context.Watchdog_Timer_Id, EXT_FLASH_WATCHDOG_PERIOD);
+  }
+
+  p_job = &Ext_Flash_Context.Jobs[Ext_Flash_Context.Head & EXT_FLASH_JOB_MASK];
+  p_job->Type = Type;
+  p_job->Status = EXT_FLASH_BUSY;
+  p_job->Offset = Offset;
+  p_job->pData = pData;
+  p_job->Size = Size;
+  p_job->Callback = Callback;
+
+  /* The interrupt starts the next job at the end of the current one */
+  HAL_NVIC_DisableIRQ(QUADSPI_IRQn);
+  Ext_Flash_Context.Head++;
+  if((Ext_Flash_Context.Step == EXT_FLASH_STEP_IDLE) && !Ext_Flash_Context.Recover)
+  {
+    Job_Start();
+  }
+  HAL_NVIC_EnableIRQ(QUADSPI_IRQn);
+
+  return EXT_FLASH_OK;
+}
+
+/*
+ * @brief Start the job Current if any, from the task or from the interrupt of the previous job
+ */
+static void Job_Start(void)
+{
+  if(Ext_Flash_Context.Current == Ext_Flash_Context.Head)
+  {
+    return;
+  }
+
+  Ext_Flash_Context.Done = 0;
+  Step_Write_Enable();
+
+  return;
+}
+
+/*
+ * @brief End of the job Current, the next one is started unless the memory needs to be recovered
+ */
+static void Job_End(Ext_Flash_Status_t Status)
+{
+  Ext_Flash_Context.Jobs[Ext_Flash_Context.Current & EXT_FLASH_JOB_MASK].Status = Status;
+  Ext_Flash_Context.Current++;
+  Ext_Flash_Context.Step = EXT_FLASH_STEP_IDLE;
+
+  if(Status == EXT_FLASH_OK)
+  {
+    Job_Start();
+  }
+  else
+  {
+    Ext_Flash_Context.Recover = 1;
+  }
+
+  UTIL_SEQ_SetTask(1<<CFG_TASK_EXT_FLASH, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Send the write enable command before each page program or sector erase
+ */
+static void Step_Write_Enable(void)
+{
+  Ext_Flash_Job_t *p_job = &Ext_Flash_Context.Jobs[Ext_Flash_Context.Current & EXT_FLASH_JOB_MASK];
+  QSPI_CommandTypeDef sCommand;
+  uint32_t offset;
+
+  if(p_job->Type == EXT_FLASH_JOB_PROGRAM)
+  {
+    /* Up to the end of the page */
+    offset = p_job->Offset + Ext_Flash_Context.Done;
+    Ext_Flash_Context.Length = EXT_FLASH_PAGE_SIZE - (offset % EXT_FLASH_PAGE_SIZE);
+    if(Ext_Flash_Context.Length > (p_job->Size - Ext_Flash_Context.Done))
+    {
+      Ext_Flash_Context.Length = p_job->Size - Ext_Flash_Context.Done;
+    }
+  }
+
+  Ext_Flash_Context.Step = EXT_FLASH_STEP_WRITE_ENABLE;
+  Ext_Flash_Context.Step_Tick = HAL_GetTick();
+
+  Command_Init(&sCommand, WRITE_ENABLE_CMD);
+  if(HAL_QSPI_Command_IT(&hqspi, &sCommand) != HAL_OK)
+  {
+    Job_End(EXT_FLASH_ERROR);
+  }
+
+  return;
+}
+
+/*
+ * @brief Write enabled : send the erase command, or the program command and the data of the page
+ */
+static void Step_Operation(void)
+{
+  Ext_Flash_Job_t *p_job = &Ext_Flash_Context.Jobs[Ext_Flash_Context.Current & EXT_FLASH_JOB_MASK];
+  QSPI_CommandTypeDef sCommand;
+
+  if(p_job->Type == EXT_FLASH_JOB_ERASE)
+  {
+    Ext_Flash_Context.Step = EXT_FLASH_STEP_ERASE;
+
+    Command_Init(&sCommand, SECTOR_ERASE_CMD);
+    sCommand.AddressMode = QSPI_ADDRESS_1_LINE;
+    sCommand.Address     = p_job->Offset;
+
+    if(HAL_QSPI_Command_IT(&hqspi, &sCommand) != HAL_OK)
+    {
+      Job_End(EXT_FLASH_ERROR);
+    }
+  }
+  else
+  {
+    Ext_Flash_Context.Step = EXT_FLASH_STEP_TRANSMIT;
+
+    Command_Init(&sCommand, QUAD_IN_FAST_PROG_CMD);
+    sCommand.AddressMode = QSPI_ADDRESS_1_LINE;
+    sCommand.Address     = p_job->Offset + Ext_Flash_Context.Done;
+    sCommand.DataMode    = QSPI_DATA_4_LINES;
+    sCommand.NbData      = Ext_Flash_Context.Length;
+
+    /* With data, the command only configures the peripheral : the transfer starts with the transmit */
+    if((HAL_QSPI_Command_IT(&hqspi, &sCommand) != HAL_OK) ||
+       (HAL_QSPI_Transmit_IT(&hqspi, (uint8_t *)&p_job->pData[Ext_Flash_Context.Done]) != HAL_OK))
+    {
+      Job_End(EXT_FLASH_ERROR);
+    }
+  }
+
+  return;
+}
+
+/*
+ * @brief Poll the status register 1 by the QSPI peripheral until (SR1 & Mask) == Match
+ */
+static void Step_Wait(uint8_t Mask, uint8_t Match, Ext_Flash_Step_t Step)
+{
+  QSPI_CommandTypeDef     sCommand;
+  QSPI_AutoPollingTypeDef sConfig;
+
+  Ext_Flash_Context.Step = Step;
+
+  Command_Init(&sCommand, READ_STATUS_REG_CMD);
+  sCommand.DataMode = QSPI_DATA_1_LINE;
+
+  sConfig.Match           = Match;
+  sConfig.Mask            = Mask;
+  sConfig.MatchMode       = QSPI_MATCH_MODE_AND;
+  sConfig.StatusBytesSize = 1;
+  sConfig.Interval        = 0x10;
+  sConfig.AutomaticStop   = QSPI_AUTOMATIC_STOP_ENABLE;
+
+  if(HAL_QSPI_AutoPolling_IT(&hqspi, &sCommand, &sConfig) != HAL_OK)
+  {
+    Job_End(EXT_FLASH_ERROR);
+  }
+
+  return;
+}
+
+/*
+ * @brief Single line instruction without address nor data, to be completed by the caller
+ */
+static void Command_Init(QSPI_CommandTypeDef *pCommand, uint8_t Instruction)
+{
+  pCommand->Instruction        = Instruction;
+  pCommand->InstructionMode    = QSPI_INSTRUCTION_1_LINE;
+  pCommand->Address            = 0;
+  pCommand->AddressMode        = QSPI_ADDRESS_NONE;
+  pCommand->AddressSize        = QSPI_ADDRESS_24_BITS;
+  pCommand->AlternateBytes     = 0;
+  pCommand->AlternateByteMode  = QSPI_ALTERNATE_BYTES_NONE;
+  pCommand->AlternateBytesSize = QSPI_ALTERNATE_BYTES_8_BITS;
+  pCommand->DataMode           = QSPI_DATA_NONE;
+  pCommand->NbData             = 0;
+  pCommand->DummyCycles        = 0;
+  pCommand->DdrMode            = QSPI_DDR_MODE_DISABLE;
+  pCommand->SIOOMode           = QSPI_SIOO_INST_EVERY_CMD;
+
+  return;
+}
+
+/*
+ * @brief After an error, stop the polling in progress and clear the program and erase error
+ *        bits : the memory stays busy until they are cleared
+ */
+static void Ext_Flash_Recover(void)
+{
+  QSPI_CommandTypeDef sCommand;
+
+  if(hqspi.State != HAL_QSPI_STATE_READY)
+  {
+    HAL_QSPI_Abort(&hqspi);
+  }
+
+  Command_Init(&sCommand, CLEAR_STATUS_REG_CMD);
+  HAL_QSPI_Command(&hqspi, &sCommand, EXT_FLASH_COMMAND_TIMEOUT);
+
+  return;
+}
+
+/*
+ * @brief Timer callback to check the job in progress
+ */
+static void Ext_Flash_Watchdog_cb(void)
+{
+  UTIL_SEQ_SetTask(1<<CFG_TASK_EXT_FLASH, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Flash task : ends a job over its worst case time, recovers the memory after an error
+ *        and calls the callbacks of the jobs over
+ */
+static void Ext_Flash_Task(void)
+{
+  Ext_Flash_Job_t job;
+  uint32_t max_time;
+
+  HAL_NVIC_DisableIRQ(QUADSPI_IRQn);
+  if(Ext_Flash_Context.Step != EXT_FLASH_STEP_IDLE)
+  {
+    max_time = (Ext_Flash_Context.Jobs[Ext_Flash_Context.Current & EXT_FLASH_JOB_MASK].Type == EXT_FLASH_JOB_ERASE) ?
+               EXT_FLASH_SECTOR_ERASE_MAX_TIME : EXT_FLASH_PAGE_PROGRAM_MAX_TIME;
+    /* One more tick : HAL_GetTick() may have been incremented just after the step started */
+    if((HAL_GetTick() - Ext_Flash_Context.Step_Tick) > (max_time + 1))
+    {
+      Job_End(EXT_FLASH_ERROR);
+    }
+  }
+  if(Ext_Flash_Context.Recover)
+  {
+    Ext_Flash_Recover();
+    Ext_Flash_Context.Recover = 0;
+    Job_Start();
+  }
+  HAL_NVIC_EnableIRQ(QUADSPI_IRQn);
+
+  while(Ext_Flash_Context.Tail != Ext_Flash_Context.Current)
+  {
+    /* The callback may queue a job in the entry */
+    job = Ext_Flash_Context.Jobs[Ext_Flash_Context.Tail & EXT_FLASH_JOB_MASK];
+    Ext_Flash_Context.Tail++;
+    if(job.Callback != NULL)
+    {
+      job.Callback(job.Status, job.Offset, job.Size);
+    }
+  }
+
+  if(EXT_FLASH_Is_Idle())
+  {
+    HW_TS_Stop(Ext_Flash_Context.Watchdog_Timer_Id);
+  }
+
+  return;
+}
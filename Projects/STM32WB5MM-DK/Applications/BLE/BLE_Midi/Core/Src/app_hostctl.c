@@ -0,0 +1,718 @@
+/**
+  ******************************************************************************
+  * @file    app_hostctl.c
+  * @author  MCD Application Team
+  * @brief   Host control protocol on the trace UART : the reception runs by
+  *          DMA in a circular buffer, the frames are decoded in a task
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+#include "dbg_trace.h"
+#include "utilities_conf.h"
+#include "stm32_seq.h"
+#include "hw_if.h"
+#include "tl.h"
+#include "hci_tl.h"
+#include "custom_app.h"
+#include "app_midi.h"
+#include "app_latency.h"
+#include "app_hostctl.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  void                  (*pTextCmdCb)(const char *pCmd);
+  uint8_t               Rx_Dma[HOSTCTL_RX_DMA_SIZE];    /*!< Written by the DMA */
+  volatile uint32_t     Rx_Written;                     /*!< Bytes written by the DMA since start */
+  uint16_t              Rx_Dma_Pos;                     /*!< Last position reported by the DMA */
+  volatile uint8_t      Rx_Restart;                     /*!< Reception restarted after an error */
+  uint32_t              Rx_Restart_At;                  /*!< Value of Rx_Written at the restart */
+  uint32_t              Rx_Read;                        /*!< Bytes parsed since start */
+  uint8_t               In_Frame;                       /*!< Between the opening and closing delimiters */
+  uint8_t               Discard;                        /*!< Frame too long or overwritten, dropped at its end */
+  uint16_t              Length;                         /*!< Bytes of the text line or of the frame */
+  uint8_t               Rx_Frame[HOSTCTL_FRAME_MAX_SIZE];
+  uint8_t               Tx_Frame[HOSTCTL_FRAME_MAX_SIZE];       /*!< Response before encoding */
+  uint8_t               Tx_Buffer[HOSTCTL_FRAME_MAX_SIZE + 4U]; /*!< Response on the wire */
+  uint16_t              Tx_Length;                      /*!< Response waiting for the UART, 0 when none */
+  volatile uint8_t      Tx_Busy;                        /*!< Response being sent by DMA */
+  uint32_t              Stats[HOSTCTL_STATS_NBR];
+} HostCtl_Context_t;
+
+/* Private defines -----------------------------------------------------------*/
+/* Type, sequence number and CRC */
+#define HOSTCTL_REQUEST_MIN_SIZE        (4U)
+#define HOSTCTL_CRC_SIZE                (2U)
+/* Type, sequence number and status */
+#define HOSTCTL_RESPONSE_HEADER_SIZE    (3U)
+
+#define HOSTCTL_CRC_INIT                (0xFFFFU)
+
+/* Private variables ---------------------------------------------------------*/
+static HostCtl_Context_t HostCtl_Context;
+
+/* CRC-16/CCITT-FALSE (polynomial 0x1021) by nibble */
+static const uint16_t HostCtl_Crc_Table[16] =
+{
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void             HostCtl_Rx_Event_cb(uint16_t Pos);
+static void             HostCtl_Task(void);
+static void             HostCtl_Rx_Byte(uint8_t Byte);
+static void             HostCtl_Frame_Process(void);
+static uint16_t         HostCtl_Request(uint8_t Type, const uint8_t *pData, uint16_t Length, uint8_t *pStatus);
+static uint16_t         HostCtl_Midi(const uint8_t *pData, uint16_t Length, uint8_t *pStatus);
+static uint8_t          HostCtl_Midi_Length(uint8_t Status);
+static uint16_t         HostCtl_Stats(uint8_t *pData);
+static void             HostCtl_Send(uint16_t Length);
+static uint8_t          HostCtl_Tx_Start(void);
+#if (CFG_DEBUG_TRACE == 0)
+static void             HostCtl_Tx_Cplt_cb(void);
+#endif
+static uint16_t         HostCtl_Crc(const uint8_t *pData, uint16_t Length);
+static uint16_t         HostCtl_Cobs_Encode(const uint8_t *pSrc, uint16_t Length, uint8_t *pDst);
+static uint16_t         HostCtl_Cobs_Decode(uint8_t *pBuf, uint16_t Length);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Start the reception of the text commands and of the host control frames
+ *
+ * @param pTextCmdCb    called in task context with each text command, without its carriage return
+ */
+void HOSTCTL_Init(void (*pTextCmdCb)(const char *pCmd))
+{
+#if ((CFG_DEBUG_TRACE == 0) && (CFG_DEBUG_TRACE_BINARY == 0))
+  /* No trace at all, the UART is owned by the host control */
+  MX_USART1_UART_Init();
+#endif
+
+  HostCtl_Context.pTextCmdCb = pTextCmdCb;
+  UTIL_SEQ_RegTask(1<<CFG_TASK_HOSTCTL, UTIL_SEQ_RFU, HostCtl_Task);
+
+  if(HW_UART_Receive_DMA_Circular(CFG_DEBUG_TRACE_UART,
+                                  HostCtl_Context.Rx_Dma,
+                                  HOSTCTL_RX_DMA_SIZE,
+                                  HostCtl_Rx_Event_cb) != hw_uart_ok)
+  {
+    APP_DBG_MSG("HOSTCTL reception not started\n");
+  }
+
+  return;
+}
+
+/*
+ * @brief Clear the counters of the protocol
+ */
+void HOSTCTL_Reset_Stats(void)
+{
+  memset(HostCtl_Context.Stats, 0, sizeof(HostCtl_Context.Stats));
+
+  return;
+}
+
+/*
+ * @brief The UART DMA is free again after a block of the binary traces : send the pending response
+ * @note  Called under the DMA interrupt
+ */
+void HOSTCTL_Uart_Tx_Done(void)
+{
+  if(HostCtl_Context.Tx_Length != 0)
+  {
+    UTIL_SEQ_SetTask(1<<CFG_TASK_HOSTCTL, CFG_SCH_PRIO_1);
+  }
+
+  return;
+}
+
+/*
+ * @brief Bytes received by the DMA
+ * @note  Called under interrupt at the half and at the end of the buffer and when the line goes idle
+ *
+ * @param Pos           position of the DMA in the buffer or HW_UART_RX_RESTART
+ */
+static void HostCtl_Rx_Event_cb(uint16_t Pos)
+{
+  if(Pos == HW_UART_RX_RESTART)
+  {
+    /* The DMA writes again from the buffer start : skip to the next lap */
+    if(HostCtl_Context.Rx_Dma_Pos != 0)
+    {
+      HostCtl_Context.Rx_Written += HOSTCTL_RX_DMA_SIZE - HostCtl_Context.Rx_Dma_Pos;
+      HostCtl_Context.Rx_Dma_Pos = 0;
+    }
+    HostCtl_Context.Rx_Restart_At = HostCtl_Context.Rx_Written;
+    HostCtl_Context.Rx_Restart = 1;
+  }
+  else
+  {
+    if(Pos >= HostCtl_Context.Rx_Dma_Pos)
+    {
+      HostCtl_Context.Rx_Written += Pos - HostCtl_Context.Rx_Dma_Pos;
+    }
+    else
+    {
+      HostCtl_Context.Rx_Written += HOSTCTL_RX_DMA_SIZE - HostCtl_Context.Rx_Dma_Pos + Pos;
+    }
+    HostCtl_Context.Rx_Dma_Pos = Pos % HOSTCTL_RX_DMA_SIZE;
+  }
+  UTIL_SEQ_SetTask(1<<CFG_TASK_HOSTCTL, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Parse the bytes received since the last run
+ * @note  A frame is processed only once the response of the previous one is handed to the UART, the DMA
+ *        buffer absorbs the requests received meanwhile. While the UART is busy, the task is set again
+ *        by the end of the transmission (HostCtl_Tx_Cplt_cb, HOSTCTL_Uart_Tx_Done)
+ */
+static void HostCtl_Task(void)
+{
+  uint32_t written;
+  uint32_t start;
+  uint8_t restart;
+  uint32_t restart_at;
+
+  if((HostCtl_Context.Tx_Length != 0) && (HostCtl_Tx_Start() == 0))
+  {
+    return;
+  }
+
+  UTILS_ENTER_CRITICAL_SECTION();
+  written = HostCtl_Context.Rx_Written;
+  restart = HostCtl_Context.Rx_Restart;
+  restart_at = HostCtl_Context.Rx_Restart_At;
+  HostCtl_Context.Rx_Restart = 0;
+  UTILS_EXIT_CRITICAL_SECTION();
+
+  if(restart != 0)
+  {
+    HostCtl_Context.Stats[HOSTCTL_STATS_UART_ERRORS]++;
+    HostCtl_Context.Discard = 1;
+    if((int32_t)(restart_at - HostCtl_Context.Rx_Read) > 0)
+    {
+      HostCtl_Context.Rx_Read = restart_at;
+    }
+  }
+  if((written - HostCtl_Context.Rx_Read) > HOSTCTL_RX_DMA_SIZE)
+  {
+    HostCtl_Context.Stats[HOSTCTL_STATS_OVERRUNS] += written - HostCtl_Context.Rx_Read - HOSTCTL_RX_DMA_SIZE;
+    HostCtl_Context.Rx_Read = written - HOSTCTL_RX_DMA_SIZE;
+    HostCtl_Context.Discard = 1;
+  }
+
+  start = HostCtl_Context.Rx_Read;
+  while((HostCtl_Context.Rx_Read != written) && (HostCtl_Context.Tx_Length == 0))
+  {
+    HostCtl_Rx_Byte(HostCtl_Context.Rx_Dma[HostCtl_Context.Rx_Read % HOSTCTL_RX_DMA_SIZE]);
+    HostCtl_Context.Rx_Read++;
+  }
+  HostCtl_Context.Stats[HOSTCTL_STATS_RX_BYTES] += HostCtl_Context.Rx_Read - start;
+
+  /* The DMA may have lapped the bytes while they were parsed */
+  if((HostCtl_Context.Rx_Written - start) > HOSTCTL_RX_DMA_SIZE)
+  {
+    HostCtl_Context.Stats[HOSTCTL_STATS_OVERRUNS]++;
+    HostCtl_Context.Discard = 1;
+  }
+
+  if((HostCtl_Context.Rx_Read != HostCtl_Context.Rx_Written) && (HostCtl_Context.Tx_Length == 0))
+  {
+    UTIL_SEQ_SetTask(1<<CFG_TASK_HOSTCTL, CFG_SCH_PRIO_1);
+  }
+
+  return;
+}
+
+/*
+ * @brief Text line up to a carriage return, frame between two delimiters
+ *
+ * @param Byte          received byte
+ */
+static void HostCtl_Rx_Byte(uint8_t Byte)
+{
+  if(Byte == HOSTCTL_DELIMITER)
+  {
+    if((HostCtl_Context.In_Frame != 0) && (HostCtl_Context.Length != 0))
+    {
+      /* Closing delimiter, back to the text commands */
+      if(HostCtl_Context.Discard == 0)
+      {
+        HostCtl_Frame_Process();
+      }
+      HostCtl_Context.In_Frame = 0;
+    }
+    else
+    {
+      /* Opening delimiter, a partial text line is dropped */
+      HostCtl_Context.In_Frame = 1;
+    }
+    HostCtl_Context.Length = 0;
+    HostCtl_Context.Discard = 0;
+  }
+  else if(HostCtl_Context.In_Frame != 0)
+  {
+    if(HostCtl_Context.Length < HOSTCTL_FRAME_MAX_SIZE)
+    {
+      HostCtl_Context.Rx_Frame[HostCtl_Context.Length++] = Byte;
+    }
+    else if(HostCtl_Context.Discard == 0)
+    {
+      HostCtl_Context.Stats[HOSTCTL_STATS_FRAMING_ERRORS]++;
+      HostCtl_Context.Discard = 1;
+    }
+  }
+  else if(Byte == '\r')
+  {
+    HostCtl_Context.Rx_Frame[HostCtl_Context.Length] = '\0';
+    APP_DBG_MSG("received %s\n", HostCtl_Context.Rx_Frame);
+    if(HostCtl_Context.pTextCmdCb != NULL)
+    {
+      HostCtl_Context.pTextCmdCb((const char *)HostCtl_Context.Rx_Frame);
+    }
+    HostCtl_Context.Length = 0;
+  }
+  else if(HostCtl_Context.Length < (HOSTCTL_FRAME_MAX_SIZE - 1U))
+  {
+    HostCtl_Context.Rx_Frame[HostCtl_Context.Length++] = Byte;
+  }
+
+  return;
+}
+
+/*
+ * @brief Decode and check a frame, then answer it
+ */
+static void HostCtl_Frame_Process(void)
+{
+  uint16_t length;
+  uint16_t crc;
+  uint8_t status;
+
+  length = HostCtl_Cobs_Decode(HostCtl_Context.Rx_Frame, HostCtl_Context.Length);
+  if(length < HOSTCTL_REQUEST_MIN_SIZE)
+  {
+    HostCtl_Context.Stats[HOSTCTL_STATS_FRAMING_ERRORS]++;
+    return;
+  }
+
+  length -= HOSTCTL_CRC_SIZE;
+  crc = HostCtl_Context.Rx_Frame[length] | (HostCtl_Context.Rx_Frame[length + 1U] << 8);
+  if(HostCtl_Crc(HostCtl_Context.Rx_Frame, length) != crc)
+  {
+    /* Not answered, the sequence number may be wrong : the host retries on timeout */
+    HostCtl_Context.Stats[HOSTCTL_STATS_CRC_ERRORS]++;
+    return;
+  }
+  HostCtl_Context.Stats[HOSTCTL_STATS_FRAMES]++;
+
+  HostCtl_Context.Tx_Frame[0] = HostCtl_Context.Rx_Frame[0] | HOSTCTL_RESPONSE;
+  HostCtl_Context.Tx_Frame[1] = HostCtl_Context.Rx_Frame[1];
+  length = HostCtl_Request(HostCtl_Context.Rx_Frame[0], &HostCtl_Context.Rx_Frame[2], length - 2U, &status);
+  HostCtl_Context.Tx_Frame[2] = status;
+
+  HostCtl_Send(HOSTCTL_RESPONSE_HEADER_SIZE + length);
+
+  return;
+}
+
+/*
+ * @brief Execute a request
+ *
+ * @param Type          request type
+ * @param pData         request data
+ * @param Length        request data length
+ * @param pStatus       HostCtl_Status_t of the request
+ *
+ * @retval              length of the response data, written after the response header
+ */
+static uint16_t HostCtl_Request(uint8_t Type, const uint8_t *pData, uint16_t Length, uint8_t *pStatus)
+{
+  uint8_t *p_rsp = &HostCtl_Context.Tx_Frame[HOSTCTL_RESPONSE_HEADER_SIZE];
+  uint16_t rsp_length = 0;
+
+  *pStatus = HOSTCTL_STATUS_OK;
+  switch(Type)
+  {
+    case HOSTCTL_TYPE_PING:
+      memcpy(p_rsp, pData, Length);
+      rsp_length = Length;
+      break;
+
+    case HOSTCTL_TYPE_TRANSPORT:
+      if(Length != 1U)
+      {
+        *pStatus = HOSTCTL_STATUS_LENGTH;
+      }
+      else if(pData[0] == HOSTCTL_TRANSPORT_RESTART)
+      {
+        Midi_Button_Restart();
+      }
+      else if(pData[0] > HOSTCTL_TRANSPORT_RESTART)
+      {
+        *pStatus = HOSTCTL_STATUS_UNKNOWN;
+      }
+      else if(Midi_Is_Playing() != pData[0])
+      {
+        Midi_Button_Switch_Mode();
+      }
+      p_rsp[0] = Midi_Is_Playing();
+      rsp_length = 1U;
+      break;
+
+    case HOSTCTL_TYPE_MIDI:
+      rsp_length = HostCtl_Midi(pData, Length, pStatus);
+      break;
+
+    case HOSTCTL_TYPE_STATS_GET:
+      rsp_length = HostCtl_Stats(p_rsp);
+      break;
+
+    case HOSTCTL_TYPE_STATS_RESET:
+      HOSTCTL_Reset_Stats();
+      TL_MM_ResetStats();
+      hci_reset_stats();
+#if (CFG_LATENCY_PROBES != 0)
+      LATENCY_Reset();
+#endif
+      break;
+
+    case HOSTCTL_TYPE_COMMAND:
+      if((Length == 0) || (Length >= HOSTCTL_FRAME_MAX_SIZE))
+      {
+        *pStatus = HOSTCTL_STATUS_LENGTH;
+      }
+      else
+      {
+        /* The data is in the reception buffer, there is room for the terminating character */
+        ((uint8_t *)pData)[Length] = '\0';
+        if(HostCtl_Context.pTextCmdCb != NULL)
+        {
+          HostCtl_Context.pTextCmdCb((const char *)pData);
+        }
+      }
+      break;
+
+    default:
+      *pStatus = HOSTCTL_STATUS_UNKNOWN;
+      break;
+  }
+
+  return rsp_length;
+}
+
+/*
+ * @brief Send the midi messages of a request to the centrals
+ * @note  All the messages are checked first, nothing is sent when one of them is not valid
+ *
+ * @param pData         complete midi messages, status byte first, no running status
+ * @param Length        data length
+ * @param pStatus       HostCtl_Status_t of the request
+ *
+ * @retval              length of the response data : number of messages sent
+ */
+static uint16_t HostCtl_Midi(const uint8_t *pData, uint16_t Length, uint8_t *pStatus)
+{
+  uint16_t index;
+  uint8_t msg_length;
+  uint8_t i;
+  uint8_t count = 0;
+
+  for(index = 0; index < Length; index += msg_length)
+  {
+    msg_length = HostCtl_Midi_Length(pData[index]);
+    if((msg_length == 0) || ((index + msg_length) > Length))
+    {
+      *pStatus = HOSTCTL_STATUS_MIDI;
+      return 0;
+    }
+    for(i = 1; i < msg_length; i++)
+    {
+      if((pData[index + i] & 0x80U) != 0)
+      {
+        *pStatus = HOSTCTL_STATUS_MIDI;
+        return 0;
+      }
+    }
+  }
+
+  for(index = 0; index < Length; index += msg_length)
+  {
+    msg_length = HostCtl_Midi_Length(pData[index]);
+    Midi_Send_Message(&pData[index], msg_length);
+    count++;
+  }
+  HostCtl_Context.Stats[HOSTCTL_STATS_MIDI_MESSAGES] += count;
+  HostCtl_Context.Tx_Frame[HOSTCTL_RESPONSE_HEADER_SIZE] = count;
+
+  return 1U;
+}
+
+/*
+ * @brief Length of a midi message
+ *
+ * @param Status        status byte
+ *
+ * @retval              message length, 0 for a data byte and for the system exclusive messages
+ */
+static uint8_t HostCtl_Midi_Length(uint8_t Status)
+{
+  uint8_t length;
+
+  if(Status < 0x80U)
+  {
+    length = 0;
+  }
+  else if(Status < 0xF0U)
+  {
+    length = (((Status & 0xE0U) == 0xC0U) ? 2U : 3U);
+  }
+  else
+  {
+    switch(Status)
+    {
+      case 0xF1U:
+      case 0xF3U:
+        length = 2U;
+        break;
+
+      case MIDI_SONG_POSITION:
+        length = 3U;
+        break;
+
+      case 0xF6U:
+        length = 1U;
+        break;
+
+      default:
+        /* System exclusive and undefined messages are not supported, real time messages are single bytes */
+        length = (Status >= MIDI_TIMING_CLOCK) ? 1U : 0U;
+        break;
+    }
+  }
+
+  return length;
+}
+
+/*
+ * @brief Fill the HOSTCTL_TYPE_STATS_GET response
+ *
+ * @param pData         response data
+ *
+ * @retval              response data length
+ */
+static uint16_t HostCtl_Stats(uint8_t *pData)
+{
+  TL_MM_Stats_t mm_stats;
+  HCI_TL_Stats_t hci_stats;
+  Midi_Player_State_t player;
+  uint32_t value;
+  uint8_t i;
+
+  TL_MM_GetStats(&mm_stats);
+  hci_get_stats(&hci_stats);
+  Midi_Get_Player_State(&player);
+
+#if (CFG_LATENCY_PROBES != 0)
+  HostCtl_Context.Stats[HOSTCTL_STATS_CPU_LOAD] = LATENCY_Get_Cpu_Load();
+#endif
+  HostCtl_Context.Stats[HOSTCTL_STATS_MBOX_PEAK_BYTES] = mm_stats.InUseBytesMax;
+  HostCtl_Context.Stats[HOSTCTL_STATS_MBOX_SPARE_EVT] = mm_stats.SpareEvtCount;
+  HostCtl_Context.Stats[HOSTCTL_STATS_HCI_QUEUE_MAX] = hci_stats.QueueDepthMax;
+  HostCtl_Context.Stats[HOSTCTL_STATS_PLAYING] = player.Playing;
+  HostCtl_Context.Stats[HOSTCTL_STATS_TICK] = HAL_GetTick();
+  HostCtl_Context.Stats[HOSTCTL_STATS_ELAPSED_MS] = player.Elapsed_Ms;
+  HostCtl_Context.Stats[HOSTCTL_STATS_REMAINING_MS] = player.Remaining_Ms;
+  HostCtl_Context.Stats[HOSTCTL_STATS_PROGRESS] = player.Progress;
+
+  pData[0] = HOSTCTL_STATS_NBR;
+  for(i = 0; i < HOSTCTL_STATS_NBR; i++)
+  {
+    value = HostCtl_Context.Stats[i];
+    pData[1U + 4U*i] = (uint8_t)value;
+    pData[2U + 4U*i] = (uint8_t)(value >> 8);
+    pData[3U + 4U*i] = (uint8_t)(value >> 16);
+    pData[4U + 4U*i] = (uint8_t)(value >> 24);
+  }
+
+  return (1U + 4U*HOSTCTL_STATS_NBR);
+}
+
+/*
+ * @brief Add the CRC to the response, encode it and hand it to the UART
+ *
+ * @param Length        response length, header included
+ */
+static void HostCtl_Send(uint16_t Length)
+{
+  uint16_t crc;
+
+  crc = HostCtl_Crc(HostCtl_Context.Tx_Frame, Length);
+  HostCtl_Context.Tx_Frame[Length++] = (uint8_t)crc;
+  HostCtl_Context.Tx_Frame[Length++] = (uint8_t)(crc >> 8);
+
+  HostCtl_Context.Tx_Buffer[0] = HOSTCTL_DELIMITER;
+  Length = 1U + HostCtl_Cobs_Encode(HostCtl_Context.Tx_Frame, Length, &HostCtl_Context.Tx_Buffer[1]);
+  HostCtl_Context.Tx_Buffer[Length++] = HOSTCTL_DELIMITER;
+  HostCtl_Context.Tx_Length = Length;
+
+  (void)HostCtl_Tx_Start();
+
+  return;
+}
+
+/*
+ * @brief Send the pending response
+ *
+ * @retval              0 when the UART is still busy
+ */
+static uint8_t HostCtl_Tx_Start(void)
+{
+#if (CFG_DEBUG_TRACE != 0)
+  /* Shared with the text traces : the response is copied in their queue */
+  DbgTraceWrite(1U, HostCtl_Context.Tx_Buffer, HostCtl_Context.Tx_Length);
+  HostCtl_Context.Tx_Length = 0;
+#else
+  /* The DMA may be sending the previous response or the binary traces */
+  if(HostCtl_Context.Tx_Busy != 0)
+  {
+    return 0;
+  }
+  HostCtl_Context.Tx_Busy = 1;
+  if(HW_UART_Transmit_DMA(CFG_DEBUG_TRACE_UART,
+                          HostCtl_Context.Tx_Buffer,
+                          HostCtl_Context.Tx_Length,
+                          HostCtl_Tx_Cplt_cb) != hw_uart_ok)
+  {
+    HostCtl_Context.Tx_Busy = 0;
+    return 0;
+  }
+  HostCtl_Context.Tx_Length = 0;
+#endif
+
+  return 1;
+}
+
+#if (CFG_DEBUG_TRACE == 0)
+/*
+ * @brief Response sent on the UART
+ * @note  Called under the DMA interrupt
+ */
+static void HostCtl_Tx_Cplt_cb(void)
+{
+  HostCtl_Context.Tx_Busy = 0;
+  /* Pending response or requests held back by the previous one */
+  UTIL_SEQ_SetTask(1<<CFG_TASK_HOSTCTL, CFG_SCH_PRIO_1);
+
+  return;
+}
+#endif
+
+/*
+ * @brief CRC-16/CCITT-FALSE
+ *
+ * @param pData         data
+ * @param Length        data length
+ *
+ * @retval              CRC
+ */
+static uint16_t HostCtl_Crc(const uint8_t *pData, uint16_t Length)
+{
+  uint16_t crc = HOSTCTL_CRC_INIT;
+  uint16_t i;
+
+  for(i = 0; i < Length; i++)
+  {
+    crc = (crc << 4) ^ HostCtl_Crc_Table[((crc >> 12) ^ (pData[i] >> 4)) & 0x0FU];
+    crc = (crc << 4) ^ HostCtl_Crc_Table[((crc >> 12) ^ pData[i]) & 0x0FU];
+  }
+
+  return crc;
+}
+
+/*
+ * @brief Consistent overhead byte stuffing : no 0x00 left in the encoded data
+ *
+ * @param pSrc          data
+ * @param Length        data length
+ * @param pDst          encoded data, up to Length + Length/254 + 1 bytes
+ *
+ * @retval              encoded length
+ */
+static uint16_t HostCtl_Cobs_Encode(const uint8_t *pSrc, uint16_t Length, uint8_t *pDst)
+{
+  uint16_t code_index = 0;
+  uint16_t out = 1;
+  uint16_t i;
+  uint8_t code = 1;
+
+  for(i = 0; i < Length; i++)
+  {
+    if(pSrc[i] != 0)
+    {
+      pDst[out++] = pSrc[i];
+      code++;
+    }
+    if((pSrc[i] == 0) || (code == 0xFFU))
+    {
+      pDst[code_index] = code;
+      code_index = out++;
+      code = 1;
+    }
+  }
+  pDst[code_index] = code;
+
+  return out;
+}
+
+/*
+ * @brief Decode in place a COBS encoded frame, without its delimiters
+ *
+ * @param pBuf          encoded frame, replaced by the decoded data
+ * @param Length        encoded length
+ *
+ * @retval              decoded length, 0 when the encoding is not valid
+ */
+static uint16_t HostCtl_Cobs_Decode(uint8_t *pBuf, uint16_t Length)
+{
+  uint16_t in = 0;
+  uint16_t out = 0;
+  uint8_t code;
+  uint8_t i;
+
+  while(in < Length)
+  {
+    code = pBuf[in++];
+    if((in + code - 1U) > Length)
+    {
+      return 0;
+    }
+    for(i = 1; i < code; i++)
+    {
+      pBuf[out++] = pBuf[in++];
+    }
+    if((code != 0xFFU) && (in < Length))
+    {
+      pBuf[out++] = 0;
+    }
+  }
+
+  return out;
+}
@@ -0,0 +1,449 @@
+/**
+  ******************************************************************************
+  * @file    app_latency.c
+  * @author  MCD Application Team
+  * @brief   Midi latency probes : time stamps taken with the DWT cycle counter
+  *          from the sequencer timer to the radio, aggregated per stage.
+  *          Report of the sequencer task profiling and of the CPU load
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+#include "dbg_trace.h"
+#include "utilities_conf.h"
+#include "stm32_seq.h"
+#include "app_latency.h"
+#include "app_ts_bench.h"
+
+#if (CFG_LATENCY_PROBES != 0)
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint32_t              Count;
+  uint64_t              Sum_Us;
+  uint32_t              Min_Us;
+  uint32_t              Max_Us;
+  uint32_t              Bins[LATENCY_BIN_NBR];
+} Latency_Histogram_t;
+
+typedef struct
+{
+  uint32_t              Cycles_Per_Us;
+  uint32_t              Timeout_Cycles;
+  uint32_t              Timer_Stamp;            /*!< Last sequencer timer */
+  uint32_t              Dispatch_Stamp;         /*!< Midi task start following the timer */
+  uint32_t              Update_Stamp;           /*!< Last characteristic update call */
+  uint32_t              Pool_Stamp;             /*!< First notification refused */
+  uint8_t               Pending;                /*!< Stages started and not closed yet */
+  Latency_Histogram_t   Stages[LATENCY_STAGE_NBR];
+  uint8_t               Load_Timer_Id;          /*!< CPU load computation timer id */
+  uint32_t              Load_Cycles;            /*!< Cycle counter at the previous computation */
+  uint64_t              Load_Idle_Cycles;       /*!< Idle cycles at the previous computation */
+  uint16_t              Cpu_Load;               /*!< Last period, per mille */
+  uint16_t              Cpu_Load_Max;           /*!< Since the last reset, per mille */
+} Latency_Context_t;
+
+/* Private defines -----------------------------------------------------------*/
+#define LATENCY_PENDING_DISPATCH        (1U << 0)
+#define LATENCY_PENDING_UPDATE          (1U << 1)
+#define LATENCY_PENDING_RADIO           (1U << 2)
+#define LATENCY_PENDING_POOL            (1U << 3)
+
+#define LATENCY_BIN_SUB                 (1U << LATENCY_BIN_SUB_BITS)
+
+/* Private variables ---------------------------------------------------------*/
+static Latency_Context_t Latency_Context;
+
+static const char * const Latency_Stage_Names[LATENCY_STAGE_NBR] =
+{
+  "timer->dispatch",
+  "dispatch->update",
+  "update call",
+  "tx pool wait",
+  "timer->radio",
+};
+
+static const char * const Latency_Task_Names[CFG_TASK_NBR] =
+{
+  CFG_TASK_NAMES
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void     Latency_Record(Latency_Stage_t Stage, uint32_t Cycles);
+static void     Latency_Load_cb(void);
+static uint32_t Latency_Bin(uint32_t Us);
+static uint32_t Latency_Bin_Upper_Us(uint32_t Bin);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Start the CPU load computation and the report task
+ * @note  The cycle counter is stopped in Stop mode, a stage spanning a low power
+ *        period (TX pool wait) is underestimated unless the low power is disabled
+ */
+void LATENCY_Init(void)
+{
+  Latency_Context.Cycles_Per_Us = SystemCoreClock / 1000000U;
+  Latency_Context.Timeout_Cycles = LATENCY_TIMEOUT_US * Latency_Context.Cycles_Per_Us;
+  LATENCY_Reset();
+
+  UTIL_SEQ_RegTask(1<<CFG_TASK_LATENCY_REPORT, UTIL_SEQ_RFU, LATENCY_Report);
+
+  Latency_Context.Load_Cycles = DWT->CYCCNT;
+  Latency_Context.Load_Idle_Cycles = UTIL_SEQ_GetIdleCycles();
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+        &Latency_Context.Load_Timer_Id,
+        hw_ts_Repeated,
+        Latency_Load_cb);
+  HW_TS_Start(Latency_Context.Load_Timer_Id, LATENCY_LOAD_PERIOD);
+
+  return;
+}
+
+/*
+ * @brief Time stamp a probe point and close the stages ending there
+ * @note  Can be called from interrupt context
+ *
+ * @param Probe         probe point
+ */
+void LATENCY_Probe(Latency_Probe_t Probe)
+{
+  uint32_t now = DWT->CYCCNT;
+
+  UTILS_ENTER_CRITICAL_SECTION();
+  switch(Probe)
+  {
+    case LATENCY_PROBE_SEQ_TIMER:
+      Latency_Context.Timer_Stamp = now;
+      Latency_Context.Pending |= (LATENCY_PENDING_DISPATCH | LATENCY_PENDING_RADIO);
+      Latency_Context.Pending &= ~LATENCY_PENDING_UPDATE;
+      break;
+
+    case LATENCY_PROBE_SEQ_DISPATCH:
+      if((Latency_Context.Pending & LATENCY_PENDING_DISPATCH) != 0)
+      {
+        Latency_Record(LATENCY_STAGE_TIMER_TO_DISPATCH, now - Latency_Context.Timer_Stamp);
+        Latency_Context.Dispatch_Stamp = now;
+        Latency_Context.Pending &= ~LATENCY_PENDING_DISPATCH;
+        Latency_Context.Pending |= LATENCY_PENDING_UPDATE;
+      }
+      break;
+
+    case LATENCY_PROBE_UPDATE_ENTRY:
+      if(((Latency_Context.Pending & LATENCY_PENDING_UPDATE) != 0) &&
+         ((now - Latency_Context.Dispatch_Stamp) < Latency_Context.Timeout_Cycles))
+      {
+        Latency_Record(LATENCY_STAGE_DISPATCH_TO_UPDATE, now - Latency_Context.Dispatch_Stamp);
+      }
+      Latency_Context.Pending &= ~LATENCY_PENDING_UPDATE;
+      Latency_Context.Update_Stamp = now;
+      break;
+
+    case LATENCY_PROBE_UPDATE_EXIT:
+      Latency_Record(LATENCY_STAGE_UPDATE, now - Latency_Context.Update_Stamp);
+      if(((Latency_Context.Pending & LATENCY_PENDING_RADIO) != 0) &&
+         ((now - Latency_Context.Timer_Stamp) < Latency_Context.Timeout_Cycles))
+      {
+        Latency_Record(LATENCY_STAGE_END_TO_END, now - Latency_Context.Timer_Stamp);
+      }
+      Latency_Context.Pending &= ~LATENCY_PENDING_RADIO;
+      break;
+
+    case LATENCY_PROBE_TX_POOL_FULL:
+      if((Latency_Context.Pending & LATENCY_PENDING_POOL) == 0)
+      {
+        Latency_Context.Pool_Stamp = now;
+        Latency_Context.Pending |= LATENCY_PENDING_POOL;
+      }
+      break;
+
+    case LATENCY_PROBE_TX_POOL_AVAILABLE:
+      if((Latency_Context.Pending & LATENCY_PENDING_POOL) != 0)
+      {
+        Latency_Record(LATENCY_STAGE_TX_POOL_WAIT, now - Latency_Context.Pool_Stamp);
+        Latency_Context.Pending &= ~LATENCY_PENDING_POOL;
+      }
+      break;
+
+    default:
+      break;
+  }
+  UTILS_EXIT_CRITICAL_SECTION();
+
+  return;
+}
+
+/*
+ * @brief Task about to be run by UTIL_SEQ_Run, see UTIL_SEQ_TASK_START_HOOK
+ *
+ * @param TaskIdx       index of the task
+ */
+void LATENCY_Task_Dispatch(uint32_t TaskIdx)
+{
+  if(TaskIdx == CFG_TASK_MIDI_SEQ)
+  {
+    LATENCY_Probe(LATENCY_PROBE_SEQ_DISPATCH);
+  }
+
+  return;
+}
+
+/*
+ * @brief Get the statistics of a stage since the last reset
+ *
+ * @param Stage         measured stage
+ * @param pStats        statistics, times in us
+ */
+void LATENCY_Get_Stats(Latency_Stage_t Stage, Latency_Stats_t *pStats)
+{
+  Latency_Histogram_t *pHisto = &Latency_Context.Stages[Stage];
+  uint32_t rank;
+  uint32_t cumul = 0;
+  uint32_t bin;
+
+  memset(pStats, 0, sizeof(Latency_Stats_t));
+
+  UTILS_ENTER_CRITICAL_SECTION();
+  if(pHisto->Count != 0)
+  {
+    pStats->Count = pHisto->Count;
+    pStats->Min_Us = pHisto->Min_Us;
+    pStats->Max_Us = pHisto->Max_Us;
+    pStats->Avg_Us = (uint32_t)(pHisto->Sum_Us / pHisto->Count);
+
+    /* Smallest bin holding at least 99% of the measures */
+    rank = pHisto->Count - (pHisto->Count / 100U);
+    for(bin = 0; bin < LATENCY_BIN_NBR; bin++)
+    {
+      cumul += pHisto->Bins[bin];
+      if(cumul >= rank)
+      {
+        break;
+      }
+    }
+    pStats->P99_Us = Latency_Bin_Upper_Us(bin);
+    if(pStats->P99_Us > pStats->Max_Us)
+    {
+      pStats->P99_Us = pStats->Max_Us;
+    }
+  }
+  UTILS_EXIT_CRITICAL_SECTION();
+
+  return;
+}
+
+/*
+ * @brief CPU load of the last period, time out of UTIL_SEQ_Idle including the interrupts
+ *
+ * @retval              per mille
+ */
+uint16_t LATENCY_Get_Cpu_Load(void)
+{
+  return Latency_Context.Cpu_Load;
+}
+
+/*
+ * @brief Clear all the histograms and the task profiling
+ * @note  Can be called from interrupt context
+ */
+void LATENCY_Reset(void)
+{
+  uint8_t i;
+
+  UTILS_ENTER_CRITICAL_SECTION();
+  memset(Latency_Context.Stages, 0, sizeof(Latency_Context.Stages));
+  for(i = 0; i < LATENCY_STAGE_NBR; i++)
+  {
+    Latency_Context.Stages[i].Min_Us = UINT32_MAX;
+  }
+  Latency_Context.Pending = 0;
+  Latency_Context.Cpu_Load_Max = 0;
+  UTILS_EXIT_CRITICAL_SECTION();
+  UTIL_SEQ_ResetProfile();
+  TS_BENCH_Reset();
+
+  return;
+}
+
+/*
+ * @brief Print the statistics of all the stages, of the sequencer tasks and the CPU load
+ *        on the trace UART
+ */
+void LATENCY_Report(void)
+{
+  Latency_Stats_t stats;
+  UTIL_SEQ_TaskProfile_t profile;
+  uint32_t cycles_per_us = Latency_Context.Cycles_Per_Us;
+  uint8_t i;
+
+  APP_DBG_MSG("Latency (us)          count      min      avg      max      p99\n\r");
+  for(i = 0; i < LATENCY_STAGE_NBR; i++)
+  {
+    LATENCY_Get_Stats((Latency_Stage_t)i, &stats);
+    APP_DBG_MSG("%-18s %8ld %8ld %8ld %8ld %8ld\n\r",
+                Latency_Stage_Names[i],
+                stats.Count,
+                stats.Min_Us,
+                stats.Avg_Us,
+                stats.Max_Us,
+                stats.P99_Us);
+  }
+
+  APP_DBG_MSG("Task (us)             count exec avg exec max wait avg wait max\n\r");
+  for(i = 0; i < CFG_TASK_NBR; i++)
+  {
+    UTIL_SEQ_GetTaskProfile(i, &profile);
+    if(profile.Count == 0)
+    {
+      continue;
+    }
+    APP_DBG_MSG("%2d %-15s %8ld %8ld %8ld %8ld %8ld\n\r",
+                i,
+                (Latency_Task_Names[i] != NULL) ? Latency_Task_Names[i] : "",
+                profile.Count,
+                (uint32_t)(profile.TotalCycles / profile.Count / cycles_per_us),
+                profile.MaxCycles / cycles_per_us,
+                (uint32_t)(profile.TotalLatencyCycles / profile.Count / cycles_per_us),
+                profile.MaxLatencyCycles / cycles_per_us);
+  }
+
+  APP_DBG_MSG("CPU load %d.%d%% (max %d.%d%%)\n\r",
+              Latency_Context.Cpu_Load / 10, Latency_Context.Cpu_Load % 10,
+              Latency_Context.Cpu_Load_Max / 10, Latency_Context.Cpu_Load_Max % 10);
+
+  TS_BENCH_Report();
+
+  return;
+}
+
+/*
+ * @brief CPU load period elapsed : the CPU is busy when the cycle counter runs out of
+ *        UTIL_SEQ_Idle, it does not run in Stop mode
+ * @note  Called under the RTC interrupt
+ */
+static void Latency_Load_cb(void)
+{
+  uint32_t cycles = DWT->CYCCNT;
+  uint64_t idle_cycles = UTIL_SEQ_GetIdleCycles();
+  uint32_t busy;
+  uint32_t load;
+
+  busy = (cycles - Latency_Context.Load_Cycles) - (uint32_t)(idle_cycles - Latency_Context.Load_Idle_Cycles);
+  Latency_Context.Load_Cycles = cycles;
+  Latency_Context.Load_Idle_Cycles = idle_cycles;
+
+  /* Period of 1s : SystemCoreClock cycles */
+  load = (uint32_t)(((uint64_t)busy * 1000U) / SystemCoreClock);
+  Latency_Context.Cpu_Load = (load < 1000U) ? load : 1000U;
+  if(Latency_Context.Cpu_Load > Latency_Context.Cpu_Load_Max)
+  {
+    Latency_Context.Cpu_Load_Max = Latency_Context.Cpu_Load;
+  }
+
+  return;
+}
+
+/*
+ * @brief Add a measure to the histogram of a stage
+ * @note  Called in critical section
+ *
+ * @param Stage         measured stage
+ * @param Cycles        duration in CPU cycles
+ */
+static void Latency_Record(Latency_Stage_t Stage, uint32_t Cycles)
+{
+  Latency_Histogram_t *pHisto = &Latency_Context.Stages[Stage];
+  uint32_t us = Cycles / Latency_Context.Cycles_Per_Us;
+
+  pHisto->Count++;
+  pHisto->Sum_Us += us;
+  if(us < pHisto->Min_Us)
+  {
+    pHisto->Min_Us = us;
+  }
+  if(us > pHisto->Max_Us)
+  {
+    pHisto->Max_Us = us;
+  }
+  pHisto->Bins[Latency_Bin(us)]++;
+
+  return;
+}
+
+/*
+ * @brief Histogram bin of a duration : LATENCY_BIN_SUB bins per power of two
+ *
+ * @param Us            duration in us
+ *
+ * @retval              bin index
+ */
+static uint32_t Latency_Bin(uint32_t Us)
+{
+  uint32_t msb;
+  uint32_t bin;
+
+  if(Us < LATENCY_BIN_SUB)
+  {
+    return Us;
+  }
+  msb = 31U - __CLZ(Us);
+  bin = ((msb - LATENCY_BIN_SUB_BITS + 1U) << LATENCY_BIN_SUB_BITS) +
+        ((Us >> (msb - LATENCY_BIN_SUB_BITS)) & (LATENCY_BIN_SUB - 1U));
+
+  return (bin < LATENCY_BIN_NBR) ? bin : (LATENCY_BIN_NBR - 1U);
+}
+
+/*
+ * @brief Duration just above a histogram bin
+ *
+ * @param Bin           bin index
+ *
+ * @retval              upper bound of the bin in us
+ */
+static uint32_t Latency_Bin_Upper_Us(uint32_t Bin)
+{
+  uint32_t shift;
+
+  if(Bin < LATENCY_BIN_SUB)
+  {
+    return (Bin + 1U);
+  }
+  shift = (Bin >> LATENCY_BIN_SUB_BITS) - 1U;
+
+  return ((LATENCY_BIN_SUB + (Bin & (LATENCY_BIN_SUB - 1U)) + 1U) << shift);
+}
+
+#else
+
+void LATENCY_Init(void)
+{
+  UTIL_SEQ_RegTask(1<<CFG_TASK_LATENCY_REPORT, UTIL_SEQ_RFU, LATENCY_Report);
+
+  return;
+}
+
+void LATENCY_Report(void)
+{
+  APP_DBG_MSG("Latency : CFG_LATENCY_PROBES is 0\n\r");
+
+  return;
+}
+
+void LATENCY_Reset(void)
+{
+  return;
+}
+
+#endif /* CFG_LATENCY_PROBES */
@@ -0,0 +1,129 @@
+/**
+  ******************************************************************************
+  * @file    app_lcd_font.c
+  * @author  MCD Application Team
+  * @brief   Fonts of the text fast path, page oriented
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*
+ * Generated by Tools/lcd_font_convert.py from Utilities/Fonts, do not edit.
+ * Each character is Width columns of ((Height + 7) / 8) bytes, least significant bit on top.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_lcd_text.h"
+
+/* Private variables ---------------------------------------------------------*/
+static const uint8_t Lcd_Font12_Columns[] =
+{
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* ' ' */
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* '!' */
+  0x00, 0x00, 0x0E, 0x00, 0x02, 0x00, 0x00, 0x00, 0x0E, 0x00, 0x02, 0x00, 0x00, 0x00, /* '"' */
+  0x00, 0x00, 0x50, 0x03, 0xF8, 0x00, 0x56, 0x03, 0xF8, 0x00, 0x56, 0x00, 0x00, 0x00, /* '#' */
+  0x00, 0x00, 0xD8, 0x00, 0xA4, 0x00, 0xA6, 0x03, 0x64, 0x00, 0x00, 0x00, 0x00, 0x00, /* '$' */
+  0x00, 0x00, 0x24, 0x00, 0x2A, 0x00, 0xA4, 0x00, 0x50, 0x01, 0x90, 0x00, 0x00, 0x00, /* '%' */
+  0x00, 0x00, 0xC0, 0x00, 0x30, 0x01, 0x48, 0x01, 0x88, 0x00, 0x40, 0x01, 0x00, 0x00, /* '&' */
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* ''' */
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x01, 0x06, 0x06, 0x00, 0x00, 0x00, 0x00, /* '(' */
+  0x00, 0x00, 0x00, 0x00, 0x06, 0x06, 0xF8, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* ')' */
+  0x00, 0x00, 0x04, 0x00, 0x34, 0x00, 0x0E, 0x00, 0x34, 0x00, 0x04, 0x00, 0x00, 0x00, /* '*' */
+  0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0xFC, 0x01, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, /* '+' */
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x80, 0x03, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, /* ',' */
+  0x00, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x00, 0x00, /* '-' */
+  0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* '.' */
+  0x00, 0x00, 0x00, 0x02, 0x80, 0x01, 0x60, 0x00, 0x18, 0x00, 0x06, 0x00, 0x00, 0x00, /* '/' */
+  0x00, 0x00, 0xFC, 0x00, 0x02, 0x01, 0x02, 0x01, 0x02, 0x01, 0xFC, 0x00, 0x00, 0x00, /* '0' */
+  0x00, 0x00, 0x00, 0x01, 0x02, 0x01, 0xFE, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, /* '1' */
+  0x00, 0x00, 0x84, 0x01, 0x42, 0x01, 0x22, 0x01, 0x12, 0x01, 0x8C, 0x01, 0x00, 0x00, /* '2' */
+  0x00, 0x00, 0x84, 0x00, 0x02, 0x01, 0x12, 0x01, 0x12, 0x01, 0xEC, 0x00, 0x00, 0x00, /* '3' */
+  0x00, 0x00, 0x60, 0x00, 0x50, 0x00, 0x4C, 0x00, 0x42, 0x01, 0xFE, 0x01, 0x40, 0x01, /* '4' */
+  0x00, 0x00, 0x80, 0x00, 0x1E, 0x01, 0x12, 0x01, 0x12, 0x01, 0xE2, 0x00, 0x00, 0x00, /* '5' */
+  0x00, 0x00, 0xF8, 0x00, 0x14, 0x01, 0x12, 0x01, 0x12, 0x01, 0xE2, 0x00, 0x00, 0x00, /* '6' */
+  0x00, 0x00, 0x06, 0x00, 0x02, 0x00, 0x82, 0x01, 0x72, 0x00, 0x0E, 0x00, 0x00, 0x00, /* '7' */
+  0x00, 0x00, 0xEC, 0x00, 0x12, 0x01, 0x12, 0x01, 0x12, 0x01, 0xEC, 0x00, 0x00, 0x00, /* '8' */
+  0x00, 0x00, 0x1C, 0x01, 0x22, 0x01, 0x22, 0x01, 0xA2, 0x00, 0x7C, 0x00, 0x00, 0x00, /* '9' */
+  0x00, 0x00, 0x00, 0x00, 0x98, 0x01, 0x98, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* ':' */
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x98, 0x01, 0x98, 0x00, 0x00, 0x00, 0x00, 0x00, /* ';' */
+  0x20, 0x00, 0x50, 0x00, 0x50, 0x00, 0x88, 0x00, 0x04, 0x01, 0x04, 0x01, 0x00, 0x00, /* '<' */
+  0x00, 0x00, 0x50, 0x00, 0x50, 0x00, 0x50, 0x00, 0x50, 0x00, 0x50, 0x00, 0x00, 0x00, /* '=' */
+  0x04, 0x01, 0x04, 0x01, 0x88, 0x00, 0x50, 0x00, 0x50, 0x00, 0x20, 0x00, 0x00, 0x00, /* '>' */
+  0x00, 0x00, 0x00, 0x00, 0x08, 0x01, 0x44, 0x01, 0x24, 0x00, 0x18, 0x00, 0x00, 0x00, /* '?' */
+  0x00, 0x00, 0xFE, 0x01, 0x01, 0x02, 0x31, 0x02, 0x49, 0x02, 0x7E, 0x01, 0x00, 0x00, /* '@' */
+  0x00, 0x01, 0xC0, 0x01, 0x7A, 0x01, 0x46, 0x00, 0x78, 0x01, 0xC0, 0x01, 0x00, 0x01, /* 'A' */
+  0x02, 0x01, 0xFE, 0x01, 0x12, 0x01, 0x12, 0x01, 0x12, 0x01, 0xEC, 0x00, 0x00, 0x00, /* 'B' */
+  0x00, 0x00, 0xFC, 0x00, 0x02, 0x01, 0x02, 0x01, 0x02, 0x01, 0x86, 0x00, 0x00, 0x00, /* 'C' */
+  0x02, 0x01, 0xFE, 0x01, 0x02, 0x01, 0x02, 0x01, 0x84, 0x00, 0x78, 0x00, 0x00, 0x00, /* 'D' */
+  0x02, 0x01, 0xFE, 0x01, 0x12, 0x01, 0x3A, 0x01, 0x02, 0x01, 0x86, 0x01, 0x00, 0x00, /* 'E' */
+  0x00, 0x00, 0x02, 0x01, 0xFE, 0x01, 0x12, 0x01, 0x3A, 0x00, 0x02, 0x00, 0x06, 0x00, /* 'F' */
+  0x00, 0x00, 0xFC, 0x00, 0x02, 0x01, 0x02, 0x01, 0x22, 0x01, 0xE6, 0x00, 0x20, 0x00, /* 'G' */
+  0x02, 0x01, 0xFE, 0x01, 0x12, 0x01, 0x10, 0x00, 0x12, 0x01, 0xFE, 0x01, 0x02, 0x01, /* 'H' */
+  0x00, 0x00, 0x02, 0x01, 0x02, 0x01, 0xFE, 0x01, 0x02, 0x01, 0x02, 0x01, 0x00, 0x00, /* 'I' */
+  0x00, 0x00, 0xE0, 0x00, 0x02, 0x01, 0x02, 0x01, 0xFE, 0x00, 0x02, 0x00, 0x00, 0x00, /* 'J' */
+  0x02, 0x01, 0xFE, 0x01, 0x22, 0x01, 0x30, 0x00, 0x4A, 0x00, 0x86, 0x01, 0x02, 0x01, /* 'K' */
+  0x00, 0x00, 0x02, 0x01, 0xFE, 0x01, 0x02, 0x01, 0x00, 0x01, 0xC0, 0x01, 0x00, 0x00, /* 'L' */
+  0x02, 0x01, 0xFE, 0x01, 0x0E, 0x01, 0x30, 0x00, 0x0E, 0x01, 0xFE, 0x01, 0x02, 0x01, /* 'M' */
+  0x02, 0x01, 0xFE, 0x01, 0x0E, 0x01, 0x70, 0x00, 0x82, 0x01, 0xFE, 0x01, 0x02, 0x00, /* 'N' */
+  0x00, 0x00, 0xFC, 0x00, 0x02, 0x01, 0x02, 0x01, 0x02, 0x01, 0xFC, 0x00, 0x00, 0x00, /* 'O' */
+  0x00, 0x00, 0x02, 0x01, 0xFE, 0x01, 0x22, 0x01, 0x22, 0x00, 0x1C, 0x00, 0x00, 0x00, /* 'P' */
+  0x00, 0x00, 0xFC, 0x00, 0x02, 0x01, 0x02, 0x03, 0x02, 0x03, 0xFC, 0x02, 0x00, 0x00, /* 'Q' */
+  0x02, 0x01, 0xFE, 0x01, 0x22, 0x01, 0x22, 0x00, 0x62, 0x00, 0x9C, 0x00, 0x00, 0x01, /* 'R' */
+  0x00, 0x00, 0x8C, 0x01, 0x92, 0x00, 0x12, 0x01, 0x14, 0x01, 0xE6, 0x00, 0x00, 0x00, /* 'S' */
+  0x06, 0x00, 0x02, 0x00, 0x02, 0x01, 0xFE, 0x01, 0x02, 0x01, 0x02, 0x00, 0x06, 0x00, /* 'T' */
+  0x02, 0x00, 0xFE, 0x00, 0x02, 0x01, 0x00, 0x01, 0x02, 0x01, 0xFE, 0x00, 0x02, 0x00, /* 'U' */
+  0x02, 0x00, 0x0E, 0x00, 0x72, 0x00, 0x80, 0x01, 0x72, 0x00, 0x0E, 0x00, 0x02, 0x00, /* 'V' */
+  0x02, 0x00, 0xFE, 0x00, 0x02, 0x01, 0xF0, 0x00, 0x02, 0x01, 0xFE, 0x00, 0x02, 0x00, /* 'W' */
+  0x02, 0x01, 0x86, 0x01, 0x48, 0x00, 0x30, 0x00, 0x48, 0x00, 0x86, 0x01, 0x02, 0x01, /* 'X' */
+  0x02, 0x00, 0x06, 0x00, 0x1A, 0x01, 0xE0, 0x01, 0x1A, 0x01, 0x06, 0x00, 0x02, 0x00, /* 'Y' */
+  0x00, 0x00, 0x86, 0x01, 0x42, 0x01, 0x32, 0x01, 0x0A, 0x01, 0x86, 0x01, 0x00, 0x00, /* 'Z' */
+  0x00, 0x00, 0x00, 0x00, 0xFE, 0x07, 0x02, 0x04, 0x02, 0x04, 0x00, 0x00, 0x00, 0x00, /* '[' */
+  0x00, 0x00, 0x02, 0x00, 0x1C, 0x00, 0x60, 0x00, 0x80, 0x03, 0x00, 0x00, 0x00, 0x00, /* '\' */
+  0x00, 0x00, 0x00, 0x00, 0x02, 0x04, 0x02, 0x04, 0xFE, 0x07, 0x00, 0x00, 0x00, 0x00, /* ']' */
+  0x00, 0x00, 0x10, 0x00, 0x08, 0x00, 0x06, 0x00, 0x08, 0x00, 0x10, 0x00, 0x00, 0x00, /* '^' */
+  0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08, /* '_' */
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, /* '`' */
+  0x00, 0x00, 0xD0, 0x00, 0x28, 0x01, 0x28, 0x01, 0x28, 0x01, 0xF0, 0x01, 0x00, 0x01, /* 'a' */
+  0x02, 0x01, 0xFE, 0x01, 0x10, 0x01, 0x08, 0x01, 0x08, 0x01, 0xF0, 0x00, 0x00, 0x00, /* 'b' */
+  0x00, 0x00, 0xF0, 0x00, 0x08, 0x01, 0x08, 0x01, 0x08, 0x01, 0x98, 0x00, 0x00, 0x00, /* 'c' */
+  0x00, 0x00, 0xF0, 0x00, 0x08, 0x01, 0x08, 0x01, 0x12, 0x01, 0xFE, 0x01, 0x00, 0x01, /* 'd' */
+  0x00, 0x00, 0xF0, 0x00, 0x28, 0x01, 0x28, 0x01, 0x28, 0x01, 0x30, 0x01, 0x00, 0x00, /* 'e' */
+  0x00, 0x00, 0x08, 0x01, 0xFC, 0x01, 0x0A, 0x01, 0x0A, 0x01, 0x0A, 0x01, 0x00, 0x00, /* 'f' */
+  0x00, 0x00, 0xF0, 0x00, 0x08, 0x05, 0x08, 0x05, 0x10, 0x05, 0xF8, 0x03, 0x08, 0x00, /* 'g' */
+  0x02, 0x01, 0xFE, 0x01, 0x10, 0x01, 0x08, 0x00, 0x08, 0x01, 0xF0, 0x01, 0x00, 0x01, /* 'h' */
+  0x00, 0x00, 0x08, 0x01, 0x08, 0x01, 0xFA, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, /* 'i' */
+  0x00, 0x00, 0x08, 0x04, 0x08, 0x04, 0x0A, 0x04, 0xF8, 0x03, 0x00, 0x00, 0x00, 0x00, /* 'j' */
+  0x02, 0x01, 0xFE, 0x01, 0x20, 0x00, 0x68, 0x01, 0x98, 0x01, 0x08, 0x01, 0x00, 0x00, /* 'k' */
+  0x00, 0x00, 0x00, 0x01, 0x02, 0x01, 0xFE, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, /* 'l' */
+  0x08, 0x01, 0xF8, 0x01, 0x08, 0x01, 0xF0, 0x01, 0x08, 0x01, 0xF0, 0x01, 0x00, 0x01, /* 'm' */
+  0x08, 0x01, 0xF8, 0x01, 0x10, 0x01, 0x08, 0x00, 0x08, 0x01, 0xF0, 0x01, 0x00, 0x01, /* 'n' */
+  0x00, 0x00, 0xF0, 0x00, 0x08, 0x01, 0x08, 0x01, 0x08, 0x01, 0xF0, 0x00, 0x00, 0x00, /* 'o' */
+  0x08, 0x04, 0xF8, 0x07, 0x10, 0x05, 0x08, 0x01, 0x08, 0x01, 0xF0, 0x00, 0x00, 0x00, /* 'p' */
+  0x00, 0x00, 0xF0, 0x00, 0x08, 0x01, 0x08, 0x01, 0x10, 0x05, 0xF8, 0x07, 0x08, 0x04, /* 'q' */
+  0x00, 0x00, 0x08, 0x01, 0xF8, 0x01, 0x10, 0x01, 0x08, 0x01, 0x08, 0x01, 0x00, 0x00, /* 'r' */
+  0x00, 0x00, 0x90, 0x01, 0x28, 0x01, 0x28, 0x01, 0x28, 0x01, 0xD8, 0x00, 0x00, 0x00, /* 's' */
+  0x00, 0x00, 0x08, 0x00, 0xFC, 0x00, 0x08, 0x01, 0x08, 0x01, 0x08, 0x01, 0x80, 0x00, /* 't' */
+  0x08, 0x00, 0xF8, 0x00, 0x00, 0x01, 0x00, 0x01, 0x88, 0x00, 0xF8, 0x01, 0x00, 0x01, /* 'u' */
+  0x08, 0x00, 0x38, 0x00, 0xC8, 0x00, 0x00, 0x01, 0xC8, 0x00, 0x38, 0x00, 0x08, 0x00, /* 'v' */
+  0x08, 0x00, 0xF8, 0x00, 0x08, 0x01, 0xE0, 0x00, 0x08, 0x01, 0xF8, 0x00, 0x08, 0x00, /* 'w' */
+  0x08, 0x01, 0x98, 0x01, 0x60, 0x00, 0x60, 0x00, 0x98, 0x01, 0x08, 0x01, 0x00, 0x00, /* 'x' */
+  0x08, 0x00, 0x18, 0x04, 0x68, 0x04, 0x80, 0x07, 0xC8, 0x04, 0x38, 0x00, 0x08, 0x00, /* 'y' */
+  0x00, 0x00, 0x98, 0x01, 0x48, 0x01, 0x28, 0x01, 0x18, 0x01, 0x88, 0x01, 0x00, 0x00, /* 'z' */
+  0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0xBC, 0x03, 0x02, 0x04, 0x00, 0x00, 0x00, 0x00, /* '{' */
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFE, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* '|' */
+  0x00, 0x00, 0x00, 0x00, 0x02, 0x04, 0xBC, 0x03, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, /* '}' */
+  0x00, 0x00, 0x40, 0x00, 0x20, 0x00, 0x40, 0x00, 0x40, 0x00, 0x20, 0x00, 0x00, 0x00, /* '~' */
+};
+
+/* Exported variables --------------------------------------------------------*/
+const Lcd_Text_Font_t Lcd_Font12 = { Lcd_Font12_Columns, 7, 12 };
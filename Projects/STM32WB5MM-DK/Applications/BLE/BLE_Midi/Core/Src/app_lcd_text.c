@@ -0,0 +1,270 @@
+/**
+  ******************************************************************************
+  * @file    app_lcd_text.c
+  * @author  MCD Application Team
+  * @brief   Text fast path of the SSD1315, the glyphs are copied a column at
+  *          a time into the frame buffer
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+#include "stm32_seq.h"
+#include "app_led.h"
+#include "app_lcd_text.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define LCD_TEXT_FIRST_CHAR             (' ')
+#define LCD_TEXT_LAST_CHAR              ('~')
+
+/* Private variables ---------------------------------------------------------*/
+/* Frame buffer of the SSD1315 driver : pages of 8 rows, a byte per column, least significant bit on top */
+extern uint8_t PhysFrameBuffer[];
+
+/* Frame buffer changed since the last refresh */
+static volatile uint8_t Lcd_Text_Refresh_Pending;
+
+/* Private function prototypes -----------------------------------------------*/
+static const Lcd_Text_Font_t *Lcd_Text_Font(uint32_t *pInvert);
+static void Lcd_Text_Blit_Column(uint32_t Xpos, uint32_t Ypos, uint32_t Column, uint32_t Mask);
+static void Lcd_Text_Draw_Char(const Lcd_Text_Font_t *pFont, uint32_t Xpos, uint32_t Ypos, uint8_t Ascii, uint32_t Invert);
+static void Lcd_Text_Refresh_Task(void);
+
+/* Functions Definition ------------------------------------------------------*/
+/*
+ * @brief Register the refresh task
+ */
+void LCD_TEXT_Init(void)
+{
+  UTIL_SEQ_RegTask(1<<CFG_TASK_LCD_REFRESH, UTIL_SEQ_RFU, Lcd_Text_Refresh_Task);
+
+  return;
+}
+
+/*
+ * @brief Same layout as UTIL_LCD_DisplayStringAt(), falls back to it when the
+ *        current font or colors have no fast path
+ */
+void LCD_TEXT_DisplayStringAt(uint32_t Xpos, uint32_t Ypos, const uint8_t *pText, Text_AlignModeTypdef Mode)
+{
+  const Lcd_Text_Font_t *pFont;
+  uint32_t invert;
+  uint32_t refcolumn, i = 0;
+  uint32_t size = 0, xsize;
+  const uint8_t *ptr = pText;
+
+  pFont = Lcd_Text_Font(&invert);
+  if (pFont == NULL)
+  {
+    UTIL_LCD_DisplayStringAt(Xpos, Ypos, (uint8_t *)pText, Mode);
+    return;
+  }
+
+  while (*ptr++ != 0U)
+  {
+    size++;
+  }
+
+  /* Characters number per line */
+  xsize = SSD1315_LCD_PIXEL_WIDTH / pFont->Width;
+
+  switch (Mode)
+  {
+    case CENTER_MODE:
+      refcolumn = Xpos + ((xsize - size) * pFont->Width) / 2U;
+      break;
+
+    case RIGHT_MODE:
+      refcolumn = - Xpos + ((xsize - size) * pFont->Width);
+      break;
+
+    case LEFT_MODE:
+    default:
+      refcolumn = Xpos;
+      break;
+  }
+
+  /* Check that the start column is located in the screen */
+  if ((refcolumn < 1U) || (refcolumn >= 0x8000U))
+  {
+    refcolumn = 1;
+  }
+
+  while ((*pText != 0U) && (((SSD1315_LCD_PIXEL_WIDTH - (i * pFont->Width)) & 0xFFFFU) >= pFont->Width))
+  {
+    Lcd_Text_Draw_Char(pFont, refcolumn, Ypos, *pText, invert);
+    refcolumn += pFont->Width;
+    pText++;
+    i++;
+  }
+
+  return;
+}
+
+/*
+ * @brief Left aligned text on a line of the current font
+ */
+void LCD_TEXT_DisplayStringAtLine(uint32_t Line, const uint8_t *pText)
+{
+  LCD_TEXT_DisplayStringAt(0, LINE(Line), pText, LEFT_MODE);
+
+  return;
+}
+
+/*
+ * @brief Fills a line of the current font with the background color
+ */
+void LCD_TEXT_ClearStringLine(uint32_t Line)
+{
+  const Lcd_Text_Font_t *pFont;
+  uint32_t invert;
+  uint32_t x, mask;
+
+  pFont = Lcd_Text_Font(&invert);
+  if (pFont == NULL)
+  {
+    UTIL_LCD_ClearStringLine(Line);
+    return;
+  }
+
+  mask = (1UL << pFont->Height) - 1U;
+  for (x = 0; x < SSD1315_LCD_PIXEL_WIDTH; x++)
+  {
+    Lcd_Text_Blit_Column(x, Line * pFont->Height, invert, mask);
+  }
+
+  return;
+}
+
+/*
+ * @brief Send the frame buffer to the screen from the refresh task
+ * @note  Can be called from interrupt context. What is drawn until the task runs is sent
+ *        with the same refresh.
+ */
+void LCD_TEXT_Refresh(void)
+{
+  Lcd_Text_Refresh_Pending = 1;
+  UTIL_SEQ_SetTask(1<<CFG_TASK_LCD_REFRESH, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Send the frame buffer to the screen
+ * @note  The MOSI of the LCD is the SDI of the RGB LED : while a LED frame is played the refresh
+ *        waits, the end of the frame sets the task again
+ */
+static void Lcd_Text_Refresh_Task(void)
+{
+  if((Lcd_Text_Refresh_Pending == 0U) || (LED_PWM_Busy() != 0U))
+  {
+    return;
+  }
+  Lcd_Text_Refresh_Pending = 0;
+  BSP_LCD_Refresh(0);
+
+  return;
+}
+
+/*
+ * @brief Converted font of the current UTIL_LCD font, NULL when there is none or when
+ *        the colors are not black and white. pInvert is set for black text on white.
+ */
+static const Lcd_Text_Font_t *Lcd_Text_Font(uint32_t *pInvert)
+{
+  const Lcd_Text_Font_t *pFont = NULL;
+  uint32_t text_color = UTIL_LCD_GetTextColor();
+  uint32_t back_color = UTIL_LCD_GetBackColor();
+
+  if ((text_color == SSD1315_COLOR_WHITE) && (back_color == SSD1315_COLOR_BLACK))
+  {
+    *pInvert = 0;
+  }
+  else if ((text_color == SSD1315_COLOR_BLACK) && (back_color == SSD1315_COLOR_WHITE))
+  {
+    *pInvert = 0xFFFFFFFFU;
+  }
+  else
+  {
+    return NULL;
+  }
+
+  if (UTIL_LCD_GetFont() == &Font12)
+  {
+    pFont = &Lcd_Font12;
+  }
+
+  return pFont;
+}
+
+/*
+ * @brief Writes the bits of Mask of a column, bit 0 on row Ypos. A column spans at most
+ *        4 pages, each page is a read-modify-write of one byte.
+ */
+static void Lcd_Text_Blit_Column(uint32_t Xpos, uint32_t Ypos, uint32_t Column, uint32_t Mask)
+{
+  uint8_t *pDst;
+  uint32_t page = Ypos / 8U;
+  uint32_t shift = Ypos % 8U;
+
+  if (Xpos >= SSD1315_LCD_PIXEL_WIDTH)
+  {
+    return;
+  }
+
+  pDst = &PhysFrameBuffer[Xpos + page * SSD1315_LCD_PIXEL_WIDTH];
+  Column = (Column & Mask) << shift;
+  Mask <<= shift;
+
+  while ((Mask != 0U) && (page < SSD1315_LCD_PAGE_NUMBER))
+  {
+    *pDst = (uint8_t)((*pDst & ~Mask) | Column);
+    pDst += SSD1315_LCD_PIXEL_WIDTH;
+    Column >>= 8;
+    Mask >>= 8;
+    page++;
+  }
+
+  return;
+}
+
+/*
+ * @brief Draws a character, text and background pixels
+ */
+static void Lcd_Text_Draw_Char(const Lcd_Text_Font_t *pFont, uint32_t Xpos, uint32_t Ypos, uint8_t Ascii, uint32_t Invert)
+{
+  const uint8_t *pColumn;
+  uint32_t column_bytes = (pFont->Height + 7U) / 8U;
+  uint32_t mask = (1UL << pFont->Height) - 1U;
+  uint32_t column;
+  uint32_t j, k;
+
+  if ((Ascii < LCD_TEXT_FIRST_CHAR) || (Ascii > LCD_TEXT_LAST_CHAR))
+  {
+    Ascii = LCD_TEXT_FIRST_CHAR;
+  }
+  pColumn = &pFont->pColumns[(Ascii - LCD_TEXT_FIRST_CHAR) * pFont->Width * column_bytes];
+
+  for (j = 0; j < pFont->Width; j++)
+  {
+    column = 0;
+    for (k = 0; k < column_bytes; k++)
+    {
+      column |= (uint32_t)(*pColumn++) << (8U * k);
+    }
+    Lcd_Text_Blit_Column(Xpos + j, Ypos, column ^ Invert, mask);
+  }
+
+  return;
+}
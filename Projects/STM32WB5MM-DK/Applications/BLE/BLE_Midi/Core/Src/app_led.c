@@ -0,0 +1,436 @@
+/**
+  ******************************************************************************
+  * @file    app_led.c
+  * @author  MCD Application Team
+  * @brief   RGB LED driven by TIM17 and DMA, the grayscale frame is encoded
+  *          in a buffer of pulses played by the timer
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+#include "stm32_seq.h"
+#include "stm32_lpm.h"
+#include "stm32wb5mm_dk_bus.h"
+#include "app_led.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define LED_PWM_WRITE_COMMAND           (0x3AU)
+
+/* Timer counting microseconds */
+#define LED_PWM_SLOT_TICKS              (LED_PWM_SLOT_US * PWM_LED_TIM_COUNTER_FREQ / 1000000U)
+#define LED_PWM_PULSE_TICKS             (LED_PWM_PULSE_US * PWM_LED_TIM_COUNTER_FREQ / 1000000U)
+
+/*
+ * A first slot low while the first compare value is loaded, the cycle measured by the driver,
+ * the write command, the grayscale data, then the end of sequence
+ */
+#define LED_PWM_FRAME_SLOTS             (1U + ((1U + 8U + (8U * PWM_LED_NB)) * LED_PWM_SLOTS_PER_BIT) \
+                                         + (LED_PWM_EOS_CYCLES * LED_PWM_SLOTS_PER_BIT))
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  TIM_HandleTypeDef     Tim;
+  DMA_HandleTypeDef     Dma;
+  uint8_t               Slots[LED_PWM_FRAME_SLOTS];     /*!< Compare value of each slot, read by the DMA */
+  aPwmLedGsData_TypeDef Wanted;                         /*!< Grayscale data to show */
+  aPwmLedGsData_TypeDef Shown;                          /*!< Grayscale data of the last frame sent */
+  volatile uint8_t      Busy;                           /*!< Frame being played */
+  volatile uint8_t      Flash_End;                      /*!< Note flash over, switch the LED off */
+  aPwmLedGsData_TypeDef Note;                           /*!< Grayscale data of the next note flash */
+  uint32_t              Note_Time;                      /*!< Render time of the next note flash, HAL_GetTick() base in ms */
+  volatile uint8_t      Note_Pending;                   /*!< Note flash waiting for its render time */
+  volatile uint8_t      Note_Due;                       /*!< Note flash to start */
+  uint8_t               Flash_Timer_Id;
+  uint8_t               Note_Timer_Id;
+} Led_Pwm_Context_t;
+
+/* Private variables ---------------------------------------------------------*/
+static Led_Pwm_Context_t Led_Pwm_Context;
+
+/* Color of each midi channel, full scale */
+static const uint8_t Led_Note_Colors[16][PWM_LED_NB] =
+{
+  {255,   0,   0}, {255, 128,   0}, {255, 255,   0}, {128, 255,   0},
+  {  0, 255,   0}, {  0, 255, 128}, {  0, 255, 255}, {  0, 128, 255},
+  {  0,   0, 255}, {128,   0, 255}, {255,   0, 255}, {255,   0, 128},
+  {255, 255, 255}, {255, 128, 128}, {128, 255, 128}, {128, 128, 255},
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void Led_Pwm_Show(aPwmLedGsData_TypeDef aPwmLedGsData);
+static uint8_t *Led_Pwm_Encode_Bit(uint8_t *pSlot, uint8_t Bit);
+static uint8_t *Led_Pwm_Encode_Byte(uint8_t *pSlot, uint8_t Byte);
+static void Led_Pwm_Encode_Frame(void);
+static void Led_Pwm_Start(void);
+static void Led_Pwm_Release_Pin(void);
+static void Led_Pwm_Dma_Cplt(DMA_HandleTypeDef *hdma);
+static void Led_Pwm_Flash_Timer_Cb(void);
+static void Led_Pwm_Note_Timer_Cb(void);
+static void Led_Pwm_Task(void);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Configure TIM17 channel 1 and its DMA, switch the LED off
+ * @note  The SDI pin is the MOSI of the LCD : it is given to the timer only while a frame is played
+ */
+void LED_PWM_Init(void)
+{
+  GPIO_InitTypeDef gpio_config = {0};
+  TIM_OC_InitTypeDef oc_config = {0};
+
+  PWM_LED_SELECT_GPIO_CLK_ENABLE();
+  gpio_config.Pin       = PWM_LED_SELECT_GPIO_PIN;
+  gpio_config.Mode      = GPIO_MODE_OUTPUT_PP;
+  gpio_config.Pull      = GPIO_PULLDOWN;
+  HAL_GPIO_Init(PWM_LED_SELECT_GPIO_PORT, &gpio_config);
+  HAL_GPIO_WritePin(PWM_LED_SELECT_GPIO_PORT, PWM_LED_SELECT_GPIO_PIN, GPIO_PIN_RESET);
+
+  PWM_LED_TIM_CLOCK_ENABLE();
+  Led_Pwm_Context.Tim.Instance = PWM_LED_TIM;
+  Led_Pwm_Context.Tim.Init.Prescaler = (PWM_LED_TIM_GET_COUNTER_CLK_FREQ() / PWM_LED_TIM_COUNTER_FREQ) - 1U;
+  Led_Pwm_Context.Tim.Init.CounterMode = TIM_COUNTERMODE_UP;
+  Led_Pwm_Context.Tim.Init.Period = LED_PWM_SLOT_TICKS - 1U;
+  Led_Pwm_Context.Tim.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  Led_Pwm_Context.Tim.Init.RepetitionCounter = 0;
+  Led_Pwm_Context.Tim.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+  HAL_TIM_PWM_Init(&Led_Pwm_Context.Tim);
+
+  oc_config.OCMode = TIM_OCMODE_PWM1;
+  oc_config.Pulse = 0;
+  oc_config.OCPolarity = TIM_OCPOLARITY_HIGH;
+  oc_config.OCIdleState = TIM_OCIDLESTATE_RESET;
+  oc_config.OCFastMode = TIM_OCFAST_DISABLE;
+  HAL_TIM_PWM_ConfigChannel(&Led_Pwm_Context.Tim, &oc_config, TIM_CHANNEL_1);
+
+  /* A byte of the buffer per slot, written in the 16 bits compare register */
+  __HAL_RCC_DMAMUX1_CLK_ENABLE();
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  Led_Pwm_Context.Dma.Instance = LED_PWM_DMA_CHANNEL;
+  Led_Pwm_Context.Dma.Init.Request = DMA_REQUEST_TIM17_UP;
+  Led_Pwm_Context.Dma.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  Led_Pwm_Context.Dma.Init.PeriphInc = DMA_PINC_DISABLE;
+  Led_Pwm_Context.Dma.Init.MemInc = DMA_MINC_ENABLE;
+  Led_Pwm_Context.Dma.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+  Led_Pwm_Context.Dma.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+  Led_Pwm_Context.Dma.Init.Mode = DMA_NORMAL;
+  Led_Pwm_Context.Dma.Init.Priority = DMA_PRIORITY_HIGH;
+  HAL_DMA_Init(&Led_Pwm_Context.Dma);
+  Led_Pwm_Context.Dma.XferCpltCallback = Led_Pwm_Dma_Cplt;
+  Led_Pwm_Context.Dma.XferErrorCallback = Led_Pwm_Dma_Cplt;
+
+  HAL_NVIC_SetPriority(LED_PWM_DMA_IRQn, LED_PWM_DMA_IT_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(LED_PWM_DMA_IRQn);
+
+  UTIL_SEQ_RegTask(1<<CFG_TASK_LED, UTIL_SEQ_RFU, Led_Pwm_Task);
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+        &Led_Pwm_Context.Flash_Timer_Id,
+        hw_ts_SingleShot,
+        Led_Pwm_Flash_Timer_Cb);
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+        &Led_Pwm_Context.Note_Timer_Id,
+        hw_ts_SingleShot,
+        Led_Pwm_Note_Timer_Cb);
+
+  /* State of the driver unknown : a first frame is sent */
+  memset(Led_Pwm_Context.Wanted, PWM_LED_GSDATA_OFF, sizeof(Led_Pwm_Context.Wanted));
+  memset(Led_Pwm_Context.Shown, 0xFF, sizeof(Led_Pwm_Context.Shown));
+  UTIL_SEQ_SetTask(1<<CFG_TASK_LED, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Grayscale data to show, sent by the LED task
+ * @note  Task context. A frame being played is not interrupted, the last data wins.
+ */
+void LED_PWM_Set(aPwmLedGsData_TypeDef aPwmLedGsData)
+{
+  HW_TS_Stop(Led_Pwm_Context.Note_Timer_Id);
+  HW_TS_Stop(Led_Pwm_Context.Flash_Timer_Id);
+  Led_Pwm_Context.Note_Pending = 0;
+  Led_Pwm_Context.Note_Due = 0;
+  Led_Pwm_Show(aPwmLedGsData);
+
+  return;
+}
+
+/*
+ * @brief Flash the LED in the color of the channel, as bright as the velocity, when the note
+ *        is rendered by the centrals
+ * @note  Task context. One flash waits for its render time : a note rendered later is dropped,
+ *        it would fall in the flash of the waiting one, a note at the same time replaces it.
+ *
+ * @param Channel       midi channel
+ * @param Velocity      note velocity
+ * @param Timestamp     render time in milliseconds (HAL_GetTick base)
+ */
+void LED_PWM_Note(uint8_t Channel, uint8_t Velocity, uint32_t Timestamp)
+{
+  int32_t delay_ms = (int32_t)(Timestamp - HAL_GetTick());
+  uint8_t i;
+
+  if(Led_Pwm_Context.Note_Pending && ((int32_t)(Timestamp - Led_Pwm_Context.Note_Time) > 0))
+  {
+    return;
+  }
+
+  HW_TS_Stop(Led_Pwm_Context.Note_Timer_Id);
+  for(i = 0; i < PWM_LED_NB; i++)
+  {
+    Led_Pwm_Context.Note[i] = (PwmLedGsData_TypeDef)(((uint32_t)Led_Note_Colors[Channel & 0x0F][i] * (Velocity & 0x7F) * LED_NOTE_MAX_GSDATA)
+                                                     / (255U * 127U));
+  }
+  Led_Pwm_Context.Note_Time = Timestamp;
+
+  if(delay_ms > 0)
+  {
+    Led_Pwm_Context.Note_Pending = 1;
+    HW_TS_Start(Led_Pwm_Context.Note_Timer_Id, ((uint32_t)delay_ms * 1000U) / CFG_TS_TICK_VAL);
+  }
+  else
+  {
+    Led_Pwm_Context.Note_Pending = 0;
+    Led_Pwm_Context.Note_Due = 1;
+    UTIL_SEQ_SetTask(1<<CFG_TASK_LED, CFG_SCH_PRIO_1);
+  }
+
+  return;
+}
+
+/*
+ * @brief A frame is being played, the SDI pin is not available for the LCD
+ */
+uint8_t LED_PWM_Busy(void)
+{
+  return Led_Pwm_Context.Busy;
+}
+
+/*
+ * @brief DMA interrupt of the frame
+ */
+void LED_PWM_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&Led_Pwm_Context.Dma);
+
+  return;
+}
+
+/*
+ * @brief Data for the LED task, a flash ending before it is sent does not switch it off
+ */
+static void Led_Pwm_Show(aPwmLedGsData_TypeDef aPwmLedGsData)
+{
+  Led_Pwm_Context.Flash_End = 0;
+  memcpy(Led_Pwm_Context.Wanted, aPwmLedGsData, sizeof(Led_Pwm_Context.Wanted));
+  UTIL_SEQ_SetTask(1<<CFG_TASK_LED, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Slots of a bit : a pulse starts the cycle, a second one in the next slot is a 1
+ */
+static uint8_t *Led_Pwm_Encode_Bit(uint8_t *pSlot, uint8_t Bit)
+{
+  uint8_t i;
+
+  *pSlot++ = LED_PWM_PULSE_TICKS;
+  *pSlot++ = (Bit != 0U) ? LED_PWM_PULSE_TICKS : 0U;
+  for(i = 2; i < LED_PWM_SLOTS_PER_BIT; i++)
+  {
+    *pSlot++ = 0;
+  }
+
+  return pSlot;
+}
+
+/*
+ * @brief Slots of a byte, most significant bit first
+ */
+static uint8_t *Led_Pwm_Encode_Byte(uint8_t *pSlot, uint8_t Byte)
+{
+  uint8_t mask;
+
+  for(mask = 0x80; mask != 0U; mask >>= 1)
+  {
+    pSlot = Led_Pwm_Encode_Bit(pSlot, Byte & mask);
+  }
+
+  return pSlot;
+}
+
+/*
+ * @brief Slots of the frame showing the grayscale data of Shown
+ */
+static void Led_Pwm_Encode_Frame(void)
+{
+  uint8_t *pSlot = Led_Pwm_Context.Slots;
+  uint8_t i;
+
+  *pSlot++ = 0;
+  /* Cycle measurement : two rising edges one cycle apart, the second starts the command */
+  pSlot = Led_Pwm_Encode_Bit(pSlot, 0);
+  pSlot = Led_Pwm_Encode_Byte(pSlot, LED_PWM_WRITE_COMMAND);
+  for(i = 0; i < PWM_LED_NB; i++)
+  {
+    pSlot = Led_Pwm_Encode_Byte(pSlot, Led_Pwm_Context.Shown[i]);
+  }
+  memset(pSlot, 0, &Led_Pwm_Context.Slots[LED_PWM_FRAME_SLOTS] - pSlot);
+
+  return;
+}
+
+/*
+ * @brief Give the SDI pin to the timer and play the frame, the DMA writes the compare value
+ *        of the next slot at each update
+ */
+static void Led_Pwm_Start(void)
+{
+  GPIO_InitTypeDef gpio_config = {0};
+
+  Led_Pwm_Context.Busy = 1;
+  UTIL_LPM_SetStopMode(1 << CFG_LPM_APP_LED, UTIL_LPM_DISABLE);
+
+  gpio_config.Pin       = PWM_LED_SDI_GPIO_PIN;
+  gpio_config.Mode      = GPIO_MODE_AF_PP;
+  gpio_config.Pull      = GPIO_PULLDOWN;
+  gpio_config.Speed     = GPIO_SPEED_FREQ_LOW;
+  gpio_config.Alternate = GPIO_AF14_TIM17;
+  HAL_GPIO_Init(PWM_LED_SDI_GPIO_PORT, &gpio_config);
+
+  /* Enable Grayscale (GS) Control */
+  HAL_GPIO_WritePin(PWM_LED_SELECT_GPIO_PORT, PWM_LED_SELECT_GPIO_PIN, GPIO_PIN_SET);
+
+  __HAL_TIM_SET_COMPARE(&Led_Pwm_Context.Tim, TIM_CHANNEL_1, 0);
+  __HAL_TIM_SET_COUNTER(&Led_Pwm_Context.Tim, 0);
+  HAL_DMA_Start_IT(&Led_Pwm_Context.Dma,
+                   (uint32_t)Led_Pwm_Context.Slots,
+                   (uint32_t)&Led_Pwm_Context.Tim.Instance->CCR1,
+                   LED_PWM_FRAME_SLOTS);
+  __HAL_TIM_ENABLE_DMA(&Led_Pwm_Context.Tim, TIM_DMA_UPDATE);
+  HAL_TIM_PWM_Start(&Led_Pwm_Context.Tim, TIM_CHANNEL_1);
+
+  return;
+}
+
+/*
+ * @brief Give the SDI pin back to the SPI of the LCD
+ */
+static void Led_Pwm_Release_Pin(void)
+{
+  GPIO_InitTypeDef gpio_config = {0};
+
+  gpio_config.Pin       = BUS_SPI1_MOSI_PIN;
+  gpio_config.Mode      = GPIO_MODE_AF_PP;
+  gpio_config.Pull      = GPIO_PULLDOWN;
+  gpio_config.Speed     = GPIO_SPEED_FREQ_LOW;
+  gpio_config.Alternate = BUS_SPI1_AF;
+  HAL_GPIO_Init(BUS_SPI1_GPIO_PORTA, &gpio_config);
+
+  return;
+}
+
+/*
+ * @brief Last compare value written : only end of sequence slots are left, the frame is over
+ * @note  Called under the DMA interrupt
+ */
+static void Led_Pwm_Dma_Cplt(DMA_HandleTypeDef *hdma)
+{
+  UNUSED(hdma);
+
+  __HAL_TIM_DISABLE_DMA(&Led_Pwm_Context.Tim, TIM_DMA_UPDATE);
+  HAL_TIM_PWM_Stop(&Led_Pwm_Context.Tim, TIM_CHANNEL_1);
+
+  /* Disable Grayscale (GS) Control */
+  HAL_GPIO_WritePin(PWM_LED_SELECT_GPIO_PORT, PWM_LED_SELECT_GPIO_PIN, GPIO_PIN_RESET);
+  Led_Pwm_Release_Pin();
+
+  Led_Pwm_Context.Busy = 0;
+  UTIL_LPM_SetStopMode(1 << CFG_LPM_APP_LED, UTIL_LPM_ENABLE);
+
+  /* Data changed while the frame was played */
+  if((Led_Pwm_Context.Flash_End != 0)
+  || (memcmp(Led_Pwm_Context.Wanted, Led_Pwm_Context.Shown, sizeof(Led_Pwm_Context.Shown)) != 0))
+  {
+    UTIL_SEQ_SetTask(1<<CFG_TASK_LED, CFG_SCH_PRIO_1);
+  }
+
+  /* A screen refresh waiting for the SDI pin */
+  UTIL_SEQ_SetTask(1<<CFG_TASK_LCD_REFRESH, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Render time of the note flash
+ * @note  Called under the timer server interrupt
+ */
+static void Led_Pwm_Note_Timer_Cb(void)
+{
+  Led_Pwm_Context.Note_Pending = 0;
+  Led_Pwm_Context.Note_Due = 1;
+  UTIL_SEQ_SetTask(1<<CFG_TASK_LED, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief End of the note flash
+ * @note  Called under the timer server interrupt
+ */
+static void Led_Pwm_Flash_Timer_Cb(void)
+{
+  Led_Pwm_Context.Flash_End = 1;
+  UTIL_SEQ_SetTask(1<<CFG_TASK_LED, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Start the note flash due, send a frame when the data to show changed and no frame
+ *        is being played
+ */
+static void Led_Pwm_Task(void)
+{
+  if(Led_Pwm_Context.Note_Due != 0)
+  {
+    Led_Pwm_Context.Note_Due = 0;
+    Led_Pwm_Show(Led_Pwm_Context.Note);
+    HW_TS_Start(Led_Pwm_Context.Flash_Timer_Id, LED_NOTE_FLASH_DURATION);
+  }
+
+  if(Led_Pwm_Context.Busy != 0)
+  {
+    /* Rescheduled at the end of the frame */
+    return;
+  }
+
+  if(Led_Pwm_Context.Flash_End != 0)
+  {
+    Led_Pwm_Context.Flash_End = 0;
+    memset(Led_Pwm_Context.Wanted, PWM_LED_GSDATA_OFF, sizeof(Led_Pwm_Context.Wanted));
+  }
+
+  if(memcmp(Led_Pwm_Context.Wanted, Led_Pwm_Context.Shown, sizeof(Led_Pwm_Context.Shown)) != 0)
+  {
+    memcpy(Led_Pwm_Context.Shown, Led_Pwm_Context.Wanted, sizeof(Led_Pwm_Context.Shown));
+    Led_Pwm_Encode_Frame();
+    Led_Pwm_Start();
+  }
+
+  return;
+}
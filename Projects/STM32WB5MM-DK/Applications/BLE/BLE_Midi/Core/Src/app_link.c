@@ -0,0 +1,356 @@
+/**
+  ******************************************************************************
+  * @file    app_link.c
+  * @author  MCD Application Team
+  * @brief   Per connection PHY, data length and ATT_MTU negotiation and
+  *          throughput counters
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+#include "dbg_trace.h"
+#include "ble.h"
+#include "stm32_seq.h"
+#include "app_link.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  Link_Info_t           Info;
+  uint32_t              Last_Tx_Bytes;          /*!< Tx_Bytes at the previous computation */
+  uint32_t              Last_Tx_Notifications;  /*!< Tx_Notifications at the previous computation */
+} Link_Context_t;
+
+typedef struct
+{
+  uint8_t               Stats_Timer_Id;         /*!< Throughput computation timer id */
+  uint8_t               Connected;              /*!< Number of links in use */
+  Link_Context_t        Links[CFG_BLE_NUM_LINK];
+} Link_App_Context_t;
+
+/* Private defines -----------------------------------------------------------*/
+#define LINK_NO_HANDLE                  (0xFFFFU)
+
+/* Private variables ---------------------------------------------------------*/
+static Link_App_Context_t Link_App_Context;
+
+/* Private function prototypes -----------------------------------------------*/
+static Link_Context_t * Find_Link(uint16_t Handle);
+static void             Link_Stats_cb(void);
+static void             Link_Stats_Task(void);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Initialize the links table and the throughput computation
+ */
+void LINK_Init(void)
+{
+  uint8_t i;
+
+  for(i = 0; i < CFG_BLE_NUM_LINK; i++)
+  {
+    Link_App_Context.Links[i].Info.Handle = LINK_NO_HANDLE;
+  }
+
+  UTIL_SEQ_RegTask(1<<CFG_TASK_LINK_STATS, UTIL_SEQ_RFU, Link_Stats_Task);
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+        &Link_App_Context.Stats_Timer_Id,
+        hw_ts_Repeated,
+        Link_Stats_cb);
+
+  return;
+}
+
+/*
+ * @brief A central is connected, ask for the 2M PHY, the longest data length and the
+ *        largest ATT_MTU. The results come with the PHY update, data length change
+ *        and exchange MTU events.
+ *
+ * @param Handle        connection handle
+ */
+void LINK_Connected(uint16_t Handle)
+{
+  Link_Context_t *pLink = Find_Link(LINK_NO_HANDLE);
+  tBleStatus ret;
+
+  if(pLink == NULL)
+  {
+    return;
+  }
+  memset(pLink, 0, sizeof(Link_Context_t));
+  pLink->Info.Handle = Handle;
+  pLink->Info.Tx_Phy = HCI_TX_PHY_LE_1M;
+  pLink->Info.Rx_Phy = HCI_RX_PHY_LE_1M;
+  pLink->Info.Max_Tx_Octets = LINK_DEFAULT_TX_OCTETS;
+  pLink->Info.Max_Rx_Octets = LINK_DEFAULT_TX_OCTETS;
+  pLink->Info.Att_Mtu = LINK_DEFAULT_ATT_MTU;
+
+  ret = hci_le_read_phy(Handle, &pLink->Info.Tx_Phy, &pLink->Info.Rx_Phy);
+  if (ret != BLE_STATUS_SUCCESS)
+  {
+    APP_DBG_MSG("  Fail   : hci_le_read_phy command, result: 0x%x \n", ret);
+  }
+
+  ret = hci_le_set_phy(Handle, ALL_PHYS_PREFERENCE, TX_2M_PREFERRED, RX_2M_PREFERRED, 0);
+  if (ret != BLE_STATUS_SUCCESS)
+  {
+    APP_DBG_MSG("  Fail   : hci_le_set_phy command, result: 0x%x \n", ret);
+  }
+
+  ret = hci_le_set_data_length(Handle, LINK_MAX_TX_OCTETS, LINK_MAX_TX_TIME);
+  if (ret != BLE_STATUS_SUCCESS)
+  {
+    APP_DBG_MSG("  Fail   : hci_le_set_data_length command, result: 0x%x \n", ret);
+  }
+
+  ret = aci_gatt_exchange_config(Handle);
+  if (ret != BLE_STATUS_SUCCESS)
+  {
+    APP_DBG_MSG("  Fail   : aci_gatt_exchange_config command, result: 0x%x \n", ret);
+  }
+
+  if(Link_App_Context.Connected++ == 0)
+  {
+    HW_TS_Start(Link_App_Context.Stats_Timer_Id, LINK_STATS_PERIOD);
+  }
+
+  return;
+}
+
+/*
+ * @brief A central is disconnected
+ *
+ * @param Handle        connection handle
+ */
+void LINK_Disconnected(uint16_t Handle)
+{
+  Link_Context_t *pLink = Find_Link(Handle);
+
+  if(pLink == NULL)
+  {
+    return;
+  }
+  APP_DBG_MSG("Link 0x%x : %ld bytes in %ld notifications\n\r",
+              Handle, pLink->Info.Tx_Bytes, pLink->Info.Tx_Notifications);
+  pLink->Info.Handle = LINK_NO_HANDLE;
+
+  if(--Link_App_Context.Connected == 0)
+  {
+    HW_TS_Stop(Link_App_Context.Stats_Timer_Id);
+  }
+
+  return;
+}
+
+/*
+ * @brief PHY in use on a link
+ *
+ * @param Handle        connection handle
+ * @param Tx_Phy        transmitter PHY
+ * @param Rx_Phy        receiver PHY
+ */
+void LINK_Phy_Update(uint16_t Handle, uint8_t Tx_Phy, uint8_t Rx_Phy)
+{
+  Link_Context_t *pLink = Find_Link(Handle);
+
+  if(pLink == NULL)
+  {
+    return;
+  }
+  pLink->Info.Tx_Phy = Tx_Phy;
+  pLink->Info.Rx_Phy = Rx_Phy;
+  APP_DBG_MSG("Link 0x%x : PHY TX %dM, RX %dM\n\r", Handle, Tx_Phy, Rx_Phy);
+
+  return;
+}
+
+/*
+ * @brief Link layer payload in use on a link
+ *
+ * @param Handle        connection handle
+ * @param Max_Tx_Octets transmitted payload
+ * @param Max_Rx_Octets received payload
+ */
+void LINK_Data_Length_Change(uint16_t Handle, uint16_t Max_Tx_Octets, uint16_t Max_Rx_Octets)
+{
+  Link_Context_t *pLink = Find_Link(Handle);
+
+  if(pLink == NULL)
+  {
+    return;
+  }
+  pLink->Info.Max_Tx_Octets = Max_Tx_Octets;
+  pLink->Info.Max_Rx_Octets = Max_Rx_Octets;
+  APP_DBG_MSG("Link 0x%x : data length TX %d, RX %d octets\n\r", Handle, Max_Tx_Octets, Max_Rx_Octets);
+
+  return;
+}
+
+/*
+ * @brief ATT_MTU exchange done on a link
+ *
+ * @param Handle        connection handle
+ * @param Mtu           ATT_MTU of the central
+ */
+void LINK_Mtu_Exchanged(uint16_t Handle, uint16_t Mtu)
+{
+  Link_Context_t *pLink = Find_Link(Handle);
+
+  if(pLink == NULL)
+  {
+    return;
+  }
+  pLink->Info.Att_Mtu = (Mtu < CFG_BLE_MAX_ATT_MTU) ? Mtu : CFG_BLE_MAX_ATT_MTU;
+  APP_DBG_MSG("Link 0x%x : ATT_MTU %d\n\r", Handle, pLink->Info.Att_Mtu);
+
+  return;
+}
+
+/*
+ * @brief Account a notification sent on a link
+ *
+ * @param Handle        connection handle
+ * @param Length        notified value length
+ */
+void LINK_Notified(uint16_t Handle, uint16_t Length)
+{
+  Link_Context_t *pLink = Find_Link(Handle);
+
+  if(pLink == NULL)
+  {
+    return;
+  }
+  pLink->Info.Tx_Bytes += Length;
+  pLink->Info.Tx_Notifications++;
+
+  return;
+}
+
+/*
+ * @brief Largest value that fits in one notification on a link
+ *
+ * @param Handle        connection handle
+ *
+ * @retval              ATT_MTU minus the notification header
+ */
+uint16_t LINK_Get_Payload_Size(uint16_t Handle)
+{
+  Link_Context_t *pLink = Find_Link(Handle);
+
+  if(pLink == NULL)
+  {
+    return (LINK_DEFAULT_ATT_MTU - 3U);
+  }
+
+  return (pLink->Info.Att_Mtu - 3U);
+}
+
+/*
+ * @brief Number of connected centrals
+ *
+ * @retval              links in use
+ */
+uint8_t LINK_Get_Connected_Nbr(void)
+{
+  return Link_App_Context.Connected;
+}
+
+/*
+ * @brief Get the negotiated parameters and the counters of a link
+ *
+ * @param Handle        connection handle
+ *
+ * @retval              link information, NULL if the handle is not connected
+ */
+const Link_Info_t * LINK_Get_Info(uint16_t Handle)
+{
+  Link_Context_t *pLink = Find_Link(Handle);
+
+  if(pLink == NULL)
+  {
+    return NULL;
+  }
+
+  return &pLink->Info;
+}
+
+/*
+ * @brief Get the context of a connection handle
+ *
+ * @param Handle        connection handle, LINK_NO_HANDLE to get a free context
+ *
+ * @retval              link context, NULL if not found
+ */
+static Link_Context_t * Find_Link(uint16_t Handle)
+{
+  uint8_t i;
+
+  for(i = 0; i < CFG_BLE_NUM_LINK; i++)
+  {
+    if(Link_App_Context.Links[i].Info.Handle == Handle)
+    {
+      return &Link_App_Context.Links[i];
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * @brief Throughput period elapsed
+ * @note  Called under the RTC interrupt, the counters are handled by the task
+ */
+static void Link_Stats_cb(void)
+{
+  UTIL_SEQ_SetTask(1<<CFG_TASK_LINK_STATS, CFG_SCH_PRIO_2);
+
+  return;
+}
+
+/*
+ * @brief Compute the throughput of the last period on each link
+ */
+static void Link_Stats_Task(void)
+{
+  uint8_t i;
+
+  for(i = 0; i < CFG_BLE_NUM_LINK; i++)
+  {
+    Link_Context_t *pLink = &Link_App_Context.Links[i];
+
+    if(pLink->Info.Handle == LINK_NO_HANDLE)
+    {
+      continue;
+    }
+    pLink->Info.Bytes_Per_Sec = pLink->Info.Tx_Bytes - pLink->Last_Tx_Bytes;
+    pLink->Info.Notifications_Per_Sec = pLink->Info.Tx_Notifications - pLink->Last_Tx_Notifications;
+    pLink->Last_Tx_Bytes = pLink->Info.Tx_Bytes;
+    pLink->Last_Tx_Notifications = pLink->Info.Tx_Notifications;
+
+    if(pLink->Info.Notifications_Per_Sec != 0)
+    {
+      APP_DBG_MSG("Link 0x%x : %ld B/s, %ld notif/s (PHY %dM, %d octets, MTU %d)\n\r",
+                  pLink->Info.Handle,
+                  pLink->Info.Bytes_Per_Sec,
+                  pLink->Info.Notifications_Per_Sec,
+                  pLink->Info.Tx_Phy,
+                  pLink->Info.Max_Tx_Octets,
+                  pLink->Info.Att_Mtu);
+    }
+  }
+
+  return;
+}
@@ -20,10 +20,16 @@
 #include "app_common.h"
 #include "dbg_trace.h"
 #include "stm32_seq.h"
+#include "utilities_conf.h"
 #include "stm32_lcd.h"
+#include "app_lcd_text.h"
 #include "stm32wb5mm_dk_lcd.h"
 #include "app_vl53l0x.h"
 #include "custom_app.h"
+#include "app_conn_param.h"
+#include "app_trace.h"
+#include "app_latency.h"
+#include "app_song_store.h"
 
 #include "simple_midi_parser.h"
 #include "app_midi.h"
@@ -33,94 +39,262 @@ typedef struct
 {
   uint8_t               Check_Distance_Timer_Id;        /*!< Distance measurements CB timer id */
   uint8_t               Midi_Seq_Timer_Id;              /*!< Sequencer CB timer id */
+  uint8_t               Midi_Clock_Timer_Id;            /*!< Timing clock CB timer id */
+  uint8_t               Gesture_Note_Timer_Id;          /*!< End of the note played by the distance sensor CB timer id */
   uint8_t               run; 				/*!< Player mode status (0 not running , else running) */
   Midi_Note_Event_t     song[MAX_EVENTS];               /*!< Array of Midi NoteOn or Off events with their deltas */
   uint16_t              index;				/*!< Index of the first empty event of the song */
   uint16_t              cpt;				/*!< Current index in the song */
   uint16_t              ticks_per_beat;		        /*!< Ticks per beat */
   uint32_t              tempo;				/*!< Tempo in microseconds per quarter note */
-  uint8_t               trackname[100];                 /*!< Track name buffer passed to the parser */        
-  uint64_t              songLength;			/*!< Song lenth in ticks */
+  Midi_Tempo_Event_t    tempo_map[MAX_TEMPO_EVENTS];    /*!< Tempo changes with their absolute position in ticks */
+  uint8_t               tempo_nbr;                      /*!< Number of tempo changes in tempo_map */
+  uint8_t               tempo_idx;                      /*!< Tempo map entry used by the sequencer */
+  uint8_t               trackname[MAX_TRACKNAME_SIZE];                 /*!< Track name buffer passed to the parser */        
   uint64_t              currentLength;		        /*!< Cumulated length to the current event in ticks */
+  uint32_t              duration_ms;                    /*!< Song duration following the tempo map */
+  uint32_t              position_ms;                    /*!< Song time of the current event */
+  uint32_t              position_us;                    /*!< Part of the song time below 1 ms, in us */
+  uint32_t              elapsed_ms;                     /*!< Song time of the last event sent */
+  uint16_t              progress;                       /*!< elapsed_ms in MIDI_PROGRESS_SCALE of duration_ms */
+  uint32_t              progress_next_ms;               /*!< Song time of the next progress step */
+  uint32_t              progress_step_ms;               /*!< duration_ms / MIDI_PROGRESS_SCALE */
+  uint32_t              progress_rem;                   /*!< duration_ms % MIDI_PROGRESS_SCALE */
+  uint32_t              progress_acc;                   /*!< Remainders accumulated by the progress steps */
+  uint8_t               shown_cells;                    /*!< Progress bar cells on the screen */
+  uint32_t              shown_seconds;                  /*!< Elapsed time on the screen */
   uint8_t               distance;			/*!< ToF sensor distance in cm */
+  uint8_t               gesture_note;                   /*!< Note played by the distance sensor, 0 if none */
+  uint8_t               gesture_note_end;               /*!< Note Off of gesture_note due */
+  uint8_t               notes_release;                  /*!< Note Offs to send by the sequencer task, NOTES_RELEASE_xxx */
+  uint8_t               notes_restrike;                 /*!< Notes released by the pause to strike again by the sequencer task */
+  uint8_t               seq_sync;                       /*!< The current event is due now, at play and restart */
+  uint8_t               seq_restart;                    /*!< Back to the start of the song, done by the sequencer task */
+  uint8_t               seq_toggle;                     /*!< Switch between pause and play, done by the sequencer task */
+  uint32_t              due_time;                       /*!< Render time of the current event, HAL_GetTick() base in ms */
+  uint32_t              due_us;                         /*!< Part of the render time below 1 ms, in us */
+  uint8_t               clock_running;                  /*!< Timing clock status */
+  uint8_t               clock_tempo_idx;                /*!< Tempo map entry used by the timing clock */
+  uint32_t              clock_count;                    /*!< Timing clocks sent since the song start */
+  uint64_t              clock_remainder;                /*!< Fraction of timer tick carried to the next clock period */
 } Midi_App_Context_t;
 
-/* Private defines -----------------------------------------------------------*/ 
-#define DK_EXTERNAL_FLASH_ADDRESS (uint8_t *)(0x90000000U)
+typedef struct
+{
+  uint32_t              Timestamp;                      /*!< Time the message was generated (HAL_GetTick) */
+  uint8_t               Length;                         /*!< Message length */
+  uint8_t               Data[3];                        /*!< Message, status byte first */
+} Midi_Clock_Msg_t;
 
+/* Private defines -----------------------------------------------------------*/ 
 #define LCD_CHAR_WIDTH          (18U)
 
 #define BASE_NOTE               (50U)
 
 #define MEASUREMENTS_PERIOD     (100U)
+
+#define GESTURE_NOTE_DURATION   (100*1000/CFG_TS_TICK_VAL)     /**< 100ms */
+
+/* The buttons pause and restart under interrupt, the Note Offs are sent by the sequencer task */
+#define NOTES_RELEASE_NONE      (0U)
+#define NOTES_RELEASE_HOLD      (1U)    /*!< Pause : struck again on resume with CFG_MIDI_RESTRIKE_ON_RESUME */
+#define NOTES_RELEASE_FORGET    (2U)    /*!< Restart, new song */
+
+/* Lookahead : time for the packet to be notified, and bound of the time a pause takes to be heard */
+#define MIDI_LOOKAHEAD_MARGIN_MS (2U)
+#define MIDI_LOOKAHEAD_MAX_MS   (40U)
+
+/* Resolution of the progress : per mille */
+#define MIDI_PROGRESS_SCALE     (1000U)
+
+/* Midi timing clocks per quarter note, and per Song Position Pointer beat (16th note) */
+#define MIDI_CLOCK_PPQN         (24U)
+#define MIDI_CLOCK_PER_BEAT     (6U)
+
+/* Clock period in timer ticks = tempo(us) * MIDI_CLOCK_TICK_NUM / MIDI_CLOCK_TICK_DEN */
+#define MIDI_CLOCK_TICK_NUM     ((uint64_t)LSE_VALUE)
+#define MIDI_CLOCK_TICK_DEN     ((uint64_t)MIDI_CLOCK_PPQN * CFG_RTCCLK_DIV * 1000000U)
+
+/* Messages generated under interrupt waiting to be put in a BLE-MIDI packet */
+#define MIDI_CLOCK_QUEUE_SIZE   (8U)
 /* Private variables ---------------------------------------------------------*/
 static Midi_App_Context_t Midi_App_Context;
 
+static Midi_Clock_Msg_t Midi_Clock_Queue[MIDI_CLOCK_QUEUE_SIZE];
+static volatile uint8_t Midi_Clock_Queue_Head;
+static volatile uint8_t Midi_Clock_Queue_Tail;
+static uint32_t         Midi_Clock_Queue_Drops;
+
 /* Private function prototypes -----------------------------------------------*/
 static uint8_t IsNotEmpty(char* str);
+static void    Midi_Load_Song(void);
 
 static void    Check_distance_cb(void);
+static void    Gesture_Note_cb(void);
 static void    Check_distance(void);
 static void    Midi_seq_cb(void);
 static void    Midi_seq(void);
+static void    Midi_Switch_Mode(void);
+static uint32_t Midi_Lookahead(void);
+static uint64_t Event_Delta_Us(uint16_t idx, uint64_t position, uint8_t *pTempoIdx);
+static void    Midi_Advance(uint64_t delta_us);
+static void    Midi_Progress_Reset(void);
+static void    Midi_Progress_Update(void);
 static void    Update_progress_bar(void);
+static uint32_t Tempo_At(uint64_t position, uint8_t *pIdx);
+static void    Midi_Clock_Post(uint8_t status, uint8_t data1, uint8_t data2, uint8_t length);
+static void    Midi_Clock_cb(void);
+static void    Midi_Clock_Schedule(void);
+static void    Midi_Clock_Start(uint8_t status);
+static void    Midi_Clock_Stop(void);
+static void    Midi_Clock_Locate(void);
 
 /* Functions Definition ------------------------------------------------------*/
 void MIDI_Init()
 {
+  /* Task and timer for the distance measurement */
+  UTIL_SEQ_RegTask(1<<CFG_TASK_CHECK_DISTANCE, UTIL_SEQ_RFU, Check_distance);
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+        &Midi_App_Context.Check_Distance_Timer_Id,
+        hw_ts_Repeated,
+        Check_distance_cb);
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+        &Midi_App_Context.Gesture_Note_Timer_Id,
+        hw_ts_SingleShot,
+        Gesture_Note_cb);
+  
+  /* Task and timer for the midi sequencer */
+  UTIL_SEQ_RegTask(1<<CFG_TASK_MIDI_SEQ, UTIL_SEQ_RFU, Midi_seq);
+  /* The progress bar is drawn when no Midi is pending */
+  UTIL_SEQ_RegTask(1<<CFG_TASK_MIDI_DISPLAY, UTIL_SEQ_RFU, Update_progress_bar);
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+        &Midi_App_Context.Midi_Seq_Timer_Id,
+        hw_ts_SingleShot,
+        Midi_seq_cb);
+  
+  /* Timer for the midi timing clock, rescheduled at each clock */
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+        &Midi_App_Context.Midi_Clock_Timer_Id,
+        hw_ts_SingleShot,
+        Midi_Clock_cb);
+  
+  return;
+}
+
+/*
+ * @brief Find the active song and parse it
+ * @note  Needs no BLE : called at startup while CPU2 starts, before MIDI_Init(). The memory
+ *        shall be mapped.
+ */
+void MIDI_Load(void)
+{
+  SONG_STORE_Init();
+  Midi_Load_Song();
+  
+  return;
+}
+
+/*
+ * @brief Parse the active song of the song store and show its name
+ */
+static void Midi_Load_Song(void)
+{
+  uint32_t size;
+  
   BSP_LCD_Clear(0, SSD1315_COLOR_BLACK);
-  UTIL_LCD_DisplayStringAt(0, 0, (uint8_t *)"WB BLE MIDI", CENTER_MODE);
-  UTIL_LCD_DisplayStringAt(0, LINE(2), (uint8_t *)"Parsing file...", LEFT_MODE);
-  BSP_LCD_Refresh(0);
+  LCD_TEXT_DisplayStringAt(0, 0, (uint8_t *)"WB BLE MIDI", CENTER_MODE);
+  LCD_TEXT_DisplayStringAt(0, LINE(2), (uint8_t *)"Parsing file...", LEFT_MODE);
+  LCD_TEXT_Refresh();
   
   Midi_App_Context.index = 0;
-  uint8_t* flash_address = DK_EXTERNAL_FLASH_ADDRESS;
-  uint8_t status = ParseMidi(flash_address, Midi_App_Context.trackname,
+  Midi_App_Context.tempo = 0;
+  Midi_App_Context.tempo_nbr = 0;
+  uint8_t* flash_address = (uint8_t *)SONG_STORE_Get_Song(&size);
+  if(size == 0)
+  {
+    /* Legacy file, its size is not known : up to the first song slot */
+    size = SONG_STORE_SLOT_0_OFFSET - SONG_STORE_LEGACY_OFFSET;
+  }
+  uint8_t status = ParseMidi(flash_address, size, Midi_App_Context.trackname,
                              &Midi_App_Context.ticks_per_beat, &Midi_App_Context.tempo,
-                             Midi_App_Context.song, &Midi_App_Context.index);
+                             Midi_App_Context.song, &Midi_App_Context.index,
+                             Midi_App_Context.tempo_map, &Midi_App_Context.tempo_nbr);
+  if(Midi_App_Context.tempo == 0)
+  {
+    Midi_App_Context.tempo = MIDI_DEFAULT_TEMPO;
+  }
+  /* No division or a SMPTE division (frames per second, bit 15 set) : no ticks per beat to play at */
+  if((Midi_App_Context.ticks_per_beat == 0) || (Midi_App_Context.ticks_per_beat & 0x8000U))
+  {
+    Midi_App_Context.ticks_per_beat = 0;
+    Midi_App_Context.index = 0;
+    status = MIDI_PARSING_NO_FILE;
+  }
   
-  UTIL_LCD_ClearStringLine(2);
+  LCD_TEXT_ClearStringLine(2);
   if(status != MIDI_PARSING_NO_FILE)
   {
     if(IsNotEmpty((char*)Midi_App_Context.trackname))
     {
-      UTIL_LCD_DisplayStringAt(0, LINE(2), (uint8_t *)Midi_App_Context.trackname, LEFT_MODE);
+      LCD_TEXT_DisplayStringAt(0, LINE(2), (uint8_t *)Midi_App_Context.trackname, LEFT_MODE);
     }
     else
     {
-      UTIL_LCD_DisplayStringAt(0, LINE(2), (uint8_t *)"No track name", LEFT_MODE);
+      LCD_TEXT_DisplayStringAt(0, LINE(2), (uint8_t *)"No track name", LEFT_MODE);
     }
 
-    UTIL_LCD_DisplayStringAt(0, LINE(4), (uint8_t *)"|>  ", RIGHT_MODE);
-    UTIL_LCD_DisplayStringAt(0, LINE(4), (uint8_t *)"  |<<", LEFT_MODE);
+    LCD_TEXT_DisplayStringAt(0, LINE(4), (uint8_t *)"|>  ", RIGHT_MODE);
+    LCD_TEXT_DisplayStringAt(0, LINE(4), (uint8_t *)"  |<<", LEFT_MODE);
   }
   else
   {
-    UTIL_LCD_DisplayStringAt(0, LINE(2), (uint8_t *)"No midi file found", LEFT_MODE);    
+    LCD_TEXT_DisplayStringAt(0, LINE(2), (uint8_t *)"No midi file found", LEFT_MODE);    
   }
-  BSP_LCD_Refresh(0);
+  LCD_TEXT_Refresh();
+  
+  /* Duration once for all, each event at the tempo the sequencer uses for it */
+  uint64_t duration_us = 0;
+  uint8_t tempo_idx = 0;
+  uint16_t i;
   
   Midi_App_Context.currentLength = 0;
-  Midi_App_Context.songLength = 0;
-  uint32_t i;
   for(i = 0; i < Midi_App_Context.index; i++)
   {
-    Midi_App_Context.songLength += Midi_App_Context.song[i].Delta;
-  } 
+    duration_us += Event_Delta_Us(i, Midi_App_Context.currentLength, &tempo_idx);
+    Midi_App_Context.currentLength += Midi_App_Context.song[i].Delta;
+  }
+  Midi_App_Context.currentLength = 0;
+  Midi_App_Context.duration_ms = (uint32_t)(duration_us / 1000U);
+  Midi_Progress_Reset();
+  Midi_App_Context.shown_cells = 0xFF;
   
-  /* Task and timer for the distance measurement */
-  UTIL_SEQ_RegTask(1<<CFG_TASK_CHECK_DISTANCE, UTIL_SEQ_RFU, Check_distance);
-  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
-        &Midi_App_Context.Check_Distance_Timer_Id,
-        hw_ts_Repeated,
-        Check_distance_cb);
+  return;
+}
+
+/*
+ * @brief Stop the player and load the active song again, after an upload
+ */
+void Midi_Reload_Song(void)
+{
+  /* A pause or play still pending was asked for the previous song */
+  UTILS_ENTER_CRITICAL_SECTION();
+  Midi_App_Context.seq_toggle = 0;
+  UTILS_EXIT_CRITICAL_SECTION();
+  if(Midi_App_Context.run)
+  {
+    Midi_Switch_Mode();
+  }
+  HW_TS_Stop(Midi_App_Context.Midi_Seq_Timer_Id);
+  /* The notes released by the pause belong to the previous song */
+  Midi_App_Context.notes_release = NOTES_RELEASE_FORGET;
+  Midi_App_Context.notes_restrike = 0;
+  UTIL_SEQ_SetTaskDeadline(1<<CFG_TASK_MIDI_SEQ, CFG_SCH_PRIO_0, CFG_SCH_DEADLINE_NOW());
   
-  /* Task and timer for the midi sequencer */
-  UTIL_SEQ_RegTask(1<<CFG_TASK_MIDI_SEQ, UTIL_SEQ_RFU, Midi_seq);
-  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
-        &Midi_App_Context.Midi_Seq_Timer_Id,
-        hw_ts_SingleShot,
-        Midi_seq_cb);
+  Midi_Load_Song();
+  Midi_App_Context.cpt = 0;
+  Midi_App_Context.tempo_idx = 0;
+  Midi_App_Context.clock_count = 0;
+  Midi_App_Context.clock_tempo_idx = 0;
   
   return;
 }
@@ -150,7 +324,16 @@ static uint8_t IsNotEmpty(char* str)
  */
 static void Check_distance_cb(void)
 {
- UTIL_SEQ_SetTask(1<<CFG_TASK_CHECK_DISTANCE, CFG_SCH_PRIO_0); 
+ UTIL_SEQ_SetTask(1<<CFG_TASK_CHECK_DISTANCE, CFG_SCH_PRIO_1);
+}
+
+/*
+ * @brief Timer callback to end the note played by the distance sensor
+ */
+static void Gesture_Note_cb(void)
+{
+  Midi_App_Context.gesture_note_end = 1;
+  UTIL_SEQ_SetTask(1<<CFG_TASK_CHECK_DISTANCE, CFG_SCH_PRIO_1);
 }
 
 /*
@@ -158,6 +341,13 @@ static void Check_distance_cb(void)
  */
 static void Check_distance(void)
 {
+  if(Midi_App_Context.gesture_note_end)
+  {
+    Midi_App_Context.gesture_note_end = 0;
+    Midi_Send_Note(NOTE_OFF, 0, Midi_App_Context.gesture_note, 127);
+    Midi_App_Context.gesture_note = 0;
+  }
+  
   /* If sequencer should be running disable hadn playing */
   /* We still let the timer run (not optimum way to do it) */
   if(!Midi_App_Context.run)
@@ -188,13 +378,16 @@ static void Check_distance(void)
           }
           average /= valid;
           Midi_App_Context.distance = (uint8_t)(average / 10);
-          if(Midi_App_Context.distance != 0)
+          if((Midi_App_Context.distance != 0) && (Midi_App_Context.gesture_note == 0))
           {
-            APP_DBG_MSG("Send : %d\n\r", Midi_App_Context.distance);
+            APP_TRACE1("Send : %d\n\r", Midi_App_Context.distance);
             uint8_t note_offset = BASE_NOTE + Midi_App_Context.distance / 2;
             Midi_Send_Note(NOTE_ON, 0, note_offset, 127);
-            HAL_Delay(100);
-            Midi_Send_Note(NOTE_OFF, 0, note_offset, 127);
+            /* Do not wait for the end of the task to send the Note On */
+            Midi_Tx_Flush();
+            /* The Note Off is sent by the task without blocking it, the note is tracked until then */
+            Midi_App_Context.gesture_note = note_offset;
+            HW_TS_Start(Midi_App_Context.Gesture_Note_Timer_Id, GESTURE_NOTE_DURATION);
           }
           ongoingNote = 1;
         }
@@ -211,31 +404,43 @@ static void Check_distance(void)
 }
 
 /*
- * @brief Update the progress bar on the LCD screen
- * @note  Will overwrite what was on the 3rd line.
+ * @brief Update the progress bar and the elapsed time on the LCD screen
+ * @note  Will overwrite what was on the 3rd line and the middle of the 4th one.
+ *        Sequencer task at CFG_SCH_PRIO_2, the LCD refresh never delays the Midi.
+ *        The screen is only refreshed when a cell of the bar or the second changes.
  */
 static void Update_progress_bar(void)
 {
-  /* LCD Progress bar */
-  uint8_t progress = (uint8_t)(((float)Midi_App_Context.currentLength / (float)Midi_App_Context.songLength) * 100);
-  char progressBar[LCD_CHAR_WIDTH];
-  progressBar[0] = '[';
-  progressBar[LCD_CHAR_WIDTH-1] = ']';
+  Midi_Player_State_t state;
+  char progressBar[LCD_CHAR_WIDTH + 1];
+  char elapsed[8];
+  uint8_t cells;
+  uint32_t seconds;
   uint8_t i;
+  
+  Midi_Get_Player_State(&state);
+  cells = (uint8_t)(((state.Progress * (LCD_CHAR_WIDTH - 2U)) + MIDI_PROGRESS_SCALE - 1U) / MIDI_PROGRESS_SCALE);
+  seconds = state.Elapsed_Ms / 1000U;
+  if((cells == Midi_App_Context.shown_cells) && (seconds == Midi_App_Context.shown_seconds))
+  {
+    return;
+  }
+  Midi_App_Context.shown_cells = cells;
+  Midi_App_Context.shown_seconds = seconds;
+  
+  progressBar[0] = '[';
   for(i = 1; i < LCD_CHAR_WIDTH - 1; i++)
   {
-    if(progress > ((float)(i - 1) / (float)(LCD_CHAR_WIDTH - 2) * 100))
-    {
-      progressBar[i] = '=';
-    }
-    else
-    {
-      progressBar[i] = ' ';
-    }
+    progressBar[i] = (i <= cells) ? '=' : ' ';
   }
-  UTIL_LCD_ClearStringLine(3);
-  UTIL_LCD_DisplayStringAt(0, LINE(3), (uint8_t *)progressBar, LEFT_MODE);
-  BSP_LCD_Refresh(0);
+  progressBar[LCD_CHAR_WIDTH - 1] = ']';
+  progressBar[LCD_CHAR_WIDTH] = '\0';
+  snprintf(elapsed, sizeof(elapsed), " %2lu:%02lu ", (unsigned long)((seconds / 60U) % 100U), (unsigned long)(seconds % 60U));
+  
+  LCD_TEXT_ClearStringLine(3);
+  LCD_TEXT_DisplayStringAt(0, LINE(3), (uint8_t *)progressBar, LEFT_MODE);
+  LCD_TEXT_DisplayStringAt(0, LINE(4), (uint8_t *)elapsed, CENTER_MODE);
+  LCD_TEXT_Refresh();
   
   return;
 }
@@ -245,83 +450,254 @@ static void Update_progress_bar(void)
  */
 static void Midi_seq_cb(void)
 {
-  UTIL_SEQ_SetTask(1<<CFG_TASK_MIDI_SEQ, CFG_SCH_PRIO_0); 
+  LATENCY_PROBE(LATENCY_PROBE_SEQ_TIMER);
+  UTIL_SEQ_SetTaskDeadline(1<<CFG_TASK_MIDI_SEQ, CFG_SCH_PRIO_0, CFG_SCH_DEADLINE_NOW());
   
   return;
 }
 
 /*
- * @brief Play an event and recursively trigger himself for the next event at the the next delta time
+ * @brief Lookahead of the sequencer : the events due within this time are sent now, timestamped
+ *        with their render time, so that they reach the centrals before being due
+ *
+ * @retval              time in ms, 0 to send each event when due
+ */
+static uint32_t Midi_Lookahead(void)
+{
+#if (CFG_MIDI_LOOKAHEAD == 1)
+  uint32_t interval_us = CONN_PARAM_Get_Interval_Us();
+  uint32_t lookahead;
+  
+  if(interval_us == 0)
+  {
+    return 0;
+  }
+  /* A notification waits up to one interval for the next connection event */
+  lookahead = ((interval_us + 999U) / 1000U) + MIDI_LOOKAHEAD_MARGIN_MS;
+  
+  return (lookahead < MIDI_LOOKAHEAD_MAX_MS) ? lookahead : MIDI_LOOKAHEAD_MAX_MS;
+#else
+  return 0;
+#endif
+}
+
+/*
+ * @brief Send the events due before the lookahead horizon and program the timer for the next ones
+ * @note  The render time of each event is computed from the previous one, not from the time the
+ *        timer fired : the timer latency never accumulates and does not show in the timestamps
  */
 static void Midi_seq(void)
 {
+  uint32_t now = HAL_GetTick();
+  uint32_t horizon;
+  uint32_t wait_ms;
+  uint8_t toggle;
+  
+  UTILS_ENTER_CRITICAL_SECTION();
+  toggle = Midi_App_Context.seq_toggle;
+  Midi_App_Context.seq_toggle = 0;
+  UTILS_EXIT_CRITICAL_SECTION();
+  if(toggle)
+  {
+    /* Requested by Midi_Button_Switch_Mode(), the notes to release or strike again are sent below */
+    Midi_Switch_Mode();
+  }
+  if(Midi_App_Context.notes_release != NOTES_RELEASE_NONE)
+  {
+    Midi_Notes_Off((Midi_App_Context.notes_release == NOTES_RELEASE_HOLD) ? 1 : 0);
+    Midi_App_Context.notes_release = NOTES_RELEASE_NONE;
+  }
+  if(Midi_App_Context.notes_restrike)
+  {
+    Midi_App_Context.notes_restrike = 0;
+    Midi_Notes_Restrike();
+  }
+  if(Midi_App_Context.seq_restart)
+  {
+    /* Requested by Midi_Button_Restart(), also when paused */
+    Midi_App_Context.seq_restart = 0;
+    Midi_App_Context.cpt = 0;
+    Midi_App_Context.currentLength = 0;
+    Midi_App_Context.tempo_idx = 0;
+    Midi_Progress_Reset();
+    UTIL_SEQ_SetTask(1<<CFG_TASK_MIDI_DISPLAY, CFG_SCH_PRIO_2);
+    Midi_Clock_Locate();
+  }
+  
   /* If sequencer should be running */
-  if(Midi_App_Context.run)
+  if(!Midi_App_Context.run)
   {
-    /* If not at the end of the song */
-    if(Midi_App_Context.cpt < Midi_App_Context.index)
+    return;
+  }
+  
+  if(Midi_App_Context.seq_sync)
+  {
+    /* Play, restart : the current event is due now, the first one after its delta */
+    Midi_App_Context.seq_sync = 0;
+    Midi_App_Context.due_time = now;
+    Midi_App_Context.due_us = 0;
+    HW_TS_Stop(Midi_App_Context.Midi_Seq_Timer_Id);
+    if((Midi_App_Context.cpt == 0) && (Midi_App_Context.index != 0))
     {
-      Midi_App_Context.currentLength += Midi_App_Context.song[Midi_App_Context.cpt].Delta;
-      Update_progress_bar();
+      Midi_Progress_Reset();
+      Midi_App_Context.tempo_idx = 0;
+      Midi_Advance(Event_Delta_Us(0, 0, &Midi_App_Context.tempo_idx));
+    }
+  }
+  
+  horizon = now + Midi_Lookahead();
+  if((Midi_App_Context.cpt < Midi_App_Context.index) && ((int32_t)(Midi_App_Context.due_time - horizon) <= 0))
+  {
+    /* Timing clocks first, the timestamps do not go backward in the packet */
+    Midi_Clock_Drain();
+    UTIL_SEQ_SetTask(1<<CFG_TASK_MIDI_DISPLAY, CFG_SCH_PRIO_2);
     
+    while((Midi_App_Context.cpt < Midi_App_Context.index) && ((int32_t)(Midi_App_Context.due_time - horizon) <= 0))
+    {
       Midi_Note_Event_t evt = Midi_App_Context.song[Midi_App_Context.cpt];
-      Midi_Send_Note((evt.Status & 0xF0), (evt.Status & 0x0F), evt.Note, evt.Velocity);
+      uint8_t msg[3];
       
-      APP_DBG_MSG("Midi event : status %x note %d velocity %d\n\r",evt.Status, evt.Note, evt.Velocity);
+      Midi_App_Context.currentLength += evt.Delta;
+      msg[0] = evt.Status;
+      msg[1] = evt.Note & 0x7F;
+      msg[2] = evt.Velocity & 0x7F;
+      Midi_Send_Timed_Message(msg, sizeof(msg), Midi_App_Context.due_time);
       
-      Midi_App_Context.cpt++;
+      APP_TRACE3("Midi event : status %x note %d velocity %d\n\r", evt.Status, evt.Note, evt.Velocity);
       
-      if(Midi_App_Context.song[Midi_App_Context.cpt].Delta != 0)
-      {
-        /* Program the sequencer to send the next event after next delta */
-        uint32_t delta_us = Midi_App_Context.tempo * Midi_App_Context.song[Midi_App_Context.cpt].Delta / Midi_App_Context.ticks_per_beat;
-        HW_TS_Start(Midi_App_Context.Midi_Seq_Timer_Id, (delta_us / CFG_TS_TICK_VAL));
-      }
-      else
+      Midi_App_Context.elapsed_ms = Midi_App_Context.position_ms;
+      Midi_App_Context.cpt++;
+      if(Midi_App_Context.cpt < Midi_App_Context.index)
       {
-        /* In case delta is null between events we need to quickly send the next one to
-         * prevent excessive latency so we call recursively this function directly 
-         * without using it by setting the task */ 
-        Midi_seq();
+        /* Render time of the next event */
+        Midi_Advance(Event_Delta_Us(Midi_App_Context.cpt, Midi_App_Context.currentLength, &Midi_App_Context.tempo_idx));
       }
     }
+    Midi_Progress_Update();
+    /* The events ahead go in their own packets, the next messages start a new one */
+    Midi_Tx_Flush();
+  }
+  
+  if(Midi_App_Context.cpt < Midi_App_Context.index)
+  {
+    /* Wake up when the next event enters the lookahead */
+    wait_ms = Midi_App_Context.due_time - horizon;
+  }
+  else if(Midi_App_Context.clock_running && ((int32_t)(Midi_App_Context.due_time - now) > 0))
+  {
+    /* End of the song once the last events are rendered */
+    wait_ms = Midi_App_Context.due_time - now;
+  }
+  else
+  {
+    if(Midi_App_Context.clock_running)
+    {
+      Midi_Clock_Stop();
+    }
+    return;
   }
   
+  HW_TS_Start(Midi_App_Context.Midi_Seq_Timer_Id, (((wait_ms * 1000U) + Midi_App_Context.due_us) / CFG_TS_TICK_VAL) + 1U);
+  
   return;
 }
 
 /*
  * @brief Switch between pause and play
+ * @note  Called from the button interrupt : the player is only started and stopped by the
+ *        sequencer task, which does the switch. A second call before it runs cancels the first.
  */
 void Midi_Button_Switch_Mode(void)
+{
+  UTILS_ENTER_CRITICAL_SECTION();
+  Midi_App_Context.seq_toggle ^= 1U;
+  UTILS_EXIT_CRITICAL_SECTION();
+  UTIL_SEQ_SetTaskDeadline(1<<CFG_TASK_MIDI_SEQ, CFG_SCH_PRIO_0, CFG_SCH_DEADLINE_NOW());
+  
+  return;
+}
+
+/*
+ * @brief Player mode status
+ * @note  A switch requested by Midi_Button_Switch_Mode() is counted as done
+ *
+ * @retval              0 when the player is paused
+ */
+uint8_t Midi_Is_Playing(void)
+{
+  return ((Midi_App_Context.run != 0) != (Midi_App_Context.seq_toggle != 0)) ? 1 : 0;
+}
+
+/*
+ * @brief Switch between pause and play : timing clock, screen and notes sounding
+ * @note  Called by the sequencer task, or by a task when no sequencer task can run in between
+ */
+static void Midi_Switch_Mode(void)
 {
   Midi_App_Context.run = ~Midi_App_Context.run;
   if(Midi_App_Context.run)
   {
-    UTIL_LCD_DisplayStringAt(0, LINE(4), (uint8_t *)"||  ", RIGHT_MODE);
+    LCD_TEXT_DisplayStringAt(0, LINE(4), (uint8_t *)"||  ", RIGHT_MODE);
+    /* Ask for the short connection interval before the first notes */
+    CONN_PARAM_Activity();
+    Midi_App_Context.seq_sync = 1;
+    if(Midi_App_Context.cpt < Midi_App_Context.index)
+    {
+      Midi_Clock_Start((Midi_App_Context.clock_count == 0) ? MIDI_START : MIDI_CONTINUE);
+    }
+#if (CFG_MIDI_RESTRIKE_ON_RESUME == 1)
+    Midi_App_Context.notes_restrike = 1;
+#endif
   }
   else
   {
-    UTIL_LCD_DisplayStringAt(0, LINE(4), (uint8_t *)"|>  ", RIGHT_MODE);
+    LCD_TEXT_DisplayStringAt(0, LINE(4), (uint8_t *)"|>  ", RIGHT_MODE);
+    if(Midi_App_Context.clock_running)
+    {
+      Midi_Clock_Stop();
+    }
+    /* Nothing left sounding on the centrals while paused */
+    Midi_App_Context.notes_release = NOTES_RELEASE_HOLD;
+    Midi_App_Context.notes_restrike = 0;
   }
-  BSP_LCD_Refresh(0);
-  UTIL_SEQ_SetTask(1<<CFG_TASK_MIDI_SEQ, CFG_SCH_PRIO_0); 
+  LCD_TEXT_Refresh();
+  
+  return;
+}
+
+/*
+ * @brief Player position following the tempo map
+ * @note  Each value is one word written by the sequencer task : it can be read from any
+ *        context without lock, the elapsed time is the one of the last event sent
+ *
+ * @param pState        state filled
+ */
+void Midi_Get_Player_State(Midi_Player_State_t *pState)
+{
+  uint32_t duration = Midi_App_Context.duration_ms;
+  uint32_t elapsed = Midi_App_Context.elapsed_ms;
+  
+  pState->Playing = Midi_Is_Playing();
+  pState->Progress = Midi_App_Context.progress;
+  pState->Duration_Ms = duration;
+  pState->Elapsed_Ms = (elapsed < duration) ? elapsed : duration;
+  pState->Remaining_Ms = duration - pState->Elapsed_Ms;
   
   return;
 }
 
 /*
  * @brief Restart the midi player at the beginning
+ * @note  Called from the button interrupt : the song position is only written by the
+ *        sequencer task, which does the restart
  */
 void Midi_Button_Restart(void)
 {
-  Midi_App_Context.cpt = 0;
-  Midi_App_Context.currentLength = 0;
-  Update_progress_bar();
-  if(Midi_App_Context.run)
-  {
-    UTIL_SEQ_SetTask(1<<CFG_TASK_MIDI_SEQ, CFG_SCH_PRIO_0); 
-  }
+  Midi_App_Context.notes_release = NOTES_RELEASE_FORGET;
+  Midi_App_Context.notes_restrike = 0;
+  Midi_App_Context.seq_restart = 1;
+  Midi_App_Context.seq_sync = 1;
+  UTIL_SEQ_SetTaskDeadline(1<<CFG_TASK_MIDI_SEQ, CFG_SCH_PRIO_0, CFG_SCH_DEADLINE_NOW());
   
   return;
 }
@@ -344,4 +720,279 @@ void Midi_Stop_Measures(void)
   HW_TS_Stop(Midi_App_Context.Check_Distance_Timer_Id);
   
   return;
-}
\ No newline at end of file
+}
+
+/*
+ * @brief Put the messages posted under interrupt by the clock and the transport
+ *        controls in the BLE-MIDI packet being built
+ * @note  Called from task context before any other message is added
+ */
+void Midi_Clock_Drain(void)
+{
+  while(Midi_Clock_Queue_Tail != Midi_Clock_Queue_Head)
+  {
+    Midi_Clock_Msg_t *pMsg = &Midi_Clock_Queue[Midi_Clock_Queue_Tail];
+    Midi_Send_Timed_Message(pMsg->Data, pMsg->Length, pMsg->Timestamp);
+    Midi_Clock_Queue_Tail = (Midi_Clock_Queue_Tail + 1U) % MIDI_CLOCK_QUEUE_SIZE;
+  }
+  
+  return;
+}
+
+/*
+ * @brief Time between an event and the previous one, at the tempo of the previous event
+ *
+ * @param idx           event index in the song
+ * @param position      position of the previous event in ticks
+ * @param pTempoIdx     tempo map index of the caller
+ *
+ * @retval              time in us
+ */
+static uint64_t Event_Delta_Us(uint16_t idx, uint64_t position, uint8_t *pTempoIdx)
+{
+  if(Midi_App_Context.ticks_per_beat == 0)
+  {
+    return 0;
+  }
+  
+  return ((uint64_t)Tempo_At(position, pTempoIdx) * Midi_App_Context.song[idx].Delta) / Midi_App_Context.ticks_per_beat;
+}
+
+/*
+ * @brief Move the render time and the song time of the current event forward
+ *
+ * @param delta_us      time from the previous event
+ */
+static void Midi_Advance(uint64_t delta_us)
+{
+  uint64_t us;
+  
+  us = delta_us + Midi_App_Context.due_us;
+  Midi_App_Context.due_time += (uint32_t)(us / 1000U);
+  Midi_App_Context.due_us = (uint32_t)(us % 1000U);
+  
+  us = delta_us + Midi_App_Context.position_us;
+  Midi_App_Context.position_ms += (uint32_t)(us / 1000U);
+  Midi_App_Context.position_us = (uint32_t)(us % 1000U);
+  
+  return;
+}
+
+/*
+ * @brief Back to the start of the song
+ * @note  The progress steps are at duration_ms * n / MIDI_PROGRESS_SCALE : the quotient and the
+ *        remainder of one step are added at each step, with no multiplication nor division
+ */
+static void Midi_Progress_Reset(void)
+{
+  Midi_App_Context.position_ms = 0;
+  Midi_App_Context.position_us = 0;
+  Midi_App_Context.elapsed_ms = 0;
+  Midi_App_Context.progress = 0;
+  Midi_App_Context.progress_step_ms = Midi_App_Context.duration_ms / MIDI_PROGRESS_SCALE;
+  Midi_App_Context.progress_rem = Midi_App_Context.duration_ms % MIDI_PROGRESS_SCALE;
+  Midi_App_Context.progress_next_ms = Midi_App_Context.progress_step_ms;
+  Midi_App_Context.progress_acc = Midi_App_Context.progress_rem;
+  
+  return;
+}
+
+/*
+ * @brief Move the progress up to the elapsed time
+ */
+static void Midi_Progress_Update(void)
+{
+  while((Midi_App_Context.progress < MIDI_PROGRESS_SCALE) &&
+        (Midi_App_Context.elapsed_ms >= Midi_App_Context.progress_next_ms))
+  {
+    Midi_App_Context.progress++;
+    Midi_App_Context.progress_next_ms += Midi_App_Context.progress_step_ms;
+    Midi_App_Context.progress_acc += Midi_App_Context.progress_rem;
+    if(Midi_App_Context.progress_acc >= MIDI_PROGRESS_SCALE)
+    {
+      Midi_App_Context.progress_acc -= MIDI_PROGRESS_SCALE;
+      Midi_App_Context.progress_next_ms++;
+    }
+  }
+  
+  return;
+}
+
+/*
+ * @brief Get the tempo in use at a position of the song
+ * @note  The index is kept by the caller so that the search starts from the last
+ *        tempo change found, positions are expected to increase between calls
+ *
+ * @param position      position in ticks from the start of the song
+ * @param pIdx          tempo map index of the caller
+ *
+ * @retval              tempo in microseconds per quarter note
+ */
+static uint32_t Tempo_At(uint64_t position, uint8_t *pIdx)
+{
+  uint8_t idx = *pIdx;
+  
+  if(Midi_App_Context.tempo_nbr == 0)
+  {
+    return Midi_App_Context.tempo;
+  }
+  if((idx >= Midi_App_Context.tempo_nbr) || (Midi_App_Context.tempo_map[idx].Tick > position))
+  {
+    idx = 0;
+  }
+  while(((idx + 1U) < Midi_App_Context.tempo_nbr) && (Midi_App_Context.tempo_map[idx + 1U].Tick <= position))
+  {
+    idx++;
+  }
+  *pIdx = idx;
+  
+  return Midi_App_Context.tempo_map[idx].Tempo;
+}
+
+/*
+ * @brief Queue a clock or transport message until the next BLE-MIDI packet
+ * @note  Can be called from interrupt context, the message is timestamped now
+ *
+ * @param status        status byte
+ * @param data1         first data byte (Song Position Pointer only)
+ * @param data2         second data byte (Song Position Pointer only)
+ * @param length        message length
+ */
+static void Midi_Clock_Post(uint8_t status, uint8_t data1, uint8_t data2, uint8_t length)
+{
+  uint8_t next;
+  
+  UTILS_ENTER_CRITICAL_SECTION();
+  next = (Midi_Clock_Queue_Head + 1U) % MIDI_CLOCK_QUEUE_SIZE;
+  if(next != Midi_Clock_Queue_Tail)
+  {
+    Midi_Clock_Msg_t *pMsg = &Midi_Clock_Queue[Midi_Clock_Queue_Head];
+    pMsg->Timestamp = HAL_GetTick();
+    pMsg->Length = length;
+    pMsg->Data[0] = status;
+    pMsg->Data[1] = data1;
+    pMsg->Data[2] = data2;
+    Midi_Clock_Queue_Head = next;
+  }
+  else
+  {
+    Midi_Clock_Queue_Drops++;
+  }
+  UTILS_EXIT_CRITICAL_SECTION();
+  
+  Midi_Tx_Schedule();
+  
+  return;
+}
+
+/*
+ * @brief Timer callback sending a timing clock and programming the next one
+ * @note  Called under the RTC interrupt. The next period is computed from the
+ *        time of this one so that timer latency does not accumulate.
+ */
+static void Midi_Clock_cb(void)
+{
+  Midi_Clock_Post(MIDI_TIMING_CLOCK, 0, 0, 1);
+  Midi_Clock_Schedule();
+  Midi_App_Context.clock_count++;
+  
+  return;
+}
+
+/*
+ * @brief Program the timer for the next timing clock
+ * @note  The period follows the tempo map at the position of the current clock.
+ *        The part of the period that does not fit in whole timer ticks is carried
+ *        to the next period so that the average clock rate is exact.
+ */
+static void Midi_Clock_Schedule(void)
+{
+  uint64_t position;
+  uint32_t tempo;
+  uint32_t ticks;
+  
+  if((Midi_App_Context.index == 0) || (Midi_App_Context.ticks_per_beat == 0))
+  {
+    return;
+  }
+  
+  position = ((uint64_t)Midi_App_Context.clock_count * Midi_App_Context.ticks_per_beat) / MIDI_CLOCK_PPQN;
+  tempo = Tempo_At(position, &Midi_App_Context.clock_tempo_idx);
+  
+  Midi_App_Context.clock_remainder += (uint64_t)tempo * MIDI_CLOCK_TICK_NUM;
+  ticks = (uint32_t)(Midi_App_Context.clock_remainder / MIDI_CLOCK_TICK_DEN);
+  Midi_App_Context.clock_remainder -= (uint64_t)ticks * MIDI_CLOCK_TICK_DEN;
+  if(ticks == 0)
+  {
+    ticks = 1;
+  }
+  HW_TS_Start(Midi_App_Context.Midi_Clock_Timer_Id, ticks);
+  
+  return;
+}
+
+/*
+ * @brief Send Start or Continue followed by the first timing clock and start the clock
+ *
+ * @param status        MIDI_START or MIDI_CONTINUE
+ */
+static void Midi_Clock_Start(uint8_t status)
+{
+  Midi_App_Context.clock_remainder = 0;
+  Midi_App_Context.clock_running = 1;
+  Midi_Clock_Post(status, 0, 0, 1);
+  Midi_Clock_cb();
+  
+  return;
+}
+
+/*
+ * @brief Stop the timing clock and send Stop
+ */
+static void Midi_Clock_Stop(void)
+{
+  HW_TS_Stop(Midi_App_Context.Midi_Clock_Timer_Id);
+  Midi_App_Context.clock_running = 0;
+  Midi_Clock_Post(MIDI_STOP, 0, 0, 1);
+  
+  return;
+}
+
+/*
+ * @brief Align the timing clock on the song position after a seek and send the
+ *        Song Position Pointer
+ * @note  The receivers only accept Song Position Pointer when stopped, a running
+ *        clock is stopped and continued around it
+ */
+static void Midi_Clock_Locate(void)
+{
+  uint32_t beats;
+  uint8_t running = Midi_App_Context.clock_running;
+  
+  if((Midi_App_Context.index == 0) || (Midi_App_Context.ticks_per_beat == 0))
+  {
+    return;
+  }
+  
+  if(running)
+  {
+    Midi_Clock_Stop();
+  }
+  
+  /* Song Position Pointer has a 16th note resolution */
+  beats = (uint32_t)((Midi_App_Context.currentLength * 4U) / Midi_App_Context.ticks_per_beat);
+  if(beats > 0x3FFFU)
+  {
+    beats = 0x3FFFU;
+  }
+  Midi_App_Context.clock_count = beats * MIDI_CLOCK_PER_BEAT;
+  Midi_App_Context.clock_tempo_idx = 0;
+  Midi_Clock_Post(MIDI_SONG_POSITION, beats & 0x7FU, (beats >> 7) & 0x7FU, 3);
+  
+  if(running)
+  {
+    Midi_Clock_Start(MIDI_CONTINUE);
+  }
+  
+  return;
+}
@@ -0,0 +1,1066 @@
+/**
+  ******************************************************************************
+  * @file    app_recorder.c
+  * @author  MCD Application Team
+  * @brief   Recorder of the live midi events in a log of the external memory,
+  *          saved as a standard midi file in the song store
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+#include "dbg_trace.h"
+#include "stm32_seq.h"
+#include "app_ext_flash.h"
+#include "app_song_store.h"
+#include "app_midi.h"
+#include "app_recorder.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint32_t              Sequence;               /*!< Page number since the log was created, gives its position */
+  uint32_t              Time;                   /*!< Time of the event before the page, in ms from the take start */
+  uint16_t              Take;                   /*!< Take number */
+  uint8_t               Length;                 /*!< Bytes of events in the page */
+  uint8_t               Flags;                  /*!< RECORDER_PAGE_FIRST on the first page of a take */
+  uint32_t              Crc;                    /*!< CRC-32 of the fields above and of the events */
+} Recorder_Page_Header_t;
+
+/*
+ * An event is the time from the previous event in ms (variable length quantity as in a midi file)
+ * followed by the channel message with its status byte. It never spans two pages : each page
+ * programmed is read back on its own, a page lost only loses its events.
+ */
+typedef struct
+{
+  Recorder_Page_Header_t Header;
+  uint8_t               Events[EXT_FLASH_PAGE_SIZE - sizeof(Recorder_Page_Header_t)];
+} Recorder_Page_t;
+
+typedef enum
+{
+  RECORDER_IDLE,
+  RECORDER_RECORDING,
+  RECORDER_STOPPING,                    /*!< Waiting for the last pages to be programmed */
+  RECORDER_COUNTING,                    /*!< Size of the standard midi file computed from the log */
+  RECORDER_ERASING,                     /*!< Erase of the free song slot queued */
+  RECORDER_WRITING,                     /*!< Standard midi file programmed in the free song slot */
+  RECORDER_COMMITTING,                  /*!< Header of the song slot programmed */
+  RECORDER_ENDING,                      /*!< Waiting for the end of the flash jobs */
+} Recorder_State_t;
+
+typedef struct
+{
+  uint32_t              Seq;                    /*!< Page read */
+  uint32_t              Index;                  /*!< Next event in the page */
+  uint32_t              Page_Time;              /*!< Time of the last event read */
+  uint32_t              Time;                   /*!< Time of the last event written in the file */
+} Recorder_Cursor_t;
+
+typedef struct
+{
+  Recorder_State_t      State;
+  uint8_t               Flush_Timer_Id;
+  uint8_t               Flush_Pending;          /*!< Page partially filled to be programmed */
+  uint8_t               Page_Open;              /*!< Page Write_Seq being filled */
+  uint8_t               Erasing;                /*!< Sector erase queued and not over */
+  uint8_t               Save_Error;             /*!< Erase or program error in the song slot */
+  uint16_t              Take;                   /*!< Take recorded or saved */
+  uint16_t              Last_Take;              /*!< Last take of the log */
+  uint32_t              Start_Tick;             /*!< HAL_GetTick() at the take start */
+  uint32_t              Last_Time;              /*!< Time of the last event recorded, in ms from the take start */
+  uint32_t              Fill;                   /*!< Bytes of events in the page being filled */
+  uint32_t              Events;                 /*!< Events recorded */
+  uint32_t              Dropped;                /*!< Events lost : buffer full or take too long */
+  uint32_t              First_Seq;              /*!< First page of the take */
+  uint32_t              Write_Seq;              /*!< Page being filled, the next one of the log */
+  uint32_t              Queued_Seq;             /*!< The pages before are queued to be programmed */
+  uint32_t              Done_Seq;               /*!< The pages before are programmed, their buffer is free */
+  uint32_t              Erased_Seq;             /*!< The pages before are erased, or their erase is queued */
+  /* Standard midi file written from the log */
+  Recorder_Cursor_t     Cursor;
+  uint32_t              Last_Seq;               /*!< Last page of the take */
+  uint32_t              Slot;                   /*!< Song slot written */
+  uint32_t              Size;                   /*!< File size */
+  uint32_t              Written;                /*!< Bytes of the file queued to be programmed */
+  uint32_t              Erase_Queued;           /*!< Bytes of the slot queued to be erased */
+  uint32_t              Crc;                    /*!< CRC-32 of the bytes of the file written */
+  uint8_t               Status;                 /*!< Result of the save, 0 when the song is committed */
+  /* Pages filled and programmed while recording, then buffer of the file while saving */
+  Recorder_Page_t       Pages[RECORDER_PAGE_BUFFER_NBR];
+} Recorder_Context_t;
+
+/* Private defines -----------------------------------------------------------*/
+#define RECORDER_LOG_PAGES              (RECORDER_LOG_SIZE / EXT_FLASH_PAGE_SIZE)
+#define RECORDER_SECTOR_PAGES           (EXT_FLASH_SECTOR_SIZE / EXT_FLASH_PAGE_SIZE)
+#define RECORDER_LOG_SECTORS            (RECORDER_LOG_SIZE / EXT_FLASH_SECTOR_SIZE)
+
+/* A take fits in a song slot, and far from the sectors erased ahead when the log wraps around */
+#define RECORDER_TAKE_MAX_PAGES         ((SONG_STORE_FILE_MAX_SIZE / EXT_FLASH_PAGE_SIZE) - 1U)
+
+#define RECORDER_PAGE_FIRST             (0x01U)
+
+/* Delta time up to 4 bytes and a channel message */
+#define RECORDER_EVENT_MAX_SIZE         (7U)
+
+/* Partially filled page programmed after this time : the events lost on a power cut */
+#define RECORDER_FLUSH_PERIOD           (1000*1000/CFG_TS_TICK_VAL)     /**< 1s */
+
+/* Pages of the log read per task run to count the file size */
+#define RECORDER_COUNT_PAGES            (16U)
+
+/* Chunk header and track header of the file */
+#define RECORDER_SMF_TRACK_START        (22U)
+
+/* Private variables ---------------------------------------------------------*/
+static Recorder_Context_t Recorder_Context;
+
+static const uint8_t Recorder_End_Of_Track[4] = {0x00, 0xFF, 0x2F, 0x00};
+
+/* Private function prototypes -----------------------------------------------*/
+static void     Recorder_Scan(void);
+static uint8_t  Recorder_Page_Start(void);
+static void     Recorder_Page_Close(void);
+static void     Recorder_Flush(void);
+static void     Recorder_Save(uint32_t First_Seq, uint32_t Last_Seq);
+static void     Recorder_Count(void);
+static void     Recorder_Erase(void);
+static void     Recorder_Write(void);
+static void     Recorder_End(uint8_t Status);
+static void     Recorder_Close(void);
+static uint32_t Smf_Header(uint8_t *pDst, uint32_t Track_Length);
+static uint32_t Smf_Fill(uint8_t *pDst, uint32_t Max);
+static uint32_t Smf_Next_Event(Recorder_Cursor_t *pCursor, uint32_t Last_Seq, uint8_t *pDst);
+static const Recorder_Page_t * Page_Mapped(uint32_t Seq);
+static uint8_t  Page_Is_Valid(const Recorder_Page_t *pPage, uint32_t Seq);
+static uint32_t Page_Crc(const Recorder_Page_t *pPage);
+static uint8_t  Msg_Length(uint8_t Status);
+static uint8_t  Vlq_Write(uint8_t *pDst, uint32_t Value);
+static uint8_t  Vlq_Read(const uint8_t *pSrc, uint32_t Max, uint32_t *pValue);
+static void     Recorder_Log_Cb(Ext_Flash_Status_t Status, uint32_t Offset, uint32_t Size);
+static void     Recorder_Save_Cb(Ext_Flash_Status_t Status, uint32_t Offset, uint32_t Size);
+static void     Recorder_Commit_Cb(Ext_Flash_Status_t Status);
+static void     Recorder_Flush_Timer_Cb(void);
+static void     Recorder_Task(void);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Find the end of the log, register the recorder task and its timer
+ * @note  The memory shall be mapped
+ */
+void RECORDER_Init(void)
+{
+  Recorder_Context.State = RECORDER_IDLE;
+
+  UTIL_SEQ_RegTask(1<<CFG_TASK_RECORDER, UTIL_SEQ_RFU, Recorder_Task);
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+        &Recorder_Context.Flush_Timer_Id,
+        hw_ts_Repeated,
+        Recorder_Flush_Timer_Cb);
+
+  Recorder_Scan();
+
+  APP_DBG_MSG("Recorder : last take %d, log page %ld\n\r", Recorder_Context.Last_Take, Recorder_Context.Write_Seq);
+
+  return;
+}
+
+/*
+ * @brief Start a new take, the memory stays unmapped until it is saved
+ */
+void RECORDER_Start(void)
+{
+  if(Recorder_Context.State != RECORDER_IDLE)
+  {
+    APP_DBG_MSG("Recorder : busy\n\r");
+    return;
+  }
+  /* A song transfer unmaps the memory */
+  if(!EXT_FLASH_Is_Memory_Mapped() || !EXT_FLASH_Is_Idle() || (EXT_FLASH_Memory_Mapped_Disable() != EXT_FLASH_OK))
+  {
+    APP_DBG_MSG("Recorder : memory busy\n\r");
+    return;
+  }
+
+  Recorder_Context.Last_Take++;
+  Recorder_Context.Take = Recorder_Context.Last_Take;
+  Recorder_Context.First_Seq = Recorder_Context.Write_Seq;
+  Recorder_Context.Start_Tick = HAL_GetTick();
+  Recorder_Context.Last_Time = 0;
+  Recorder_Context.Events = 0;
+  Recorder_Context.Dropped = 0;
+  Recorder_Context.Page_Open = 0;
+  Recorder_Context.Flush_Pending = 0;
+  Recorder_Context.State = RECORDER_RECORDING;
+
+  HW_TS_Start(Recorder_Context.Flush_Timer_Id, RECORDER_FLUSH_PERIOD);
+  APP_DBG_MSG("Recorder : take %d\n\r", Recorder_Context.Take);
+
+  return;
+}
+
+/*
+ * @brief Stop the take, it is saved as the active song once its last pages are programmed
+ */
+void RECORDER_Stop(void)
+{
+  if(Recorder_Context.State != RECORDER_RECORDING)
+  {
+    return;
+  }
+
+  HW_TS_Stop(Recorder_Context.Flush_Timer_Id);
+  Recorder_Page_Close();
+  Recorder_Flush();
+  Recorder_Context.State = RECORDER_STOPPING;
+  UTIL_SEQ_SetTask(1<<CFG_TASK_RECORDER, CFG_SCH_PRIO_1);
+
+  APP_DBG_MSG("Recorder : take %d, %ld events in %ld ms, %ld lost\n\r",
+              Recorder_Context.Take, Recorder_Context.Events, Recorder_Context.Last_Time, Recorder_Context.Dropped);
+
+  return;
+}
+
+/*
+ * @brief Save again the last take of the log, when its save failed or was cut by a power loss
+ */
+void RECORDER_Save_Last_Take(void)
+{
+  const Recorder_Page_t *p_page;
+  uint32_t seq;
+
+  if((Recorder_Context.State != RECORDER_IDLE) || !EXT_FLASH_Is_Memory_Mapped())
+  {
+    APP_DBG_MSG("Recorder : busy\n\r");
+    return;
+  }
+  if(Recorder_Context.Write_Seq == 0)
+  {
+    APP_DBG_MSG("Recorder : no take\n\r");
+    return;
+  }
+
+  /* Back to the first page of the take, the pages of a take follow each other */
+  seq = Recorder_Context.Write_Seq - 1;
+  p_page = Page_Mapped(seq);
+  Recorder_Context.Take = p_page->Header.Take;
+  while(((p_page->Header.Flags & RECORDER_PAGE_FIRST) == 0) && (seq > 0) &&
+        ((Recorder_Context.Write_Seq - seq) < RECORDER_TAKE_MAX_PAGES))
+  {
+    p_page = Page_Mapped(seq - 1);
+    if((p_page->Header.Sequence != (seq - 1)) || (p_page->Header.Take != Recorder_Context.Take))
+    {
+      break;
+    }
+    seq--;
+  }
+
+  Recorder_Save(seq, Recorder_Context.Write_Seq - 1);
+
+  return;
+}
+
+/*
+ * @brief Record a midi message, only the channel messages are kept
+ * @note  Called from task context for the messages sent and the messages received
+ *
+ * @param pMsg          complete midi message, status byte first
+ * @param Length        message length
+ * @param Timestamp     render time, HAL_GetTick() base in ms
+ */
+void RECORDER_Midi_Event(const uint8_t *pMsg, uint8_t Length, uint32_t Timestamp)
+{
+  Recorder_Page_t *p_page;
+  uint8_t event[RECORDER_EVENT_MAX_SIZE];
+  uint32_t time;
+  uint8_t n;
+
+  if((Recorder_Context.State != RECORDER_RECORDING) || (Length == 0) || (Msg_Length(pMsg[0]) != Length))
+  {
+    return;
+  }
+
+  /* The song is sent ahead of the messages received : the events are kept in order */
+  time = Timestamp - Recorder_Context.Start_Tick;
+  if((int32_t)(time - Recorder_Context.Last_Time) < 0)
+  {
+    time = Recorder_Context.Last_Time;
+  }
+  n = Vlq_Write(event, time - Recorder_Context.Last_Time);
+  memcpy(&event[n], pMsg, Length);
+  n += Length;
+
+  if(Recorder_Context.Page_Open && ((Recorder_Context.Fill + n) > sizeof(p_page->Events)))
+  {
+    Recorder_Page_Close();
+    Recorder_Flush();
+  }
+  if(!Recorder_Context.Page_Open && !Recorder_Page_Start())
+  {
+    /* The time of the lost event is kept in the delta of the next one */
+    Recorder_Context.Dropped++;
+    return;
+  }
+
+  p_page = &Recorder_Context.Pages[Recorder_Context.Write_Seq % RECORDER_PAGE_BUFFER_NBR];
+  memcpy(&p_page->Events[Recorder_Context.Fill], event, n);
+  Recorder_Context.Fill += n;
+  Recorder_Context.Last_Time = time;
+  Recorder_Context.Events++;
+
+  return;
+}
+
+/*
+ * @brief Find the last page of the log : the newest sector starts with the highest sequence number
+ * @note  When the program of a page was cut, the log goes on at the next sector
+ */
+static void Recorder_Scan(void)
+{
+  const Recorder_Page_t *p_page;
+  const uint32_t *p_word;
+  uint32_t sector;
+  uint32_t seq = 0;
+  uint8_t found = 0;
+
+  for(sector = 0; sector < RECORDER_LOG_SECTORS; sector++)
+  {
+    p_page = Page_Mapped(sector * RECORDER_SECTOR_PAGES);
+    if(Page_Is_Valid(p_page, sector * RECORDER_SECTOR_PAGES) && (!found || (p_page->Header.Sequence > seq)))
+    {
+      seq = p_page->Header.Sequence;
+      found = 1;
+    }
+  }
+
+  if(!found)
+  {
+    Recorder_Context.Write_Seq = 0;
+    Recorder_Context.Erased_Seq = 0;
+    Recorder_Context.Last_Take = 0;
+  }
+  else
+  {
+    while(((seq + 1) % RECORDER_SECTOR_PAGES) != 0)
+    {
+      p_page = Page_Mapped(seq + 1);
+      if(!Page_Is_Valid(p_page, seq + 1) || (p_page->Header.Sequence != (seq + 1)))
+      {
+        break;
+      }
+      seq++;
+    }
+    Recorder_Context.Last_Take = Page_Mapped(seq)->Header.Take;
+    Recorder_Context.Write_Seq = seq + 1;
+    Recorder_Context.Erased_Seq = ((seq / RECORDER_SECTOR_PAGES) + 1) * RECORDER_SECTOR_PAGES;
+
+    /* The rest of the sector shall be erased */
+    for(p_word = (const uint32_t *)Page_Mapped(Recorder_Context.Write_Seq);
+        (Recorder_Context.Write_Seq != Recorder_Context.Erased_Seq) &&
+        (p_word < ((const uint32_t *)Page_Mapped(Recorder_Context.Erased_Seq - 1) + (EXT_FLASH_PAGE_SIZE / 4)));
+        p_word++)
+    {
+      if(*p_word != 0xFFFFFFFFU)
+      {
+        Recorder_Context.Write_Seq = Recorder_Context.Erased_Seq;
+        break;
+      }
+    }
+  }
+
+  Recorder_Context.Queued_Seq = Recorder_Context.Write_Seq;
+  Recorder_Context.Done_Seq = Recorder_Context.Write_Seq;
+
+  return;
+}
+
+/*
+ * @brief Start filling the page Write_Seq
+ *
+ * @retval              0 when all the page buffers wait to be programmed or the take is full
+ */
+static uint8_t Recorder_Page_Start(void)
+{
+  Recorder_Page_t *p_page;
+
+  if(((Recorder_Context.Write_Seq - Recorder_Context.Done_Seq) >= RECORDER_PAGE_BUFFER_NBR) ||
+     ((Recorder_Context.Write_Seq - Recorder_Context.First_Seq) >= RECORDER_TAKE_MAX_PAGES))
+  {
+    return 0;
+  }
+
+  p_page = &Recorder_Context.Pages[Recorder_Context.Write_Seq % RECORDER_PAGE_BUFFER_NBR];
+  memset(p_page, 0xFF, sizeof(Recorder_Page_t));
+  p_page->Header.Time = Recorder_Context.Last_Time;
+  p_page->Header.Take = Recorder_Context.Take;
+  p_page->Header.Flags = (Recorder_Context.Write_Seq == Recorder_Context.First_Seq) ? RECORDER_PAGE_FIRST : 0;
+  Recorder_Context.Fill = 0;
+  Recorder_Context.Page_Open = 1;
+
+  return 1;
+}
+
+/*
+ * @brief Close the page being filled, it is ready to be programmed
+ */
+static void Recorder_Page_Close(void)
+{
+  Recorder_Page_t *p_page;
+
+  if(!Recorder_Context.Page_Open)
+  {
+    return;
+  }
+  Recorder_Context.Page_Open = 0;
+  if(Recorder_Context.Fill == 0)
+  {
+    return;
+  }
+
+  p_page = &Recorder_Context.Pages[Recorder_Context.Write_Seq % RECORDER_PAGE_BUFFER_NBR];
+  p_page->Header.Sequence = Recorder_Context.Write_Seq;
+  p_page->Header.Length = Recorder_Context.Fill;
+  p_page->Header.Crc = Page_Crc(p_page);
+  Recorder_Context.Write_Seq++;
+
+  return;
+}
+
+/*
+ * @brief Queue the program of the pages closed, by one job up to the end of the page buffers, and
+ *        the erase of the sector ahead of the pages
+ */
+static void Recorder_Flush(void)
+{
+  Ext_Flash_Status_t status = EXT_FLASH_OK;
+  uint32_t seq;
+  uint32_t n;
+
+  while(status == EXT_FLASH_OK)
+  {
+    seq = Recorder_Context.Queued_Seq;
+    n = Recorder_Context.Write_Seq - seq;
+    if(n > (RECORDER_PAGE_BUFFER_NBR - (seq % RECORDER_PAGE_BUFFER_NBR)))
+    {
+      n = RECORDER_PAGE_BUFFER_NBR - (seq % RECORDER_PAGE_BUFFER_NBR);
+    }
+    if(n > (RECORDER_LOG_PAGES - (seq % RECORDER_LOG_PAGES)))
+    {
+      n = RECORDER_LOG_PAGES - (seq % RECORDER_LOG_PAGES);
+    }
+    if(n > (Recorder_Context.Erased_Seq - seq))
+    {
+      n = Recorder_Context.Erased_Seq - seq;
+    }
+
+    if(n != 0)
+    {
+      status = EXT_FLASH_Program(RECORDER_LOG_OFFSET + ((seq % RECORDER_LOG_PAGES) * EXT_FLASH_PAGE_SIZE),
+                                 (const uint8_t *)&Recorder_Context.Pages[seq % RECORDER_PAGE_BUFFER_NBR],
+                                 n * EXT_FLASH_PAGE_SIZE,
+                                 Recorder_Log_Cb);
+      if(status == EXT_FLASH_OK)
+      {
+        Recorder_Context.Queued_Seq += n;
+      }
+    }
+    else if(!Recorder_Context.Erasing &&
+            (Recorder_Context.Erased_Seq < (Recorder_Context.Write_Seq + RECORDER_SECTOR_PAGES)))
+    {
+      /* The oldest sector of the log, a whole sector ahead of the page being filled */
+      status = EXT_FLASH_Erase_Sector(RECORDER_LOG_OFFSET + ((Recorder_Context.Erased_Seq % RECORDER_LOG_PAGES) * EXT_FLASH_PAGE_SIZE),
+                                      Recorder_Log_Cb);
+      if(status == EXT_FLASH_OK)
+      {
+        Recorder_Context.Erased_Seq += RECORDER_SECTOR_PAGES;
+        Recorder_Context.Erasing = 1;
+      }
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  if(status == EXT_FLASH_ERROR)
+  {
+    APP_DBG_MSG("Recorder : flash job error\n\r");
+  }
+
+  return;
+}
+
+/*
+ * @brief Write the take as a standard midi file in the free song slot
+ * @note  The memory shall be mapped
+ */
+static void Recorder_Save(uint32_t First_Seq, uint32_t Last_Seq)
+{
+  uint8_t header[RECORDER_SMF_TRACK_START + 32];
+
+  if(SONG_STORE_Open_Slot(&Recorder_Context.Slot) != EXT_FLASH_OK)
+  {
+    APP_DBG_MSG("Recorder : song store busy\n\r");
+    Recorder_Context.State = RECORDER_IDLE;
+    return;
+  }
+
+  Recorder_Context.First_Seq = First_Seq;
+  Recorder_Context.Cursor.Seq = First_Seq;
+  Recorder_Context.Cursor.Index = 0;
+  Recorder_Context.Cursor.Page_Time = 0;
+  Recorder_Context.Cursor.Time = 0;
+  Recorder_Context.Last_Seq = Last_Seq;
+  Recorder_Context.Size = Smf_Header(header, 0) + sizeof(Recorder_End_Of_Track);
+  Recorder_Context.Written = 0;
+  Recorder_Context.Erase_Queued = 0;
+  Recorder_Context.Crc = 0;
+  Recorder_Context.Save_Error = 0;
+  Recorder_Context.State = RECORDER_COUNTING;
+  UTIL_SEQ_SetTask(1<<CFG_TASK_RECORDER, CFG_SCH_PRIO_1);
+
+  APP_DBG_MSG("Recorder : saving take %d, log pages %ld to %ld\n\r", Recorder_Context.Take, First_Seq, Last_Seq);
+
+  return;
+}
+
+/*
+ * @brief Add the size of the events of a few pages of the log to the file size
+ */
+static void Recorder_Count(void)
+{
+  uint8_t event[RECORDER_EVENT_MAX_SIZE];
+  uint32_t last;
+  uint32_t n;
+
+  last = Recorder_Context.Cursor.Seq + RECORDER_COUNT_PAGES - 1;
+  if(last > Recorder_Context.Last_Seq)
+  {
+    last = Recorder_Context.Last_Seq;
+  }
+  while((n = Smf_Next_Event(&Recorder_Context.Cursor, last, event)) != 0)
+  {
+    Recorder_Context.Size += n;
+  }
+
+  if(Recorder_Context.Cursor.Seq > Recorder_Context.Last_Seq)
+  {
+    if(Recorder_Context.Size > SONG_STORE_FILE_MAX_SIZE)
+    {
+      Recorder_End(1);
+      return;
+    }
+    Recorder_Context.Cursor.Seq = Recorder_Context.First_Seq;
+    Recorder_Context.Cursor.Index = 0;
+    Recorder_Context.Cursor.Page_Time = 0;
+    Recorder_Context.Cursor.Time = 0;
+    Recorder_Context.State = RECORDER_ERASING;
+  }
+  UTIL_SEQ_SetTask(1<<CFG_TASK_RECORDER, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Queue the erase of the sectors of the song slot
+ */
+static void Recorder_Erase(void)
+{
+  Ext_Flash_Status_t status;
+
+  if(EXT_FLASH_Memory_Mapped_Disable() != EXT_FLASH_OK)
+  {
+    Recorder_End(1);
+    return;
+  }
+
+  while(Recorder_Context.Erase_Queued < (SONG_STORE_HEADER_SIZE + Recorder_Context.Size))
+  {
+    status = EXT_FLASH_Erase_Sector(Recorder_Context.Slot + Recorder_Context.Erase_Queued, Recorder_Save_Cb);
+    if(status == EXT_FLASH_BUSY)
+    {
+      /* Queued again from the next callback */
+      return;
+    }
+    if(status != EXT_FLASH_OK)
+    {
+      Recorder_End(1);
+      return;
+    }
+    Recorder_Context.Erase_Queued += EXT_FLASH_SECTOR_SIZE;
+  }
+
+  Recorder_Context.State = RECORDER_WRITING;
+  UTIL_SEQ_SetTask(1<<CFG_TASK_RECORDER, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Build the next chunk of the file from the mapped log and queue its program, then commit
+ *        the song once the whole file is programmed
+ */
+static void Recorder_Write(void)
+{
+  uint8_t *p_buffer = (uint8_t *)Recorder_Context.Pages;
+  uint32_t n;
+
+  if(!EXT_FLASH_Is_Idle())
+  {
+    /* Set again by the callback */
+    return;
+  }
+  if(Recorder_Context.Save_Error || (EXT_FLASH_Memory_Mapped_Enable() != EXT_FLASH_OK))
+  {
+    Recorder_End(1);
+    return;
+  }
+
+  if(Recorder_Context.Written == Recorder_Context.Size)
+  {
+    if(SONG_STORE_Commit(Recorder_Context.Slot, Recorder_Context.Size, Recorder_Context.Crc,
+                         Recorder_Commit_Cb) != EXT_FLASH_OK)
+    {
+      Recorder_End(1);
+      return;
+    }
+    Recorder_Context.State = RECORDER_COMMITTING;
+    return;
+  }
+
+  n = Smf_Fill(p_buffer, sizeof(Recorder_Context.Pages));
+  if((n == 0) || (EXT_FLASH_Memory_Mapped_Disable() != EXT_FLASH_OK) ||
+     (EXT_FLASH_Program(Recorder_Context.Slot + SONG_STORE_HEADER_SIZE + Recorder_Context.Written,
+                        p_buffer, n, Recorder_Save_Cb) != EXT_FLASH_OK))
+  {
+    Recorder_End(1);
+    return;
+  }
+  Recorder_Context.Crc = SONG_STORE_Crc32(Recorder_Context.Crc, p_buffer, n);
+  Recorder_Context.Written += n;
+
+  return;
+}
+
+/*
+ * @brief End of the save, the memory is mapped again once the flash jobs are over
+ *
+ * @param Status        0 when the song is committed
+ */
+static void Recorder_End(uint8_t Status)
+{
+  Recorder_Context.Status = Status;
+  Recorder_Context.State = RECORDER_ENDING;
+  UTIL_SEQ_SetTask(1<<CFG_TASK_RECORDER, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Map the memory again, the saved take is played
+ */
+static void Recorder_Close(void)
+{
+  if(!EXT_FLASH_Is_Idle())
+  {
+    return;
+  }
+
+  if(EXT_FLASH_Memory_Mapped_Enable() != EXT_FLASH_OK)
+  {
+    APP_DBG_MSG("Recorder : memory not mapped\n\r");
+  }
+  SONG_STORE_Close_Slot();
+  Recorder_Context.State = RECORDER_IDLE;
+
+  if(Recorder_Context.Status != 0)
+  {
+    APP_DBG_MSG("Recorder : take %d not saved\n\r", Recorder_Context.Take);
+    return;
+  }
+
+  APP_DBG_MSG("Recorder : take %d saved, %ld bytes\n\r", Recorder_Context.Take, Recorder_Context.Size);
+  Midi_Reload_Song();
+
+  return;
+}
+
+/*
+ * @brief Header chunk, start of the track chunk, track name and tempo
+ *
+ * @param pDst          RECORDER_SMF_TRACK_START + 32 bytes
+ * @param Track_Length  length of the track chunk data
+ *
+ * @retval              bytes written
+ */
+static uint32_t Smf_Header(uint8_t *pDst, uint32_t Track_Length)
+{
+  static const uint8_t smf_header[] =
+  {
+    'M', 'T', 'h', 'd', 0x00, 0x00, 0x00, 0x06,
+    0x00, 0x00,                                         /* Format 0 */
+    0x00, 0x01,                                         /* One track */
+    (RECORDER_TICKS_PER_BEAT >> 8), (RECORDER_TICKS_PER_BEAT & 0xFF),
+    'M', 'T', 'r', 'k',
+  };
+  static const uint8_t tempo[] = {0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20};  /* 500000 us per beat */
+  uint32_t n;
+  int length;
+
+  memcpy(pDst, smf_header, sizeof(smf_header));
+  n = sizeof(smf_header);
+  pDst[n++] = (uint8_t)(Track_Length >> 24);
+  pDst[n++] = (uint8_t)(Track_Length >> 16);
+  pDst[n++] = (uint8_t)(Track_Length >> 8);
+  pDst[n++] = (uint8_t)Track_Length;
+
+  /* Track name, shown by the player */
+  length = snprintf((char *)&pDst[n + 4], 16, "Take %d", Recorder_Context.Take);
+  pDst[n++] = 0x00;
+  pDst[n++] = 0xFF;
+  pDst[n++] = 0x03;
+  pDst[n++] = (uint8_t)length;
+  n += length;
+
+  memcpy(&pDst[n], tempo, sizeof(tempo));
+  n += sizeof(tempo);
+
+  return n;
+}
+
+/*
+ * @brief Next bytes of the file : header, events of the log, end of track
+ *
+ * @param pDst          buffer
+ * @param Max           buffer size
+ *
+ * @retval              bytes written
+ */
+static uint32_t Smf_Fill(uint8_t *pDst, uint32_t Max)
+{
+  uint32_t n = 0;
+  uint32_t length;
+
+  if(Recorder_Context.Written == 0)
+  {
+    n = Smf_Header(pDst, Recorder_Context.Size - RECORDER_SMF_TRACK_START);
+  }
+
+  while((Max - n) >= RECORDER_EVENT_MAX_SIZE)
+  {
+    length = Smf_Next_Event(&Recorder_Context.Cursor, Recorder_Context.Last_Seq, &pDst[n]);
+    if(length == 0)
+    {
+      break;
+    }
+    n += length;
+  }
+
+  if(((Recorder_Context.Written + n + sizeof(Recorder_End_Of_Track)) == Recorder_Context.Size) &&
+     ((Max - n) >= sizeof(Recorder_End_Of_Track)))
+  {
+    memcpy(&pDst[n], Recorder_End_Of_Track, sizeof(Recorder_End_Of_Track));
+    n += sizeof(Recorder_End_Of_Track);
+  }
+
+  return n;
+}
+
+/*
+ * @brief Read the next event of the take in the mapped log, as an event of the track
+ * @note  The pages not valid are skipped : the time of the next event is given by the next page
+ *
+ * @param pCursor       position in the log
+ * @param Last_Seq      last page to read
+ * @param pDst          RECORDER_EVENT_MAX_SIZE bytes
+ *
+ * @retval              bytes written, 0 once after Last_Seq
+ */
+static uint32_t Smf_Next_Event(Recorder_Cursor_t *pCursor, uint32_t Last_Seq, uint8_t *pDst)
+{
+  const Recorder_Page_t *p_page;
+  uint32_t delta;
+  uint32_t index;
+  uint8_t length;
+  uint8_t msg_length;
+  uint8_t n;
+
+  while(pCursor->Seq <= Last_Seq)
+  {
+    p_page = Page_Mapped(pCursor->Seq);
+    if(pCursor->Index == 0)
+    {
+      if(!Page_Is_Valid(p_page, pCursor->Seq) || (p_page->Header.Sequence != pCursor->Seq) ||
+         (p_page->Header.Take != Recorder_Context.Take))
+      {
+        pCursor->Seq++;
+        continue;
+      }
+      pCursor->Page_Time = p_page->Header.Time;
+    }
+
+    index = pCursor->Index;
+    length = 0;
+    msg_length = 0;
+    if(index < p_page->Header.Length)
+    {
+      length = Vlq_Read(&p_page->Events[index], p_page->Header.Length - index, &delta);
+    }
+    if((length != 0) && ((index + length) < p_page->Header.Length))
+    {
+      msg_length = Msg_Length(p_page->Events[index + length]);
+    }
+    if((msg_length == 0) || ((index + length + msg_length) > p_page->Header.Length))
+    {
+      pCursor->Seq++;
+      pCursor->Index = 0;
+      continue;
+    }
+
+    pCursor->Page_Time += delta;
+    n = Vlq_Write(pDst, pCursor->Page_Time - pCursor->Time);
+    memcpy(&pDst[n], &p_page->Events[index + length], msg_length);
+    pCursor->Time = pCursor->Page_Time;
+    pCursor->Index = index + length + msg_length;
+
+    return n + msg_length;
+  }
+
+  return 0;
+}
+
+/*
+ * @brief Page of the log in the mapped memory
+ */
+static const Recorder_Page_t * Page_Mapped(uint32_t Seq)
+{
+  return (const Recorder_Page_t *)(EXT_FLASH_MAPPED_ADDRESS + RECORDER_LOG_OFFSET +
+                                   ((Seq % RECORDER_LOG_PAGES) * EXT_FLASH_PAGE_SIZE));
+}
+
+/*
+ * @brief Check the CRC of a page and its position in the log
+ *
+ * @retval              0 for an erased, partially programmed or corrupted page
+ */
+static uint8_t Page_Is_Valid(const Recorder_Page_t *pPage, uint32_t Seq)
+{
+  if(((pPage->Header.Sequence % RECORDER_LOG_PAGES) != (Seq % RECORDER_LOG_PAGES)) ||
+     (pPage->Header.Length > sizeof(pPage->Events)))
+  {
+    return 0;
+  }
+
+  return (pPage->Header.Crc == Page_Crc(pPage)) ? 1 : 0;
+}
+
+static uint32_t Page_Crc(const Recorder_Page_t *pPage)
+{
+  uint32_t crc;
+
+  crc = SONG_STORE_Crc32(0, (const uint8_t *)&pPage->Header, offsetof(Recorder_Page_Header_t, Crc));
+  return SONG_STORE_Crc32(crc, pPage->Events, pPage->Header.Length);
+}
+
+/*
+ * @brief Length of a channel message
+ *
+ * @retval              0 for the system messages, which are not recorded
+ */
+static uint8_t Msg_Length(uint8_t Status)
+{
+  switch(Status & 0xF0)
+  {
+    case 0x80:          /* Note off */
+    case 0x90:          /* Note on */
+    case 0xA0:          /* Polyphonic key pressure */
+    case 0xB0:          /* Control change */
+    case 0xE0:          /* Pitch bend */
+      return 3;
+
+    case 0xC0:          /* Program change */
+    case 0xD0:          /* Channel pressure */
+      return 2;
+
+    default:
+      return 0;
+  }
+}
+
+/*
+ * @brief Variable length quantity of a midi file, up to 4 bytes
+ */
+static uint8_t Vlq_Write(uint8_t *pDst, uint32_t Value)
+{
+  uint8_t n = 1;
+  uint8_t i;
+
+  if(Value > 0x0FFFFFFFU)
+  {
+    Value = 0x0FFFFFFFU;
+  }
+  while((n < 4) && ((Value >> (7 * n)) != 0))
+  {
+    n++;
+  }
+  for(i = 0; i < n; i++)
+  {
+    pDst[i] = (uint8_t)((Value >> (7 * (n - 1 - i))) & 0x7F) | ((i < (n - 1)) ? 0x80 : 0);
+  }
+
+  return n;
+}
+
+/*
+ * @retval              bytes read, 0 when the quantity is not complete
+ */
+static uint8_t Vlq_Read(const uint8_t *pSrc, uint32_t Max, uint32_t *pValue)
+{
+  uint8_t i;
+
+  *pValue = 0;
+  for(i = 0; (i < 4) && (i < Max); i++)
+  {
+    *pValue = (*pValue << 7) | (pSrc[i] & 0x7F);
+    if((pSrc[i] & 0x80) == 0)
+    {
+      return i + 1;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * @brief End of a log page program or sector erase
+ */
+static void Recorder_Log_Cb(Ext_Flash_Status_t Status, uint32_t Offset, uint32_t Size)
+{
+  if(Status != EXT_FLASH_OK)
+  {
+    /* The pages programmed are not valid, they are skipped by the save */
+    APP_DBG_MSG("Recorder : log error at 0x%lx\n\r", Offset);
+  }
+
+  if(Size == EXT_FLASH_SECTOR_SIZE)
+  {
+    Recorder_Context.Erasing = 0;
+  }
+  else
+  {
+    Recorder_Context.Done_Seq += Size / EXT_FLASH_PAGE_SIZE;
+  }
+
+  Recorder_Flush();
+  UTIL_SEQ_SetTask(1<<CFG_TASK_RECORDER, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief End of a song slot erase or program
+ */
+static void Recorder_Save_Cb(Ext_Flash_Status_t Status, uint32_t Offset, uint32_t Size)
+{
+  if(Status != EXT_FLASH_OK)
+  {
+    Recorder_Context.Save_Error = 1;
+  }
+  UTIL_SEQ_SetTask(1<<CFG_TASK_RECORDER, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Header of the song slot programmed and read back
+ */
+static void Recorder_Commit_Cb(Ext_Flash_Status_t Status)
+{
+  Recorder_End((Status == EXT_FLASH_OK) ? 0 : 1);
+
+  return;
+}
+
+/*
+ * @brief Timer callback to program the page being filled
+ */
+static void Recorder_Flush_Timer_Cb(void)
+{
+  Recorder_Context.Flush_Pending = 1;
+  UTIL_SEQ_SetTask(1<<CFG_TASK_RECORDER, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Recorder task, sequencer CFG_SCH_PRIO_1
+ */
+static void Recorder_Task(void)
+{
+  switch(Recorder_Context.State)
+  {
+    case RECORDER_RECORDING:
+      if(Recorder_Context.Flush_Pending)
+      {
+        Recorder_Context.Flush_Pending = 0;
+        Recorder_Page_Close();
+        Recorder_Flush();
+      }
+      break;
+
+    case RECORDER_STOPPING:
+      Recorder_Flush();
+      if((Recorder_Context.Done_Seq == Recorder_Context.Write_Seq) && EXT_FLASH_Is_Idle())
+      {
+        if(EXT_FLASH_Memory_Mapped_Enable() != EXT_FLASH_OK)
+        {
+          APP_DBG_MSG("Recorder : memory not mapped\n\r");
+          Recorder_Context.State = RECORDER_IDLE;
+        }
+        else if(Recorder_Context.Write_Seq == Recorder_Context.First_Seq)
+        {
+          APP_DBG_MSG("Recorder : empty take\n\r");
+          Recorder_Context.State = RECORDER_IDLE;
+        }
+        else
+        {
+          Recorder_Save(Recorder_Context.First_Seq, Recorder_Context.Write_Seq - 1);
+        }
+      }
+      break;
+
+    case RECORDER_COUNTING:
+      Recorder_Count();
+      break;
+
+    case RECORDER_ERASING:
+      Recorder_Erase();
+      break;
+
+    case RECORDER_WRITING:
+      Recorder_Write();
+      break;
+
+    case RECORDER_ENDING:
+      Recorder_Close();
+      break;
+
+    default:
+      break;
+  }
+
+  return;
+}
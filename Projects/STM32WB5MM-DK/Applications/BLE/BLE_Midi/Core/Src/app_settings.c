@@ -0,0 +1,376 @@
+/**
+  ******************************************************************************
+  * @file    app_settings.c
+  * @author  MCD Application Team
+  * @brief   Settings kept across resets in records of the external memory
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+#include "dbg_trace.h"
+#include "stm32_seq.h"
+#include "app_ext_flash.h"
+#include "app_song_store.h"
+#include "app_settings.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint32_t              Magic;                  /*!< SETTINGS_MAGIC */
+  uint32_t              Sequence;               /*!< Record number since the first one, gives its page */
+  uint16_t              Version;                /*!< SETTINGS_VERSION, the records of another layout are ignored */
+  uint16_t              Length;                 /*!< Size of the settings */
+  Settings_t            Settings;
+  uint32_t              Crc;                    /*!< CRC-32 of the fields above */
+} Settings_Record_t;
+
+typedef enum
+{
+  SETTINGS_IDLE,
+  SETTINGS_WRITING,                     /*!< Erase and program of the record queued */
+} Settings_State_t;
+
+typedef struct
+{
+  Settings_State_t      State;
+  uint8_t               Started;                /*!< SETTINGS_Init() called, the records may be written */
+  uint8_t               Save_Pending;           /*!< Settings changed since the last record written */
+  uint8_t               Tries;                  /*!< Records written and not read back since the save */
+  uint8_t               Retry_Timer_Id;
+  uint32_t              Write_Seq;              /*!< Next record */
+  uint32_t              Erased_Seq;             /*!< The pages of the records before are erased */
+  Settings_t            Settings;               /*!< Current settings, saved or to be saved */
+  Settings_Record_t     Record;                 /*!< Programmed from here, kept until the end of the job */
+} Settings_Context_t;
+
+/* Private defines -----------------------------------------------------------*/
+#define SETTINGS_MAGIC                  (0x53544553U)   /* "SETS" */
+#define SETTINGS_VERSION                (1U)
+
+#define SETTINGS_PAGES                  (SETTINGS_SIZE / EXT_FLASH_PAGE_SIZE)
+#define SETTINGS_SECTOR_PAGES           (EXT_FLASH_SECTOR_SIZE / EXT_FLASH_PAGE_SIZE)
+
+/* The memory mapped or busy with other jobs, the save is tried again after this time */
+#define SETTINGS_RETRY_PERIOD           (100*1000/CFG_TS_TICK_VAL)      /**< 100ms */
+
+/* Records written for a save not read back before giving up, each one in a new sector */
+#define SETTINGS_MAX_TRIES              (3U)
+
+/* Private variables ---------------------------------------------------------*/
+static Settings_Context_t Settings_Context;
+
+/* Private function prototypes -----------------------------------------------*/
+static void     Settings_Write(void);
+static void     Settings_End(void);
+static const Settings_Record_t * Record_Mapped(uint32_t Seq);
+static uint8_t  Record_Is_Valid(const Settings_Record_t *pRecord, uint32_t Seq);
+static uint32_t Record_Crc(const Settings_Record_t *pRecord);
+static void     Settings_Job_Cb(Ext_Flash_Status_t Status, uint32_t Offset, uint32_t Size);
+static void     Settings_Retry_Timer_Cb(void);
+static void     Settings_Task(void);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Read the last valid record, the settings are zero without one
+ * @note  The memory shall be mapped. Called at startup before the settings are used.
+ */
+void SETTINGS_Load(void)
+{
+  const Settings_Record_t *p_record;
+  const uint32_t *p_word;
+  uint32_t seq = 0;
+  uint32_t i;
+  uint8_t found = 0;
+
+  for(i = 0; i < SETTINGS_PAGES; i++)
+  {
+    p_record = Record_Mapped(i);
+    if(Record_Is_Valid(p_record, i) && (!found || (p_record->Sequence > seq)))
+    {
+      seq = p_record->Sequence;
+      found = 1;
+    }
+  }
+
+  if(!found)
+  {
+    memset(&Settings_Context.Settings, 0, sizeof(Settings_t));
+    Settings_Context.Write_Seq = 0;
+    Settings_Context.Erased_Seq = 0;
+  }
+  else
+  {
+    memcpy(&Settings_Context.Settings, &Record_Mapped(seq)->Settings, sizeof(Settings_t));
+    Settings_Context.Write_Seq = seq + 1;
+    Settings_Context.Erased_Seq = ((seq / SETTINGS_SECTOR_PAGES) + 1) * SETTINGS_SECTOR_PAGES;
+
+    /* A record cut by a reset : the next one goes to the other sector */
+    if(Settings_Context.Write_Seq != Settings_Context.Erased_Seq)
+    {
+      for(p_word = (const uint32_t *)Record_Mapped(Settings_Context.Write_Seq);
+          p_word < ((const uint32_t *)Record_Mapped(Settings_Context.Write_Seq) + (EXT_FLASH_PAGE_SIZE / 4));
+          p_word++)
+      {
+        if(*p_word != 0xFFFFFFFFU)
+        {
+          Settings_Context.Write_Seq = Settings_Context.Erased_Seq;
+          break;
+        }
+      }
+    }
+  }
+
+  if(found)
+  {
+    APP_DBG_MSG("Settings : record %ld\n\r", seq);
+  }
+  else
+  {
+    APP_DBG_MSG("Settings : no record\n\r");
+  }
+
+  return;
+}
+
+/*
+ * @brief Register the settings task and its timer, start the save requested until now
+ * @note  Called once the startup readers of the mapped memory are done
+ */
+void SETTINGS_Init(void)
+{
+  Settings_Context.State = SETTINGS_IDLE;
+
+  UTIL_SEQ_RegTask(1<<CFG_TASK_SETTINGS, UTIL_SEQ_RFU, Settings_Task);
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+        &Settings_Context.Retry_Timer_Id,
+        hw_ts_SingleShot,
+        Settings_Retry_Timer_Cb);
+
+  Settings_Context.Started = 1;
+  if(Settings_Context.Save_Pending)
+  {
+    UTIL_SEQ_SetTask(1<<CFG_TASK_SETTINGS, CFG_SCH_PRIO_1);
+  }
+
+  return;
+}
+
+/*
+ * @brief Current settings
+ */
+const Settings_t * SETTINGS_Get(void)
+{
+  return &Settings_Context.Settings;
+}
+
+/*
+ * @brief Change the settings, a new record is written in the background
+ * @note  Called from task context
+ */
+void SETTINGS_Save(const Settings_t *pSettings)
+{
+  memcpy(&Settings_Context.Settings, pSettings, sizeof(Settings_t));
+  Settings_Context.Save_Pending = 1;
+  Settings_Context.Tries = 0;
+
+  if(Settings_Context.Started)
+  {
+    UTIL_SEQ_SetTask(1<<CFG_TASK_SETTINGS, CFG_SCH_PRIO_1);
+  }
+
+  return;
+}
+
+/*
+ * @brief Queue the record of the current settings, and the erase of its sector when it is the
+ *        first one of the sector. The memory stays unmapped until the jobs are over.
+ */
+static void Settings_Write(void)
+{
+  Settings_Record_t *p_record = &Settings_Context.Record;
+  Ext_Flash_Status_t status = EXT_FLASH_OK;
+  uint32_t offset;
+
+  /* A song transfer or a take unmaps the memory */
+  if(!EXT_FLASH_Is_Memory_Mapped() || !EXT_FLASH_Is_Idle() || (EXT_FLASH_Memory_Mapped_Disable() != EXT_FLASH_OK))
+  {
+    HW_TS_Start(Settings_Context.Retry_Timer_Id, SETTINGS_RETRY_PERIOD);
+    return;
+  }
+
+  Settings_Context.Save_Pending = 0;
+  Settings_Context.Tries++;
+
+  memset(p_record, 0xFF, sizeof(Settings_Record_t));
+  p_record->Magic = SETTINGS_MAGIC;
+  p_record->Sequence = Settings_Context.Write_Seq;
+  p_record->Version = SETTINGS_VERSION;
+  p_record->Length = sizeof(Settings_t);
+  memcpy(&p_record->Settings, &Settings_Context.Settings, sizeof(Settings_t));
+  p_record->Crc = Record_Crc(p_record);
+
+  offset = SETTINGS_OFFSET + ((Settings_Context.Write_Seq % SETTINGS_PAGES) * EXT_FLASH_PAGE_SIZE);
+  if(Settings_Context.Write_Seq == Settings_Context.Erased_Seq)
+  {
+    status = EXT_FLASH_Erase_Sector(offset, Settings_Job_Cb);
+    if(status == EXT_FLASH_OK)
+    {
+      Settings_Context.Erased_Seq += SETTINGS_SECTOR_PAGES;
+    }
+  }
+  if(status == EXT_FLASH_OK)
+  {
+    status = EXT_FLASH_Program(offset, (const uint8_t *)p_record, sizeof(Settings_Record_t), Settings_Job_Cb);
+  }
+
+  /* The record is read back once the jobs queued are over */
+  Settings_Context.State = SETTINGS_WRITING;
+  if(status != EXT_FLASH_OK)
+  {
+    APP_DBG_MSG("Settings : flash job error\n\r");
+    UTIL_SEQ_SetTask(1<<CFG_TASK_SETTINGS, CFG_SCH_PRIO_1);
+  }
+
+  return;
+}
+
+/*
+ * @brief Map the memory again and read the record back, a record not read back is written again
+ *        in the next sector
+ */
+static void Settings_End(void)
+{
+  const Settings_Record_t *p_record;
+  uint32_t seq = Settings_Context.Write_Seq;
+
+  if(!EXT_FLASH_Is_Idle())
+  {
+    return;
+  }
+
+  /* Still writing until the memory is mapped again, the song player reads it */
+  if(EXT_FLASH_Memory_Mapped_Enable() != EXT_FLASH_OK)
+  {
+    APP_DBG_MSG("Settings : memory not mapped\n\r");
+    HW_TS_Start(Settings_Context.Retry_Timer_Id, SETTINGS_RETRY_PERIOD);
+    return;
+  }
+  Settings_Context.State = SETTINGS_IDLE;
+
+  p_record = Record_Mapped(seq);
+  if(Record_Is_Valid(p_record, seq) && (p_record->Sequence == seq) &&
+     (memcmp(&p_record->Settings, &Settings_Context.Record.Settings, sizeof(Settings_t)) == 0))
+  {
+    Settings_Context.Write_Seq++;
+    Settings_Context.Tries = 0;
+    APP_DBG_MSG("Settings : record %ld saved\n\r", seq);
+  }
+  else
+  {
+    Settings_Context.Write_Seq = Settings_Context.Erased_Seq;
+    if(Settings_Context.Tries < SETTINGS_MAX_TRIES)
+    {
+      Settings_Context.Save_Pending = 1;
+    }
+    APP_DBG_MSG("Settings : record %ld not saved\n\r", seq);
+  }
+
+  if(Settings_Context.Save_Pending)
+  {
+    UTIL_SEQ_SetTask(1<<CFG_TASK_SETTINGS, CFG_SCH_PRIO_1);
+  }
+
+  return;
+}
+
+/*
+ * @brief Record of a sequence number in the mapped memory
+ */
+static const Settings_Record_t * Record_Mapped(uint32_t Seq)
+{
+  return (const Settings_Record_t *)(EXT_FLASH_MAPPED_ADDRESS + SETTINGS_OFFSET +
+                                     ((Seq % SETTINGS_PAGES) * EXT_FLASH_PAGE_SIZE));
+}
+
+/*
+ * @brief Record of the expected page with the current layout and a good CRC
+ */
+static uint8_t Record_Is_Valid(const Settings_Record_t *pRecord, uint32_t Seq)
+{
+  return ((pRecord->Magic == SETTINGS_MAGIC) &&
+          ((pRecord->Sequence % SETTINGS_PAGES) == (Seq % SETTINGS_PAGES)) &&
+          (pRecord->Version == SETTINGS_VERSION) &&
+          (pRecord->Length == sizeof(Settings_t)) &&
+          (pRecord->Crc == Record_Crc(pRecord)));
+}
+
+/*
+ * @brief CRC-32 of the record without its CRC field
+ */
+static uint32_t Record_Crc(const Settings_Record_t *pRecord)
+{
+  return SONG_STORE_Crc32(0, (const uint8_t *)pRecord, offsetof(Settings_Record_t, Crc));
+}
+
+/*
+ * @brief End of the sector erase or of the record program
+ */
+static void Settings_Job_Cb(Ext_Flash_Status_t Status, uint32_t Offset, uint32_t Size)
+{
+  if(Status != EXT_FLASH_OK)
+  {
+    /* The record read back is not valid */
+    APP_DBG_MSG("Settings : flash error at 0x%lx\n\r", Offset);
+  }
+  UTIL_SEQ_SetTask(1<<CFG_TASK_SETTINGS, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Timer callback to try the save again
+ */
+static void Settings_Retry_Timer_Cb(void)
+{
+  UTIL_SEQ_SetTask(1<<CFG_TASK_SETTINGS, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Settings task, sequencer CFG_SCH_PRIO_1
+ */
+static void Settings_Task(void)
+{
+  switch(Settings_Context.State)
+  {
+    case SETTINGS_IDLE:
+      if(Settings_Context.Save_Pending)
+      {
+        Settings_Write();
+      }
+      break;
+
+    case SETTINGS_WRITING:
+      Settings_End();
+      break;
+
+    default:
+      break;
+  }
+
+  return;
+}
@@ -0,0 +1,287 @@
+/**
+  ******************************************************************************
+  * @file    app_song_store.c
+  * @author  MCD Application Team
+  * @brief   Slots of the midi files in the external memory and selection of
+  *          the active song
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+#include "dbg_trace.h"
+#include "app_ext_flash.h"
+#include "app_song_store.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint32_t              Magic;                  /*!< SONG_STORE_MAGIC */
+  uint32_t              Sequence;               /*!< Incremented at each commit, the highest valid slot is active */
+  uint32_t              Size;                   /*!< File size in bytes */
+  uint32_t              Crc;                    /*!< CRC-32 of the file */
+  uint32_t              Header_Crc;             /*!< CRC-32 of the fields above */
+} Song_Store_Header_t;
+
+typedef struct
+{
+  uint8_t               Active;                 /*!< Active slot, SONG_STORE_NO_SLOT for the legacy file */
+  uint32_t              Sequence;               /*!< Sequence number of the active slot */
+  uint32_t              Size;                   /*!< File size of the active slot */
+  uint8_t               Slot_Open;              /*!< The free slot is being written */
+  uint32_t              Commit_Slot;            /*!< Slot whose header is programmed */
+  Song_Store_Callback_t Commit_Callback;
+  Song_Store_Header_t   Commit_Header;          /*!< Programmed from here, kept until the end of the job */
+} Song_Store_Context_t;
+
+/* Private defines -----------------------------------------------------------*/
+#define SONG_STORE_MAGIC                (0x474E4F53U)   /* "SONG" */
+
+/* Private variables ---------------------------------------------------------*/
+static Song_Store_Context_t Song_Store_Context;
+
+static const uint32_t Song_Store_Slots[SONG_STORE_SLOT_NBR] =
+{
+  SONG_STORE_SLOT_0_OFFSET,
+  SONG_STORE_SLOT_1_OFFSET,
+};
+
+/* CRC-32 (IEEE 802.3, reflected 0xEDB88320) of a nibble */
+static const uint32_t Crc32_Table[16] =
+{
+  0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU, 0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+  0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU, 0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU,
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t Header_Is_Valid(const Song_Store_Header_t *pHeader);
+static void    Song_Store_Commit_cb(Ext_Flash_Status_t Status, uint32_t Offset, uint32_t Size);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Find the active song
+ * @note  The memory shall be mapped
+ */
+void SONG_STORE_Init(void)
+{
+  const Song_Store_Header_t *pHeader;
+  uint8_t i;
+
+  Song_Store_Context.Active = SONG_STORE_NO_SLOT;
+  Song_Store_Context.Sequence = 0;
+  Song_Store_Context.Size = 0;
+
+  for(i = 0; i < SONG_STORE_SLOT_NBR; i++)
+  {
+    pHeader = (const Song_Store_Header_t *)(EXT_FLASH_MAPPED_ADDRESS + Song_Store_Slots[i]);
+    if(Header_Is_Valid(pHeader) &&
+       ((Song_Store_Context.Active == SONG_STORE_NO_SLOT) || (pHeader->Sequence > Song_Store_Context.Sequence)))
+    {
+      Song_Store_Context.Active = i;
+      Song_Store_Context.Sequence = pHeader->Sequence;
+      Song_Store_Context.Size = pHeader->Size;
+    }
+  }
+
+  if(Song_Store_Context.Active != SONG_STORE_NO_SLOT)
+  {
+    APP_DBG_MSG("Song store : slot %d, %ld bytes, sequence %ld\n\r",
+                Song_Store_Context.Active, Song_Store_Context.Size, Song_Store_Context.Sequence);
+  }
+
+  return;
+}
+
+/*
+ * @brief Active midi file, read in place
+ * @note  The memory shall be mapped
+ *
+ * @param pSize         file size, 0 for the legacy file whose size is not known
+ *
+ * @retval              start of the file in the mapped memory
+ */
+const uint8_t * SONG_STORE_Get_Song(uint32_t *pSize)
+{
+  if(Song_Store_Context.Active == SONG_STORE_NO_SLOT)
+  {
+    *pSize = 0;
+    return (const uint8_t *)(EXT_FLASH_MAPPED_ADDRESS + SONG_STORE_LEGACY_OFFSET);
+  }
+
+  *pSize = Song_Store_Context.Size;
+  return (const uint8_t *)(EXT_FLASH_MAPPED_ADDRESS + Song_Store_Slots[Song_Store_Context.Active] + SONG_STORE_HEADER_SIZE);
+}
+
+/*
+ * @brief Slot to write the next file in, never the active one
+ *
+ * @retval              offset of the slot in the memory, the file starts SONG_STORE_HEADER_SIZE after
+ */
+uint32_t SONG_STORE_Get_Free_Slot(void)
+{
+  return (Song_Store_Context.Active == 0) ? Song_Store_Slots[1] : Song_Store_Slots[0];
+}
+
+/*
+ * @brief Reserve the free slot to write a new file, the song transfer and the recorder share it
+ *
+ * @param pSlot_Offset  offset of the slot, the file starts SONG_STORE_HEADER_SIZE after
+ *
+ * @retval              EXT_FLASH_BUSY when the slot is already being written
+ */
+Ext_Flash_Status_t SONG_STORE_Open_Slot(uint32_t *pSlot_Offset)
+{
+  if(Song_Store_Context.Slot_Open)
+  {
+    return EXT_FLASH_BUSY;
+  }
+
+  Song_Store_Context.Slot_Open = 1;
+  *pSlot_Offset = SONG_STORE_Get_Free_Slot();
+
+  return EXT_FLASH_OK;
+}
+
+/*
+ * @brief Release the free slot, after the commit or when the file is given up
+ */
+void SONG_STORE_Close_Slot(void)
+{
+  Song_Store_Context.Slot_Open = 0;
+
+  return;
+}
+
+/*
+ * @brief Make the file written in a slot the active song
+ * @note  The slot shall be erased but for the file, its CRC is already verified. Programming the
+ *        header is the only step that changes the active song : if it is cut, the header is not
+ *        valid and the previous song stays active.
+ *        The memory is unmapped until the callback, called from task context.
+ *
+ * @param Slot_Offset   offset of the slot, from SONG_STORE_Get_Free_Slot()
+ * @param Size          file size
+ * @param Crc           CRC-32 of the file
+ * @param Callback      called once the header is programmed and read back
+ *
+ * @retval              EXT_FLASH_OK when the header program is queued
+ */
+Ext_Flash_Status_t SONG_STORE_Commit(uint32_t Slot_Offset, uint32_t Size, uint32_t Crc, Song_Store_Callback_t Callback)
+{
+  Song_Store_Header_t *p_header = &Song_Store_Context.Commit_Header;
+  Ext_Flash_Status_t  status;
+
+  if((Slot_Offset != SONG_STORE_Get_Free_Slot()) || (Size == 0) || (Size > SONG_STORE_FILE_MAX_SIZE))
+  {
+    return EXT_FLASH_ERROR;
+  }
+
+  p_header->Magic = SONG_STORE_MAGIC;
+  p_header->Sequence = Song_Store_Context.Sequence + 1;
+  p_header->Size = Size;
+  p_header->Crc = Crc;
+  p_header->Header_Crc = SONG_STORE_Crc32(0, (const uint8_t *)p_header, offsetof(Song_Store_Header_t, Header_Crc));
+
+  Song_Store_Context.Commit_Slot = Slot_Offset;
+  Song_Store_Context.Commit_Callback = Callback;
+
+  status = EXT_FLASH_Memory_Mapped_Disable();
+  if(status == EXT_FLASH_OK)
+  {
+    status = EXT_FLASH_Program(Slot_Offset, (const uint8_t *)p_header, sizeof(Song_Store_Header_t), Song_Store_Commit_cb);
+  }
+  if(status != EXT_FLASH_OK)
+  {
+    EXT_FLASH_Memory_Mapped_Enable();
+  }
+
+  return status;
+}
+
+/*
+ * @brief CRC-32 as zlib crc32() and Python zlib.crc32(), with a 16 entries table
+ *
+ * @param Crc           0 for the first block, then the result of the previous block
+ * @param pData         data
+ * @param Size          number of bytes
+ *
+ * @retval              CRC-32 of the data so far
+ */
+uint32_t SONG_STORE_Crc32(uint32_t Crc, const uint8_t *pData, uint32_t Size)
+{
+  uint32_t i;
+
+  Crc = ~Crc;
+  for(i = 0; i < Size; i++)
+  {
+    Crc ^= pData[i];
+    Crc = Crc32_Table[Crc & 0x0FU] ^ (Crc >> 4);
+    Crc = Crc32_Table[Crc & 0x0FU] ^ (Crc >> 4);
+  }
+
+  return ~Crc;
+}
+
+/*
+ * @brief Check the magic number and the CRC of a slot header
+ *
+ * @retval              0 for an erased, partially programmed or corrupted header
+ */
+static uint8_t Header_Is_Valid(const Song_Store_Header_t *pHeader)
+{
+  if(pHeader->Magic != SONG_STORE_MAGIC)
+  {
+    return 0;
+  }
+  if(pHeader->Header_Crc != SONG_STORE_Crc32(0, (const uint8_t *)pHeader, offsetof(Song_Store_Header_t, Header_Crc)))
+  {
+    return 0;
+  }
+  if((pHeader->Size == 0) || (pHeader->Size > SONG_STORE_FILE_MAX_SIZE))
+  {
+    return 0;
+  }
+
+  return 1;
+}
+
+/*
+ * @brief Header programmed : map the memory again and read the header back
+ */
+static void Song_Store_Commit_cb(Ext_Flash_Status_t Status, uint32_t Offset, uint32_t Size)
+{
+  if(EXT_FLASH_Memory_Mapped_Enable() != EXT_FLASH_OK)
+  {
+    Status = EXT_FLASH_ERROR;
+  }
+
+  if(Status == EXT_FLASH_OK)
+  {
+    /* A header programmed on a page that was not erased is not valid */
+    SONG_STORE_Init();
+    if((Song_Store_Context.Active == SONG_STORE_NO_SLOT) ||
+       (Song_Store_Slots[Song_Store_Context.Active] != Song_Store_Context.Commit_Slot))
+    {
+      Status = EXT_FLASH_ERROR;
+    }
+  }
+
+  if(Song_Store_Context.Commit_Callback != NULL)
+  {
+    Song_Store_Context.Commit_Callback(Status);
+  }
+
+  return;
+}
@@ -0,0 +1,618 @@
+/**
+  ******************************************************************************
+  * @file    app_song_xfer.c
+  * @author  MCD Application Team
+  * @brief   Upload of a midi file over BLE in the song store of the external
+  *          memory
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+#include "dbg_trace.h"
+#include "ble.h"
+#include "stm32_seq.h"
+#include "song_xfer_stm.h"
+#include "app_ext_flash.h"
+#include "app_song_store.h"
+#include "app_midi.h"
+#include "app_latency.h"
+#include "app_song_xfer.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum
+{
+  SONG_XFER_IDLE,
+  SONG_XFER_RECEIVING,                  /*!< Data received, sectors erased and pages programmed */
+  SONG_XFER_VERIFYING,                  /*!< CRC of the file read back in the mapped memory */
+  SONG_XFER_COMMITTING,                 /*!< Header of the slot programmed */
+  SONG_XFER_ENDING,                     /*!< Waiting for the end of the flash jobs and the end report to be sent */
+} Song_Xfer_State_t;
+
+typedef struct
+{
+  Song_Xfer_State_t     State;
+  uint8_t               Poll_Timer_Id;          /*!< Task period while a transfer is in progress */
+  uint8_t               Erasing;                /*!< Sector erase queued and not over */
+  uint8_t               Ack_Pending;            /*!< Acknowledge to notify */
+  Song_Xfer_Status_t    End_Status;             /*!< Status of the end report */
+  uint16_t              ConnectionHandle;       /*!< Client of the transfer */
+  uint32_t              Slot;                   /*!< Offset of the slot written */
+  uint32_t              Size;                   /*!< File size announced by the client */
+  uint32_t              Crc;                    /*!< File CRC-32 announced by the client */
+  uint32_t              Received;               /*!< Bytes received */
+  uint32_t              Queued;                 /*!< Bytes queued to be programmed */
+  uint32_t              Programmed;             /*!< Bytes programmed */
+  uint32_t              Acked;                  /*!< Bytes programmed at the last acknowledge */
+  uint32_t              Verified;               /*!< Bytes read back */
+  uint32_t              Verify_Crc;             /*!< CRC-32 of the bytes read back */
+  uint32_t              Erase_Queued_End;       /*!< End of the sectors queued to be erased from the slot start */
+  uint32_t              Erase_End;              /*!< End of the sectors to erase from the slot start */
+  uint32_t              Start_Tick;             /*!< HAL_GetTick() at the start request */
+  uint32_t              Duration;               /*!< Transfer duration in ms */
+  uint8_t               Buffer[SONG_XFER_BUFFER_SIZE];
+} Song_Xfer_Context_t;
+
+/* Private defines -----------------------------------------------------------*/
+#define SONG_XFER_NO_LINK               (0xFFFFU)
+
+/* Period of the task while a transfer is in progress : end of erase, pending notifications */
+#define SONG_XFER_POLL_PERIOD           (5*1000/CFG_TS_TICK_VAL)        /**< 5ms */
+
+/* Bytes read back per task run, about 1 ms */
+#define SONG_XFER_VERIFY_CHUNK          (2048U)
+
+/* Private variables ---------------------------------------------------------*/
+static Song_Xfer_Context_t Song_Xfer_Context;
+
+/* Private function prototypes -----------------------------------------------*/
+static void Song_Xfer_Start(uint16_t ConnectionHandle, const uint8_t *pPayload, uint16_t Length);
+static void Song_Xfer_Data(uint16_t ConnectionHandle, const uint8_t *pPayload, uint16_t Length);
+static void Song_Xfer_End(Song_Xfer_Status_t Status);
+static void Song_Xfer_Program(void);
+static void Song_Xfer_Verify(void);
+static void Song_Xfer_Close(void);
+static void Song_Xfer_Erase_cb(Ext_Flash_Status_t Status, uint32_t Offset, uint32_t Size);
+static void Song_Xfer_Program_cb(Ext_Flash_Status_t Status, uint32_t Offset, uint32_t Size);
+static void Song_Xfer_Commit_cb(Ext_Flash_Status_t Status);
+static void Song_Xfer_Poll_cb(void);
+static void Song_Xfer_Task(void);
+static void Song_Xfer_Stats(void);
+static void Put_Le32(uint8_t *pDst, uint32_t Value);
+static uint32_t Get_Le32(const uint8_t *pSrc);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Add the song transfer service, its task and its timer
+ */
+void SONG_XFER_Init(void)
+{
+  Song_Xfer_Context.State = SONG_XFER_IDLE;
+  Song_Xfer_Context.ConnectionHandle = SONG_XFER_NO_LINK;
+
+  SONG_XFER_STM_Init();
+
+  UTIL_SEQ_RegTask(1<<CFG_TASK_SONG_XFER, UTIL_SEQ_RFU, Song_Xfer_Task);
+  HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+        &Song_Xfer_Context.Poll_Timer_Id,
+        hw_ts_Repeated,
+        Song_Xfer_Poll_cb);
+
+  return;
+}
+
+/*
+ * @brief A central is disconnected, its transfer is aborted
+ */
+void SONG_XFER_Disconnected(uint16_t ConnectionHandle)
+{
+  if((Song_Xfer_Context.State != SONG_XFER_IDLE) && (Song_Xfer_Context.ConnectionHandle == ConnectionHandle))
+  {
+    Song_Xfer_Context.ConnectionHandle = SONG_XFER_NO_LINK;
+    /* Once the header program is queued, the end comes with the commit callback */
+    if((Song_Xfer_Context.State != SONG_XFER_ENDING) && (Song_Xfer_Context.State != SONG_XFER_COMMITTING))
+    {
+      Song_Xfer_End(SONG_XFER_STATUS_ABORTED);
+    }
+  }
+
+  return;
+}
+
+/*
+ * @brief Requests and data written by a client, in the BLE events task
+ */
+void SONG_XFER_STM_App_Notification(Song_Xfer_STM_Notification_evt_t *pNotification)
+{
+  switch(pNotification->Evt_Opcode)
+  {
+    case SONG_XFER_STM_DATA_WRITE_EVT:
+      Song_Xfer_Data(pNotification->ConnectionHandle, pNotification->pPayload, pNotification->Length);
+      break;
+
+    case SONG_XFER_STM_CTRL_WRITE_EVT:
+      if((pNotification->Length > 0) && (pNotification->pPayload[0] == SONG_XFER_REQ_START))
+      {
+        Song_Xfer_Start(pNotification->ConnectionHandle, pNotification->pPayload, pNotification->Length);
+      }
+      else if((pNotification->Length > 0) && (pNotification->pPayload[0] == SONG_XFER_REQ_ABORT) &&
+              (pNotification->ConnectionHandle == Song_Xfer_Context.ConnectionHandle) &&
+              ((Song_Xfer_Context.State == SONG_XFER_RECEIVING) || (Song_Xfer_Context.State == SONG_XFER_VERIFYING)))
+      {
+        Song_Xfer_End(SONG_XFER_STATUS_ABORTED);
+      }
+      break;
+
+    case SONG_XFER_STM_STATS_READ_EVT:
+      Song_Xfer_Stats();
+      break;
+
+    default:
+      break;
+  }
+
+  return;
+}
+
+/*
+ * @brief Start request : the memory is unmapped and the sectors are erased as the data comes
+ */
+static void Song_Xfer_Start(uint16_t ConnectionHandle, const uint8_t *pPayload, uint16_t Length)
+{
+  uint8_t response[4];
+  Song_Xfer_Status_t status = SONG_XFER_STATUS_OK;
+  uint32_t size = 0;
+
+  if(Length < 9)
+  {
+    status = SONG_XFER_STATUS_PROTOCOL;
+  }
+  else if(Song_Xfer_Context.State != SONG_XFER_IDLE)
+  {
+    status = SONG_XFER_STATUS_BUSY;
+  }
+  else
+  {
+    size = Get_Le32(&pPayload[1]);
+    if((size == 0) || (size > SONG_STORE_FILE_MAX_SIZE))
+    {
+      status = SONG_XFER_STATUS_SIZE;
+    }
+    else if(!EXT_FLASH_Is_Memory_Mapped() || (SONG_STORE_Open_Slot(&Song_Xfer_Context.Slot) != EXT_FLASH_OK))
+    {
+      /* The memory is written by the recorder */
+      status = SONG_XFER_STATUS_BUSY;
+    }
+    else if(EXT_FLASH_Memory_Mapped_Disable() != EXT_FLASH_OK)
+    {
+      SONG_STORE_Close_Slot();
+      status = SONG_XFER_STATUS_FLASH;
+    }
+  }
+
+  if(status == SONG_XFER_STATUS_OK)
+  {
+    Song_Xfer_Context.State = SONG_XFER_RECEIVING;
+    Song_Xfer_Context.ConnectionHandle = ConnectionHandle;
+    Song_Xfer_Context.Size = size;
+    Song_Xfer_Context.Crc = Get_Le32(&pPayload[5]);
+    Song_Xfer_Context.Received = 0;
+    Song_Xfer_Context.Queued = 0;
+    Song_Xfer_Context.Programmed = 0;
+    Song_Xfer_Context.Acked = 0;
+    Song_Xfer_Context.Ack_Pending = 0;
+    Song_Xfer_Context.Erasing = 0;
+    Song_Xfer_Context.Erase_Queued_End = 0;
+    Song_Xfer_Context.Erase_End = ((SONG_STORE_HEADER_SIZE + size + EXT_FLASH_SECTOR_SIZE - 1) / EXT_FLASH_SECTOR_SIZE) * EXT_FLASH_SECTOR_SIZE;
+    Song_Xfer_Context.Start_Tick = HAL_GetTick();
+
+    HW_TS_Start(Song_Xfer_Context.Poll_Timer_Id, SONG_XFER_POLL_PERIOD);
+    UTIL_SEQ_SetTask(1<<CFG_TASK_SONG_XFER, CFG_SCH_PRIO_1);
+    APP_DBG_MSG("Song transfer : %ld bytes in slot 0x%lx\n\r", size, Song_Xfer_Context.Slot);
+  }
+
+  response[0] = SONG_XFER_REQ_START | SONG_XFER_RESPONSE;
+  response[1] = status;
+  response[2] = (uint8_t)(SONG_XFER_WINDOW & 0xFFU);
+  response[3] = (uint8_t)(SONG_XFER_WINDOW >> 8);
+  SONG_XFER_STM_Notify(ConnectionHandle, response, sizeof(response));
+
+  return;
+}
+
+/*
+ * @brief File data : copied in the reception buffer, queued to be programmed by the task
+ * @note  Writes of a previous transfer still in flight after an abort are ignored
+ */
+static void Song_Xfer_Data(uint16_t ConnectionHandle, const uint8_t *pPayload, uint16_t Length)
+{
+  uint32_t index;
+  uint32_t first;
+
+  if((Song_Xfer_Context.State != SONG_XFER_RECEIVING) || (Song_Xfer_Context.ConnectionHandle != ConnectionHandle))
+  {
+    return;
+  }
+
+  if(((Song_Xfer_Context.Received + Length) > Song_Xfer_Context.Size) ||
+     ((Song_Xfer_Context.Received + Length - Song_Xfer_Context.Programmed) > SONG_XFER_BUFFER_SIZE))
+  {
+    Song_Xfer_End(SONG_XFER_STATUS_PROTOCOL);
+    return;
+  }
+
+  index = Song_Xfer_Context.Received % SONG_XFER_BUFFER_SIZE;
+  first = SONG_XFER_BUFFER_SIZE - index;
+  if(first > Length)
+  {
+    first = Length;
+  }
+  memcpy(&Song_Xfer_Context.Buffer[index], pPayload, first);
+  memcpy(&Song_Xfer_Context.Buffer[0], &pPayload[first], Length - first);
+  Song_Xfer_Context.Received += Length;
+
+  UTIL_SEQ_SetTask(1<<CFG_TASK_SONG_XFER, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief End of the transfer, the end report is sent by the task once the memory is mapped again
+ */
+static void Song_Xfer_End(Song_Xfer_Status_t Status)
+{
+  Song_Xfer_Context.State = SONG_XFER_ENDING;
+  Song_Xfer_Context.End_Status = Status;
+  Song_Xfer_Context.Ack_Pending = 0;
+  Song_Xfer_Context.Duration = HAL_GetTick() - Song_Xfer_Context.Start_Tick;
+  UTIL_SEQ_SetTask(1<<CFG_TASK_SONG_XFER, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Queue the program of the data received, or the erase of the next sector ahead of the data
+ * @note  The flash jobs run in order : data queued after the erase of its sector is programmed once
+ *        the sector is erased. When no data can be queued, the next sector is erased while the radio
+ *        fills the buffer. When the queue is full, the next job callback sets the task again.
+ */
+static void Song_Xfer_Program(void)
+{
+  Ext_Flash_Status_t status = EXT_FLASH_OK;
+  uint32_t queued;
+  uint32_t length;
+
+  if(Song_Xfer_Context.Programmed == Song_Xfer_Context.Size)
+  {
+    status = EXT_FLASH_Memory_Mapped_Enable();
+    if(status == EXT_FLASH_ERROR)
+    {
+      Song_Xfer_End(SONG_XFER_STATUS_FLASH);
+    }
+    else if(status == EXT_FLASH_OK)
+    {
+      Song_Xfer_Context.State = SONG_XFER_VERIFYING;
+      Song_Xfer_Context.Verified = 0;
+      Song_Xfer_Context.Verify_Crc = 0;
+      UTIL_SEQ_SetTask(1<<CFG_TASK_SONG_XFER, CFG_SCH_PRIO_1);
+    }
+    return;
+  }
+
+  while(status == EXT_FLASH_OK)
+  {
+    /*
+     * The file starts on a page boundary : whole pages but for the end of the file, up to the end
+     * of the buffer and of the sectors queued to be erased
+     */
+    queued = Song_Xfer_Context.Queued;
+    length = Song_Xfer_Context.Received - queued;
+    if((queued + length) != Song_Xfer_Context.Size)
+    {
+      length -= length % EXT_FLASH_PAGE_SIZE;
+    }
+    if(length > (SONG_XFER_BUFFER_SIZE - (queued % SONG_XFER_BUFFER_SIZE)))
+    {
+      length = SONG_XFER_BUFFER_SIZE - (queued % SONG_XFER_BUFFER_SIZE);
+    }
+    if((SONG_STORE_HEADER_SIZE + queued) >= Song_Xfer_Context.Erase_Queued_End)
+    {
+      length = 0;
+    }
+    else if(length > (Song_Xfer_Context.Erase_Queued_End - SONG_STORE_HEADER_SIZE - queued))
+    {
+      length = Song_Xfer_Context.Erase_Queued_End - SONG_STORE_HEADER_SIZE - queued;
+    }
+
+    if(length != 0)
+    {
+      status = EXT_FLASH_Program(Song_Xfer_Context.Slot + SONG_STORE_HEADER_SIZE + queued,
+                                 &Song_Xfer_Context.Buffer[queued % SONG_XFER_BUFFER_SIZE],
+                                 length,
+                                 Song_Xfer_Program_cb);
+      if(status == EXT_FLASH_OK)
+      {
+        Song_Xfer_Context.Queued += length;
+      }
+    }
+    else if(!Song_Xfer_Context.Erasing && (Song_Xfer_Context.Erase_Queued_End < Song_Xfer_Context.Erase_End))
+    {
+      status = EXT_FLASH_Erase_Sector(Song_Xfer_Context.Slot + Song_Xfer_Context.Erase_Queued_End, Song_Xfer_Erase_cb);
+      if(status == EXT_FLASH_OK)
+      {
+        Song_Xfer_Context.Erase_Queued_End += EXT_FLASH_SECTOR_SIZE;
+        Song_Xfer_Context.Erasing = 1;
+      }
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  if(status == EXT_FLASH_ERROR)
+  {
+    Song_Xfer_End(SONG_XFER_STATUS_FLASH);
+  }
+
+  return;
+}
+
+/*
+ * @brief End of a sector erase, the data waiting for it is queued by the task
+ */
+static void Song_Xfer_Erase_cb(Ext_Flash_Status_t Status, uint32_t Offset, uint32_t Size)
+{
+  Song_Xfer_Context.Erasing = 0;
+
+  if(Song_Xfer_Context.State == SONG_XFER_RECEIVING)
+  {
+    if(Status != EXT_FLASH_OK)
+    {
+      Song_Xfer_End(SONG_XFER_STATUS_FLASH);
+      return;
+    }
+    UTIL_SEQ_SetTask(1<<CFG_TASK_SONG_XFER, CFG_SCH_PRIO_1);
+  }
+
+  return;
+}
+
+/*
+ * @brief Data programmed : its room in the buffer is free, the client is acknowledged by steps
+ */
+static void Song_Xfer_Program_cb(Ext_Flash_Status_t Status, uint32_t Offset, uint32_t Size)
+{
+  if(Song_Xfer_Context.State != SONG_XFER_RECEIVING)
+  {
+    return;
+  }
+  if(Status != EXT_FLASH_OK)
+  {
+    Song_Xfer_End(SONG_XFER_STATUS_FLASH);
+    return;
+  }
+
+  Song_Xfer_Context.Programmed += Size;
+  if(((Song_Xfer_Context.Programmed - Song_Xfer_Context.Acked) >= SONG_XFER_ACK_STEP) ||
+     (Song_Xfer_Context.Programmed == Song_Xfer_Context.Size))
+  {
+    Song_Xfer_Context.Ack_Pending = 1;
+  }
+  UTIL_SEQ_SetTask(1<<CFG_TASK_SONG_XFER, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Read back the file in the mapped memory by chunks, then make it the active song
+ */
+static void Song_Xfer_Verify(void)
+{
+  uint32_t length;
+
+  length = Song_Xfer_Context.Size - Song_Xfer_Context.Verified;
+  if(length > SONG_XFER_VERIFY_CHUNK)
+  {
+    length = SONG_XFER_VERIFY_CHUNK;
+  }
+  Song_Xfer_Context.Verify_Crc = SONG_STORE_Crc32(Song_Xfer_Context.Verify_Crc,
+                                                  (const uint8_t *)(EXT_FLASH_MAPPED_ADDRESS + Song_Xfer_Context.Slot +
+                                                                    SONG_STORE_HEADER_SIZE + Song_Xfer_Context.Verified),
+                                                  length);
+  Song_Xfer_Context.Verified += length;
+
+  if(Song_Xfer_Context.Verified < Song_Xfer_Context.Size)
+  {
+    UTIL_SEQ_SetTask(1<<CFG_TASK_SONG_XFER, CFG_SCH_PRIO_1);
+  }
+  else if(Song_Xfer_Context.Verify_Crc != Song_Xfer_Context.Crc)
+  {
+    Song_Xfer_End(SONG_XFER_STATUS_CRC);
+  }
+  else if(SONG_STORE_Commit(Song_Xfer_Context.Slot, Song_Xfer_Context.Size, Song_Xfer_Context.Crc,
+                            Song_Xfer_Commit_cb) != EXT_FLASH_OK)
+  {
+    Song_Xfer_End(SONG_XFER_STATUS_FLASH);
+  }
+  else
+  {
+    Song_Xfer_Context.State = SONG_XFER_COMMITTING;
+  }
+
+  return;
+}
+
+/*
+ * @brief Header of the slot programmed and read back, the new song is played
+ */
+static void Song_Xfer_Commit_cb(Ext_Flash_Status_t Status)
+{
+  if(Status != EXT_FLASH_OK)
+  {
+    Song_Xfer_End(SONG_XFER_STATUS_FLASH);
+    return;
+  }
+
+  Song_Xfer_End(SONG_XFER_STATUS_OK);
+  Midi_Reload_Song();
+
+  return;
+}
+
+/*
+ * @brief Map the memory again once the flash jobs queued are over and send the end report
+ */
+static void Song_Xfer_Close(void)
+{
+  uint8_t report[14];
+  uint32_t rate;
+
+  if(!EXT_FLASH_Is_Idle())
+  {
+    /* Checked again at the next poll */
+    return;
+  }
+
+  if(EXT_FLASH_Memory_Mapped_Enable() != EXT_FLASH_OK)
+  {
+    APP_DBG_MSG("Song transfer : memory not mapped\n\r");
+  }
+
+  rate = (Song_Xfer_Context.Duration != 0) ?
+         (uint32_t)(((uint64_t)Song_Xfer_Context.Programmed * 1000U) / Song_Xfer_Context.Duration) : 0;
+
+  if(Song_Xfer_Context.ConnectionHandle != SONG_XFER_NO_LINK)
+  {
+    report[0] = SONG_XFER_REPORT_END;
+    report[1] = Song_Xfer_Context.End_Status;
+    Put_Le32(&report[2], Song_Xfer_Context.Programmed);
+    Put_Le32(&report[6], Song_Xfer_Context.Duration);
+    Put_Le32(&report[10], rate);
+    if(SONG_XFER_STM_Notify(Song_Xfer_Context.ConnectionHandle, report, sizeof(report)) == BLE_STATUS_INSUFFICIENT_RESOURCES)
+    {
+      /* Sent again at the next poll */
+      return;
+    }
+  }
+
+  APP_DBG_MSG("Song transfer : status %d, %ld bytes in %ld ms, %ld bytes/s\n\r",
+              Song_Xfer_Context.End_Status, Song_Xfer_Context.Programmed, Song_Xfer_Context.Duration, rate);
+
+  SONG_STORE_Close_Slot();
+  Song_Xfer_Context.State = SONG_XFER_IDLE;
+  Song_Xfer_Context.ConnectionHandle = SONG_XFER_NO_LINK;
+  HW_TS_Stop(Song_Xfer_Context.Poll_Timer_Id);
+
+  return;
+}
+
+/*
+ * @brief Timer callback to set the transfer task
+ */
+static void Song_Xfer_Poll_cb(void)
+{
+  UTIL_SEQ_SetTask(1<<CFG_TASK_SONG_XFER, CFG_SCH_PRIO_1);
+
+  return;
+}
+
+/*
+ * @brief Transfer task, sequencer CFG_SCH_PRIO_1 : the programs and erases run under interrupt,
+ *        one read back chunk per run so that the Midi tasks are not delayed by more than about 1 ms
+ */
+static void Song_Xfer_Task(void)
+{
+  uint8_t report[5];
+
+  switch(Song_Xfer_Context.State)
+  {
+    case SONG_XFER_RECEIVING:
+      Song_Xfer_Program();
+      break;
+
+    case SONG_XFER_VERIFYING:
+      Song_Xfer_Verify();
+      break;
+
+    case SONG_XFER_ENDING:
+      Song_Xfer_Close();
+      break;
+
+    default:
+      break;
+  }
+
+  if(Song_Xfer_Context.Ack_Pending)
+  {
+    report[0] = SONG_XFER_REPORT_ACK;
+    Put_Le32(&report[1], Song_Xfer_Context.Programmed);
+    if(SONG_XFER_STM_Notify(Song_Xfer_Context.ConnectionHandle, report, sizeof(report)) != BLE_STATUS_INSUFFICIENT_RESOURCES)
+    {
+      Song_Xfer_Context.Acked = Song_Xfer_Context.Programmed;
+      Song_Xfer_Context.Ack_Pending = 0;
+    }
+  }
+
+  return;
+}
+
+/*
+ * @brief Statistics read by a client : the latency of each stage of the Midi path since the last reset
+ */
+static void Song_Xfer_Stats(void)
+{
+  uint8_t stats[SONG_XFER_STATS_HEADER_SIZE + (LATENCY_STAGE_NBR * SONG_XFER_STATS_STAGE_SIZE)];
+  uint8_t size = SONG_XFER_STATS_HEADER_SIZE;
+  uint16_t load = 0;
+#if (CFG_LATENCY_PROBES != 0)
+  Latency_Stats_t stage_stats;
+  uint32_t stage;
+
+  for(stage = 0; stage < LATENCY_STAGE_NBR; stage++)
+  {
+    LATENCY_Get_Stats((Latency_Stage_t)stage, &stage_stats);
+    Put_Le32(&stats[size], stage_stats.Count);
+    Put_Le32(&stats[size + 4], stage_stats.Min_Us);
+    Put_Le32(&stats[size + 8], stage_stats.Avg_Us);
+    Put_Le32(&stats[size + 12], stage_stats.Max_Us);
+    Put_Le32(&stats[size + 16], stage_stats.P99_Us);
+    size += SONG_XFER_STATS_STAGE_SIZE;
+  }
+  load = LATENCY_Get_Cpu_Load();
+#endif
+
+  stats[0] = (uint8_t)((size - SONG_XFER_STATS_HEADER_SIZE) / SONG_XFER_STATS_STAGE_SIZE);
+  stats[1] = (uint8_t)(load & 0xFFU);
+  stats[2] = (uint8_t)(load >> 8);
+  SONG_XFER_STM_Update_Stats(stats, size);
+
+  return;
+}
+
+static void Put_Le32(uint8_t *pDst, uint32_t Value)
+{
+  pDst[0] = (uint8_t)Value;
+  pDst[1] = (uint8_t)(Value >> 8);
+  pDst[2] = (uint8_t)(Value >> 16);
+  pDst[3] = (uint8_t)(Value >> 24);
+
+  return;
+}
+
+static uint32_t Get_Le32(const uint8_t *pSrc)
+{
+  return (uint32_t)pSrc[0] | ((uint32_t)pSrc[1] << 8) | ((uint32_t)pSrc[2] << 16) | ((uint32_t)pSrc[3] << 24);
+}
@@ -0,0 +1,221 @@
+/**
+  ******************************************************************************
+  * @file    app_trace.c
+  * @author  MCD Application Team
+  * @brief   Binary deferred traces : records are stored in RAM by the
+  *          application and sent on the trace UART when the CPU is idle
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+#include "dbg_trace.h"
+#include "utilities_conf.h"
+#include "stm32_lpm.h"
+#include "hw_if.h"
+#include "app_trace.h"
+#include "app_hostctl.h"
+
+#if (CFG_DEBUG_TRACE_BINARY != 0)
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint32_t              Buffer[TRACE_BUFFER_WORDS];     /*!< Records ring */
+  volatile uint32_t     Head;                           /*!< Words written since start */
+  volatile uint32_t     Tail;                           /*!< Words sent since start */
+  volatile uint32_t     Tx_Words;                       /*!< Words being sent by DMA, 0 when idle */
+  uint32_t              Lost;                           /*!< Records dropped since the last lost record */
+} Trace_Context_t;
+
+/* Private defines -----------------------------------------------------------*/
+#define TRACE_BUFFER_MASK               (TRACE_BUFFER_WORDS - 1U)
+
+/* Header : sync byte, number of arguments and the low 16 bits of the millisecond tick */
+#define TRACE_HEADER(nargs, tick)       (TRACE_SYNC | ((uint32_t)(nargs) << 8) | ((uint32_t)(tick) << 16))
+
+/* Padding written up to the end of the ring when a record does not fit before it */
+#define TRACE_PADDING                   (0x00000000U)
+
+/* Private variables ---------------------------------------------------------*/
+static Trace_Context_t Trace_Context;
+
+static const char TRACE_FMT_SECTION Trace_Lost_Fmt[] = "<%lu trace records lost>\n\r";
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t Trace_Write(const char *pFmt, uint8_t Nargs, const uint32_t *pArgs, uint32_t Tick);
+#if (CFG_DEBUG_TRACE == 0)
+static void Trace_Tx_Cplt_cb(void);
+#endif
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Initialize the binary traces
+ */
+void TRACE_Init(void)
+{
+#if (CFG_DEBUG_TRACE == 0)
+  /* The text traces are disabled, the UART is owned by the binary traces */
+  MX_USART1_UART_Init();
+#endif
+
+  return;
+}
+
+/*
+ * @brief Record a trace, called through the APP_TRACEn macros
+ * @note  Can be called from interrupt context. The record is dropped when the
+ *        ring is full and the number of dropped records is reported later.
+ *
+ * @param pFmt          format string, only its address is stored
+ * @param Nargs         number of arguments, up to 4
+ * @param pArgs         arguments
+ */
+void TRACE_Record(const char *pFmt, uint8_t Nargs, const uint32_t *pArgs)
+{
+  uint32_t tick = HAL_GetTick();
+
+  UTILS_ENTER_CRITICAL_SECTION();
+  if((Trace_Context.Lost != 0) && (Trace_Write(Trace_Lost_Fmt, 1, (const uint32_t *)&Trace_Context.Lost, tick) != 0))
+  {
+    Trace_Context.Lost = 0;
+  }
+  if((Trace_Context.Lost != 0) || (Trace_Write(pFmt, Nargs, pArgs, tick) == 0))
+  {
+    Trace_Context.Lost++;
+  }
+  UTILS_EXIT_CRITICAL_SECTION();
+
+  return;
+}
+
+/*
+ * @brief Send the recorded traces, called when the sequencer has nothing else to do
+ */
+void TRACE_Drain(void)
+{
+  uint32_t index;
+  uint32_t words;
+
+  if((Trace_Context.Tx_Words != 0) || (Trace_Context.Tail == Trace_Context.Head))
+  {
+    return;
+  }
+
+  /* Contiguous part of the ring, records never wrap */
+  index = Trace_Context.Tail & TRACE_BUFFER_MASK;
+  words = Trace_Context.Head - Trace_Context.Tail;
+  if(words > (TRACE_BUFFER_WORDS - index))
+  {
+    words = TRACE_BUFFER_WORDS - index;
+  }
+  if(words > TRACE_DRAIN_MAX_WORDS)
+  {
+    words = TRACE_DRAIN_MAX_WORDS;
+  }
+
+#if (CFG_DEBUG_TRACE != 0)
+  /* Shared with the text traces : the block is copied in their queue */
+  DbgTraceWrite(1U, (const unsigned char *)&Trace_Context.Buffer[index], words * sizeof(uint32_t));
+  Trace_Context.Tail += words;
+#else
+  Trace_Context.Tx_Words = words;
+  UTIL_LPM_SetStopMode(1 << CFG_LPM_APP_TRACE, UTIL_LPM_DISABLE);
+  if(HW_UART_Transmit_DMA(CFG_DEBUG_TRACE_UART,
+                          (uint8_t *)&Trace_Context.Buffer[index],
+                          words * sizeof(uint32_t),
+                          Trace_Tx_Cplt_cb) != hw_uart_ok)
+  {
+    Trace_Context.Tx_Words = 0;
+    UTIL_LPM_SetStopMode(1 << CFG_LPM_APP_TRACE, UTIL_LPM_ENABLE);
+  }
+#endif
+
+  return;
+}
+
+/*
+ * @brief Write a record in the ring
+ * @note  Called in critical section
+ *
+ * @param pFmt          format string
+ * @param Nargs         number of arguments
+ * @param pArgs         arguments
+ * @param Tick          time of the record
+ *
+ * @retval              0 when there is no room for the record
+ */
+static uint8_t Trace_Write(const char *pFmt, uint8_t Nargs, const uint32_t *pArgs, uint32_t Tick)
+{
+  uint32_t needed = 2U + Nargs;
+  uint32_t index = Trace_Context.Head & TRACE_BUFFER_MASK;
+  uint32_t padding = 0;
+  uint8_t i;
+
+  if((index + needed) > TRACE_BUFFER_WORDS)
+  {
+    padding = TRACE_BUFFER_WORDS - index;
+  }
+  if((Trace_Context.Head - Trace_Context.Tail + padding + needed) > TRACE_BUFFER_WORDS)
+  {
+    return 0;
+  }
+
+  for(i = 0; i < padding; i++)
+  {
+    Trace_Context.Buffer[index + i] = TRACE_PADDING;
+  }
+  Trace_Context.Head += padding;
+  index = Trace_Context.Head & TRACE_BUFFER_MASK;
+
+  Trace_Context.Buffer[index++] = TRACE_HEADER(Nargs, Tick & 0xFFFFU);
+  Trace_Context.Buffer[index++] = (uint32_t)pFmt;
+  for(i = 0; i < Nargs; i++)
+  {
+    Trace_Context.Buffer[index++] = pArgs[i];
+  }
+  Trace_Context.Head += needed;
+
+  return 1;
+}
+
+#if (CFG_DEBUG_TRACE == 0)
+/*
+ * @brief Block sent on the UART
+ * @note  Called under the DMA interrupt, the next block is sent at the next idle time
+ */
+static void Trace_Tx_Cplt_cb(void)
+{
+  Trace_Context.Tail += Trace_Context.Tx_Words;
+  Trace_Context.Tx_Words = 0;
+  UTIL_LPM_SetStopMode(1 << CFG_LPM_APP_TRACE, UTIL_LPM_ENABLE);
+  HOSTCTL_Uart_Tx_Done();
+
+  return;
+}
+#endif
+
+#else
+
+void TRACE_Init(void)
+{
+  return;
+}
+
+void TRACE_Drain(void)
+{
+  return;
+}
+
+#endif /* CFG_DEBUG_TRACE_BINARY */
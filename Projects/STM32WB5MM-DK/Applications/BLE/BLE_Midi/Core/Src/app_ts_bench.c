@@ -0,0 +1,207 @@
+/**
+  ******************************************************************************
+  * @file    app_ts_bench.c
+  * @author  MCD Application Team
+  * @brief   Timer server benchmark : worst case of the RTC wakeup interrupt,
+  *          HW_TS_Start() and HW_TS_Stop() with the timers of the application
+  *          and timers restarted at random
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+#include "dbg_trace.h"
+#include "stm32_seq.h"
+#include "app_ts_bench.h"
+
+#if (CFG_HW_TS_BENCHMARK != 0)
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint8_t               Timer_Id[TS_BENCH_TIMER_NBR];
+  uint8_t               Timer_Nbr;              /*!< Benchmark timers created */
+  uint8_t               End_Timer_Id;
+  uint32_t              Random;                 /*!< Pseudo random timeouts */
+} Ts_Bench_Context_t;
+
+/* Private variables ---------------------------------------------------------*/
+static Ts_Bench_Context_t Ts_Bench_Context;
+
+/* Private function prototypes -----------------------------------------------*/
+static void     Ts_Bench_cb(void);
+static void     Ts_Bench_End_cb(void);
+static uint32_t Ts_Bench_Random(void);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Clear the timer server measures and register the report task
+ */
+void TS_BENCH_Init(void)
+{
+  UTIL_SEQ_RegTask(1<<CFG_TASK_TS_BENCH, UTIL_SEQ_RFU, TS_BENCH_Report);
+  HW_TS_Benchmark_Reset();
+
+  return;
+}
+
+/*
+ * @brief Load the timer server with up to TS_BENCH_TIMER_NBR timers restarted at random
+ *        for TS_BENCH_DURATION, then print the report
+ * @note  Build with CFG_HW_TS_TIMING_WHEEL set to 0 and 1 to compare the worst case of both
+ *        implementations
+ */
+void TS_BENCH_Start(void)
+{
+  uint8_t i;
+
+  if(Ts_Bench_Context.Timer_Nbr != 0)
+  {
+    return;
+  }
+
+  if(HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+                  &Ts_Bench_Context.End_Timer_Id,
+                  hw_ts_SingleShot,
+                  Ts_Bench_End_cb) != hw_ts_Successful)
+  {
+    APP_DBG_MSG("Timer server benchmark : no timer left\n\r");
+    return;
+  }
+
+  Ts_Bench_Context.Random = DWT->CYCCNT;
+  while((Ts_Bench_Context.Timer_Nbr < TS_BENCH_TIMER_NBR) &&
+        (HW_TS_Create(CFG_TIM_PROC_ID_ISR,
+                      &Ts_Bench_Context.Timer_Id[Ts_Bench_Context.Timer_Nbr],
+                      hw_ts_Repeated,
+                      Ts_Bench_cb) == hw_ts_Successful))
+  {
+    Ts_Bench_Context.Timer_Nbr++;
+  }
+
+  APP_DBG_MSG("Timer server benchmark with %d more timers\n\r", Ts_Bench_Context.Timer_Nbr);
+  HW_TS_Benchmark_Reset();
+  for(i = 0; i < Ts_Bench_Context.Timer_Nbr; i++)
+  {
+    HW_TS_Start(Ts_Bench_Context.Timer_Id[i], Ts_Bench_Random());
+  }
+  HW_TS_Start(Ts_Bench_Context.End_Timer_Id, TS_BENCH_DURATION);
+
+  return;
+}
+
+/*
+ * @brief Clear the worst cases recorded by the timer server
+ */
+void TS_BENCH_Reset(void)
+{
+  HW_TS_Benchmark_Reset();
+
+  return;
+}
+
+/*
+ * @brief Print the worst cases recorded by the timer server since the last reset
+ */
+void TS_BENCH_Report(void)
+{
+  HW_TS_Benchmark_t timer_benchmark;
+
+  HW_TS_Benchmark_Get(&timer_benchmark);
+  APP_DBG_MSG("Timer server (%s) : %d timers max, %ld interrupts, max cycles isr %ld start %ld stop %ld\n\r",
+              (CFG_HW_TS_TIMING_WHEEL == 1) ? "wheel" : "list",
+              timer_benchmark.RunningMax,
+              timer_benchmark.IsrCount,
+              timer_benchmark.IsrMaxCycles,
+              timer_benchmark.StartMaxCycles,
+              timer_benchmark.StopMaxCycles);
+
+  return;
+}
+
+/*
+ * @brief Benchmark timer elapsed : restart another one, as a note off timer would be
+ * @note  Called under the RTC interrupt
+ */
+static void Ts_Bench_cb(void)
+{
+  uint32_t random = Ts_Bench_Random();
+
+  HW_TS_Start(Ts_Bench_Context.Timer_Id[random % Ts_Bench_Context.Timer_Nbr], random);
+
+  return;
+}
+
+/*
+ * @brief End of the benchmark : release the timers and print the report
+ * @note  Called under the RTC interrupt
+ */
+static void Ts_Bench_End_cb(void)
+{
+  uint8_t i;
+
+  for(i = 0; i < Ts_Bench_Context.Timer_Nbr; i++)
+  {
+    HW_TS_Delete(Ts_Bench_Context.Timer_Id[i]);
+  }
+  HW_TS_Delete(Ts_Bench_Context.End_Timer_Id);
+  Ts_Bench_Context.Timer_Nbr = 0;
+
+  UTIL_SEQ_SetTask(1<<CFG_TASK_TS_BENCH, CFG_SCH_PRIO_2);
+
+  return;
+}
+
+/*
+ * @brief Pseudo random timeout of the benchmark timers (xorshift)
+ *
+ * @retval              timeout in timer server ticks, 1 to TS_BENCH_MAX_TIMEOUT
+ */
+static uint32_t Ts_Bench_Random(void)
+{
+  uint32_t x = Ts_Bench_Context.Random;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  Ts_Bench_Context.Random = (x != 0) ? x : 1U;
+
+  return ((x % TS_BENCH_MAX_TIMEOUT) + 1U);
+}
+
+#else
+
+void TS_BENCH_Init(void)
+{
+  return;
+}
+
+void TS_BENCH_Start(void)
+{
+  APP_DBG_MSG("Timer server benchmark : CFG_HW_TS_BENCHMARK is 0\n\r");
+
+  return;
+}
+
+void TS_BENCH_Reset(void)
+{
+  return;
+}
+
+void TS_BENCH_Report(void)
+{
+  return;
+}
+
+#endif /* CFG_HW_TS_BENCHMARK */
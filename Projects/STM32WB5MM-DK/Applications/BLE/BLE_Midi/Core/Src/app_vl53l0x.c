@@ -24,6 +24,9 @@
 #include "stm32wb5mm_dk.h"
 #include "stm32wb5mm_dk_lcd.h"
 #include "stm32_lcd.h"
+#include "app_lcd_text.h"
+#include "app_settings.h"
+#include "dbg_trace.h"
 #include "stm32wb5mm_dk_bus.h"
 
 /* Private defines -----------------------------------------------------------*/ 
@@ -44,6 +47,7 @@ VL53L0X_Dev_t Dev =
 uint8_t VL53L0X_PROXIMITY_Update_Timer_Id;
 
 /* Private function prototypes -----------------------------------------------*/
+static void VL53L0X_PROXIMITY_Setup(uint8_t Calibrate);
 
 /**
   * @brief  VL53L0X proximity sensor Initialization.
@@ -67,7 +71,7 @@ void VL53L0X_PROXIMITY_Init(void)
         if (VL53L0X_ERROR_NONE == VL53L0X_DataInit(&Dev))
         {
           Dev.Present = 1;
-          SetupSingleShot(Dev);
+          VL53L0X_PROXIMITY_Setup(0);
         }
         else
         { 
@@ -88,6 +92,56 @@ void VL53L0X_PROXIMITY_Init(void)
 }
 
 
+/**
+  * @brief  Perform the reference calibration again and save it, the sensor
+  *         shall not be covered.
+  * @note   Called from task context
+  */
+void VL53L0X_PROXIMITY_Calibrate(void)
+{
+  VL53L0X_PROXIMITY_Setup(1);
+}
+
+/**
+  * @brief  Single shot setup with the reference calibration of the settings.
+  *         The calibration is performed and saved when there is none, when it
+  *         is rejected by the sensor, or on request.
+  * @param  Calibrate: 1 to perform the calibration even when one is saved
+  */
+static void VL53L0X_PROXIMITY_Setup(uint8_t Calibrate)
+{
+  const Settings_t *p_settings = SETTINGS_Get();
+  Settings_t settings;
+  VL53L0X_RefCal_t ref_cal = {0};
+  int restore = 0;
+  int refcal;
+
+  if((Calibrate == 0) && (p_settings->Tof_Calibrated != 0))
+  {
+    ref_cal.refSpadCount = p_settings->Tof_Ref_Spad_Count;
+    ref_cal.isApertureSpads = p_settings->Tof_Aperture_Spads;
+    ref_cal.VhvSettings = p_settings->Tof_Vhv_Settings;
+    ref_cal.PhaseCal = p_settings->Tof_Phase_Cal;
+    restore = 1;
+  }
+
+  refcal = SetupSingleShot(Dev, &ref_cal, restore);
+  if(refcal == VL53L0X_REFCAL_MEASURED)
+  {
+    settings = *p_settings;
+    settings.Tof_Calibrated = 1;
+    settings.Tof_Ref_Spad_Count = ref_cal.refSpadCount;
+    settings.Tof_Aperture_Spads = ref_cal.isApertureSpads;
+    settings.Tof_Vhv_Settings = ref_cal.VhvSettings;
+    settings.Tof_Phase_Cal = ref_cal.PhaseCal;
+    SETTINGS_Save(&settings);
+  }
+
+  APP_DBG_MSG("VL53L0X : reference calibration %s, %ld %s SPADs, VHV %d, phase %d\n\r",
+              (refcal == VL53L0X_REFCAL_RESTORED) ? "restored" : ((refcal == VL53L0X_REFCAL_MEASURED) ? "measured" : "failed"),
+              ref_cal.refSpadCount, ref_cal.isApertureSpads ? "aperture" : "non aperture",
+              ref_cal.VhvSettings, ref_cal.PhaseCal);
+}
 
 /**
   * @brief  Get distance from VL53L0X proximity sensor.
@@ -109,7 +163,7 @@ uint16_t VL53L0X_PROXIMITY_GetDistance(void)
   * @retval None
   */
 void VL53L0X_PROXIMITY_PrintValue(void){
-      UTIL_LCD_ClearStringLine(2);
+      LCD_TEXT_ClearStringLine(2);
       char distanceText[18];
       uint16_t prox_value = 0;
       uint16_t distance = 0;
@@ -117,10 +171,10 @@ void VL53L0X_PROXIMITY_PrintValue(void){
       if(prox_value < DISTANCE_MAX_PROXIMITY){
         distance = prox_value / 10;
         sprintf(distanceText,"Distance : %3d cm",distance);
-        UTIL_LCD_DisplayStringAtLine(2,(uint8_t*)distanceText);
+        LCD_TEXT_DisplayStringAtLine(2,(uint8_t*)distanceText);
       }else{
-        UTIL_LCD_DisplayStringAtLine(2,(uint8_t*)"Distance > 200 cm");
+        LCD_TEXT_DisplayStringAtLine(2,(uint8_t*)"Distance > 200 cm");
       }
-      BSP_LCD_Refresh(0);
+      LCD_TEXT_Refresh();
 }
 
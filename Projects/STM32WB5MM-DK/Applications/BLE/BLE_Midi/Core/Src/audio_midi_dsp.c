@@ -0,0 +1,437 @@
+/**
+  ******************************************************************************
+  * @file    audio_midi_dsp.c
+  * @author  MCD Application Team
+  * @brief   Fixed-point onset and pitch detection turning PCM blocks into
+  *          Note On/Off decisions
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+/* This module only relies on the C library so that it can be built and fed
+ * with recorded files on a host as well as on target */
+#include <string.h>
+#include "audio_midi_dsp.h"
+
+/* Private defines -----------------------------------------------------------*/
+/* 2^(1/12) and 2^(1/24) in Q16 */
+#define SEMITONE_Q16            (69433U)
+#define HALF_SEMITONE_Q16       (67440U)
+
+#define A4_NOTE                 (69U)
+#define A4_FREQUENCY            (440U)
+
+/* Energy average is kept in Q4 and updated with a 1/8 weight */
+#define AVG_ENERGY_SHIFT        (3U)
+/* DC tracker update weight 1/4 per block */
+#define DC_SHIFT                (2U)
+/* Difference values are stored divided by 2^DIFF_SHIFT to fit in 32 bits */
+#define DIFF_SHIFT              (6U)
+
+/* Velocity mapping : log2 of mean square, Q3, from the noise gate (velocity 1)
+ * to full scale (velocity 127). Full scale is 2^(2*(15-PRESHIFT)) */
+#define VELOCITY_LOG_MAX        ((2U * (15U - AUDIO_DSP_PRESHIFT)) * 8U)
+
+/* Number of consecutive blocks a different pitch must be held before the
+ * sounding note is changed */
+#define NOTE_CHANGE_BLOCKS      (2U)
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t Log2_Q3(uint32_t x);
+static uint8_t  Energy_To_Velocity(uint32_t energy);
+static uint32_t Estimate_Lag(Audio_Dsp_Context_t *pCtx, const int16_t *pPcm, uint32_t Size);
+static uint8_t  Lag_To_Note(const Audio_Dsp_Context_t *pCtx, uint32_t lagQ4);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/*
+ * @brief Initialize the detection context for a given sample rate
+ *
+ * @param pCtx          detection context
+ * @param SampleRate    sample rate of the PCM blocks in Hz
+ */
+void AUDIO_DSP_Init(Audio_Dsp_Context_t *pCtx, uint32_t SampleRate)
+{
+  uint32_t i;
+  uint64_t lag;
+
+  memset(pCtx, 0, sizeof(Audio_Dsp_Context_t));
+  pCtx->SampleRate = SampleRate;
+  pCtx->BlocksSinceOnset = AUDIO_DSP_REFRACTORY_BLOCKS;
+
+  /* Lower edge of A4 (A4 - 1/2 semitone) expressed as a lag in Q16 */
+  lag = ((uint64_t)SampleRate * HALF_SEMITONE_Q16) / A4_FREQUENCY;
+
+  /* Walk down to the lowest supported note, each semitone lengthens the period */
+  for(i = AUDIO_DSP_LOWEST_NOTE; i < A4_NOTE; i++)
+  {
+    lag = (lag * SEMITONE_Q16) >> 16;
+  }
+
+  /* Then fill the edges table upward, each semitone shortens the period */
+  for(i = 0; i <= AUDIO_DSP_NOTE_NBR; i++)
+  {
+    pCtx->NoteEdgeLagQ16[i] = (uint32_t)lag;
+    lag = (lag << 16) / SEMITONE_Q16;
+  }
+
+  return;
+}
+
+/*
+ * @brief Forget the sounding note and the energy history, keeping the tables
+ *
+ * @param pCtx          detection context
+ */
+void AUDIO_DSP_Reset(Audio_Dsp_Context_t *pCtx)
+{
+  pCtx->AvgEnergy = 0;
+  pCtx->OnsetEnergy = 0;
+  pCtx->Note = 0;
+  pCtx->BlocksSinceOnset = AUDIO_DSP_REFRACTORY_BLOCKS;
+  pCtx->Candidate = 0;
+  pCtx->CandidateCount = 0;
+
+  return;
+}
+
+/*
+ * @brief Analyse one PCM block
+ * @note  The block is modified in place: DC is removed and samples are scaled
+ *        down by AUDIO_DSP_PRESHIFT. No copy of the block is made.
+ *
+ * @param pCtx          detection context
+ * @param pPcm          PCM block, mono 16 bits
+ * @param Size          number of samples in the block
+ * @param pResult       decision taken on this block
+ */
+void AUDIO_DSP_Process(Audio_Dsp_Context_t *pCtx, int16_t *pPcm, uint32_t Size, Audio_Dsp_Result_t *pResult)
+{
+  uint32_t n;
+  int32_t dc = pCtx->DcQ8 >> 8;
+  int64_t sum = 0;
+  uint64_t energy = 0;
+  uint32_t mean_square;
+  uint8_t onset;
+  uint8_t note = 0;
+
+  pResult->Event = AUDIO_DSP_EVT_NONE;
+  pResult->LagQ4 = 0;
+  pResult->Energy = 0;
+
+  if(Size == 0)
+  {
+    return;
+  }
+
+  /* In place DC removal and scaling, energy accumulation on the way */
+  for(n = 0; n < Size; n++)
+  {
+    int32_t s = pPcm[n];
+    int32_t y = (s - dc) >> AUDIO_DSP_PRESHIFT;
+
+    if(y > INT16_MAX)
+    {
+      y = INT16_MAX;
+    }
+    else if(y < INT16_MIN)
+    {
+      y = INT16_MIN;
+    }
+    pPcm[n] = (int16_t)y;
+    sum += s;
+    energy += (uint32_t)(y * y);
+  }
+  pCtx->DcQ8 += ((int32_t)((sum * 256) / (int64_t)Size) - pCtx->DcQ8) >> DC_SHIFT;
+
+  mean_square = (uint32_t)(energy / Size);
+  pResult->Energy = mean_square;
+
+  if(pCtx->BlocksSinceOnset < UINT8_MAX)
+  {
+    pCtx->BlocksSinceOnset++;
+  }
+
+  onset = (mean_square > AUDIO_DSP_NOISE_GATE)
+       && (((uint64_t)mean_square << 4) > ((uint64_t)pCtx->AvgEnergy * AUDIO_DSP_ONSET_RATIO))
+       && (pCtx->BlocksSinceOnset >= AUDIO_DSP_REFRACTORY_BLOCKS);
+
+  if(mean_square > AUDIO_DSP_NOISE_GATE)
+  {
+    pResult->LagQ4 = Estimate_Lag(pCtx, pPcm, Size);
+    note = Lag_To_Note(pCtx, pResult->LagQ4);
+  }
+
+  if(onset && (note != 0))
+  {
+    pResult->Event = (pCtx->Note != 0) ? AUDIO_DSP_EVT_NOTE_CHANGE : AUDIO_DSP_EVT_NOTE_ON;
+    pResult->PrevNote = pCtx->Note;
+    pResult->Note = note;
+    pResult->Velocity = Energy_To_Velocity(mean_square);
+    pCtx->Note = note;
+    pCtx->OnsetEnergy = mean_square;
+    pCtx->BlocksSinceOnset = 0;
+    pCtx->CandidateCount = 0;
+  }
+  else if(pCtx->Note != 0)
+  {
+    if((mean_square <= AUDIO_DSP_NOISE_GATE)
+    || (((uint64_t)mean_square * AUDIO_DSP_RELEASE_RATIO) < pCtx->OnsetEnergy))
+    {
+      pResult->Event = AUDIO_DSP_EVT_NOTE_OFF;
+      pResult->Note = pCtx->Note;
+      pCtx->Note = 0;
+      pCtx->CandidateCount = 0;
+    }
+    else if((note != 0) && (note != pCtx->Note))
+    {
+      /* Legato : follow the pitch once it has been stable for a few blocks */
+      if(note == pCtx->Candidate)
+      {
+        pCtx->CandidateCount++;
+      }
+      else
+      {
+        pCtx->Candidate = note;
+        pCtx->CandidateCount = 1;
+      }
+      if(pCtx->CandidateCount >= NOTE_CHANGE_BLOCKS)
+      {
+        pResult->Event = AUDIO_DSP_EVT_NOTE_CHANGE;
+        pResult->PrevNote = pCtx->Note;
+        pResult->Note = note;
+        pResult->Velocity = Energy_To_Velocity(mean_square);
+        pCtx->Note = note;
+        pCtx->CandidateCount = 0;
+      }
+    }
+    else
+    {
+      pCtx->CandidateCount = 0;
+    }
+  }
+
+  /* Slow running average of the energy, used as onset reference. It is
+   * dropped quickly on silence so that a note following a short rest is seen */
+  if(mean_square <= AUDIO_DSP_NOISE_GATE)
+  {
+    pCtx->AvgEnergy >>= 1;
+  }
+  else
+  {
+    pCtx->AvgEnergy = (uint32_t)((int64_t)pCtx->AvgEnergy
+                    + ((((int64_t)mean_square << 4) - (int64_t)pCtx->AvgEnergy) >> AVG_ENERGY_SHIFT));
+  }
+
+  return;
+}
+
+/*
+ * @brief Integer log2 with 3 fractional bits
+ *
+ * @param x     value
+ *
+ * @retval      log2(x) in Q3, 0 for x == 0
+ */
+static uint32_t Log2_Q3(uint32_t x)
+{
+  uint32_t msb = 0;
+  uint32_t frac;
+
+  if(x == 0)
+  {
+    return 0;
+  }
+  while((x >> msb) > 1U)
+  {
+    msb++;
+  }
+  if(msb >= 3U)
+  {
+    frac = (x >> (msb - 3U)) & 7U;
+  }
+  else
+  {
+    frac = (x << (3U - msb)) & 7U;
+  }
+
+  return (msb * 8U) + frac;
+}
+
+/*
+ * @brief Map a block mean square to a Midi velocity on a logarithmic scale
+ *
+ * @param energy        block mean square
+ *
+ * @retval              velocity from 1 to 127
+ */
+static uint8_t Energy_To_Velocity(uint32_t energy)
+{
+  uint32_t level = Log2_Q3(energy);
+  uint32_t gate = Log2_Q3(AUDIO_DSP_NOISE_GATE);
+  uint32_t velocity;
+
+  if(level <= gate)
+  {
+    return 1;
+  }
+  velocity = ((level - gate) * 127U) / (VELOCITY_LOG_MAX - gate);
+  if(velocity > 127U)
+  {
+    velocity = 127U;
+  }
+  if(velocity == 0U)
+  {
+    velocity = 1U;
+  }
+
+  return (uint8_t)velocity;
+}
+
+/*
+ * @brief Estimate the fundamental period of a block (YIN difference function)
+ *
+ * @param pCtx          detection context, used for scratch memory
+ * @param pPcm          pre-processed PCM block
+ * @param Size          number of samples in the block
+ *
+ * @retval              period in samples Q4, 0 when no clear period is found
+ */
+static uint32_t Estimate_Lag(Audio_Dsp_Context_t *pCtx, const int16_t *pPcm, uint32_t Size)
+{
+  uint32_t window;
+  uint32_t tau;
+  uint32_t j;
+  uint64_t running_sum = 0;
+  uint32_t cmnd;
+  uint32_t best = 0;
+  uint32_t best_cmnd = 0;
+
+  if(Size <= AUDIO_DSP_MAX_LAG)
+  {
+    return 0;
+  }
+  window = Size - AUDIO_DSP_MAX_LAG;
+
+  pCtx->Diff[0] = 0;
+  for(tau = 1; tau <= AUDIO_DSP_MAX_LAG; tau++)
+  {
+    uint64_t acc = 0;
+    for(j = 0; j < window; j++)
+    {
+      int32_t d = (int32_t)pPcm[j] - (int32_t)pPcm[j + tau];
+      acc += (uint32_t)(d * d);
+    }
+    pCtx->Diff[tau] = (uint32_t)(acc >> DIFF_SHIFT);
+  }
+
+  /* Cumulative mean normalised difference, first dip below the threshold */
+  for(tau = 1; tau <= AUDIO_DSP_MAX_LAG; tau++)
+  {
+    running_sum += pCtx->Diff[tau];
+    if(running_sum == 0)
+    {
+      continue;
+    }
+    cmnd = (uint32_t)((((uint64_t)pCtx->Diff[tau] * tau) << 15) / running_sum);
+    if(tau < AUDIO_DSP_MIN_LAG)
+    {
+      continue;
+    }
+    if(best == 0)
+    {
+      if(cmnd < AUDIO_DSP_YIN_THRESHOLD_Q15)
+      {
+        best = tau;
+        best_cmnd = cmnd;
+      }
+    }
+    else if(cmnd < best_cmnd)
+    {
+      /* Still going down toward the local minimum */
+      best = tau;
+      best_cmnd = cmnd;
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  if(best == 0)
+  {
+    return 0;
+  }
+
+  /* Parabolic interpolation around the minimum for sub-sample accuracy */
+  if((best > 1U) && (best < AUDIO_DSP_MAX_LAG))
+  {
+    int64_t a = pCtx->Diff[best - 1U];
+    int64_t b = pCtx->Diff[best];
+    int64_t c = pCtx->Diff[best + 1U];
+    int64_t den = a - (2 * b) + c;
+    int32_t offset = 0;
+
+    if(den > 0)
+    {
+      offset = (int32_t)(((a - c) * 8) / den);
+      if(offset > 8)
+      {
+        offset = 8;
+      }
+      else if(offset < -8)
+      {
+        offset = -8;
+      }
+    }
+    return (uint32_t)((int32_t)(best * 16U) + offset);
+  }
+
+  return best * 16U;
+}
+
+/*
+ * @brief Convert a period into the closest Midi note
+ *
+ * @param pCtx          detection context
+ * @param lagQ4         period in samples Q4
+ *
+ * @retval              Midi note number, 0 when out of the supported range
+ */
+static uint8_t Lag_To_Note(const Audio_Dsp_Context_t *pCtx, uint32_t lagQ4)
+{
+  uint32_t lag = lagQ4 << 12;
+  uint32_t low = 0;
+  uint32_t high = AUDIO_DSP_NOTE_NBR;
+
+  if((lagQ4 == 0) || (lag > pCtx->NoteEdgeLagQ16[0]) || (lag <= pCtx->NoteEdgeLagQ16[AUDIO_DSP_NOTE_NBR]))
+  {
+    return 0;
+  }
+
+  /* Edges are decreasing : find i such as Edge[i + 1] < lag <= Edge[i] */
+  while((high - low) > 1U)
+  {
+    uint32_t mid = (low + high) / 2U;
+    if(lag <= pCtx->NoteEdgeLagQ16[mid])
+    {
+      low = mid;
+    }
+    else
+    {
+      high = mid;
+    }
+  }
+
+  return (uint8_t)(AUDIO_DSP_LOWEST_NOTE + low);
+}
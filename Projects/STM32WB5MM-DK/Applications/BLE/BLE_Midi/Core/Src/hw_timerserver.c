@@ -46,19 +46,53 @@ typedef struct
 {
   HW_TS_pTimerCb_t  pTimerCallBack;
   uint32_t        CounterInit;
+#if (CFG_HW_TS_TIMING_WHEEL == 1)
+  uint64_t        Expiry;         /**< Timeout date in wakeup timer ticks */
+#else
   uint32_t        CountLeft;
+#endif
   TimerIDStatus_t     TimerIDStatus;
   HW_TS_Mode_t   TimerMode;
   uint32_t        TimerProcessID;
   uint8_t         PreviousID;
   uint8_t         NextID;
+#if (CFG_HW_TS_TIMING_WHEEL == 1)
+  uint8_t         Slot;           /**< Wheel slot holding the timer */
+#endif
 }TimerContext_t;
 
 /* Private defines -----------------------------------------------------------*/
 #define SSR_FORBIDDEN_VALUE   0xFFFFFFFF
 #define TIMER_LIST_EMPTY      0xFFFF
 
+#if (CFG_HW_TS_TIMING_WHEEL == 1)
+/**
+ * Each level of the wheel has 32 slots, a slot of level n covers 32^n ticks.
+ * The 6 levels cover 2^30 ticks, the timers further away are kept in a separate slot
+ */
+#define WHEEL_SLOT_BITS       5
+#define WHEEL_SLOT_NBR        (1UL << WHEEL_SLOT_BITS)
+#define WHEEL_LEVEL_NBR       6
+#define WHEEL_SPAN_BITS       (WHEEL_SLOT_BITS * WHEEL_LEVEL_NBR)
+#define WHEEL_FAR_SLOT        (WHEEL_LEVEL_NBR * WHEEL_SLOT_NBR)
+#define WHEEL_NO_EVENT        UINT64_MAX
+#endif
+
 /* Private macros ------------------------------------------------------------*/
+#if (CFG_HW_TS_BENCHMARK == 1)
+#define TS_BENCHMARK_START()          uint32_t benchmark_cycles = DWT->CYCCNT
+#define TS_BENCHMARK_STOP(field)      do{                                                 \
+                                        benchmark_cycles = DWT->CYCCNT - benchmark_cycles;\
+                                        if(benchmark_cycles > TimerBenchmark.field)       \
+                                        {                                                 \
+                                          TimerBenchmark.field = benchmark_cycles;        \
+                                        }                                                 \
+                                      }while(0)
+#else
+#define TS_BENCHMARK_START()
+#define TS_BENCHMARK_STOP(field)
+#endif
+
 /* Private variables ---------------------------------------------------------*/
 
 /**
@@ -70,6 +104,16 @@ static volatile uint8_t CurrentRunningTimerID;
 static volatile uint8_t PreviousRunningTimerID;
 static volatile uint32_t SSRValueOnLastSetup;
 static volatile WakeupTimerLimitation_Status_t  WakeupTimerLimitation;
+static volatile uint8_t RunningTimerNbr;
+
+#if (CFG_HW_TS_TIMING_WHEEL == 1)
+static volatile uint8_t  aWheelSlotHead[WHEEL_FAR_SLOT + 1];  /**< First timer of each slot */
+static volatile uint32_t aWheelOccupancy[WHEEL_LEVEL_NBR];    /**< One bit per non empty slot */
+static volatile uint64_t WheelTime;                           /**< Date the wheel has been processed up to */
+static volatile uint64_t WheelTimeOnLastSetup;                /**< Date of the last wakeup timer setup */
+static volatile uint64_t WheelWakeupTime;                     /**< Date of the programmed wakeup */
+static volatile uint64_t WheelNextEvent;                      /**< Wheel event the wakeup is programmed for */
+#endif
 
 /**
  * END of Section TIMERSERVER_CONTEXT
@@ -80,17 +124,32 @@ static uint8_t  AsynchPrescalerUserConfig;
 static uint16_t SynchPrescalerUserConfig;
 static volatile uint16_t MaxWakeupTimerSetup;
 
+#if (CFG_HW_TS_BENCHMARK == 1)
+static HW_TS_Benchmark_t TimerBenchmark;
+#endif
+
 /* Global variables ----------------------------------------------------------*/
 extern RTC_HandleTypeDef hrtc;
 
 /* Private function prototypes -----------------------------------------------*/
 static void RestartWakeupCounter(uint16_t Value);
 static uint16_t ReturnTimeElapsed(void);
+#if (CFG_HW_TS_TIMING_WHEEL == 1)
+static uint64_t WheelNow(void);
+static void WheelLink(uint8_t TimerID);
+static void WheelUnlink(uint8_t TimerID);
+static void WheelRelinkSlot(uint32_t Slot);
+static uint64_t WheelFindNextEvent(void);
+static uint8_t WheelAdvance(uint64_t Now, uint8_t *pExpiredID);
+static void WheelSchedule(uint64_t Now);
+static void DisableWakeupTimer(void);
+#else
 static void RescheduleTimerList(void);
 static void UnlinkTimer(uint8_t TimerID, RequestReadSSR_t RequestReadSSR);
 static void LinkTimerBefore(uint8_t TimerID, uint8_t RefTimerID);
 static void LinkTimerAfter(uint8_t TimerID, uint8_t RefTimerID);
 static uint16_t linkTimer(uint8_t TimerID);
+#endif
 static uint32_t ReadRtcSsrValue(void);
 
 __weak void HW_TS_RTC_CountUpdated_AppNot(void);
@@ -123,6 +182,7 @@ static uint32_t ReadRtcSsrValue(void)
   return second_read;
 }
 
+#if (CFG_HW_TS_TIMING_WHEEL != 1)
 /**
  * @brief  Insert a Timer in the list after the Timer ID specified
  * @param  TimerID:   The ID of the Timer
@@ -240,6 +300,8 @@ static uint16_t linkTimer(uint8_t TimerID)
     }
   }
 
+  RunningTimerNbr++;
+
   return time_elapsed;
 }
 
@@ -275,6 +337,7 @@ static void UnlinkTimer(uint8_t TimerID, RequestReadSSR_t RequestReadSSR)
    * Timer is out of the list
    */
   aTimerContext[TimerID].TimerIDStatus = TimerID_Created;
+  RunningTimerNbr--;
 
   if((CurrentRunningTimerID == CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER) && (RequestReadSSR == SSR_Read_Requested))
   {
@@ -283,6 +346,7 @@ static void UnlinkTimer(uint8_t TimerID, RequestReadSSR_t RequestReadSSR)
 
   return;
 }
+#endif
 
 /**
  * @brief  Return the number of ticks counted by the wakeuptimer since it has been started
@@ -385,6 +449,321 @@ static void RestartWakeupCounter(uint16_t Value)
   return ;
 }
 
+#if (CFG_HW_TS_TIMING_WHEEL == 1)
+/**
+ * @brief  Return the current date in wakeup timer ticks
+ * @note  The date only moves forward while the wakeup timer is running. When no timer is running, it stays at
+ *        the date of the last stop, the timeouts being relative this is not an issue
+ * @param  None
+ * @retval Date in Ticks
+ */
+static uint64_t WheelNow(void)
+{
+  return (WheelTimeOnLastSetup + ReturnTimeElapsed());
+}
+
+/**
+ * @brief  Insert a Timer in the wheel
+ * @note  The level is given by the highest bit that differs between the timeout date and the date the wheel has
+ *        been processed up to : the timer goes in the slot of its timeout date on that level. It is moved to a lower
+ *        level when the wheel time reaches the beginning of the slot
+ * @param  TimerID:   The ID of the Timer
+ * @retval None
+ */
+static void WheelLink(uint8_t TimerID)
+{
+  uint64_t expiry;
+  uint64_t diff;
+  uint32_t level;
+  uint32_t index;
+  uint32_t slot;
+  uint8_t next_id;
+
+  expiry = aTimerContext[TimerID].Expiry;
+  diff = expiry ^ WheelTime;
+
+  if((diff >> WHEEL_SPAN_BITS) != 0)
+  {
+    slot = WHEEL_FAR_SLOT;
+  }
+  else
+  {
+    level = (diff == 0) ? 0 : ((31 - __CLZ((uint32_t)diff)) / WHEEL_SLOT_BITS);
+    index = (uint32_t)(expiry >> (level * WHEEL_SLOT_BITS)) & (WHEEL_SLOT_NBR - 1);
+    slot = (level * WHEEL_SLOT_NBR) + index;
+    aWheelOccupancy[level] |= (1UL << index);
+  }
+
+  next_id = aWheelSlotHead[slot];
+  if(next_id != CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER)
+  {
+    aTimerContext[next_id].PreviousID = TimerID;
+  }
+  aTimerContext[TimerID].NextID = next_id;
+  aTimerContext[TimerID].PreviousID = CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER;
+  aTimerContext[TimerID].Slot = (uint8_t)slot;
+  aWheelSlotHead[slot] = TimerID;
+
+  RunningTimerNbr++;
+
+  return;
+}
+
+/**
+ * @brief  Remove a Timer from the wheel
+ * @param  TimerID:   The ID of the Timer
+ * @retval None
+ */
+static void WheelUnlink(uint8_t TimerID)
+{
+  uint32_t slot;
+  uint8_t previous_id;
+  uint8_t next_id;
+
+  slot = aTimerContext[TimerID].Slot;
+  previous_id = aTimerContext[TimerID].PreviousID;
+  next_id = aTimerContext[TimerID].NextID;
+
+  if(previous_id == CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER)
+  {
+    aWheelSlotHead[slot] = next_id;
+
+    if((next_id == CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER) && (slot != WHEEL_FAR_SLOT))
+    {
+      aWheelOccupancy[slot / WHEEL_SLOT_NBR] &= ~(1UL << (slot % WHEEL_SLOT_NBR));
+    }
+  }
+  else
+  {
+    aTimerContext[previous_id].NextID = next_id;
+  }
+
+  if(next_id != CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER)
+  {
+    aTimerContext[next_id].PreviousID = previous_id;
+  }
+
+  RunningTimerNbr--;
+
+  return;
+}
+
+/**
+ * @brief  Move the timers of a slot which beginning has been reached to their slot on the lower levels
+ * @param  Slot:   The slot to empty
+ * @retval None
+ */
+static void WheelRelinkSlot(uint32_t Slot)
+{
+  uint8_t timer_id;
+  uint8_t next_id;
+
+  timer_id = aWheelSlotHead[Slot];
+  if(Slot != WHEEL_FAR_SLOT)
+  {
+    aWheelOccupancy[Slot / WHEEL_SLOT_NBR] &= ~(1UL << (Slot % WHEEL_SLOT_NBR));
+  }
+  aWheelSlotHead[Slot] = CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER;
+
+  while(timer_id != CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER)
+  {
+    next_id = aTimerContext[timer_id].NextID;
+    RunningTimerNbr--;
+    WheelLink(timer_id);
+    timer_id = next_id;
+  }
+
+  return;
+}
+
+/**
+ * @brief  Return the date of the next wheel event : a timeout on the first level or the beginning of a slot
+ *         to be moved down on the upper levels
+ * @note  An event on a level always comes before the events of the upper levels, so the search stops on the
+ *        first level with a non empty slot ahead of the wheel time
+ * @param  None
+ * @retval Date in Ticks, WHEEL_NO_EVENT when no timer is running
+ */
+static uint64_t WheelFindNextEvent(void)
+{
+  uint64_t wheel_time;
+  uint32_t level;
+  uint32_t current;
+  uint32_t pending;
+  uint32_t shift;
+
+  wheel_time = WheelTime;
+
+  for(level = 0; level < WHEEL_LEVEL_NBR; level++)
+  {
+    shift = level * WHEEL_SLOT_BITS;
+    current = (uint32_t)(wheel_time >> shift) & (WHEEL_SLOT_NBR - 1);
+    pending = aWheelOccupancy[level] & (0xFFFFFFFFUL << current);
+
+    if(pending != 0)
+    {
+      return ((wheel_time & ~((1ULL << (shift + WHEEL_SLOT_BITS)) - 1)) | ((uint64_t)__CLZ(__RBIT(pending)) << shift));
+    }
+  }
+
+  if(aWheelSlotHead[WHEEL_FAR_SLOT] != CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER)
+  {
+    return ((wheel_time | ((1ULL << WHEEL_SPAN_BITS) - 1)) + 1);
+  }
+
+  return WHEEL_NO_EVENT;
+}
+
+/**
+ * @brief  Process the wheel up to the current date
+ * @note  The wheel time jumps from one event to the next one. At each event, the slots which beginning is reached
+ *        are moved down, from the upper level to the first one, then the timers of the first level slot are expired.
+ *        The expired timers are removed from the wheel
+ * @param  Now:   Current date in Ticks
+ * @param  pExpiredID:   Filled with the IDs of the expired timers
+ * @retval Number of expired timers
+ */
+static uint8_t WheelAdvance(uint64_t Now, uint8_t *pExpiredID)
+{
+  uint64_t event;
+  uint32_t level;
+  uint32_t slot;
+  uint8_t timer_id;
+  uint8_t expired_nbr = 0;
+
+  event = WheelFindNextEvent();
+
+  while(event <= Now)
+  {
+    if(event > WheelTime)
+    {
+      WheelTime = event;
+    }
+
+    if((WheelTime & ((1ULL << WHEEL_SPAN_BITS) - 1)) == 0)
+    {
+      WheelRelinkSlot(WHEEL_FAR_SLOT);
+    }
+
+    for(level = WHEEL_LEVEL_NBR - 1; level > 0; level--)
+    {
+      slot = (uint32_t)(WheelTime >> (level * WHEEL_SLOT_BITS)) & (WHEEL_SLOT_NBR - 1);
+      if((aWheelOccupancy[level] & (1UL << slot)) != 0)
+      {
+        WheelRelinkSlot((level * WHEEL_SLOT_NBR) + slot);
+      }
+    }
+
+    slot = (uint32_t)WheelTime & (WHEEL_SLOT_NBR - 1);
+    timer_id = aWheelSlotHead[slot];
+    while(timer_id != CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER)
+    {
+      pExpiredID[expired_nbr++] = timer_id;
+      WheelUnlink(timer_id);
+      timer_id = aWheelSlotHead[slot];
+    }
+
+    event = WheelFindNextEvent();
+  }
+
+  if(Now > WheelTime)
+  {
+    WheelTime = Now;
+  }
+
+  return expired_nbr;
+}
+
+/**
+ * @brief  Disable the wakeup timer and clear its pending interrupt
+ * @param  None
+ * @retval None
+ */
+static void DisableWakeupTimer(void)
+{
+  if((READ_BIT(RTC->CR, RTC_CR_WUTE) == (RTC_CR_WUTE)) == SET)
+  {
+    /**
+     * Wait for the flag to be back to 0 when the wakeup timer is enabled
+     */
+    while(__HAL_RTC_WAKEUPTIMER_GET_FLAG(&hrtc, RTC_FLAG_WUTWF) == SET);
+  }
+  __HAL_RTC_WAKEUPTIMER_DISABLE(&hrtc);   /**<  Disable the Wakeup Timer */
+
+  while(__HAL_RTC_WAKEUPTIMER_GET_FLAG(&hrtc, RTC_FLAG_WUTWF) == RESET);
+
+  /**
+   * make sure to clear the flags after checking the WUTWF.
+   * It takes 2 RTCCLK between the time the WUTE bit is disabled and the
+   * time the timer is disabled. The WUTWF bit somehow guarantee the system is stable
+   * Otherwise, when the timer is periodic with 1 Tick, it may generate an extra interrupt in between
+   * due to the autoreload feature
+   */
+  __HAL_RTC_WAKEUPTIMER_CLEAR_FLAG(&hrtc, RTC_FLAG_WUTF);   /**<  Clear flag in RTC module */
+  __HAL_RTC_WAKEUPTIMER_EXTI_CLEAR_FLAG(); /**<  Clear flag in EXTI module */
+  HAL_NVIC_ClearPendingIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID);   /**<  Clear pending bit in NVIC */
+
+  return;
+}
+
+/**
+ * @brief  Setup the wakeuptimer for the next wheel event
+ * @note  When the event is further than the wakeuptimer maximum value, the wakeup only updates the wheel time
+ * @param  Now:   Current date in Ticks
+ * @retval None
+ */
+static void WheelSchedule(uint64_t Now)
+{
+  uint64_t event;
+  uint16_t wakeup_timer_value;
+
+  event = WheelFindNextEvent();
+  WheelNextEvent = event;
+  WheelTimeOnLastSetup = Now;
+
+  if(event == WHEEL_NO_EVENT)
+  {
+    /**
+     * No timer running
+     */
+    DisableWakeupTimer();
+    SSRValueOnLastSetup = SSR_FORBIDDEN_VALUE;
+    WheelWakeupTime = WHEEL_NO_EVENT;
+  }
+  else
+  {
+    /**
+     * The wakeuptimer is disabled now to reduce the time to poll the WUTWF
+     * FLAG when the new value will have to be written
+     */
+    if((READ_BIT(RTC->CR, RTC_CR_WUTE) == (RTC_CR_WUTE)) == SET)
+    {
+      while(__HAL_RTC_WAKEUPTIMER_GET_FLAG(&hrtc, RTC_FLAG_WUTWF) == SET);
+    }
+    __HAL_RTC_WAKEUPTIMER_DISABLE(&hrtc);   /**<  Disable the Wakeup Timer */
+
+    if(event <= Now)
+    {
+      wakeup_timer_value = 0;
+    }
+    else if((event - Now) > MaxWakeupTimerSetup)
+    {
+      wakeup_timer_value = MaxWakeupTimerSetup;
+    }
+    else
+    {
+      wakeup_timer_value = (uint16_t)(event - Now);
+    }
+
+    WheelWakeupTime = Now + wakeup_timer_value;
+    RestartWakeupCounter(wakeup_timer_value);
+  }
+
+  return;
+}
+
+#else
+
 /**
  * @brief  Reschedule the list of timer
  * @note  1) Update the count left for each timer in the list
@@ -474,6 +853,7 @@ static void RescheduleTimerList(void)
 
   return ;
 }
+#endif
 
 /* Public functions ----------------------------------------------------------*/
 
@@ -484,6 +864,112 @@ static void RescheduleTimerList(void)
  * in case some new implementation is coming in the future
  */
 
+#if (CFG_HW_TS_TIMING_WHEEL == 1)
+void HW_TS_RTC_Wakeup_Handler(void)
+{
+  uint8_t a_expired_id[CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER];
+  uint8_t expired_nbr;
+  uint8_t loop;
+  uint8_t timer_id;
+  uint64_t now;
+#if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
+  uint32_t primask_bit;
+#endif
+  TS_BENCHMARK_START();
+
+#if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
+  primask_bit = __get_PRIMASK();  /**< backup PRIMASK bit */
+  __disable_irq();          /**< Disable all interrupts by setting PRIMASK bit on Cortex*/
+#endif
+
+/* Disable the write protection for RTC registers */
+  __HAL_RTC_WRITEPROTECTION_DISABLE( &hrtc );
+
+  /**
+   * Disable the Wakeup Timer
+   * This may speed up a bit the processing to wait the timer to be disabled
+   * The timer is still counting 2 RTCCLK
+   */
+  __HAL_RTC_WAKEUPTIMER_DISABLE(&hrtc);
+
+  expired_nbr = 0;
+
+  if(RunningTimerNbr != 0)
+  {
+    /**
+     * Due to the inaccuracy of the reading of the time elapsed, it may return there is 1 tick
+     * to be left whereas the count is over : the wakeup time programmed is trusted
+     */
+    now = WheelNow();
+    if((WheelWakeupTime != WHEEL_NO_EVENT) && (now < WheelWakeupTime))
+    {
+      now = WheelWakeupTime;
+    }
+
+    expired_nbr = WheelAdvance(now, a_expired_id);
+
+    for(loop = 0; loop < expired_nbr; loop++)
+    {
+      timer_id = a_expired_id[loop];
+
+      if(aTimerContext[timer_id].TimerMode == hw_ts_Repeated)
+      {
+        /**
+         * Restart from the timeout date so that the period does not drift with the interrupt latency
+         */
+        aTimerContext[timer_id].Expiry += aTimerContext[timer_id].CounterInit;
+        if(aTimerContext[timer_id].Expiry < now)
+        {
+          aTimerContext[timer_id].Expiry = now;
+        }
+        WheelLink(timer_id);
+      }
+      else
+      {
+        aTimerContext[timer_id].TimerIDStatus = TimerID_Created;
+      }
+    }
+
+    WheelSchedule(now);
+  }
+  else
+  {
+    /**
+     * We should never end up in this case
+     * However, if due to any bug in the timer server this is the case, the mistake may not impact the user.
+     * We could just clean the interrupt flag and get out from this unexpected interrupt
+     */
+    DisableWakeupTimer();
+  }
+
+  /* Enable the write protection for RTC registers */
+  __HAL_RTC_WRITEPROTECTION_ENABLE( &hrtc );
+
+#if (CFG_HW_TS_BENCHMARK == 1)
+  TimerBenchmark.IsrCount++;
+#endif
+  TS_BENCHMARK_STOP(IsrMaxCycles);
+
+#if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
+  __set_PRIMASK(primask_bit); /**< Restore PRIMASK bit*/
+#endif
+
+  /**
+   * The callbacks are called out of the critical section, they may start or stop timers
+   */
+  for(loop = 0; loop < expired_nbr; loop++)
+  {
+    timer_id = a_expired_id[loop];
+
+    if(aTimerContext[timer_id].TimerIDStatus != TimerID_Free)
+    {
+      HW_TS_RTC_Int_AppNot(aTimerContext[timer_id].TimerProcessID, timer_id, aTimerContext[timer_id].pTimerCallBack);
+    }
+  }
+
+  return;
+}
+#else
 void HW_TS_RTC_Wakeup_Handler(void)
 {
   HW_TS_pTimerCb_t ptimer_callback;
@@ -492,6 +978,7 @@ void HW_TS_RTC_Wakeup_Handler(void)
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
   uint32_t primask_bit;
 #endif
+  TS_BENCHMARK_START();
 
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
   primask_bit = __get_PRIMASK();  /**< backup PRIMASK bit */
@@ -546,11 +1033,14 @@ void HW_TS_RTC_Wakeup_Handler(void)
         __HAL_RTC_WRITEPROTECTION_DISABLE( &hrtc );
         }
 
+      TS_BENCHMARK_STOP(IsrMaxCycles);
+
       HW_TS_RTC_Int_AppNot(timer_process_id, local_current_running_timer_id, ptimer_callback);
     }
     else
     {
       RescheduleTimerList();
+      TS_BENCHMARK_STOP(IsrMaxCycles);
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
       __set_PRIMASK(primask_bit); /**< Restore PRIMASK bit*/
 #endif
@@ -574,6 +1064,7 @@ void HW_TS_RTC_Wakeup_Handler(void)
      */
     __HAL_RTC_WAKEUPTIMER_CLEAR_FLAG(&hrtc, RTC_FLAG_WUTF);   /**<  Clear flag in RTC module */
     __HAL_RTC_WAKEUPTIMER_EXTI_CLEAR_FLAG(); /**<  Clear flag in EXTI module */
+    TS_BENCHMARK_STOP(IsrMaxCycles);
 
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
     __set_PRIMASK(primask_bit); /**< Restore PRIMASK bit*/
@@ -583,8 +1074,13 @@ void HW_TS_RTC_Wakeup_Handler(void)
   /* Enable the write protection for RTC registers */
   __HAL_RTC_WRITEPROTECTION_ENABLE( &hrtc );
 
+#if (CFG_HW_TS_BENCHMARK == 1)
+  TimerBenchmark.IsrCount++;
+#endif
+
   return;
 }
+#endif
 
 void HW_TS_Init(HW_TS_InitMode_t TimerInitMode, RTC_HandleTypeDef *phrtc)
 {
@@ -630,6 +1126,19 @@ void HW_TS_Init(HW_TS_InitMode_t TimerInitMode, RTC_HandleTypeDef *phrtc)
   {
     WakeupTimerLimitation = WakeupTimerValue_LargeEnough;
     SSRValueOnLastSetup = SSR_FORBIDDEN_VALUE;
+    RunningTimerNbr = 0;
+
+#if (CFG_HW_TS_TIMING_WHEEL == 1)
+    for(loop = 0; loop < WHEEL_LEVEL_NBR; loop++)
+    {
+      aWheelOccupancy[loop] = 0;
+    }
+    memset((void*)aWheelSlotHead, CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER, sizeof(aWheelSlotHead));
+    WheelTime = 0;
+    WheelTimeOnLastSetup = 0;
+    WheelWakeupTime = WHEEL_NO_EVENT;
+    WheelNextEvent = WHEEL_NO_EVENT;
+#endif
 
     /**
      * Initialize the timer server
@@ -721,6 +1230,113 @@ void HW_TS_Delete(uint8_t timer_id)
   return;
 }
 
+#if (CFG_HW_TS_TIMING_WHEEL == 1)
+void HW_TS_Stop(uint8_t timer_id)
+{
+#if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
+  uint32_t primask_bit;
+#endif
+  TS_BENCHMARK_START();
+
+#if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
+  primask_bit = __get_PRIMASK();  /**< backup PRIMASK bit */
+  __disable_irq();          /**< Disable all interrupts by setting PRIMASK bit on Cortex*/
+#endif
+
+  HAL_NVIC_DisableIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID);    /**<  Disable NVIC */
+
+  /* Disable the write protection for RTC registers */
+  __HAL_RTC_WRITEPROTECTION_DISABLE( &hrtc );
+
+  if(aTimerContext[timer_id].TimerIDStatus == TimerID_Running)
+  {
+    WheelUnlink(timer_id);
+    aTimerContext[timer_id].TimerIDStatus = TimerID_Created;
+
+    /**
+     * The wakeuptimer is only setup again when the timer was the next to expire or the last one running
+     */
+    if(WheelFindNextEvent() != WheelNextEvent)
+    {
+      WheelSchedule(WheelNow());
+    }
+  }
+
+  /* Enable the write protection for RTC registers */
+  __HAL_RTC_WRITEPROTECTION_ENABLE( &hrtc );
+
+  HAL_NVIC_EnableIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID); /**<  Enable NVIC */
+
+  TS_BENCHMARK_STOP(StopMaxCycles);
+
+#if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
+  __set_PRIMASK(primask_bit); /**< Restore PRIMASK bit*/
+#endif
+
+  return;
+}
+
+void HW_TS_Start(uint8_t timer_id, uint32_t timeout_ticks)
+{
+  uint64_t now;
+
+#if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
+  uint32_t primask_bit;
+#endif
+  TS_BENCHMARK_START();
+
+  if(aTimerContext[timer_id].TimerIDStatus == TimerID_Running)
+  {
+    HW_TS_Stop( timer_id );
+  }
+
+#if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
+  primask_bit = __get_PRIMASK();  /**< backup PRIMASK bit */
+  __disable_irq();          /**< Disable all interrupts by setting PRIMASK bit on Cortex*/
+#endif
+
+  HAL_NVIC_DisableIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID);    /**<  Disable NVIC */
+
+  /* Disable the write protection for RTC registers */
+  __HAL_RTC_WRITEPROTECTION_DISABLE( &hrtc );
+
+  now = WheelNow();
+
+  aTimerContext[timer_id].TimerIDStatus = TimerID_Running;
+  aTimerContext[timer_id].CounterInit = timeout_ticks;
+  aTimerContext[timer_id].Expiry = now + timeout_ticks;
+
+  WheelLink(timer_id);
+
+  /**
+   * The wakeuptimer is only setup again when the timer expires before the programmed event
+   */
+  if(WheelFindNextEvent() < WheelNextEvent)
+  {
+    WheelSchedule(now);
+  }
+
+#if (CFG_HW_TS_BENCHMARK == 1)
+  if(RunningTimerNbr > TimerBenchmark.RunningMax)
+  {
+    TimerBenchmark.RunningMax = RunningTimerNbr;
+  }
+#endif
+
+  /* Enable the write protection for RTC registers */
+  __HAL_RTC_WRITEPROTECTION_ENABLE( &hrtc );
+
+  HAL_NVIC_EnableIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID); /**<  Enable NVIC */
+
+  TS_BENCHMARK_STOP(StartMaxCycles);
+
+#if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
+  __set_PRIMASK(primask_bit); /**< Restore PRIMASK bit*/
+#endif
+
+  return;
+}
+#else
 void HW_TS_Stop(uint8_t timer_id)
 {
   uint8_t localcurrentrunningtimerid;
@@ -728,6 +1344,7 @@ void HW_TS_Stop(uint8_t timer_id)
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
   uint32_t primask_bit;
 #endif
+  TS_BENCHMARK_START();
 
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
   primask_bit = __get_PRIMASK();  /**< backup PRIMASK bit */
@@ -786,6 +1403,8 @@ void HW_TS_Stop(uint8_t timer_id)
 
   HAL_NVIC_EnableIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID); /**<  Enable NVIC */
 
+  TS_BENCHMARK_STOP(StopMaxCycles);
+
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
   __set_PRIMASK(primask_bit); /**< Restore PRIMASK bit*/
 #endif
@@ -801,6 +1420,7 @@ void HW_TS_Start(uint8_t timer_id, uint32_t timeout_ticks)
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
   uint32_t primask_bit;
 #endif
+  TS_BENCHMARK_START();
 
   if(aTimerContext[timer_id].TimerIDStatus == TimerID_Running)
   {
@@ -835,17 +1455,27 @@ void HW_TS_Start(uint8_t timer_id, uint32_t timeout_ticks)
     aTimerContext[timer_id].CountLeft -= time_elapsed;
   }
 
+#if (CFG_HW_TS_BENCHMARK == 1)
+  if(RunningTimerNbr > TimerBenchmark.RunningMax)
+  {
+    TimerBenchmark.RunningMax = RunningTimerNbr;
+  }
+#endif
+
   /* Enable the write protection for RTC registers */
   __HAL_RTC_WRITEPROTECTION_ENABLE( &hrtc );
 
   HAL_NVIC_EnableIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID); /**<  Enable NVIC */
 
+  TS_BENCHMARK_STOP(StartMaxCycles);
+
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
   __set_PRIMASK(primask_bit); /**< Restore PRIMASK bit*/
 #endif
 
   return;
 }
+#endif
 
 uint16_t HW_TS_RTC_ReadLeftTicksToCount(void)
 {
@@ -886,3 +1516,34 @@ __weak void HW_TS_RTC_Int_AppNot(uint32_t TimerProcessID, uint8_t TimerID, HW_TS
 
   return;
 }
+
+#if (CFG_HW_TS_BENCHMARK == 1)
+void HW_TS_Benchmark_Get(HW_TS_Benchmark_t *pBenchmark)
+{
+  uint32_t primask_bit;
+
+  primask_bit = __get_PRIMASK();  /**< backup PRIMASK bit */
+  __disable_irq();                /**< Disable all interrupts by setting PRIMASK bit on Cortex*/
+
+  *pBenchmark = TimerBenchmark;
+
+  __set_PRIMASK(primask_bit);     /**< Restore PRIMASK bit*/
+
+  return;
+}
+
+void HW_TS_Benchmark_Reset(void)
+{
+  uint32_t primask_bit;
+
+  primask_bit = __get_PRIMASK();  /**< backup PRIMASK bit */
+  __disable_irq();                /**< Disable all interrupts by setting PRIMASK bit on Cortex*/
+
+  memset(&TimerBenchmark, 0, sizeof(TimerBenchmark));
+  TimerBenchmark.RunningMax = RunningTimerNbr;
+
+  __set_PRIMASK(primask_bit);     /**< Restore PRIMASK bit*/
+
+  return;
+}
+#endif
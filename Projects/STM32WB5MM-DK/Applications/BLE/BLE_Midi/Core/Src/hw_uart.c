@@ -56,6 +56,11 @@ extern UART_HandleTypeDef huart1;
 #endif
     void (*HW_huart1RxCb)(void);
     void (*HW_huart1TxCb)(void);
+#if (CFG_HW_USART1_DMA_RX_SUPPORTED == 1)
+    void (*HW_huart1RxEventCb)(uint16_t pos);
+    uint8_t *HW_huart1RxBuffer;
+    uint16_t HW_huart1RxSize;
+#endif
 #endif
 
 #if (CFG_HW_LPUART1_ENABLED == 1)
@@ -212,6 +217,57 @@ hw_status_t HW_UART_Transmit_DMA(hw_uart_id_t hw_uart_id, uint8_t *p_data, uint1
     return hw_status;
 }
 
+/**
+ * The DMA writes the received bytes in a circular buffer, the callback is called under interrupt with the position
+ * of the DMA in the buffer at the half and at the end of the buffer and when the line becomes idle.
+ * The reception is restarted by the driver after an error, the callback is then called with HW_UART_RX_RESTART.
+ */
+hw_status_t HW_UART_Receive_DMA_Circular(hw_uart_id_t hw_uart_id, uint8_t *p_data, uint16_t size, void (*cb)(uint16_t pos))
+{
+    HAL_StatusTypeDef hal_status = HAL_ERROR;
+    hw_status_t hw_status = hw_uart_ok;
+
+    switch (hw_uart_id)
+    {
+#if (CFG_HW_USART1_DMA_RX_SUPPORTED == 1)
+        case hw_uart1:
+            HW_huart1RxEventCb = cb;
+            HW_huart1RxBuffer = p_data;
+            HW_huart1RxSize = size;
+            huart1.Instance = USART1;
+            hal_status = HAL_UARTEx_ReceiveToIdle_DMA(&huart1, p_data, size);
+            break;
+#endif
+
+        default:
+            break;
+    }
+
+    switch (hal_status)
+    {
+        case HAL_OK:
+            hw_status = hw_uart_ok;
+            break;
+
+        case HAL_ERROR:
+            hw_status = hw_uart_error;
+            break;
+
+        case HAL_BUSY:
+            hw_status = hw_uart_busy;
+            break;
+
+        case HAL_TIMEOUT:
+            hw_status = hw_uart_to;
+            break;
+
+        default:
+            break;
+    }
+
+    return hw_status;
+}
+
 void HW_UART_Interrupt_Handler(hw_uart_id_t hw_uart_id)
 {
     switch (hw_uart_id)
@@ -315,3 +371,45 @@ void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
 
     return;
 }
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    switch ((uint32_t)huart->Instance)
+    {
+#if (CFG_HW_USART1_DMA_RX_SUPPORTED == 1)
+        case (uint32_t)USART1:
+            if(HW_huart1RxEventCb)
+            {
+                HW_huart1RxEventCb(Size);
+            }
+            break;
+#endif
+
+        default:
+            break;
+    }
+
+    return;
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    switch ((uint32_t)huart->Instance)
+    {
+#if (CFG_HW_USART1_DMA_RX_SUPPORTED == 1)
+        case (uint32_t)USART1:
+            /* Any error aborts a DMA reception, start it again from the buffer start */
+            if((HW_huart1RxEventCb) && (huart->RxState == HAL_UART_STATE_READY))
+            {
+                HW_huart1RxEventCb(HW_UART_RX_RESTART);
+                (void)HAL_UARTEx_ReceiveToIdle_DMA(&huart1, HW_huart1RxBuffer, HW_huart1RxSize);
+            }
+            break;
+#endif
+
+        default:
+            break;
+    }
+
+    return;
+}
@@ -26,6 +26,7 @@
 #include "dbg_trace.h"
 #include "hw_conf.h"
 #include "otp.h"
+#include "app_ext_flash.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -280,24 +281,8 @@ static void MX_QUADSPI_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN QUADSPI_Init 2 */
-  QSPI_CommandTypeDef      sCommand;
-  QSPI_MemoryMappedTypeDef sMemMappedCfg;
-  
-  sCommand.Instruction = QUAD_IN_FAST_PROG_CMD;
-  sCommand.AddressMode = QSPI_ADDRESS_1_LINE;
-  sCommand.DataMode    = QSPI_DATA_4_LINES;
-  sCommand.NbData      = 10;
-  sCommand.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
-  sCommand.AddressSize       = QSPI_ADDRESS_24_BITS;
-  sCommand.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
-  sCommand.DdrMode           = QSPI_DDR_MODE_DISABLE;
-  sCommand.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
-  sCommand.Instruction = QUAD_OUT_FAST_READ_CMD;
-  sCommand.DummyCycles = DUMMY_CLOCK_CYCLES_READ;
-
-  sMemMappedCfg.TimeOutActivation = QSPI_TIMEOUT_COUNTER_DISABLE;
-
-  if (HAL_QSPI_MemoryMapped(&hqspi, &sCommand, &sMemMappedCfg) != HAL_OK)
+  /* The song is read in place at EXT_FLASH_MAPPED_ADDRESS */
+  if (EXT_FLASH_Memory_Mapped_Enable() != EXT_FLASH_OK)
   {
     Error_Handler();
   }
@@ -405,7 +390,13 @@ void MX_USART1_UART_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN USART1_Init 2 */
-
+#if (CFG_HOSTCTL_BAUDRATE != 115200)
+  huart1.Init.BaudRate = CFG_HOSTCTL_BAUDRATE;
+  if (HAL_UART_Init(&huart1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+#endif
   /* USER CODE END USART1_Init 2 */
 
 }
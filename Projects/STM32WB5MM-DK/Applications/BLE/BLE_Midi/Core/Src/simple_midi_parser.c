@@ -45,6 +45,14 @@ enum MetaEventName
 #define MIDI_FILE_HEADER        (0x4d546864U)
 #define MIDI_CHUNCK_HEADER      (0x4d54726BU)
 
+/* Header chunck : type, length, format, number of tracks and division */
+#define MIDI_FILE_HEADER_SIZE   (14U)
+/* Track chunck : type and length */
+#define MIDI_CHUNCK_HEADER_SIZE (8U)
+
+/* Text of the meta events and of the system exclusive messages, end of string included */
+#define MIDI_STRING_MAX_SIZE    (200U)
+
 #define AFTER_TOUCH             (0xA0U)
 #define CONTROL_CHANGE          (0xB0U)
 #define PROGRAM_CHANGE          (0xC0U)
@@ -58,11 +66,13 @@ enum MetaEventName
 static void    Rev_Memcpy( uint8_t *dst, const uint8_t *src, size_t n );
 static uint8_t Read32(uint32_t* dst,uint8_t *src);
 static uint8_t Read16(uint16_t* dst,uint8_t *src);
-static uint8_t ReadValue(uint32_t* dst,uint8_t *src);
+static uint8_t ReadValue(uint32_t* dst,uint8_t *src, uint8_t *end);
 static void    ReadString(uint8_t* buffer, uint8_t* src, uint32_t nLength);
+static void    AddTempo(Midi_Tempo_Event_t* tempo_map, uint8_t* tempo_nbr, uint32_t tick, uint32_t tempo);
 
-uint8_t ParseMidi(uint8_t* flash, uint8_t* trackname, uint16_t* ticks_per_beat, 
-                  uint32_t* tempo, Midi_Note_Event_t* song, uint16_t* index);
+uint8_t ParseMidi(uint8_t* flash, uint32_t size, uint8_t* trackname, uint16_t* ticks_per_beat, 
+                  uint32_t* tempo, Midi_Note_Event_t* song, uint16_t* index,
+                  Midi_Tempo_Event_t* tempo_map, uint8_t* tempo_nbr);
 
 /* Functions Definition ------------------------------------------------------*/
 
@@ -115,12 +125,15 @@ static uint8_t Read16(uint16_t* dst,uint8_t *src)
 /*
  * @brief Read a variable length data from midi file buffer
  *
+ * @note  The value is 4 bytes at most and is not read beyond end, src must be before end
+ *
  * @param dst   pointer to the destination buffer
  * @param src   pointer to the source buffer
+ * @param end   end of the source buffer
  *
  * @retval      number of bytes readed
  */
-static uint8_t ReadValue(uint32_t* dst, uint8_t *src)
+static uint8_t ReadValue(uint32_t* dst, uint8_t *src, uint8_t *end)
 {
   uint32_t value = 0;
   uint8_t byte = 0;
@@ -133,6 +146,10 @@ static uint8_t ReadValue(uint32_t* dst, uint8_t *src)
     value &= 0x7F;
     do
     {
+      if((src >= end) || (length >= 4U))
+      {
+        break;
+      }
       byte = *(src++);
       value = (value<<7) | (byte & 0x7F);
       length++;
@@ -145,6 +162,7 @@ static uint8_t ReadValue(uint32_t* dst, uint8_t *src)
 
 /*
  * @brief Read a string from midi file buffer
+ * @note  The string is cut to MIDI_STRING_MAX_SIZE bytes, end of string included
  *
  * @param dst   pointer to the destination buffer
  * @param src   pointer to the source buffer
@@ -155,6 +173,10 @@ static uint8_t ReadValue(uint32_t* dst, uint8_t *src)
 static void ReadString(uint8_t *buffer, uint8_t* src, uint32_t length)
 {
   uint32_t i;
+  if(length > (MIDI_STRING_MAX_SIZE - 1U))
+  {
+    length = MIDI_STRING_MAX_SIZE - 1U;
+  }
   for(i = 0; i < length; i++)
   {
     buffer[i] = src[i];
@@ -162,6 +184,39 @@ static void ReadString(uint8_t *buffer, uint8_t* src, uint32_t length)
   buffer[length]='\0';
 }
 
+/*
+ * @brief Insert a tempo change in the tempo map, keeping it sorted by position
+ * @note  A tempo change at the same position as an existing one replaces it
+ *
+ * @param tempo_map     tempo map buffer
+ * @param tempo_nbr     number of tempo changes in the map
+ * @param tick          absolute position of the change in ticks
+ * @param tempo         tempo in microseconds per quarter note
+ */
+static void AddTempo(Midi_Tempo_Event_t* tempo_map, uint8_t* tempo_nbr, uint32_t tick, uint32_t tempo)
+{
+  uint8_t i = *tempo_nbr;
+
+  while((i > 0) && (tempo_map[i - 1].Tick > tick))
+  {
+    i--;
+  }
+  if((i > 0) && (tempo_map[i - 1].Tick == tick))
+  {
+    tempo_map[i - 1].Tempo = tempo;
+    return;
+  }
+  if((*tempo_nbr) >= MAX_TEMPO_EVENTS)
+  {
+    MIDI_PARSER_DBG_MSG_LIGHT("Tempo map full, tempo change at %ld ignored\n\r", tick);
+    return;
+  }
+  memmove(&tempo_map[i + 1], &tempo_map[i], ((*tempo_nbr) - i) * sizeof(Midi_Tempo_Event_t));
+  tempo_map[i].Tick = tick;
+  tempo_map[i].Tempo = tempo;
+  (*tempo_nbr)++;
+}
+
 /* End of utils functions --------------------------------------------------- */
 
 /*
@@ -170,19 +225,24 @@ static void ReadString(uint8_t *buffer, uint8_t* src, uint32_t length)
  * 		  This is done in order to prevent the next track note's to be append to the first track and not in parallel.
  * 		  Midi file used for testing was using the first track for tempo and name info and the second track for notes.
  * @param flash specifies the start address of the file (in file or not as long as this address is accessible)
+ * @param size is the size of the file, no chunck is read beyond
  * @param trackname is a pointer to a buffer for the trackname string
  * @param ticks_per_beat is a pointer to write the parsed ticks_per_beat
  * @param tempo is a pointer to write the first tempo found in file (unit is microseconds per quarter note)
  * @param song is a buffer to store the events with their deltas (only Note On/Off events are stored)
  * @param index is the index of the first empty element in the buffer. Just after the last event.
+ * @param tempo_map is a buffer to store all the tempo changes with their absolute position in ticks
+ * @param tempo_nbr is the number of tempo changes written in tempo_map
  */
-uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat, uint32_t* tempo,
-                  Midi_Note_Event_t* song, uint16_t* index)
+uint8_t ParseMidi(uint8_t* flash, uint32_t size, uint8_t *trackname, uint16_t* ticks_per_beat, uint32_t* tempo,
+                  Midi_Note_Event_t* song, uint16_t* index,
+                  Midi_Tempo_Event_t* tempo_map, uint8_t* tempo_nbr)
 {
   uint32_t m_nTempo = 0;
   uint32_t m_nBPM = 0;
   
-  uint8_t buffer[200];
+  uint8_t buffer[MIDI_STRING_MAX_SIZE];
+  uint8_t* fileEnd = flash + size;
   uint8_t channel;
   uint8_t pressure;
   uint8_t sequence1;
@@ -219,7 +279,14 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
   UNUSED(minor);
   UNUSED(key);
   
-  MIDI_PARSER_DBG_MSG_LIGHT("Accessing %p\n\r", flash);
+  MIDI_PARSER_DBG_MSG_LIGHT("Accessing %p, %ld bytes\n\r", flash, size);
+  
+  if(size < MIDI_FILE_HEADER_SIZE)
+  {
+    MIDI_PARSER_DBG_MSG_LIGHT("No Midi file detected : %ld bytes\n\r", size);
+
+    return MIDI_PARSING_NO_FILE;
+  }
   
   uint32_t string_header;
   flash += Read32(&string_header, flash);
@@ -245,6 +312,11 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
       
       for(uint16_t nChunck = 0; nChunck < n && nChunck < 2; nChunck++)
       {
+        if((uint32_t)(fileEnd - flash) < MIDI_CHUNCK_HEADER_SIZE)
+        {
+          MIDI_PARSER_DBG_MSG_LIGHT("End of file before track %d\n\r", nChunck);
+          break;
+        }
         flash += Read32(&string_header, flash);
         if(string_header != MIDI_CHUNCK_HEADER)
         {
@@ -256,8 +328,15 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
           uint32_t track_length;
           flash += Read32(&track_length, flash);
           MIDI_PARSER_DBG_MSG_LIGHT("Track length = %ld bytes\n\r", track_length);
+          if(track_length > (uint32_t)(fileEnd - flash))
+          {
+            MIDI_PARSER_DBG_MSG_LIGHT("Track cut to the end of file, %ld bytes\n\r", (uint32_t)(fileEnd - flash));
+            track_length = fileEnd - flash;
+          }
 
-          uint8_t* trackStart = flash;
+          uint8_t* trackStop = flash + track_length;
+          uint32_t trackTick = 0;
+          uint32_t noteTick = 0;        /* Tick of the last note event kept, the other events are skipped */
           uint8_t trackEnd = 0;
           uint8_t previousStatus;
           
@@ -266,11 +345,17 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
            * info is found or if we exceed the length that were indicated for 
            * that chunck
            */
-          while(!trackEnd && ((flash - trackStart) < track_length))
+          while(!trackEnd && (flash < trackStop))
           {
             uint32_t delta;
               
-            flash += ReadValue(&delta, flash);
+            flash += ReadValue(&delta, flash, trackStop);
+            if(flash >= trackStop)
+            {
+              MIDI_PARSER_DBG_MSG_LIGHT("Event cut by the end of track\n\r");
+              break;
+            }
+            trackTick += delta;
             uint8_t status = (*flash++);
             
             MIDI_PARSER_DBG_MSG_FULL("Delta = %d\n\r",delta);
@@ -287,6 +372,22 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
               flash--;
             }
             
+            /* Channel events have 1 or 2 data bytes, meta events a type and a length */
+            uint32_t eventLength = 0;
+            if(status < SYSTEM_EXCLUSIVE)
+            {
+              eventLength = (((status & 0xF0) == PROGRAM_CHANGE) || ((status & 0xF0) == CHANNEL_PRESSURE)) ? 1U : 2U;
+            }
+            else if(status == 0xFF)
+            {
+              eventLength = 2U;
+            }
+            if((uint32_t)(trackStop - flash) < eventLength)
+            {
+              MIDI_PARSER_DBG_MSG_LIGHT("Event cut by the end of track\n\r");
+              break;
+            }
+            
             switch(status & 0xF0)
             {
               case NOTE_OFF:
@@ -295,7 +396,8 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
                 NoteID = *flash++;
                 NoteVelocity = *flash++;
                 Midi_Note_Event_t evt;
-                evt.Delta = delta;
+                evt.Delta = trackTick - noteTick;
+                noteTick = trackTick;
                 evt.Status = status;
                 evt.Note = NoteID;
                 evt.Velocity = NoteVelocity;
@@ -313,7 +415,8 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
                 NoteID = *flash++;
                 NoteVelocity = *flash++;
                 Midi_Note_Event_t evt;
-                evt.Delta = delta;
+                evt.Delta = trackTick - noteTick;
+                noteTick = trackTick;
                 evt.Status = status;
                 evt.Note = NoteID;
                 evt.Velocity = NoteVelocity;
@@ -381,15 +484,28 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
                 {
                   uint8_t nType = *flash++;
                   uint32_t nLength;
-                  flash += ReadValue(&nLength, flash);
+                  flash += ReadValue(&nLength, flash, trackStop);
                   
                   MIDI_PARSER_DBG_MSG_FULL("nType = %ld , length = %ld\n\r",nType,nLength);
+                  if(nLength > (uint32_t)(trackStop - flash))
+                  {
+                    MIDI_PARSER_DBG_MSG_LIGHT("Meta event of %ld bytes beyond the end of track\n\r", nLength);
+                    trackEnd = 1;
+                    break;
+                  }
+                  
+                  /* The meta event is skipped from its length, whatever was read */
+                  uint8_t* metaEnd = flash + nLength;
                   
                   switch (nType)
                   {
    
                     case MetaSequence:
                     {
+                      if(nLength < 2U)
+                      {
+                        break;
+                      }
                       sequence1 = *flash++;
                       sequence2 = *flash++;
                       MIDI_PARSER_DBG_MSG_FULL("Sequence Number: %d%d\n\r", sequence1, sequence2);
@@ -415,7 +531,8 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
                       if(nChunck == 0)
                       {
                         /* For simplicity we only tack the first trackname */
-                        memcpy(trackname,buffer,nLength);
+                        strncpy((char *)trackname, (char *)buffer, MAX_TRACKNAME_SIZE - 1U);
+                        trackname[MAX_TRACKNAME_SIZE - 1U] = '\0';
                       }
                       break;
                       
@@ -445,6 +562,10 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
                       
                     case MetaChannelPrefix:
                     {
+                      if(nLength < 1U)
+                      {
+                        break;
+                      }
                       prefix = *flash++;
                       MIDI_PARSER_DBG_MSG_FULL("Prefix: %d\n\r", prefix);
                       break;
@@ -457,8 +578,13 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
                       
                     case MetaSetTempo:
                       /* Tempo is in microseconds per quarter note */
+                      if(nLength < 3U)
+                      {
+                        break;
+                      }
                       Rev_Memcpy((uint8_t*)&m_nTempo, flash, 3);
                       flash += 3;
+                      AddTempo(tempo_map, tempo_nbr, trackTick, m_nTempo);
                       if (*tempo == 0)
                       {
                         m_nBPM = (60000000 / m_nTempo);
@@ -478,6 +604,10 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
                       
                     case MetaTimeSignature:
                     {
+                      if(nLength < 4U)
+                      {
+                        break;
+                      }
                       n = *flash++;
                       d = (*flash++)*2;
                       MIDI_PARSER_DBG_MSG_FULL("Time Signature: %d/%d\n\r", n, d);
@@ -491,6 +621,10 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
 
                     case MetaKeySignature:
                     {
+                      if(nLength < 2U)
+                      {
+                        break;
+                      }
                       key = *flash++;
                       minor = *flash++;
                       MIDI_PARSER_DBG_MSG_FULL("Key Signature: %d\n\r", key);
@@ -507,11 +641,18 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
                     default:
                       MIDI_PARSER_DBG_MSG_FULL("Unrecognised MetaEvent: %d\n\r", nType);
                   }
+                  flash = metaEnd;
                 }
                 else if(status == 0xF0)
                 {
                   uint32_t nLength;
-                  flash += ReadValue(&nLength, flash);
+                  flash += ReadValue(&nLength, flash, trackStop);
+                  if(nLength > (uint32_t)(trackStop - flash))
+                  {
+                    MIDI_PARSER_DBG_MSG_LIGHT("Sys ex message of %ld bytes beyond the end of track\n\r", nLength);
+                    trackEnd = 1;
+                    break;
+                  }
                   ReadString(buffer, flash, nLength);
                   flash += nLength;
                   MIDI_PARSER_DBG_MSG_FULL("Sys ex message begin: %s\n\r", buffer);
@@ -519,7 +660,13 @@ uint8_t ParseMidi(uint8_t* flash, uint8_t *trackname, uint16_t* ticks_per_beat,
                 else if(status == 0xF7)
                 {
                   uint32_t nLength;
-                  flash += ReadValue(&nLength, flash);
+                  flash += ReadValue(&nLength, flash, trackStop);
+                  if(nLength > (uint32_t)(trackStop - flash))
+                  {
+                    MIDI_PARSER_DBG_MSG_LIGHT("Sys ex message of %ld bytes beyond the end of track\n\r", nLength);
+                    trackEnd = 1;
+                    break;
+                  }
                   ReadString(buffer, flash, nLength);
                   flash += nLength;
                   MIDI_PARSER_DBG_MSG_FULL("Sys ex message end: %s\n\r",buffer);
@@ -43,7 +43,9 @@ extern DMA_HandleTypeDef hdma_usart1_tx;
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN PV */
-
+#if (CFG_HW_USART1_DMA_RX_SUPPORTED == 1)
+static DMA_HandleTypeDef hdma_usart1_rx;
+#endif
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -343,7 +345,29 @@ void HAL_UART_MspInit(UART_HandleTypeDef* huart)
     HAL_NVIC_SetPriority(USART1_IRQn, 0, 0);
     HAL_NVIC_EnableIRQ(USART1_IRQn);
   /* USER CODE BEGIN USART1_MspInit 1 */
+#if (CFG_HW_USART1_DMA_RX_SUPPORTED == 1)
+    /* USART1_RX Init : circular, the host control frames are read behind the DMA */
+    CFG_HW_USART1_DMAMUX_CLK_ENABLE();
+    CFG_HW_USART1_DMA_CLK_ENABLE();
+    hdma_usart1_rx.Instance = CFG_HW_USART1_RX_DMA_CHANNEL;
+    hdma_usart1_rx.Init.Request = CFG_HW_USART1_RX_DMA_REQ;
+    hdma_usart1_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_usart1_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_usart1_rx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_usart1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_usart1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_usart1_rx.Init.Mode = DMA_CIRCULAR;
+    hdma_usart1_rx.Init.Priority = DMA_PRIORITY_HIGH;
+    if (HAL_DMA_Init(&hdma_usart1_rx) != HAL_OK)
+    {
+      Error_Handler();
+    }
+
+    __HAL_LINKDMA(huart,hdmarx,hdma_usart1_rx);
 
+    HAL_NVIC_SetPriority(CFG_HW_USART1_RX_DMA_IRQn, CFG_HW_USART1_DMA_RX_PREEMPTPRIORITY, CFG_HW_USART1_DMA_RX_SUBPRIORITY);
+    HAL_NVIC_EnableIRQ(CFG_HW_USART1_RX_DMA_IRQn);
+#endif
   /* USER CODE END USART1_MspInit 1 */
   }
 
@@ -377,7 +401,10 @@ void HAL_UART_MspDeInit(UART_HandleTypeDef* huart)
     /* USART1 interrupt DeInit */
     HAL_NVIC_DisableIRQ(USART1_IRQn);
   /* USER CODE BEGIN USART1_MspDeInit 1 */
-
+#if (CFG_HW_USART1_DMA_RX_SUPPORTED == 1)
+    HAL_DMA_DeInit(huart->hdmarx);
+    HAL_NVIC_DisableIRQ(CFG_HW_USART1_RX_DMA_IRQn);
+#endif
   /* USER CODE END USART1_MspDeInit 1 */
   }
 
@@ -23,6 +23,10 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "stm32wb5mm_dk.h"
+#include "app_led.h"
+#if (CFG_AUDIO_MIDI_SUPPORTED != 0)
+#include "stm32wb5mm_dk_audio.h"
+#endif /* CFG_AUDIO_MIDI_SUPPORTED */
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -298,19 +302,43 @@ void PUSH_BUTTON_SW_EXTI_IRQHandler(void)
   HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_13);
 }
 
+void RTC_WKUP_IRQHandler(void)
+{
+  HW_TS_RTC_Wakeup_Handler();
+}
+
+#if (CFG_HW_USART1_DMA_RX_SUPPORTED == 1)
 /**
-  * @brief  This function handles TIM17 IRQ Handler.
+  * @brief  This function handles the USART1 RX DMA IRQ Handler (half and full buffer of the circular reception).
   * @param  None
   * @retval None
   */
-void TIM1_TRG_COM_TIM17_IRQHandler(void)
+void CFG_HW_USART1_DMA_RX_IRQHandler(void)
 {
-  BSP_PWM_LED_IRQHandler();
+  HAL_DMA_IRQHandler(huart1.hdmarx);
 }
+#endif /* CFG_HW_USART1_DMA_RX_SUPPORTED */
 
-void RTC_WKUP_IRQHandler(void)
+#if (CFG_AUDIO_MIDI_SUPPORTED != 0)
+/**
+  * @brief  This function handles the microphone SAI DMA IRQ Handler.
+  * @param  None
+  * @retval None
+  */
+void DMA1_Channel1_IRQHandler(void)
 {
-  HW_TS_RTC_Wakeup_Handler();
+  HAL_DMA_IRQHandler(hAudioInSai.hdmarx);
+}
+#endif /* CFG_AUDIO_MIDI_SUPPORTED */
+
+/**
+  * @brief  This function handles the RGB LED DMA IRQ Handler (end of the frame).
+  * @param  None
+  * @retval None
+  */
+void DMA1_Channel2_IRQHandler(void)
+{
+  LED_PWM_IRQHandler();
 }
 
 /* USER CODE END 1 */
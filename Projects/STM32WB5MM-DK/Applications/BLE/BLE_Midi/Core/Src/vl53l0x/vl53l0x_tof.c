@@ -244,15 +244,46 @@ VL53L0X_Error VL53L0X_PollingDelay(VL53L0X_DEV Dev) {
 }
 
 /**
- *  Setup all detected sensors for single shot mode and setup ranging configuration
+ *  Apply a reference calibration measured at a previous boot, read back to check it
  */
-void SetupSingleShot(VL53L0X_Dev_t Dev)
+static int RestoreRefCal(VL53L0X_Dev_t *pDev, const VL53L0X_RefCal_t *pRefCal)
 {
   int status;
   uint8_t VhvSettings;
   uint8_t PhaseCal;
-  uint32_t refSpadCount;
-	uint8_t isApertureSpads;
+
+  /* VL53L0X_set_reference_spads() enables 44 SPADs at most, the phase has 7 bits */
+  if( (pRefCal->refSpadCount == 0) || (pRefCal->refSpadCount > 44) ||
+      (pRefCal->isApertureSpads > 1) || (pRefCal->PhaseCal > 0x7F) ){
+    return VL53L0X_ERROR_INVALID_PARAMS;
+  }
+
+  status = VL53L0X_SetReferenceSpads(pDev, pRefCal->refSpadCount, pRefCal->isApertureSpads);
+  if( status == VL53L0X_ERROR_NONE ){
+    status = VL53L0X_SetRefCalibration(pDev, pRefCal->VhvSettings, pRefCal->PhaseCal);
+  }
+  if( status == VL53L0X_ERROR_NONE ){
+    status = VL53L0X_GetRefCalibration(pDev, &VhvSettings, &PhaseCal);
+  }
+  if( (status == VL53L0X_ERROR_NONE) &&
+      ((VhvSettings != pRefCal->VhvSettings) || (PhaseCal != pRefCal->PhaseCal)) ){
+    status = VL53L0X_ERROR_REF_SPAD_INIT;
+  }
+
+  return status;
+}
+
+/**
+ *  Setup all detected sensors for single shot mode and setup ranging configuration
+ *
+ *  The reference calibration in pRefCal is applied when restore is set. Otherwise, or when it is
+ *  rejected, the calibration is performed and returned in pRefCal.
+ *  Returns VL53L0X_REFCAL_RESTORED, VL53L0X_REFCAL_MEASURED or VL53L0X_REFCAL_FAILED.
+ */
+int SetupSingleShot(VL53L0X_Dev_t Dev, VL53L0X_RefCal_t *pRefCal, int restore)
+{
+  int status;
+  int refcal = VL53L0X_REFCAL_FAILED;
 	FixPoint1616_t signalLimit = (FixPoint1616_t)(0.25*65536);
 	FixPoint1616_t sigmaLimit = (FixPoint1616_t)(18*65536);
 	uint32_t timingBudget = 33000;
@@ -267,14 +298,30 @@ void SetupSingleShot(VL53L0X_Dev_t Dev)
     }
     
     
-    status = VL53L0X_PerformRefCalibration(&Dev, &VhvSettings, &PhaseCal);
-    if( status ){
-      printf("VL53L0X_PerformRefCalibration failed\n");
+    if( restore ){
+      status = RestoreRefCal(&Dev, pRefCal);
+      if( status ){
+        printf("Reference calibration restore failed\n");
+      }
+      else{
+        refcal = VL53L0X_REFCAL_RESTORED;
+      }
     }
     
-    status = VL53L0X_PerformRefSpadManagement(&Dev, &refSpadCount, &isApertureSpads);
-    if( status ){
-      printf("VL53L0X_PerformRefSpadManagement failed\n");
+    if( refcal != VL53L0X_REFCAL_RESTORED ){
+      refcal = VL53L0X_REFCAL_MEASURED;
+      
+      status = VL53L0X_PerformRefCalibration(&Dev, &pRefCal->VhvSettings, &pRefCal->PhaseCal);
+      if( status ){
+        printf("VL53L0X_PerformRefCalibration failed\n");
+        refcal = VL53L0X_REFCAL_FAILED;
+      }
+      
+      status = VL53L0X_PerformRefSpadManagement(&Dev, &pRefCal->refSpadCount, &pRefCal->isApertureSpads);
+      if( status ){
+        printf("VL53L0X_PerformRefSpadManagement failed\n");
+        refcal = VL53L0X_REFCAL_FAILED;
+      }
     }
     
     status = VL53L0X_SetDeviceMode(&Dev, VL53L0X_DEVICEMODE_SINGLE_RANGING); // Setup in single ranging mode
@@ -327,4 +374,6 @@ void SetupSingleShot(VL53L0X_Dev_t Dev)
     
     Dev.LeakyFirst=1;
   }
+  
+  return refcal;
 }
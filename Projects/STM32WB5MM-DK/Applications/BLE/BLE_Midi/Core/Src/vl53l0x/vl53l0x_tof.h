@@ -58,6 +58,23 @@ typedef struct {
 
 } VL53L0X_Dev_t;
 
+/**
+ * @struct  VL53L0X_RefCal_t
+ * @brief    Reference calibration of the sensor, restored or measured by SetupSingleShot()
+ *
+ */
+typedef struct {
+    uint32_t refSpadCount;
+    uint8_t  isApertureSpads;
+    uint8_t  VhvSettings;
+    uint8_t  PhaseCal;
+} VL53L0X_RefCal_t;
+
+/* Result of the reference calibration in SetupSingleShot() */
+#define VL53L0X_REFCAL_RESTORED     0
+#define VL53L0X_REFCAL_MEASURED     1
+#define VL53L0X_REFCAL_FAILED       2
+
 
 /**
  * @brief   Declare the device Handle as a pointer of the structure @a VL53L0X_Dev_t.
@@ -221,7 +238,7 @@ VL53L0X_Error VL53L0X_UpdateByte(VL53L0X_DEV Dev, uint8_t index, uint8_t AndData
  */
 VL53L0X_Error VL53L0X_PollingDelay(VL53L0X_DEV Dev); /* usually best implemented as a real function */
 
-void SetupSingleShot(VL53L0X_Dev_t Dev);
+int SetupSingleShot(VL53L0X_Dev_t Dev, VL53L0X_RefCal_t *pRefCal, int restore);
 
 #ifdef __cplusplus
 }
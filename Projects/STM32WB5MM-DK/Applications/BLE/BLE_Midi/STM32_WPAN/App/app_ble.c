@@ -38,6 +38,13 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "app_midi.h"
+#include "app_conn_param.h"
+#include "app_link.h"
+#include "app_latency.h"
+#include "app_boot_profile.h"
+#include "app_song_xfer.h"
+#include "app_recorder.h"
+#include "app_settings.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -216,12 +223,6 @@ static BleApplicationContext_t BleApplicationContext;
 
 Custom_App_ConnHandle_Not_evt_t HandleNotification;
 
-#if (L2CAP_REQUEST_NEW_CONN_PARAM != 0)
-#define SIZE_TAB_CONN_INT            2
-float a_ConnInterval[SIZE_TAB_CONN_INT] = {50, 1000}; /* ms */
-uint8_t index_con_int, mutex;
-#endif /* L2CAP_REQUEST_NEW_CONN_PARAM != 0 */
-
 /**
  * Advertising Data
  */
@@ -244,10 +245,6 @@ static void Ble_Hci_Gap_Gatt_Init(void);
 static const uint8_t* BleGetBdAddress(void);
 static void Adv_Request(APP_BLE_ConnStatus_t NewStatus);
 static void Adv_Cancel(void);
-#if (L2CAP_REQUEST_NEW_CONN_PARAM != 0)
-static void BLE_SVC_L2CAP_Conn_Update(uint16_t ConnectionHandle);
-static void Connection_Interval_Update_Req(void);
-#endif /* L2CAP_REQUEST_NEW_CONN_PARAM != 0 */
 
 /* USER CODE BEGIN PFP */
 
@@ -267,6 +264,7 @@ void APP_BLE_Init(void)
   tBleStatus ret = BLE_STATUS_INVALID_PARAMS;
 #endif /* RADIO_ACTIVITY_EVENT != 0 */
   /* USER CODE BEGIN APP_BLE_Init_1 */
+  BOOT_PROFILE_PHASE(BOOT_PROFILE_BLE_INIT);
 
   /* USER CODE END APP_BLE_Init_1 */
   SHCI_C2_Ble_Init_Cmd_Packet_t ble_init_cmd_packet =
@@ -356,6 +354,7 @@ void APP_BLE_Init(void)
   UTIL_SEQ_RegTask(1<<CFG_TASK_ADV_CANCEL_ID, UTIL_SEQ_RFU, Adv_Cancel);
 
   /* USER CODE BEGIN APP_BLE_Init_4 */
+  BOOT_PROFILE_PHASE(BOOT_PROFILE_GAP_GATT);
 
   /* USER CODE END APP_BLE_Init_4 */
 
@@ -375,8 +374,10 @@ void APP_BLE_Init(void)
 #endif /* RADIO_ACTIVITY_EVENT != 0 */
 
 #if (L2CAP_REQUEST_NEW_CONN_PARAM != 0)
-  index_con_int = 0;
-  mutex = 1;
+  /**
+   * Connection parameters follow the Midi activity
+   */
+  CONN_PARAM_Init();
 #endif /* L2CAP_REQUEST_NEW_CONN_PARAM != 0 */
 
   /**
@@ -385,6 +386,11 @@ void APP_BLE_Init(void)
   Custom_APP_Init();
 
   /* USER CODE BEGIN APP_BLE_Init_3 */
+  LINK_Init();
+  SONG_XFER_Init();
+  RECORDER_Init();
+  SETTINGS_Init();
+  BOOT_PROFILE_PHASE(BOOT_PROFILE_SERVICES);
 
   /* USER CODE END APP_BLE_Init_3 */
 
@@ -400,6 +406,7 @@ void APP_BLE_Init(void)
   Adv_Request(APP_BLE_FAST_ADV);
 
   /* USER CODE BEGIN APP_BLE_Init_2 */
+  BOOT_PROFILE_PHASE(BOOT_PROFILE_ADVERTISING);
 
   /* USER CODE END APP_BLE_Init_2 */
 
@@ -449,6 +456,16 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification(void *p_Pckt)
       }
 
       /* USER CODE BEGIN EVT_DISCONN_COMPLETE_1 */
+      LINK_Disconnected(p_disconnection_complete_event->Connection_Handle);
+      if ((LINK_Get_Connected_Nbr() + 1U) < CFG_BLE_NUM_LINK)
+      {
+        /* Still advertising for another central, stop it before the restart below */
+        aci_gap_set_non_discoverable();
+      }
+#if (L2CAP_REQUEST_NEW_CONN_PARAM != 0)
+      CONN_PARAM_Disconnected(p_disconnection_complete_event->Connection_Handle);
+#endif /* L2CAP_REQUEST_NEW_CONN_PARAM != 0 */
+      SONG_XFER_Disconnected(p_disconnection_complete_event->Connection_Handle);
 
       /* USER CODE END EVT_DISCONN_COMPLETE_1 */
 
@@ -459,7 +476,7 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification(void *p_Pckt)
        * SPECIFIC to Custom Template APP
        */
       HandleNotification.Custom_Evt_Opcode = CUSTOM_DISCON_HANDLE_EVT;
-      HandleNotification.ConnectionHandle = BleApplicationContext.BleApplicationContext_legacy.connectionHandle;
+      HandleNotification.ConnectionHandle = p_disconnection_complete_event->Connection_Handle;
       Custom_APP_Notification(&HandleNotification);
       /* USER CODE BEGIN EVT_DISCONN_COMPLETE */
 
@@ -486,6 +503,17 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification(void *p_Pckt)
 #endif /* CFG_DEBUG_APP_TRACE != 0 */
 
           /* USER CODE BEGIN EVT_LE_CONN_UPDATE_COMPLETE */
+#if (L2CAP_REQUEST_NEW_CONN_PARAM != 0)
+          {
+            hci_le_connection_update_complete_event_rp0 *p_update = (hci_le_connection_update_complete_event_rp0 *) p_meta_evt->data;
+
+            CONN_PARAM_Update_Complete(p_update->Status,
+                                       p_update->Connection_Handle,
+                                       p_update->Conn_Interval,
+                                       p_update->Conn_Latency,
+                                       p_update->Supervision_Timeout);
+          }
+#endif /* L2CAP_REQUEST_NEW_CONN_PARAM != 0 */
 
           /* USER CODE END EVT_LE_CONN_UPDATE_COMPLETE */
           break;
@@ -529,6 +557,21 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification(void *p_Pckt)
           HandleNotification.ConnectionHandle = BleApplicationContext.BleApplicationContext_legacy.connectionHandle;
           Custom_APP_Notification(&HandleNotification);
           /* USER CODE BEGIN HCI_EVT_LE_CONN_COMPLETE */
+          LINK_Connected(p_connection_complete_event->Connection_Handle);
+          if (LINK_Get_Connected_Nbr() < CFG_BLE_NUM_LINK)
+          {
+            /* Keep advertising so that another central can join the Midi stream */
+            APP_BLE_ConnStatus_t connection_status = BleApplicationContext.Device_Connection_Status;
+
+            Adv_Request(APP_BLE_FAST_ADV);
+            BleApplicationContext.Device_Connection_Status = connection_status;
+          }
+#if (L2CAP_REQUEST_NEW_CONN_PARAM != 0)
+          CONN_PARAM_Connected(p_connection_complete_event->Connection_Handle,
+                               p_connection_complete_event->Conn_Interval,
+                               p_connection_complete_event->Conn_Latency,
+                               p_connection_complete_event->Supervision_Timeout);
+#endif /* L2CAP_REQUEST_NEW_CONN_PARAM != 0 */
 
           /* USER CODE END HCI_EVT_LE_CONN_COMPLETE */
           break; /* HCI_LE_CONNECTION_COMPLETE_SUBEVT_CODE */
@@ -542,6 +585,30 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification(void *p_Pckt)
       }
 
       /* USER CODE BEGIN META_EVT */
+      switch (p_meta_evt->subevent)
+      {
+        case HCI_LE_PHY_UPDATE_COMPLETE_SUBEVT_CODE:
+        {
+          hci_le_phy_update_complete_event_rp0 *p_phy_update = (hci_le_phy_update_complete_event_rp0 *) p_meta_evt->data;
+
+          if (p_phy_update->Status == BLE_STATUS_SUCCESS)
+          {
+            LINK_Phy_Update(p_phy_update->Connection_Handle, p_phy_update->TX_PHY, p_phy_update->RX_PHY);
+          }
+          break;
+        }
+
+        case HCI_LE_DATA_LENGTH_CHANGE_SUBEVT_CODE:
+        {
+          hci_le_data_length_change_event_rp0 *p_data_length = (hci_le_data_length_change_event_rp0 *) p_meta_evt->data;
+
+          LINK_Data_Length_Change(p_data_length->Connection_Handle, p_data_length->MaxTxOctets, p_data_length->MaxRxOctets);
+          break;
+        }
+
+        default:
+          break;
+      }
 
       /* USER CODE END META_EVT */
       break; /* HCI_LE_META_EVT_CODE */
@@ -563,7 +630,8 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification(void *p_Pckt)
          */
         case ACI_L2CAP_CONNECTION_UPDATE_RESP_VSEVT_CODE:
 #if (L2CAP_REQUEST_NEW_CONN_PARAM != 0)
-          mutex = 1;
+          CONN_PARAM_Update_Resp(((aci_l2cap_connection_update_resp_event_rp0 *)(p_blecore_evt->data))->Connection_Handle,
+                                 ((aci_l2cap_connection_update_resp_event_rp0 *)(p_blecore_evt->data))->Result);
 #endif /* L2CAP_REQUEST_NEW_CONN_PARAM != 0 */
           /* USER CODE BEGIN EVT_BLUE_L2CAP_CONNECTION_UPDATE_RESP */
 
@@ -651,6 +719,16 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification(void *p_Pckt)
         /* PAIRING */
 
         /* USER CODE BEGIN BLUE_EVT */
+        case ACI_GATT_TX_POOL_AVAILABLE_VSEVT_CODE:
+          /* Resume the Midi notifications of the centrals that were waiting for TX buffers */
+          LATENCY_PROBE(LATENCY_PROBE_TX_POOL_AVAILABLE);
+          Midi_Tx_Schedule();
+          break;
+
+        case ACI_ATT_EXCHANGE_MTU_RESP_VSEVT_CODE:
+          LINK_Mtu_Exchanged(((aci_att_exchange_mtu_resp_event_rp0 *)(p_blecore_evt->data))->Connection_Handle,
+                             ((aci_att_exchange_mtu_resp_event_rp0 *)(p_blecore_evt->data))->Server_RX_MTU);
+          break;
 
         /* USER CODE END BLUE_EVT */
       }
@@ -697,6 +775,18 @@ void APP_BLE_Key_Button2_Action(void)
     prevTick=tick;
   }
 }
+
+/*
+ * @brief Stop the batch of HCI user events when a Midi task is waiting to be run
+ *
+ * @retval              1 to give back the hand to the sequencer
+ */
+uint8_t APP_BLE_Hci_Evt_Batch_Yield(void)
+{
+  return (uint8_t)(UTIL_SEQ_IsSchedulableTask(1<<CFG_TASK_MIDI_SEQ) |
+                   UTIL_SEQ_IsSchedulableTask(1<<CFG_TASK_MIDI_TX) |
+                   UTIL_SEQ_IsSchedulableTask(1<<CFG_TASK_AUDIO_MIDI));
+}
 /* USER CODE END FD*/
 
 /*************************************************************
@@ -972,6 +1062,18 @@ static void Ble_Hci_Gap_Gatt_Init(void)
   BleApplicationContext.BleApplicationContext_legacy.bleSecurityParam.Fixed_Pin = CFG_FIXED_PIN;
   BleApplicationContext.BleApplicationContext_legacy.bleSecurityParam.bonding_mode = CFG_BONDING_MODE;
   /* USER CODE BEGIN Ble_Hci_Gap_Gatt_Init_1*/
+  /**
+   * Initialize Data Length Extension, used by the links created from now on
+   */
+  ret = hci_le_write_suggested_default_data_length(LINK_MAX_TX_OCTETS, LINK_MAX_TX_TIME);
+  if (ret != BLE_STATUS_SUCCESS)
+  {
+    APP_DBG_MSG("  Fail   : hci_le_write_suggested_default_data_length command, result: 0x%x \n", ret);
+  }
+  else
+  {
+    APP_DBG_MSG("  Success: hci_le_write_suggested_default_data_length command\n");
+  }
 
   /* USER CODE END Ble_Hci_Gap_Gatt_Init_1*/
 
@@ -1139,56 +1241,6 @@ static void Adv_Cancel(void)
   return;
 }
 
-#if (L2CAP_REQUEST_NEW_CONN_PARAM != 0)
-void BLE_SVC_L2CAP_Conn_Update(uint16_t ConnectionHandle)
-{
-  /* USER CODE BEGIN BLE_SVC_L2CAP_Conn_Update_1 */
-
-  /* USER CODE END BLE_SVC_L2CAP_Conn_Update_1 */
-
-  if (mutex == 1)
-  {
-    mutex = 0;
-    index_con_int = (index_con_int + 1)%SIZE_TAB_CONN_INT;
-    uint16_t interval_min = CONN_P(a_ConnInterval[index_con_int]);
-    uint16_t interval_max = CONN_P(a_ConnInterval[index_con_int]);
-    uint16_t slave_latency = L2CAP_SLAVE_LATENCY;
-    uint16_t timeout_multiplier = L2CAP_TIMEOUT_MULTIPLIER;
-    tBleStatus ret;
-
-    ret = aci_l2cap_connection_parameter_update_req(BleApplicationContext.BleApplicationContext_legacy.connectionHandle,
-                                                    interval_min, interval_max,
-                                                    slave_latency, timeout_multiplier);
-    if (ret != BLE_STATUS_SUCCESS)
-    {
-      APP_DBG_MSG("BLE_SVC_L2CAP_Conn_Update(), Failed \r\n\r");
-    }
-    else
-    {
-      APP_DBG_MSG("BLE_SVC_L2CAP_Conn_Update(), Successfully \r\n\r");
-    }
-  }
-
-  /* USER CODE BEGIN BLE_SVC_L2CAP_Conn_Update_2 */
-
-  /* USER CODE END BLE_SVC_L2CAP_Conn_Update_2 */
-
-  return;
-}
-#endif /* L2CAP_REQUEST_NEW_CONN_PARAM != 0 */
-
-#if (L2CAP_REQUEST_NEW_CONN_PARAM != 0)
-static void Connection_Interval_Update_Req(void)
-{
-  if (BleApplicationContext.Device_Connection_Status != APP_BLE_FAST_ADV && BleApplicationContext.Device_Connection_Status != APP_BLE_IDLE)
-  {
-    BLE_SVC_L2CAP_Conn_Update(BleApplicationContext.BleApplicationContext_legacy.connectionHandle);
-  }
-
-  return;
-}
-#endif /* L2CAP_REQUEST_NEW_CONN_PARAM != 0 */
-
 /* USER CODE BEGIN FD_SPECIFIC_FUNCTIONS */
 
 /* USER CODE END FD_SPECIFIC_FUNCTIONS */
@@ -1213,7 +1265,9 @@ void hci_cmd_resp_release(uint32_t Flag)
 
 void hci_cmd_resp_wait(uint32_t Timeout)
 {
+  BOOT_PROFILE_CPU2_CMD_WAIT();
   UTIL_SEQ_WaitEvt(1 << CFG_IDLEEVT_HCI_CMD_EVT_RSP_ID);
+  BOOT_PROFILE_CPU2_CMD_DONE();
 
   return;
 }
@@ -73,6 +73,7 @@ APP_BLE_ConnStatus_t APP_BLE_Get_Server_Connection_Status(void);
 /* USER CODE BEGIN EF */
 void APP_BLE_Key_Button1_Action(void);
 void APP_BLE_Key_Button2_Action(void);
+uint8_t APP_BLE_Hci_Evt_Batch_Yield(void);
 /* USER CODE END EF */
 
 #ifdef __cplusplus
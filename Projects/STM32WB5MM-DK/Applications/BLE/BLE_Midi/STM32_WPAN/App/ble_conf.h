@@ -54,6 +54,12 @@
 
 #define BLE_CFG_CLT_MAX_NBR_CB                                                 0
 
+/**
+ * Number of attribute handle ranges registered with SVCCTL_RegisterSvcHandleRange()
+ * The GATT events on the attributes of a range are only reported to the handler of that range
+ */
+#define BLE_CFG_SVC_MAX_NBR_RANGE                                              4
+
 /******************************************************************************
  * GAP Service - Appearance
  ******************************************************************************/
@@ -62,4 +68,24 @@
 #define BLE_CFG_HR_SENSOR_APPEARANCE                (832)
 #define BLE_CFG_GAP_APPEARANCE                      (BLE_CFG_UNKNOWN_APPEARANCE)
 
+/******************************************************************************
+ *
+ * HCI TRANSPORT LAYER CONFIGURATION
+ *
+ ******************************************************************************/
+
+/**
+ * hci_user_evt_proc() reports up to BLE_CFG_HCI_EVT_BATCH_MAX events before giving back the hand to the sequencer.
+ * The batch is stopped earlier when BLE_CFG_HCI_EVT_BATCH_BUDGET is spent, in BLE_CFG_HCI_EVT_BATCH_GET_TIME() unit,
+ * or when a Midi task is waiting (BLE_CFG_HCI_EVT_BATCH_YIELD)
+ * Set BLE_CFG_HCI_EVT_BATCH_MAX to 1 to report the events one by one
+ * The cycle counter is started by APPE_Cycle_Counter_Init() (app_entry.c)
+ */
+#define BLE_CFG_HCI_EVT_BATCH_MAX                   (8)
+#define BLE_CFG_HCI_EVT_BATCH_GET_TIME()            (DWT->CYCCNT)
+#define BLE_CFG_HCI_EVT_BATCH_BUDGET                (CFG_HCI_EVT_BATCH_BUDGET_US * (SystemCoreClock / 1000000))
+#define BLE_CFG_HCI_EVT_BATCH_YIELD()               APP_BLE_Hci_Evt_Batch_Yield()
+
+uint8_t APP_BLE_Hci_Evt_Batch_Yield(void);
+
 #endif /*BLE_CONF_H */
@@ -30,6 +30,12 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "app_midi.h"
+#include "app_audio.h"
+#include "app_conn_param.h"
+#include "app_link.h"
+#include "app_recorder.h"
+#include "app_led.h"
+#include "simple_midi_parser.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -38,7 +44,17 @@ typedef struct
   /* s_midi */
   uint8_t               C_io_Notification_Status;
   /* USER CODE BEGIN CUSTOM_APP_Context_t */
-
+  Midi_Tx_Slot_t        Midi_Tx_Ring[MIDI_TX_RING_SIZE];        /*!< Packets shared by all the centrals */
+  uint32_t              Midi_Tx_Head;                           /*!< Number of packets produced, next slot to build */
+  Midi_Link_t           Links[CFG_BLE_NUM_LINK];                /*!< Connected centrals */
+  uint8_t               Links_Nbr;                              /*!< Number of connected centrals */
+  uint8_t               Midi_Tx_Length;                         /*!< Bytes used in the packet being built, 0 when empty */
+  uint16_t              Midi_Tx_Header_Time;                    /*!< Timestamp of the first message of the packet */
+  uint16_t              Midi_Tx_Last_Time;                      /*!< Timestamp of the last message of the packet */
+  uint8_t               Midi_Tx_Running;                        /*!< Status of the last channel message of the packet, 0 if none */
+  uint32_t              Midi_Tx_Horizon;                        /*!< Latest render time queued, the song is sent ahead */
+  uint32_t              Active_Notes[16][4];                    /*!< Note On sent without Note Off, one bit per channel and note */
+  uint32_t              Held_Notes[16][4];                      /*!< Notes released by the last pause, struck again on resume */
   /* USER CODE END CUSTOM_APP_Context_t */
 
   uint16_t              ConnectionHandle;
@@ -50,7 +66,16 @@ typedef struct
 
 /* Private defines ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-
+/* BLE-MIDI packets have a 13 bits millisecond timestamp */
+#define MIDI_TIMESTAMP_MASK             (0x1FFFU)
+/* A packet is closed before its timestamps span more than the low 7 bits */
+#define MIDI_TX_MAX_SPAN_MS             (127U)
+#define MIDI_NO_LINK                    (0xFFFFU)
+/* The packet being built is due within this time, ms */
+#define MIDI_TX_DEADLINE_MS             (1U)
+/* Velocity of the Note Off sent by Midi_Notes_Off() and of the notes struck again by Midi_Notes_Restrike() */
+#define MIDI_RELEASE_VELOCITY           (64U)
+#define MIDI_RESTRIKE_VELOCITY          (100U)
 /* USER CODE END PD */
 
 /* Private macros -------------------------------------------------------------*/
@@ -82,8 +107,15 @@ static void Custom_C_io_Update_Char(void);
 static void Custom_C_io_Send_Notification(void);
 
 /* USER CODE BEGIN PFP */
-void    Midi_Send_Note(const uint8_t state, const uint8_t channel, 
-                       const uint8_t note, const uint8_t velocity);
+static void Midi_Tx_Append(const uint8_t *pMsg, uint8_t Length, uint32_t Timestamp);
+static void Midi_Tx_Append_Running(const uint8_t *pMsg, uint8_t Length, uint32_t Timestamp);
+static void Midi_Notes_Track(const uint8_t *pMsg, uint8_t Length, uint32_t Timestamp);
+static uint32_t Midi_Tx_Latest(uint32_t Timestamp);
+static void Midi_Tx_Task(void);
+static void Midi_Tx_Drain(void);
+static uint16_t Midi_Tx_Packet_Limit(void);
+static Midi_Link_t * Midi_Find_Link(uint16_t ConnectionHandle);
+static void Midi_Rx_Parse(const uint8_t *pData, uint8_t Length);
 /* USER CODE END PFP */
 
 /* Functions Definition ------------------------------------------------------*/
@@ -107,18 +139,43 @@ void Custom_STM_App_Notification(Custom_STM_App_Notification_evt_t *pNotificatio
 
     case CUSTOM_STM_C_IO_WRITE_EVT:
       /* USER CODE BEGIN CUSTOM_STM_C_IO_WRITE_EVT */
-
+      Midi_Rx_Parse(pNotification->DataTransfered.pPayload, pNotification->DataTransfered.Length);
       /* USER CODE END CUSTOM_STM_C_IO_WRITE_EVT */
       break;
 
     case CUSTOM_STM_C_IO_NOTIFY_ENABLED_EVT:
       /* USER CODE BEGIN CUSTOM_STM_C_IO_NOTIFY_ENABLED_EVT */
+      {
+        Midi_Link_t *pLink = Midi_Find_Link(pNotification->ConnectionHandle);
+
+        if(pLink != NULL)
+        {
+          /* Start with the next packet */
+          pLink->Tail = Custom_App_Context.Midi_Tx_Head;
+          pLink->Notification_Status = 1;
+          Custom_App_Context.C_io_Notification_Status = 1;
+        }
+      }
 
       /* USER CODE END CUSTOM_STM_C_IO_NOTIFY_ENABLED_EVT */
       break;
 
     case CUSTOM_STM_C_IO_NOTIFY_DISABLED_EVT:
       /* USER CODE BEGIN CUSTOM_STM_C_IO_NOTIFY_DISABLED_EVT */
+      {
+        Midi_Link_t *pLink = Midi_Find_Link(pNotification->ConnectionHandle);
+        uint8_t i;
+
+        if(pLink != NULL)
+        {
+          pLink->Notification_Status = 0;
+        }
+        Custom_App_Context.C_io_Notification_Status = 0;
+        for(i = 0; i < CFG_BLE_NUM_LINK; i++)
+        {
+          Custom_App_Context.C_io_Notification_Status |= Custom_App_Context.Links[i].Notification_Status;
+        }
+      }
 
       /* USER CODE END CUSTOM_STM_C_IO_NOTIFY_DISABLED_EVT */
       break;
@@ -148,13 +205,50 @@ void Custom_APP_Notification(Custom_App_ConnHandle_Not_evt_t *pNotification)
     /* USER CODE END P2PS_CUSTOM_Notification_Custom_Evt_Opcode */
     case CUSTOM_CONN_HANDLE_EVT :
       /* USER CODE BEGIN CUSTOM_CONN_HANDLE_EVT */
-      Midi_Start_Measures();
+      Custom_App_Context.ConnectionHandle = pNotification->ConnectionHandle;
+      {
+        Midi_Link_t *pLink = Midi_Find_Link(MIDI_NO_LINK);
+
+        if(pLink != NULL)
+        {
+          memset(pLink, 0, sizeof(Midi_Link_t));
+          pLink->ConnectionHandle = pNotification->ConnectionHandle;
+        }
+      }
+      if(Custom_App_Context.Links_Nbr++ == 0)
+      {
+        Midi_Start_Measures();
+        AUDIO_MIDI_Start();
+      }
       /* USER CODE END CUSTOM_CONN_HANDLE_EVT */
       break;
 
     case CUSTOM_DISCON_HANDLE_EVT :
       /* USER CODE BEGIN CUSTOM_DISCON_HANDLE_EVT */
-      Midi_Stop_Measures();
+      {
+        Midi_Link_t *pLink = Midi_Find_Link(pNotification->ConnectionHandle);
+
+        if(pLink != NULL)
+        {
+          if(pLink->Drops != 0)
+          {
+            APP_DBG_MSG("Conn 0x%x : %ld Midi packets dropped\n\r", pLink->ConnectionHandle, pLink->Drops);
+          }
+          pLink->ConnectionHandle = MIDI_NO_LINK;
+          pLink->Notification_Status = 0;
+        }
+      }
+      if((Custom_App_Context.Links_Nbr != 0) && (--Custom_App_Context.Links_Nbr == 0))
+      {
+        Custom_App_Context.C_io_Notification_Status = 0;
+        Midi_Stop_Measures();
+        AUDIO_MIDI_Stop();
+      }
+      /*
+       * A note may have been struck while the link was lost : the centrals left start again from silence,
+       * with no central left the notes are only forgotten
+       */
+      Midi_Notes_Off(0);
       /* USER CODE END CUSTOM_DISCON_HANDLE_EVT */
       break;
 
@@ -181,7 +275,14 @@ void Custom_APP_Init(void)
   Custom_C_io_Update_Char();
   Custom_C_io_Send_Notification();
   
+  for(uint8_t i = 0; i < CFG_BLE_NUM_LINK; i++)
+  {
+    Custom_App_Context.Links[i].ConnectionHandle = MIDI_NO_LINK;
+  }
+  UTIL_SEQ_RegTask(1<<CFG_TASK_MIDI_TX, UTIL_SEQ_RFU, Midi_Tx_Task);
+
   MIDI_Init();
+  AUDIO_MIDI_Init();
   /* USER CODE END CUSTOM_APP_Init */
   return;
 }
@@ -248,21 +349,456 @@ void Custom_C_io_Send_Notification(void) /* Property Notification */
  */
 void Midi_Send_Note(const uint8_t state, const uint8_t channel, const uint8_t note, const uint8_t velocity)
 {
-  /*  13-bit millisecond-resolution timestamps is used to express the render 
-   *  time and event spacing of MIDI messages. But in our case for simplicity
-   *  we will send each event at the same timestamp as it has almost no noticable
-   *  differences 
-   */
-  NotifyCharData[0] = 0b10000000; /* Dummy timestamp part1 */
-  NotifyCharData[1] = 0b10000001; /* Dummy timestamp part2 */
-  NotifyCharData[2] = state | channel;
+  uint8_t msg[3];
+
+  msg[0] = state | channel;
   /* Next bytes are masked to be sure there are only 7 bits used */
-  NotifyCharData[3] = (note & 0x7F);
-  NotifyCharData[4] = (velocity & 0x7F);       
-  
-  Custom_STM_App_Update_Char(CUSTOM_STM_C_IO, (uint8_t *)NotifyCharData);
+  msg[1] = (note & 0x7F);
+  msg[2] = (velocity & 0x7F);
+
+  Midi_Send_Message(msg, sizeof(msg));
+}
+
+/*
+ * @brief Queue a midi message, timestamped now, in the packet being built
+ * @note  Messages posted from interrupts by the clock are queued first so that
+ *        timestamps stay in order inside the packet
+ *
+ * @param pMsg          complete midi message, status byte first
+ * @param Length        message length
+ */
+void Midi_Send_Message(const uint8_t *pMsg, uint8_t Length)
+{
+  uint32_t now = HAL_GetTick();
+
+  Midi_Clock_Drain();
+  Midi_Tx_Append(pMsg, Length, now);
+  Midi_Tx_Schedule();
+  RECORDER_Midi_Event(pMsg, Length, now);
+}
+
+/*
+ * @brief Queue a midi message with a given timestamp in the packet being built
+ * @note  To be called from task context only
+ *
+ * @param pMsg          complete midi message, status byte first
+ * @param Length        message length
+ * @param Timestamp     render time in milliseconds (HAL_GetTick base)
+ */
+void Midi_Send_Timed_Message(const uint8_t *pMsg, uint8_t Length, uint32_t Timestamp)
+{
+  Midi_Tx_Append(pMsg, Length, Timestamp);
+  Midi_Tx_Schedule();
+  RECORDER_Midi_Event(pMsg, Length, Timestamp);
+}
+
+/*
+ * @brief Send a Note Off for every note sounding, in as few packets as possible
+ * @note  To be called from task context only
+ *
+ * @param Hold          1 to keep the notes to be struck again by Midi_Notes_Restrike()
+ */
+void Midi_Notes_Off(uint8_t Hold)
+{
+  uint32_t now = Midi_Tx_Latest(HAL_GetTick());
+  uint32_t bits;
+  uint8_t msg[3];
+  uint8_t channel;
+  uint8_t word;
+
+  Midi_Clock_Drain();
+  if(Hold)
+  {
+    memcpy(Custom_App_Context.Held_Notes, Custom_App_Context.Active_Notes, sizeof(Custom_App_Context.Held_Notes));
+  }
+  else
+  {
+    memset(Custom_App_Context.Held_Notes, 0, sizeof(Custom_App_Context.Held_Notes));
+  }
+
+  for(channel = 0; channel < 16; channel++)
+  {
+    for(word = 0; word < 4; word++)
+    {
+      bits = Custom_App_Context.Active_Notes[channel][word];
+      while(bits != 0)
+      {
+        msg[0] = NOTE_OFF | channel;
+        msg[1] = (word * 32U) + __CLZ(__RBIT(bits));
+        msg[2] = MIDI_RELEASE_VELOCITY;
+        Midi_Tx_Append_Running(msg, sizeof(msg), now);
+        bits &= bits - 1U;
+      }
+    }
+  }
+  Midi_Tx_Flush();
+
+  return;
+}
+
+/*
+ * @brief Strike again the notes released by the last Midi_Notes_Off(1)
+ * @note  To be called from task context only
+ */
+void Midi_Notes_Restrike(void)
+{
+  uint32_t now = Midi_Tx_Latest(HAL_GetTick());
+  uint32_t bits;
+  uint8_t msg[3];
+  uint8_t channel;
+  uint8_t word;
+
+  Midi_Clock_Drain();
+  for(channel = 0; channel < 16; channel++)
+  {
+    for(word = 0; word < 4; word++)
+    {
+      bits = Custom_App_Context.Held_Notes[channel][word];
+      Custom_App_Context.Held_Notes[channel][word] = 0;
+      while(bits != 0)
+      {
+        msg[0] = NOTE_ON | channel;
+        msg[1] = (word * 32U) + __CLZ(__RBIT(bits));
+        msg[2] = MIDI_RESTRIKE_VELOCITY;
+        Midi_Tx_Append_Running(msg, sizeof(msg), now);
+        bits &= bits - 1U;
+      }
+    }
+  }
+  Midi_Tx_Flush();
+
+  return;
+}
+
+/*
+ * @brief Request the packet being built to be sent at the end of the current processing
+ * @note  Can be called from interrupt context
+ */
+void Midi_Tx_Schedule(void)
+{
+  UTIL_SEQ_SetTaskDeadline(1<<CFG_TASK_MIDI_TX, CFG_SCH_PRIO_0, CFG_SCH_DEADLINE_NOW() + MIDI_TX_DEADLINE_MS);
+}
+
+/*
+ * @brief Close the packet being built and send it to every subscribed central
+ */
+void Midi_Tx_Flush(void)
+{
+  if((Custom_App_Context.Midi_Tx_Length > 1) && (Custom_App_Context.C_io_Notification_Status != 0))
+  {
+    Custom_App_Context.Midi_Tx_Ring[Custom_App_Context.Midi_Tx_Head % MIDI_TX_RING_SIZE].Length = Custom_App_Context.Midi_Tx_Length;
+    Custom_App_Context.Midi_Tx_Head++;
+    CONN_PARAM_Activity();
+  }
+  Custom_App_Context.Midi_Tx_Length = 0;
+
+  Midi_Tx_Drain();
+}
+
+/*
+ * @brief Send the pending packets of each central, a central without free TX buffers
+ *        is skipped and resumed on ACI_GATT_TX_POOL_AVAILABLE_VSEVT_CODE
+ */
+static void Midi_Tx_Drain(void)
+{
+  uint8_t i;
+
+  for(i = 0; i < CFG_BLE_NUM_LINK; i++)
+  {
+    Midi_Link_t *pLink = &Custom_App_Context.Links[i];
+
+    if((pLink->ConnectionHandle == MIDI_NO_LINK) || (pLink->Notification_Status == 0))
+    {
+      continue;
+    }
+    while(pLink->Tail != Custom_App_Context.Midi_Tx_Head)
+    {
+      Midi_Tx_Slot_t *pSlot = &Custom_App_Context.Midi_Tx_Ring[pLink->Tail % MIDI_TX_RING_SIZE];
+      tBleStatus ret;
+
+      ret = Custom_STM_App_Notify_Link(CUSTOM_STM_C_IO, pLink->ConnectionHandle, pSlot->Data, pSlot->Length);
+      if(ret == BLE_STATUS_INSUFFICIENT_RESOURCES)
+      {
+        break;
+      }
+      if(ret == BLE_STATUS_SUCCESS)
+      {
+        LINK_Notified(pLink->ConnectionHandle, pSlot->Length);
+      }
+      pLink->Tail++;
+    }
+  }
+
+  return;
+}
+
+/*
+ * @brief Get the context of a central
+ *
+ * @param ConnectionHandle      connection handle, MIDI_NO_LINK to get a free context
+ *
+ * @retval                      central context, NULL if not found
+ */
+static Midi_Link_t * Midi_Find_Link(uint16_t ConnectionHandle)
+{
+  uint8_t i;
+
+  for(i = 0; i < CFG_BLE_NUM_LINK; i++)
+  {
+    if(Custom_App_Context.Links[i].ConnectionHandle == ConnectionHandle)
+    {
+      return &Custom_App_Context.Links[i];
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * @brief Largest BLE-MIDI packet every subscribed central can receive in one notification
+ *
+ * @retval              packet size in bytes
+ */
+static uint16_t Midi_Tx_Packet_Limit(void)
+{
+  uint16_t limit = SizeC_Io;
+  uint8_t i;
+
+  for(i = 0; i < CFG_BLE_NUM_LINK; i++)
+  {
+    if(Custom_App_Context.Links[i].Notification_Status != 0)
+    {
+      uint16_t payload = LINK_Get_Payload_Size(Custom_App_Context.Links[i].ConnectionHandle);
+
+      if(payload < limit)
+      {
+        limit = payload;
+      }
+    }
+  }
+
+  return limit;
+}
+
+/*
+ * @brief Append a message to the BLE-MIDI packet, sending it first if it is full
+ *
+ * @param pMsg          complete midi message, status byte first
+ * @param Length        message length
+ * @param Timestamp     render time in milliseconds
+ */
+static void Midi_Tx_Append(const uint8_t *pMsg, uint8_t Length, uint32_t Timestamp)
+{
+  uint16_t time = (uint16_t)(Timestamp & MIDI_TIMESTAMP_MASK);
+  uint8_t *pPacket;
+  uint8_t i;
+
+  Midi_Notes_Track(pMsg, Length, Timestamp);
+  Custom_App_Context.Midi_Tx_Horizon = Midi_Tx_Latest(Timestamp);
+  if(Custom_App_Context.Midi_Tx_Length != 0)
+  {
+    /* Timestamps shall not go backward inside a packet */
+    if(((time - Custom_App_Context.Midi_Tx_Last_Time) & MIDI_TIMESTAMP_MASK) > (MIDI_TIMESTAMP_MASK / 2U))
+    {
+      time = Custom_App_Context.Midi_Tx_Last_Time;
+    }
+    if((((time - Custom_App_Context.Midi_Tx_Header_Time) & MIDI_TIMESTAMP_MASK) > MIDI_TX_MAX_SPAN_MS)
+    || ((Custom_App_Context.Midi_Tx_Length + 1U + Length) > Midi_Tx_Packet_Limit()))
+    {
+      Midi_Tx_Flush();
+    }
+  }
+
+  pPacket = Custom_App_Context.Midi_Tx_Ring[Custom_App_Context.Midi_Tx_Head % MIDI_TX_RING_SIZE].Data;
+  if(Custom_App_Context.Midi_Tx_Length == 0)
+  {
+    /* The slot is reused : a central still behind by a whole ring loses its oldest packet */
+    for(i = 0; i < CFG_BLE_NUM_LINK; i++)
+    {
+      Midi_Link_t *pLink = &Custom_App_Context.Links[i];
+
+      if((pLink->Notification_Status != 0) && ((Custom_App_Context.Midi_Tx_Head - pLink->Tail) >= MIDI_TX_RING_SIZE))
+      {
+        pLink->Tail++;
+        pLink->Drops++;
+      }
+    }
+    /* Header : timestamp high bits */
+    pPacket[0] = 0x80 | ((time >> 7) & 0x3F);
+    Custom_App_Context.Midi_Tx_Length = 1;
+    Custom_App_Context.Midi_Tx_Header_Time = time;
+  }
+
+  /* Timestamp low bits then the message itself */
+  pPacket[Custom_App_Context.Midi_Tx_Length++] = 0x80 | (time & 0x7F);
+  memcpy(&pPacket[Custom_App_Context.Midi_Tx_Length], pMsg, Length);
+  Custom_App_Context.Midi_Tx_Length += Length;
+  Custom_App_Context.Midi_Tx_Last_Time = time;
+  Custom_App_Context.Midi_Tx_Running = ((pMsg[0] & 0xF0) != 0xF0) ? pMsg[0] : 0;
+}
+
+/*
+ * @brief Append a channel message to the packet being built, with neither timestamp nor status byte
+ *        when it follows a message of the same status at the same time (BLE-MIDI running status)
+ *
+ * @param pMsg          complete channel message, status byte first
+ * @param Length        message length
+ * @param Timestamp     render time in milliseconds
+ */
+static void Midi_Tx_Append_Running(const uint8_t *pMsg, uint8_t Length, uint32_t Timestamp)
+{
+  uint8_t *pPacket;
+
+  if((Custom_App_Context.Midi_Tx_Length == 0) || (pMsg[0] != Custom_App_Context.Midi_Tx_Running) ||
+     ((uint16_t)(Timestamp & MIDI_TIMESTAMP_MASK) != Custom_App_Context.Midi_Tx_Last_Time) ||
+     ((Custom_App_Context.Midi_Tx_Length + Length - 1U) > Midi_Tx_Packet_Limit()))
+  {
+    Midi_Tx_Append(pMsg, Length, Timestamp);
+    return;
+  }
+
+  Midi_Notes_Track(pMsg, Length, Timestamp);
+  pPacket = Custom_App_Context.Midi_Tx_Ring[Custom_App_Context.Midi_Tx_Head % MIDI_TX_RING_SIZE].Data;
+  memcpy(&pPacket[Custom_App_Context.Midi_Tx_Length], &pMsg[1], Length - 1U);
+  Custom_App_Context.Midi_Tx_Length += Length - 1U;
 }
 
+/*
+ * @brief Render time not before the messages already queued
+ *
+ * @param Timestamp     render time wanted, in ms
+ *
+ * @retval              Timestamp, or the latest render time queued if later
+ */
+static uint32_t Midi_Tx_Latest(uint32_t Timestamp)
+{
+  return ((int32_t)(Custom_App_Context.Midi_Tx_Horizon - Timestamp) > 0) ? Custom_App_Context.Midi_Tx_Horizon : Timestamp;
+}
 
+/*
+ * @brief Keep the notes sounding on the centrals up to date with a message sent
+ *
+ * @param pMsg          complete midi message, status byte first
+ * @param Length        message length
+ * @param Timestamp     render time in milliseconds
+ */
+static void Midi_Notes_Track(const uint8_t *pMsg, uint8_t Length, uint32_t Timestamp)
+{
+  uint32_t *pChannel = Custom_App_Context.Active_Notes[pMsg[0] & 0x0F];
+
+  if(Length != 3)
+  {
+    return;
+  }
+
+  switch(pMsg[0] & 0xF0)
+  {
+    case NOTE_ON:
+      /* Velocity 0 is a Note Off */
+      if(pMsg[2] != 0)
+      {
+        pChannel[(pMsg[1] & 0x7F) / 32U] |= (1UL << (pMsg[1] & 0x1F));
+#if (CFG_LED_MIDI_NOTES != 0)
+        LED_PWM_Note(pMsg[0] & 0x0F, pMsg[2], Timestamp);
+#endif
+      }
+      else
+      {
+        pChannel[(pMsg[1] & 0x7F) / 32U] &= ~(1UL << (pMsg[1] & 0x1F));
+      }
+      break;
+
+    case NOTE_OFF:
+      pChannel[(pMsg[1] & 0x7F) / 32U] &= ~(1UL << (pMsg[1] & 0x1F));
+      break;
+
+    case 0xB0:
+      /* Control change : All Sound Off, All Notes Off */
+      if((pMsg[1] == 120U) || (pMsg[1] == 123U))
+      {
+        memset(pChannel, 0, sizeof(Custom_App_Context.Active_Notes[0]));
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+/*
+ * @brief Send everything produced since the last packet in one notification
+ */
+static void Midi_Tx_Task(void)
+{
+  Midi_Clock_Drain();
+  Midi_Tx_Flush();
+}
+
+/*
+ * @brief Extract the channel messages of a BLE-MIDI packet written by a central, for the recorder
+ * @note  The timestamps are skipped : the messages are recorded at their arrival time. System
+ *        exclusive, system common and real time messages are skipped too
+ *
+ * @param pData         packet, header byte first
+ * @param Length        packet length
+ */
+static void Midi_Rx_Parse(const uint8_t *pData, uint8_t Length)
+{
+  uint8_t msg[3];
+  uint8_t running = 0;
+  uint8_t size;
+  uint8_t i = 1;
+
+  if((Length < 2) || ((pData[0] & 0xC0) != 0x80))
+  {
+    return;
+  }
+
+  while(i < Length)
+  {
+    if(pData[i] & 0x80)
+    {
+      /* Timestamp, followed by a status byte or by the data of the running status */
+      if(++i >= Length)
+      {
+        break;
+      }
+      if(pData[i] >= 0xF8)
+      {
+        i++;
+        continue;
+      }
+      if(pData[i] >= 0xF0)
+      {
+        /* Up to the next timestamp : end of system exclusive or next message */
+        running = 0;
+        for(i++; (i < Length) && !(pData[i] & 0x80); i++);
+        continue;
+      }
+      if(pData[i] & 0x80)
+      {
+        running = pData[i++];
+      }
+    }
+
+    if(running == 0)
+    {
+      i++;
+      continue;
+    }
+
+    size = ((running & 0xE0) == 0xC0) ? 2 : 3;
+    if((i + size - 1) > Length)
+    {
+      break;
+    }
+    msg[0] = running;
+    memcpy(&msg[1], &pData[i], size - 1);
+    i += size - 1;
+    RECORDER_Midi_Event(msg, size, HAL_GetTick());
+  }
+
+  return;
+}
 
 /* USER CODE END FD_LOCAL_FUNCTIONS*/
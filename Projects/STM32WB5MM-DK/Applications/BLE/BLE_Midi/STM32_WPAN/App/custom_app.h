@@ -46,7 +46,24 @@ typedef struct
   uint16_t                                 ConnectionHandle;
 } Custom_App_ConnHandle_Not_evt_t;
 /* USER CODE BEGIN ET */
+/* Largest BLE-MIDI packet, one notification at the maximum ATT MTU */
+#define MIDI_TX_PACKET_SIZE     (CFG_BLE_MAX_ATT_MTU - 3U)
+/* Packets kept for a central that cannot keep up, older ones are dropped for it only */
+#define MIDI_TX_RING_SIZE       (8U)
 
+typedef struct
+{
+  uint8_t               Length;                                 /*!< Packet length */
+  uint8_t               Data[MIDI_TX_PACKET_SIZE];              /*!< BLE-MIDI packet */
+} Midi_Tx_Slot_t;
+
+typedef struct
+{
+  uint16_t              ConnectionHandle;                       /*!< 0xFFFF when unused */
+  uint8_t               Notification_Status;                    /*!< Central subscribed to c_io */
+  uint32_t              Tail;                                   /*!< Next packet of the ring to send to this central */
+  uint32_t              Drops;                                  /*!< Packets overwritten before being sent */
+} Midi_Link_t;
 /* USER CODE END ET */
 
 /* Exported constants --------------------------------------------------------*/
@@ -69,6 +86,12 @@ void Custom_APP_Init(void);
 void Custom_APP_Notification(Custom_App_ConnHandle_Not_evt_t *pNotification);
 /* USER CODE BEGIN EF */
 void Midi_Send_Note(const uint8_t state, const uint8_t channel, const uint8_t note, const uint8_t velocity);
+void Midi_Send_Message(const uint8_t *pMsg, uint8_t Length);
+void Midi_Send_Timed_Message(const uint8_t *pMsg, uint8_t Length, uint32_t Timestamp);
+void Midi_Tx_Schedule(void);
+void Midi_Tx_Flush(void);
+void Midi_Notes_Off(uint8_t Hold);
+void Midi_Notes_Restrike(void);
 /* USER CODE END EF */
 
 #ifdef __cplusplus
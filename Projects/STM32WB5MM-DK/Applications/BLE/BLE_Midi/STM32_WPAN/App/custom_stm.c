@@ -23,6 +23,8 @@
 #include "custom_stm.h"
 
 /* USER CODE BEGIN Includes */
+#include "app_trace.h"
+#include "app_latency.h"
 
 /* USER CODE END Includes */
 
@@ -63,7 +65,7 @@ typedef struct{
 /* USER CODE END PM */
 
 /* Private variables ---------------------------------------------------------*/
-uint8_t SizeC_Io = 5;
+uint8_t SizeC_Io = (CFG_BLE_MAX_ATT_MTU - 3);
 
 /**
  * START of Section BLE_DRIVER_CONTEXT
@@ -82,6 +84,7 @@ static CustomContext_t CustomContext;
 static SVCCTL_EvtAckStatus_t Custom_STM_Event_Handler(void *pckt);
 
 /* USER CODE BEGIN PFP */
+static SVCCTL_EvtAckStatus_t Custom_STM_Attr_Event_Handler(SVCCTL_GattEvt_t *pEvt);
 
 /* USER CODE END PFP */
 
@@ -112,6 +115,29 @@ do {\
 #define COPY_C_MIDI_IO_UUID(uuid_struct)    COPY_UUID_128(uuid_struct,0x77,0x72,0xe5,0xdb,0x38,0x68,0x41,0x12,0xa1,0xa9,0xf2,0x66,0x9d,0x10,0x6b,0xf3)
 
 /* USER CODE BEGIN PF */
+/*
+ * @brief  Event handler of the s_midi attributes, called by the BLE controller with the event already decoded.
+ *         The Midi packets written by the central are reported without going through the generated handler
+ */
+static SVCCTL_EvtAckStatus_t Custom_STM_Attr_Event_Handler(SVCCTL_GattEvt_t *pEvt)
+{
+  Custom_STM_App_Notification_evt_t Notification;
+
+  if ((pEvt->Ecode == ACI_GATT_ATTRIBUTE_MODIFIED_VSEVT_CODE) &&
+      (pEvt->AttrHandle == (CustomContext.CustomC_IoHdle + CHARACTERISTIC_VALUE_ATTRIBUTE_OFFSET)))
+  {
+    Notification.Custom_Evt_Opcode = CUSTOM_STM_C_IO_WRITE_EVT;
+    Notification.DataTransfered.pPayload = pEvt->pData;
+    Notification.DataTransfered.Length = (uint8_t)pEvt->DataLength;
+    Notification.ConnectionHandle = pEvt->ConnectionHandle;
+    Notification.ServiceInstance = 0;
+    Custom_STM_App_Notification(&Notification);
+
+    return SVCCTL_EvtAckFlowEnable;
+  }
+
+  return Custom_STM_Event_Handler(pEvt->pckt);
+}
 
 /* USER CODE END PF */
 
@@ -151,6 +177,7 @@ static SVCCTL_EvtAckStatus_t Custom_STM_Event_Handler(void *Event)
           {
             return_value = SVCCTL_EvtAckFlowEnable;
             /* USER CODE BEGIN CUSTOM_STM_Service_1_Char_1 */
+            Notification.ConnectionHandle = attribute_modified->Connection_Handle;
 
             /* USER CODE END CUSTOM_STM_Service_1_Char_1 */
             switch (attribute_modified->Attr_Data[0])
@@ -342,7 +369,7 @@ void SVCCTL_InitCustomSvc(void)
                           ATTR_PERMISSION_NONE,
                           GATT_NOTIFY_ATTRIBUTE_WRITE | GATT_NOTIFY_WRITE_REQ_AND_WAIT_FOR_APPL_RESP | GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP,
                           0x10,
-                          CHAR_VALUE_LEN_CONSTANT,
+                          CHAR_VALUE_LEN_VARIABLE,
                           &(CustomContext.CustomC_IoHdle));
   if (ret != BLE_STATUS_SUCCESS)
   {
@@ -359,6 +386,13 @@ void SVCCTL_InitCustomSvc(void)
   /* USER CODE END SVCCTL_Init_Service1_Char1 */
 
   /* USER CODE BEGIN SVCCTL_InitCustomSvc_2 */
+  /**
+   *  The events on the s_midi attributes (service, c_midi_io declaration, value and configuration descriptor)
+   *  are routed to the service without going through the other registered handlers
+   */
+  SVCCTL_RegisterSvcHandleRange(CustomContext.CustomS_MidiHdle,
+                                CustomContext.CustomC_IoHdle + CHARACTERISTIC_DESCRIPTOR_ATTRIBUTE_OFFSET,
+                                Custom_STM_Attr_Event_Handler);
 
   /* USER CODE END SVCCTL_InitCustomSvc_2 */
 
@@ -375,6 +409,7 @@ tBleStatus Custom_STM_App_Update_Char(Custom_STM_Char_Opcode_t CharOpcode, uint8
 {
   tBleStatus ret = BLE_STATUS_INVALID_PARAMS;
   /* USER CODE BEGIN Custom_STM_App_Update_Char_1 */
+  LATENCY_PROBE(LATENCY_PROBE_UPDATE_ENTRY);
 
   /* USER CODE END Custom_STM_App_Update_Char_1 */
 
@@ -389,11 +424,7 @@ tBleStatus Custom_STM_App_Update_Char(Custom_STM_Char_Opcode_t CharOpcode, uint8
                                        (uint8_t *)  pPayload);
       if (ret != BLE_STATUS_SUCCESS)
       {
-        APP_DBG_MSG("  Fail   : aci_gatt_update_char_value C_IO command, result : 0x%x \n\r", ret);
-      }
-      else
-      {
-        APP_DBG_MSG("  Success: aci_gatt_update_char_value C_IO command\n\r");
+        APP_TRACE1("  Fail   : aci_gatt_update_char_value C_IO command, result : 0x%x \n\r", ret);
       }
       /* USER CODE BEGIN CUSTOM_STM_App_Update_Service_1_Char_1*/
 
@@ -405,8 +436,98 @@ tBleStatus Custom_STM_App_Update_Char(Custom_STM_Char_Opcode_t CharOpcode, uint8
   }
 
   /* USER CODE BEGIN Custom_STM_App_Update_Char_2 */
+  LATENCY_PROBE(LATENCY_PROBE_UPDATE_EXIT);
 
   /* USER CODE END Custom_STM_App_Update_Char_2 */
 
   return ret;
 }
+
+/**
+ * @brief  Characteristic update with a given length
+ * @param  CharOpcode: Characteristic identifier
+ * @param  pPayload: Value to write
+ * @param  size: Length of the value, up to the characteristic size
+ *
+ */
+tBleStatus Custom_STM_App_Update_Char_Variable_Length(Custom_STM_Char_Opcode_t CharOpcode, uint8_t *pPayload, uint8_t size)
+{
+  tBleStatus ret = BLE_STATUS_INVALID_PARAMS;
+  /* USER CODE BEGIN Custom_STM_App_Update_Char_Variable_Length_1 */
+  LATENCY_PROBE(LATENCY_PROBE_UPDATE_ENTRY);
+
+  /* USER CODE END Custom_STM_App_Update_Char_Variable_Length_1 */
+
+  switch (CharOpcode)
+  {
+
+    case CUSTOM_STM_C_IO:
+      ret = aci_gatt_update_char_value(CustomContext.CustomS_MidiHdle,
+                                       CustomContext.CustomC_IoHdle,
+                                       0, /* charValOffset */
+                                       size, /* charValueLen */
+                                       (uint8_t *)  pPayload);
+      if (ret != BLE_STATUS_SUCCESS)
+      {
+        APP_TRACE1("  Fail   : aci_gatt_update_char_value C_IO command, result : 0x%x \n\r", ret);
+      }
+      /* USER CODE BEGIN Custom_STM_App_Update_Char_Variable_Length_Service_1_Char_1*/
+
+      /* USER CODE END Custom_STM_App_Update_Char_Variable_Length_Service_1_Char_1*/
+      break;
+
+    default:
+      break;
+  }
+
+  /* USER CODE BEGIN Custom_STM_App_Update_Char_Variable_Length_2 */
+  LATENCY_PROBE(LATENCY_PROBE_UPDATE_EXIT);
+
+  /* USER CODE END Custom_STM_App_Update_Char_Variable_Length_2 */
+
+  return ret;
+}
+
+/**
+ * @brief  Characteristic update notified to one central only
+ * @param  CharOpcode: Characteristic identifier
+ * @param  ConnectionHandle: Connection handle of the central to notify
+ * @param  pPayload: Value to write
+ * @param  size: Length of the value, up to the characteristic size
+ * @retval BLE_STATUS_INSUFFICIENT_RESOURCES when the TX buffers are full,
+ *         ACI_GATT_TX_POOL_AVAILABLE_VSEVT_CODE is then received once some are freed
+ */
+tBleStatus Custom_STM_App_Notify_Link(Custom_STM_Char_Opcode_t CharOpcode, uint16_t ConnectionHandle, uint8_t *pPayload, uint8_t size)
+{
+  tBleStatus ret = BLE_STATUS_INVALID_PARAMS;
+
+  switch (CharOpcode)
+  {
+
+    case CUSTOM_STM_C_IO:
+      LATENCY_PROBE(LATENCY_PROBE_UPDATE_ENTRY);
+      ret = aci_gatt_update_char_value_ext(ConnectionHandle,
+                                           CustomContext.CustomS_MidiHdle,
+                                           CustomContext.CustomC_IoHdle,
+                                           0x01, /* Update_Type : notification */
+                                           size, /* Char_Length */
+                                           0, /* Value_Offset */
+                                           size, /* Value_Length */
+                                           (uint8_t *)  pPayload);
+      LATENCY_PROBE(LATENCY_PROBE_UPDATE_EXIT);
+      if (ret == BLE_STATUS_INSUFFICIENT_RESOURCES)
+      {
+        LATENCY_PROBE(LATENCY_PROBE_TX_POOL_FULL);
+      }
+      else if (ret != BLE_STATUS_SUCCESS)
+      {
+        APP_TRACE1("  Fail   : aci_gatt_update_char_value_ext C_IO command, result : 0x%x \n\r", ret);
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  return ret;
+}
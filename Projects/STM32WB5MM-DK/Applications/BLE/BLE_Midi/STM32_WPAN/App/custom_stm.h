@@ -88,6 +88,8 @@ extern uint8_t SizeC_Io;
 void SVCCTL_InitCustomSvc(void);
 void Custom_STM_App_Notification(Custom_STM_App_Notification_evt_t *pNotification);
 tBleStatus Custom_STM_App_Update_Char(Custom_STM_Char_Opcode_t CharOpcode,  uint8_t *pPayload);
+tBleStatus Custom_STM_App_Update_Char_Variable_Length(Custom_STM_Char_Opcode_t CharOpcode, uint8_t *pPayload, uint8_t size);
+tBleStatus Custom_STM_App_Notify_Link(Custom_STM_Char_Opcode_t CharOpcode, uint16_t ConnectionHandle, uint8_t *pPayload, uint8_t size);
 /* USER CODE BEGIN EF */
 
 /* USER CODE END EF */
@@ -0,0 +1,264 @@
+/**
+  ******************************************************************************
+  * @file    App/song_xfer_stm.c
+  * @author  MCD Application Team
+  * @brief   Song transfer service : upload of a midi file in the external memory
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "common_blesvc.h"
+#include "song_xfer_stm.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint16_t  SvcHdle;                            /**< Service handle */
+  uint16_t  CtrlCharHdle;                       /**< Control characteristic handle */
+  uint16_t  DataCharHdle;                       /**< Data characteristic handle */
+  uint16_t  StatsCharHdle;                      /**< Statistics characteristic handle */
+} Song_Xfer_Context_t;
+
+/* Private defines -----------------------------------------------------------*/
+#define CHARACTERISTIC_DESCRIPTOR_ATTRIBUTE_OFFSET         2
+#define CHARACTERISTIC_VALUE_ATTRIBUTE_OFFSET              1
+
+/**
+ * Service UUID
+ * 7a3e0001-5c2b-4e8d-9f61-2d0b8c4e51a7
+ */
+static const uint8_t SONG_XFER_SVC_UUID[16] = {0xa7, 0x51, 0x4e, 0x8c,
+        0x0b, 0x2d, 0x61, 0x9f,
+        0x8d, 0x4e, 0x2b, 0x5c,
+        0x01, 0x00, 0x3e, 0x7a};
+
+/**
+ * Control Characteristic UUID
+ * 7a3e0002-5c2b-4e8d-9f61-2d0b8c4e51a7
+ */
+static const uint8_t SONG_XFER_CTRL_CHAR_UUID[16] = {0xa7, 0x51, 0x4e, 0x8c,
+        0x0b, 0x2d, 0x61, 0x9f,
+        0x8d, 0x4e, 0x2b, 0x5c,
+        0x02, 0x00, 0x3e, 0x7a};
+
+/**
+ * Data Characteristic UUID
+ * 7a3e0003-5c2b-4e8d-9f61-2d0b8c4e51a7
+ */
+static const uint8_t SONG_XFER_DATA_CHAR_UUID[16] = {0xa7, 0x51, 0x4e, 0x8c,
+        0x0b, 0x2d, 0x61, 0x9f,
+        0x8d, 0x4e, 0x2b, 0x5c,
+        0x03, 0x00, 0x3e, 0x7a};
+
+/**
+ * Statistics Characteristic UUID
+ * 7a3e0004-5c2b-4e8d-9f61-2d0b8c4e51a7
+ */
+static const uint8_t SONG_XFER_STATS_CHAR_UUID[16] = {0xa7, 0x51, 0x4e, 0x8c,
+        0x0b, 0x2d, 0x61, 0x9f,
+        0x8d, 0x4e, 0x2b, 0x5c,
+        0x04, 0x00, 0x3e, 0x7a};
+
+/* Private variables ---------------------------------------------------------*/
+static Song_Xfer_Context_t Song_Xfer_Context;
+
+/* Private function prototypes -----------------------------------------------*/
+static SVCCTL_EvtAckStatus_t Song_Xfer_Event_Handler(SVCCTL_GattEvt_t *pEvt);
+
+/* Functions Definition ------------------------------------------------------*/
+
+/**
+ * @brief  Event handler of the service attributes, called by the BLE controller with the event already decoded
+ * @param  pEvt: GATT event on one of the attributes of the service
+ * @retval Ack: Return whether the Event has been managed or not
+ */
+static SVCCTL_EvtAckStatus_t Song_Xfer_Event_Handler(SVCCTL_GattEvt_t *pEvt)
+{
+  Song_Xfer_STM_Notification_evt_t notification;
+
+  if((pEvt->Ecode == ACI_GATT_READ_PERMIT_REQ_VSEVT_CODE) &&
+     (pEvt->AttrHandle == (Song_Xfer_Context.StatsCharHdle + CHARACTERISTIC_VALUE_ATTRIBUTE_OFFSET)))
+  {
+    /* The value is updated at the start of a read only, the blobs of a long read come from the same update */
+    if(pEvt->Offset == 0)
+    {
+      notification.Evt_Opcode = SONG_XFER_STM_STATS_READ_EVT;
+      notification.ConnectionHandle = pEvt->ConnectionHandle;
+      notification.pPayload = NULL;
+      notification.Length = 0;
+      SONG_XFER_STM_App_Notification(&notification);
+    }
+    aci_gatt_allow_read(pEvt->ConnectionHandle);
+
+    return SVCCTL_EvtAckFlowEnable;
+  }
+
+  if(pEvt->Ecode != ACI_GATT_ATTRIBUTE_MODIFIED_VSEVT_CODE)
+  {
+    return SVCCTL_EvtNotAck;
+  }
+
+  notification.ConnectionHandle = pEvt->ConnectionHandle;
+  notification.pPayload = pEvt->pData;
+  notification.Length = pEvt->DataLength;
+
+  if(pEvt->AttrHandle == (Song_Xfer_Context.DataCharHdle + CHARACTERISTIC_VALUE_ATTRIBUTE_OFFSET))
+  {
+    notification.Evt_Opcode = SONG_XFER_STM_DATA_WRITE_EVT;
+  }
+  else if(pEvt->AttrHandle == (Song_Xfer_Context.CtrlCharHdle + CHARACTERISTIC_VALUE_ATTRIBUTE_OFFSET))
+  {
+    notification.Evt_Opcode = SONG_XFER_STM_CTRL_WRITE_EVT;
+  }
+  else if(pEvt->AttrHandle == (Song_Xfer_Context.CtrlCharHdle + CHARACTERISTIC_DESCRIPTOR_ATTRIBUTE_OFFSET))
+  {
+    notification.Evt_Opcode = ((pEvt->pData[0] & COMSVC_Notification) != 0) ?
+                              SONG_XFER_STM_CTRL_NOTIFY_ENABLED_EVT : SONG_XFER_STM_CTRL_NOTIFY_DISABLED_EVT;
+  }
+  else
+  {
+    return SVCCTL_EvtNotAck;
+  }
+
+  SONG_XFER_STM_App_Notification(&notification);
+
+  return SVCCTL_EvtAckFlowEnable;
+}
+
+/**
+ * @brief  Service initialization
+ * @param  None
+ * @retval None
+ */
+void SONG_XFER_STM_Init(void)
+{
+  tBleStatus ret;
+
+  /**
+   *  Add the service
+   *  1 for the service + 3 for the control characteristic and its configuration descriptor
+   *  + 2 for the data characteristic + 2 for the statistics characteristic
+   */
+  ret = aci_gatt_add_service(UUID_TYPE_128,
+                             (Service_UUID_t *)SONG_XFER_SVC_UUID,
+                             PRIMARY_SERVICE,
+                             1 + 3 + 2 + 2,
+                             &(Song_Xfer_Context.SvcHdle));
+  if (ret != BLE_STATUS_SUCCESS)
+  {
+    APP_DBG_MSG("  Fail   : aci_gatt_add_service command: song transfer, error code: 0x%x \n\r", ret);
+    return;
+  }
+
+  /**
+   *  Control characteristic : requests written by the client, reports notified
+   */
+  ret = aci_gatt_add_char(Song_Xfer_Context.SvcHdle,
+                          UUID_TYPE_128,
+                          (Char_UUID_t *)SONG_XFER_CTRL_CHAR_UUID,
+                          SONG_XFER_CTRL_SIZE,
+                          CHAR_PROP_WRITE | CHAR_PROP_NOTIFY,
+                          ATTR_PERMISSION_NONE,
+                          GATT_NOTIFY_ATTRIBUTE_WRITE,
+                          0x10,
+                          CHAR_VALUE_LEN_VARIABLE,
+                          &(Song_Xfer_Context.CtrlCharHdle));
+  if (ret != BLE_STATUS_SUCCESS)
+  {
+    APP_DBG_MSG("  Fail   : aci_gatt_add_char command   : song transfer control, error code: 0x%x \n\r", ret);
+    return;
+  }
+
+  /**
+   *  Data characteristic : the file, written without response
+   */
+  ret = aci_gatt_add_char(Song_Xfer_Context.SvcHdle,
+                          UUID_TYPE_128,
+                          (Char_UUID_t *)SONG_XFER_DATA_CHAR_UUID,
+                          SONG_XFER_DATA_SIZE,
+                          CHAR_PROP_WRITE_WITHOUT_RESP,
+                          ATTR_PERMISSION_NONE,
+                          GATT_NOTIFY_ATTRIBUTE_WRITE,
+                          0x10,
+                          CHAR_VALUE_LEN_VARIABLE,
+                          &(Song_Xfer_Context.DataCharHdle));
+  if (ret != BLE_STATUS_SUCCESS)
+  {
+    APP_DBG_MSG("  Fail   : aci_gatt_add_char command   : song transfer data, error code: 0x%x \n\r", ret);
+    return;
+  }
+
+  /**
+   *  Statistics characteristic : read only, its value is updated by the application on each read
+   */
+  ret = aci_gatt_add_char(Song_Xfer_Context.SvcHdle,
+                          UUID_TYPE_128,
+                          (Char_UUID_t *)SONG_XFER_STATS_CHAR_UUID,
+                          SONG_XFER_STATS_SIZE,
+                          CHAR_PROP_READ,
+                          ATTR_PERMISSION_NONE,
+                          GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP,
+                          0x10,
+                          CHAR_VALUE_LEN_VARIABLE,
+                          &(Song_Xfer_Context.StatsCharHdle));
+  if (ret != BLE_STATUS_SUCCESS)
+  {
+    APP_DBG_MSG("  Fail   : aci_gatt_add_char command   : song transfer statistics, error code: 0x%x \n\r", ret);
+    return;
+  }
+
+  /**
+   *  The events on the service attributes are routed here without going through the other handlers
+   */
+  SVCCTL_RegisterSvcHandleRange(Song_Xfer_Context.SvcHdle,
+                                Song_Xfer_Context.StatsCharHdle + CHARACTERISTIC_VALUE_ATTRIBUTE_OFFSET,
+                                Song_Xfer_Event_Handler);
+
+  APP_DBG_MSG("  Success: song transfer service\n\r");
+
+  return;
+}
+
+/**
+ * @brief  Notify a report on the control characteristic to one client
+ * @param  ConnectionHandle: Connection handle of the client
+ * @param  pPayload: Report
+ * @param  size: Length of the report, up to SONG_XFER_CTRL_SIZE
+ * @retval BLE_STATUS_INSUFFICIENT_RESOURCES when the TX buffers are full
+ */
+tBleStatus SONG_XFER_STM_Notify(uint16_t ConnectionHandle, uint8_t *pPayload, uint8_t size)
+{
+  return aci_gatt_update_char_value_ext(ConnectionHandle,
+                                        Song_Xfer_Context.SvcHdle,
+                                        Song_Xfer_Context.CtrlCharHdle,
+                                        0x01, /* Update_Type : notification */
+                                        size, /* Char_Length */
+                                        0, /* Value_Offset */
+                                        size, /* Value_Length */
+                                        pPayload);
+}
+
+/**
+ * @brief  Update the value of the statistics characteristic, before the read of a client is allowed
+ * @param  pPayload: Statistics
+ * @param  size: Length of the statistics, up to SONG_XFER_STATS_SIZE
+ * @retval Status of the update
+ */
+tBleStatus SONG_XFER_STM_Update_Stats(uint8_t *pPayload, uint8_t size)
+{
+  return aci_gatt_update_char_value(Song_Xfer_Context.SvcHdle,
+                                    Song_Xfer_Context.StatsCharHdle,
+                                    0, /* Value_Offset */
+                                    size, /* Value_Length */
+                                    pPayload);
+}
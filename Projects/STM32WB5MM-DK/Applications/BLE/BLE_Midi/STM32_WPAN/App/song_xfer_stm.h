@@ -0,0 +1,67 @@
+/**
+  ******************************************************************************
+  * @file    App/song_xfer_stm.h
+  * @author  MCD Application Team
+  * @brief   Header for song_xfer_stm.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SONG_XFER_STM_H
+#define SONG_XFER_STM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+
+/* Exported defines ----------------------------------------------------------*/
+/* Requests and reports on the control characteristic */
+#define SONG_XFER_CTRL_SIZE             (20U)
+
+/* File data written without response, up to the ATT_MTU of the link minus 3 */
+#define SONG_XFER_DATA_SIZE             (CFG_BLE_MAX_ATT_MTU - 3U)
+
+/* Latency statistics read by the client, with a long read beyond ATT_MTU - 1 bytes */
+#define SONG_XFER_STATS_SIZE            (128U)
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  SONG_XFER_STM_CTRL_WRITE_EVT,
+  SONG_XFER_STM_CTRL_NOTIFY_ENABLED_EVT,
+  SONG_XFER_STM_CTRL_NOTIFY_DISABLED_EVT,
+  SONG_XFER_STM_DATA_WRITE_EVT,
+  SONG_XFER_STM_STATS_READ_EVT,
+} Song_Xfer_STM_Opcode_evt_t;
+
+typedef struct
+{
+  Song_Xfer_STM_Opcode_evt_t    Evt_Opcode;
+  uint16_t                      ConnectionHandle;
+  uint8_t                       *pPayload;
+  uint16_t                      Length;
+} Song_Xfer_STM_Notification_evt_t;
+
+/* Exported functions ------------------------------------------------------- */
+void SONG_XFER_STM_Init(void);
+void SONG_XFER_STM_App_Notification(Song_Xfer_STM_Notification_evt_t *pNotification);
+tBleStatus SONG_XFER_STM_Notify(uint16_t ConnectionHandle, uint8_t *pPayload, uint8_t size);
+tBleStatus SONG_XFER_STM_Update_Stats(uint8_t *pPayload, uint8_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SONG_XFER_STM_H */
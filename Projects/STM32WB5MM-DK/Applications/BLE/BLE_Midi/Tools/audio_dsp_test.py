@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+# Copyright (c) 2023 STMicroelectronics.
+# All rights reserved.
+#
+# This software is licensed under terms that can be found in the LICENSE file
+# in the root directory of this software component.
+# If no LICENSE file comes with this software, it is provided AS-IS.
+"""
+Host test of the microphone onset and pitch detector (Core/Src/audio_midi_dsp.c).
+
+The detector is built for the PC with the host C compiler (CC, default cc) and
+fed with 16 bit PCM blocks of the same size as on the board (20 ms).
+
+Without a file, a sequence of tones is synthesized (DC offset, noise, decaying
+envelope, silence between the notes) and each Note On must give the note played.
+A full scale block also checks the DC tracker. --write saves the synthesized
+signal as a WAV file.
+
+With a WAV file (mono or first channel, 16 bit), the events are printed with
+their time. --expect checks the notes of the Note Ons in order.
+
+Usage:
+  audio_dsp_test.py [--write tones.wav]
+  audio_dsp_test.py take.wav [--expect 60,64,67]
+"""
+
+import argparse
+import ctypes
+import math
+import os
+import random
+import struct
+import subprocess
+import sys
+import tempfile
+import wave
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+BLOCK_MS = 20
+
+EVT_NONE = 0
+EVT_NOTE_ON = 1
+EVT_NOTE_OFF = 2
+EVT_NOTE_CHANGE = 3
+
+# Larger than Audio_Dsp_Context_t, DcQ8 is its fourth field
+CONTEXT_SIZE = 4096
+CONTEXT_DC_OFFSET = 12
+
+TEST_NOTES = [45, 52, 57, 60, 64, 69, 72, 76, 81, 88, 93]
+
+
+class Result(ctypes.Structure):
+    """Audio_Dsp_Result_t"""
+    _fields_ = [("Event", ctypes.c_uint8),
+                ("Note", ctypes.c_uint8),
+                ("PrevNote", ctypes.c_uint8),
+                ("Velocity", ctypes.c_uint8),
+                ("Energy", ctypes.c_uint32),
+                ("LagQ4", ctypes.c_uint32)]
+
+
+class Dsp:
+    def __init__(self, library, sample_rate):
+        self.lib = library
+        self.ctx = ctypes.create_string_buffer(CONTEXT_SIZE)
+        self.lib.AUDIO_DSP_Init(self.ctx, ctypes.c_uint32(sample_rate))
+
+    def process(self, samples):
+        block = (ctypes.c_int16 * len(samples))(*samples)
+        result = Result()
+        self.lib.AUDIO_DSP_Process(self.ctx, block, ctypes.c_uint32(len(samples)), ctypes.byref(result))
+        return result
+
+    def dc(self):
+        return struct.unpack_from("<i", self.ctx, CONTEXT_DC_OFFSET)[0] >> 8
+
+
+def build(directory):
+    output = os.path.join(directory, "audio_midi_dsp.so")
+    command = [os.environ.get("CC", "cc"), "-shared", "-fPIC", "-O2", "-Wall",
+               "-I", os.path.join(ROOT, "Core", "Inc"),
+               os.path.join(ROOT, "Core", "Src", "audio_midi_dsp.c"),
+               "-o", output]
+    subprocess.run(command, check=True)
+    return ctypes.CDLL(output)
+
+
+def note_frequency(note):
+    return 440.0 * 2.0 ** ((note - 69) / 12.0)
+
+
+def synthesize(notes, sample_rate, seed):
+    rng = random.Random(seed)
+    samples = []
+    dc = 600
+    for note in notes:
+        frequency = note_frequency(note)
+        for n in range(int(sample_rate * 0.4)):
+            envelope = math.exp(-3.0 * n / sample_rate)
+            value = 12000 * envelope * (math.sin(2 * math.pi * frequency * n / sample_rate) +
+                                        0.3 * math.sin(4 * math.pi * frequency * n / sample_rate))
+            samples.append(value)
+        samples.extend([0.0] * int(sample_rate * 0.3))
+    return [max(-32768, min(32767, int(value + dc + rng.gauss(0, 20)))) for value in samples]
+
+
+def read_wav(path):
+    with wave.open(path, "rb") as stream:
+        if stream.getsampwidth() != 2:
+            raise ValueError("%s : 16 bit PCM expected" % path)
+        channels = stream.getnchannels()
+        frames = stream.readframes(stream.getnframes())
+        samples = struct.unpack("<%dh" % (len(frames) // 2), frames)
+        return list(samples[::channels]), stream.getframerate()
+
+
+def write_wav(path, samples, sample_rate):
+    with wave.open(path, "wb") as stream:
+        stream.setnchannels(1)
+        stream.setsampwidth(2)
+        stream.setframerate(sample_rate)
+        stream.writeframes(struct.pack("<%dh" % len(samples), *samples))
+
+
+def run(dsp, samples, sample_rate, verbose):
+    block_size = sample_rate * BLOCK_MS // 1000
+    notes_on = []
+    for start in range(0, len(samples) - block_size + 1, block_size):
+        result = dsp.process(samples[start:start + block_size])
+        time_ms = start * 1000 // sample_rate
+        if result.Event in (EVT_NOTE_ON, EVT_NOTE_CHANGE):
+            notes_on.append(result.Note)
+        if verbose and result.Event != EVT_NONE:
+            name = {EVT_NOTE_ON: "on", EVT_NOTE_OFF: "off", EVT_NOTE_CHANGE: "change"}[result.Event]
+            print("%7d ms  %-6s note %3d  velocity %3d  lag %.2f" %
+                  (time_ms, name, result.Note, result.Velocity, result.LagQ4 / 16.0))
+    return notes_on
+
+
+def check_notes(found, expected):
+    if found == expected:
+        return 0
+    print("notes %s, expected %s" % (found, expected))
+    return 1
+
+
+def test_synthesized(library, options):
+    sample_rate = 16000
+    failures = 0
+    samples = synthesize(TEST_NOTES, sample_rate, options.seed)
+    if options.write:
+        write_wav(options.write, samples, sample_rate)
+
+    failures += check_notes(run(Dsp(library, sample_rate), samples, sample_rate, options.verbose), TEST_NOTES)
+
+    # Full scale blocks : the DC tracker follows them
+    dsp = Dsp(library, sample_rate)
+    for _ in range(20):
+        dsp.process([32767] * (sample_rate * BLOCK_MS // 1000))
+    if dsp.dc() < 30000:
+        print("DC tracker at %d after full scale blocks" % dsp.dc())
+        failures += 1
+
+    print("%s : %d notes, %d failures" % ("synthesized", len(TEST_NOTES), failures))
+    return failures
+
+
+def test_file(library, options):
+    samples, sample_rate = read_wav(options.file)
+    notes_on = run(Dsp(library, sample_rate), samples, sample_rate, True)
+    print("%s : %d notes" % (options.file, len(notes_on)))
+    if options.expect:
+        return check_notes(notes_on, [int(note) for note in options.expect.split(",")])
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("file", nargs="?", help="WAV file, 16 bit")
+    parser.add_argument("--expect", help="notes of the Note Ons, comma separated")
+    parser.add_argument("--write", help="save the synthesized tones in this WAV file")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--verbose", action="store_true")
+    options = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as directory:
+        library = build(directory)
+        if options.file:
+            failures = test_file(library, options)
+        else:
+            failures = test_synthesized(library, options)
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,383 @@
+#!/usr/bin/env python3
+# Copyright (c) 2023 STMicroelectronics.
+# All rights reserved.
+#
+# This software is licensed under terms that can be found in the LICENSE file
+# in the root directory of this software component.
+# If no LICENSE file comes with this software, it is provided AS-IS.
+"""
+Host side of the BLE_Midi control protocol (Core/Src/app_hostctl.c).
+
+A request is sent as 0x00, the COBS encoding of type, sequence number, data and
+CRC-16/CCITT-FALSE (little endian), 0x00. The response has the same framing with
+the request type | 0x80, the sequence number, a status byte and the data. The
+text traces received between the frames are printed with --verbose.
+
+Usage:
+  hostctl.py --port /dev/ttyACM0 ping [--count 100] [--size 64]
+  hostctl.py --port /dev/ttyACM0 play | pause | restart
+  hostctl.py --port /dev/ttyACM0 note 0 60 100 [--duration 0.5]
+  hostctl.py --port /dev/ttyACM0 midi 90 3C 64 80 3C 00
+  hostctl.py --port /dev/ttyACM0 stream capture.mid.raw [--rate 500]
+  hostctl.py --port /dev/ttyACM0 stats [--reset] [--period 1]
+  hostctl.py --port /dev/ttyACM0 cmd LAT
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+
+DELIMITER = 0x00
+DATA_MAX_SIZE = 250
+
+TYPE_PING = 0x01
+TYPE_TRANSPORT = 0x02
+TYPE_MIDI = 0x03
+TYPE_STATS_GET = 0x04
+TYPE_STATS_RESET = 0x05
+TYPE_COMMAND = 0x06
+RESPONSE = 0x80
+
+TRANSPORT_PAUSE = 0
+TRANSPORT_PLAY = 1
+TRANSPORT_RESTART = 2
+
+STATUS_NAMES = ["ok", "unknown request", "bad length", "bad midi message", "busy"]
+
+# Words of the STATS_GET response, in the order of HostCtl_Stats_Word_t
+STATS_NAMES = [
+    "rx_bytes",
+    "frames",
+    "crc_errors",
+    "framing_errors",
+    "overruns",
+    "uart_errors",
+    "midi_messages",
+    "cpu_load_permille",
+    "mbox_peak_bytes",
+    "mbox_spare_events",
+    "hci_queue_max",
+    "playing",
+    "tick_ms",
+    "elapsed_ms",
+    "remaining_ms",
+    "progress_permille",
+]
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_index = 0
+    code = 1
+    for byte in data:
+        if byte:
+            out.append(byte)
+            code += 1
+        if byte == 0 or code == 0xFF:
+            out[code_index] = code
+            code_index = len(out)
+            out.append(0)
+            code = 1
+    out[code_index] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    """Decoded data, None when the encoding is not valid."""
+    out = bytearray()
+    index = 0
+    while index < len(data):
+        code = data[index]
+        index += 1
+        if code == 0 or index + code - 1 > len(data):
+            return None
+        out += data[index:index + code - 1]
+        index += code - 1
+        if code != 0xFF and index < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def frame_encode(payload):
+    """Wire bytes of a payload : delimiters, COBS and CRC."""
+    return bytes([DELIMITER]) + cobs_encode(payload + struct.pack("<H", crc16(payload))) + bytes([DELIMITER])
+
+
+def frame_decode(chunk):
+    """Payload of the bytes found between two delimiters, None when it is not a valid frame."""
+    data = cobs_decode(chunk)
+    if data is None or len(data) < 4:
+        return None
+    payload, crc = data[:-2], struct.unpack("<H", data[-2:])[0]
+    if crc16(payload) != crc:
+        return None
+    return payload
+
+
+class FrameReader:
+    """Splits the UART stream into frames and text."""
+
+    def __init__(self, text_out=None):
+        self.buffer = bytearray()
+        self.text_out = text_out
+
+    def feed(self, data):
+        """Payloads of the complete frames found in data."""
+        frames = []
+        self.buffer += data
+        while True:
+            end = self.buffer.find(bytes([DELIMITER]))
+            if end < 0:
+                break
+            chunk = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            payload = frame_decode(chunk) if chunk else None
+            if payload is not None:
+                frames.append(payload)
+            elif chunk and self.text_out:
+                self.text_out.write(chunk.decode("latin-1", "replace"))
+        if self.text_out and self.buffer and DELIMITER not in self.buffer and len(self.buffer) > 512:
+            self.text_out.write(bytes(self.buffer).decode("latin-1", "replace"))
+            self.buffer.clear()
+        return frames
+
+
+class HostCtlError(Exception):
+    pass
+
+
+class HostCtl:
+    """Requests to the board, one at a time, retried on timeout."""
+
+    def __init__(self, stream, timeout=0.5, retries=2, text_out=None):
+        self.stream = stream
+        self.timeout = timeout
+        self.retries = retries
+        self.reader = FrameReader(text_out)
+        self.seq = 0
+        self.pending = []
+        self.retried = 0
+
+    def request(self, req_type, data=b""):
+        """Data of the response, raises HostCtlError on a status other than ok."""
+        if len(data) > DATA_MAX_SIZE:
+            raise HostCtlError("data longer than %d bytes" % DATA_MAX_SIZE)
+        self.seq = (self.seq + 1) & 0xFF
+        wire = frame_encode(bytes([req_type, self.seq]) + bytes(data))
+        for attempt in range(self.retries + 1):
+            if attempt:
+                self.retried += 1
+            self.stream.write(wire)
+            response = self._wait(req_type | RESPONSE, self.seq)
+            if response is not None:
+                status, rsp_data = response
+                if status != 0:
+                    name = STATUS_NAMES[status] if status < len(STATUS_NAMES) else str(status)
+                    raise HostCtlError("request 0x%02x : %s" % (req_type, name))
+                return rsp_data
+        raise HostCtlError("request 0x%02x : no response" % req_type)
+
+    def _wait(self, rsp_type, seq):
+        deadline = time.monotonic() + self.timeout
+        while time.monotonic() < deadline:
+            if not self.pending:
+                self.pending = self.reader.feed(self.stream.read(256))
+                continue
+            payload = self.pending.pop(0)
+            if len(payload) >= 3 and payload[0] == rsp_type and payload[1] == seq:
+                return payload[2], payload[3:]
+        return None
+
+    def ping(self, data):
+        return self.request(TYPE_PING, data)
+
+    def transport(self, action):
+        return self.request(TYPE_TRANSPORT, bytes([action]))[0]
+
+    def midi(self, messages):
+        return self.request(TYPE_MIDI, messages)[0]
+
+    def stats(self):
+        data = self.request(TYPE_STATS_GET)
+        count = data[0]
+        words = struct.unpack_from("<%dI" % count, data, 1)
+        names = STATS_NAMES + ["word%d" % i for i in range(len(STATS_NAMES), count)]
+        return dict(zip(names, words))
+
+    def stats_reset(self):
+        self.request(TYPE_STATS_RESET)
+
+    def command(self, text):
+        self.request(TYPE_COMMAND, text.encode("ascii"))
+
+
+def midi_message_length(status):
+    """Length of a midi message from its status byte, 0 when not supported."""
+    if status < 0x80:
+        return 0
+    if status < 0xF0:
+        return 2 if (status & 0xE0) == 0xC0 else 3
+    return {0xF1: 2, 0xF2: 3, 0xF3: 2, 0xF6: 1}.get(status, 1 if status >= 0xF8 else 0)
+
+
+def midi_split(data):
+    """Complete messages of a raw midi byte stream, running status expanded, system exclusive dropped."""
+    messages = []
+    running = None
+    index = 0
+    while index < len(data):
+        byte = data[index]
+        if byte >= 0x80:
+            length = midi_message_length(byte)
+            if length == 0:
+                # System exclusive : skip up to the next status byte
+                running = None
+                index += 1
+                while index < len(data) and data[index] < 0x80:
+                    index += 1
+                continue
+            if byte < 0xF0:
+                running = byte
+            elif byte < 0xF8:
+                running = None
+            message = data[index:index + length]
+            index += length
+        elif running is not None:
+            length = midi_message_length(running)
+            message = bytes([running]) + data[index:index + length - 1]
+            index += length - 1
+        else:
+            index += 1
+            continue
+        if len(message) == midi_message_length(message[0]):
+            messages.append(bytes(message))
+    return messages
+
+
+def print_stats(stats):
+    for name, value in stats.items():
+        print("  %-18s %d" % (name, value))
+
+
+def cmd_ping(ctl, options):
+    total = 0
+    start = time.monotonic()
+    for i in range(options.count):
+        data = os.urandom(options.size)
+        if ctl.ping(data) != data:
+            raise HostCtlError("ping %d : echo differs" % i)
+        total += len(data)
+    elapsed = time.monotonic() - start
+    print("%d pings of %d bytes in %.3f s : %.2f ms round trip, %.0f bytes/s each way, %d retries" %
+          (options.count, options.size, elapsed, 1000.0 * elapsed / options.count, total / elapsed, ctl.retried))
+
+
+def cmd_note(ctl, options):
+    ctl.midi(bytes([0x90 | options.channel, options.note, options.velocity]))
+    time.sleep(options.duration)
+    ctl.midi(bytes([0x80 | options.channel, options.note, 0]))
+
+
+def cmd_stream(ctl, options):
+    with open(options.file, "rb") as f:
+        messages = midi_split(f.read())
+    period = 1.0 / options.rate if options.rate else 0.0
+    sent = 0
+    start = time.monotonic()
+    batch = bytearray()
+    for message in messages:
+        if len(batch) + len(message) > DATA_MAX_SIZE or (period and batch):
+            sent += ctl.midi(bytes(batch))
+            batch.clear()
+            if period:
+                time.sleep(max(0.0, start + sent * period - time.monotonic()))
+        batch += message
+    if batch:
+        sent += ctl.midi(bytes(batch))
+    elapsed = time.monotonic() - start
+    print("%d midi messages sent in %.3f s" % (sent, elapsed))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Control the BLE_Midi board on its trace UART")
+    parser.add_argument("--port", required=True, help="serial port of the ST-LINK virtual COM")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baudrate, CFG_HOSTCTL_BAUDRATE (default 115200)")
+    parser.add_argument("--timeout", type=float, default=0.5, help="response timeout in s (default 0.5)")
+    parser.add_argument("--verbose", action="store_true", help="print the text traces")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    ping = commands.add_parser("ping", help="echo test and round trip time")
+    ping.add_argument("--count", type=int, default=1)
+    ping.add_argument("--size", type=int, default=16)
+    for name in ("play", "pause", "restart"):
+        commands.add_parser(name, help="%s the midi file player" % name)
+    note = commands.add_parser("note", help="note on then note off")
+    note.add_argument("channel", type=int)
+    note.add_argument("note", type=int)
+    note.add_argument("velocity", type=int)
+    note.add_argument("--duration", type=float, default=0.5)
+    midi = commands.add_parser("midi", help="raw midi messages in hexadecimal")
+    midi.add_argument("bytes", nargs="+")
+    stream = commands.add_parser("stream", help="send the messages of a raw midi byte stream")
+    stream.add_argument("file")
+    stream.add_argument("--rate", type=float, default=0.0, help="messages per second, as fast as possible by default")
+    stats = commands.add_parser("stats", help="protocol, mailbox and CPU load counters")
+    stats.add_argument("--reset", action="store_true")
+    stats.add_argument("--period", type=float, default=0.0, help="print again every period seconds")
+    cmd = commands.add_parser("cmd", help="text command (LAT, MBOX, SW1...)")
+    cmd.add_argument("text")
+    options = parser.parse_args()
+
+    import serial  # pyserial
+    stream = serial.Serial(options.port, options.baud, timeout=0.02)
+    ctl = HostCtl(stream, timeout=options.timeout, text_out=sys.stdout if options.verbose else None)
+
+    try:
+        if options.command == "ping":
+            cmd_ping(ctl, options)
+        elif options.command in ("play", "pause", "restart"):
+            action = {"play": TRANSPORT_PLAY, "pause": TRANSPORT_PAUSE, "restart": TRANSPORT_RESTART}[options.command]
+            print("playing" if ctl.transport(action) else "paused")
+        elif options.command == "note":
+            cmd_note(ctl, options)
+        elif options.command == "midi":
+            print("%d messages sent" % ctl.midi(bytes(int(b, 16) for b in options.bytes)))
+        elif options.command == "stream":
+            cmd_stream(ctl, options)
+        elif options.command == "stats":
+            if options.reset:
+                ctl.stats_reset()
+            while True:
+                print_stats(ctl.stats())
+                if not options.period:
+                    break
+                time.sleep(options.period)
+                print()
+        elif options.command == "cmd":
+            ctl.command(options.text)
+            if options.verbose:
+                # Let the text answer come
+                ctl.reader.text_out = sys.stdout
+                end = time.monotonic() + options.timeout
+                while time.monotonic() < end:
+                    ctl.reader.feed(stream.read(256))
+    except HostCtlError as error:
+        sys.exit("hostctl: %s" % error)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+# Copyright (c) 2023 STMicroelectronics.
+# All rights reserved.
+#
+# This software is licensed under terms that can be found in the LICENSE file
+# in the root directory of this software component.
+# If no LICENSE file comes with this software, it is provided AS-IS.
+"""
+Test harness of the BLE_Midi control protocol (Tools/hostctl.py, Core/Src/app_hostctl.c).
+
+Without a port, the framing is checked on the PC : COBS and CRC round trip of
+random frames, corrupted frames rejected, frames found back in a stream mixed
+with text traces and cut in random pieces.
+
+With --port, random PING requests are sent to the board and their echo is
+checked, then the protocol counters of the board are printed : any CRC,
+framing, overrun or UART error shows the link is not reliable at that baud.
+With --wire, the port is a USB to UART adapter with RX tied to TX : the frames
+come back unchanged, which checks the adapter and the PC at high baud rates.
+
+Usage:
+  hostctl_loopback.py [--count 10000]
+  hostctl_loopback.py --port /dev/ttyACM0 --baud 921600 [--count 1000]
+  hostctl_loopback.py --port /dev/ttyUSB0 --baud 2000000 --wire
+"""
+
+import argparse
+import os
+import random
+import sys
+import time
+
+import hostctl
+
+
+def random_payload(rng, size=None):
+    if size is None:
+        size = rng.randint(0, hostctl.DATA_MAX_SIZE)
+    # Many zeros and 0xFF runs to exercise the COBS blocks
+    kind = rng.randint(0, 3)
+    if kind == 0:
+        data = bytes(size)
+    elif kind == 1:
+        data = bytes([0xFF]) * size
+    else:
+        data = bytes(rng.getrandbits(8) for _ in range(size))
+    return bytes([rng.randint(1, 0x7F), rng.getrandbits(8)]) + data
+
+
+def test_offline(count, seed):
+    rng = random.Random(seed)
+    failures = 0
+
+    # Known CRC-16/CCITT-FALSE check value
+    if hostctl.crc16(b"123456789") != 0x29B1:
+        print("crc16 check value wrong")
+        failures += 1
+
+    for size in (0, 1, 253, 254, 255, 508):
+        for payload in (bytes(size), bytes([1]) * size):
+            if hostctl.cobs_decode(hostctl.cobs_encode(payload)) != payload:
+                print("cobs round trip failed, size %d" % size)
+                failures += 1
+
+    for _ in range(count):
+        payload = random_payload(rng)
+        wire = hostctl.frame_encode(payload)
+        if 0 in wire[1:-1] or len(wire) > hostctl.DATA_MAX_SIZE + 8:
+            print("bad encoding of %s" % payload.hex())
+            failures += 1
+        if hostctl.frame_decode(wire[1:-1]) != payload:
+            print("round trip failed for %s" % payload.hex())
+            failures += 1
+        # A single bit error is always caught by the COBS structure or by the CRC
+        corrupted = bytearray(wire[1:-1])
+        corrupted[rng.randrange(len(corrupted))] ^= 1 << rng.randrange(8)
+        if 0 not in corrupted and hostctl.frame_decode(bytes(corrupted)) == payload:
+            print("corruption not detected for %s" % payload.hex())
+            failures += 1
+
+    # Frames mixed with text traces, received in random pieces
+    payloads = [random_payload(rng) for _ in range(200)]
+    stream = bytearray()
+    for payload in payloads:
+        stream += b"trace line\r\n" * rng.randint(0, 2)
+        stream += hostctl.frame_encode(payload)
+    reader = hostctl.FrameReader()
+    found = []
+    index = 0
+    while index < len(stream):
+        size = rng.randint(1, 64)
+        found += reader.feed(bytes(stream[index:index + size]))
+        index += size
+    if found != payloads:
+        print("stream : %d frames found out of %d" % (len(found), len(payloads)))
+        failures += 1
+
+    print("offline : %d random frames, %d failures" % (count, failures))
+    return failures
+
+
+def test_board(options):
+    import serial  # pyserial
+    stream = serial.Serial(options.port, options.baud, timeout=0.02)
+    ctl = hostctl.HostCtl(stream, timeout=options.timeout)
+    rng = random.Random(options.seed)
+    failures = 0
+
+    ctl.stats_reset()
+    total = 0
+    start = time.monotonic()
+    for i in range(options.count):
+        data = os.urandom(rng.randint(0, hostctl.DATA_MAX_SIZE))
+        try:
+            if ctl.ping(data) != data:
+                print("ping %d : echo differs" % i)
+                failures += 1
+        except hostctl.HostCtlError as error:
+            print("ping %d : %s" % (i, error))
+            failures += 1
+        total += len(data)
+    elapsed = time.monotonic() - start
+
+    stats = ctl.stats()
+    print("board : %d pings, %d failures, %d retries, %.0f bytes/s each way at %d baud" %
+          (options.count, failures, ctl.retried, total / elapsed, options.baud))
+    hostctl.print_stats(stats)
+    errors = sum(stats[name] for name in ("crc_errors", "framing_errors", "overruns", "uart_errors"))
+    return failures + errors
+
+
+def test_wire(options):
+    import serial  # pyserial
+    stream = serial.Serial(options.port, options.baud, timeout=0.02)
+    reader = hostctl.FrameReader()
+    rng = random.Random(options.seed)
+    failures = 0
+    total = 0
+    start = time.monotonic()
+    for i in range(options.count):
+        payload = random_payload(rng)
+        stream.write(hostctl.frame_encode(payload))
+        found = []
+        deadline = time.monotonic() + options.timeout
+        while not found and time.monotonic() < deadline:
+            found = reader.feed(stream.read(512))
+        if found != [payload]:
+            print("frame %d : %d frames back" % (i, len(found)))
+            failures += 1
+        total += len(payload)
+    elapsed = time.monotonic() - start
+    print("wire : %d frames, %d failures, %.0f bytes/s at %d baud" % (options.count, failures, total / elapsed, options.baud))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Test the BLE_Midi control protocol")
+    parser.add_argument("--port", help="serial port, offline test when not given")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baudrate (default 115200)")
+    parser.add_argument("--wire", action="store_true", help="the port has RX tied to TX, no board")
+    parser.add_argument("--count", type=int, default=None, help="number of frames")
+    parser.add_argument("--timeout", type=float, default=0.5, help="response timeout in s (default 0.5)")
+    parser.add_argument("--seed", type=int, default=1)
+    options = parser.parse_args()
+
+    if options.port is None:
+        failures = test_offline(options.count or 10000, options.seed)
+    else:
+        options.count = options.count or 1000
+        failures = test_wire(options) if options.wire else test_board(options)
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
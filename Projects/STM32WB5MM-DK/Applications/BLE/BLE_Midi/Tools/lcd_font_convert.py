@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+# Copyright (c) 2023 STMicroelectronics.
+# All rights reserved.
+#
+# This software is licensed under terms that can be found in the LICENSE file
+# in the root directory of this software component.
+# If no LICENSE file comes with this software, it is provided AS-IS.
+"""
+Converter of the Utilities/Fonts tables for the BLE_Midi text fast path
+(Core/Src/app_lcd_text.c).
+
+The fonts of Utilities/Fonts are stored row by row, most significant bit on
+the left. The SSD1315 frame buffer is organized in pages of 8 rows where each
+byte holds a column of 8 pixels, least significant bit on top. This script
+rotates each glyph into columns of ((Height + 7) / 8) bytes, least significant
+bit on top, so that a character is copied into the frame buffer a column at a
+time with a shift and a mask.
+
+The generated file is Core/Src/app_lcd_font.c, run the script again when a
+font is added or changed:
+  lcd_font_convert.py [--fonts 12 ...] [--output ../Core/Src/app_lcd_font.c]
+"""
+
+import argparse
+import os
+import re
+import sys
+
+FIRST_CHAR = 0x20
+LAST_CHAR = 0x7E
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+FONTS_DIR = os.path.normpath(os.path.join(HERE, "..", "..", "..", "..", "..", "..", "Utilities", "Fonts"))
+OUTPUT = os.path.normpath(os.path.join(HERE, "..", "Core", "Src", "app_lcd_font.c"))
+
+COMMENT = re.compile(r"//[^\n]*|/\*.*?\*/", re.S)
+TABLE = re.compile(r"Font(\d+)_Table\s*\[\s*\]\s*=\s*\{(.*?)\};", re.S)
+FONT = re.compile(r"sFONT\s+Font(\d+)\s*=\s*\{\s*Font\d+_Table\s*,\s*(\d+)\s*,\s*(\d+)\s*,?\s*\}", re.S)
+BYTE = re.compile(r"0x([0-9A-Fa-f]{1,2})")
+
+BANNER = """/**
+  ******************************************************************************
+  * @file    app_lcd_font.c
+  * @author  MCD Application Team
+  * @brief   Fonts of the text fast path, page oriented
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2023 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*
+ * Generated by Tools/lcd_font_convert.py from Utilities/Fonts, do not edit.
+ * Each character is Width columns of ((Height + 7) / 8) bytes, least significant bit on top.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_lcd_text.h"
+"""
+
+
+def load_font(size):
+    """Read Utilities/Fonts/font<size>.c, return (width, height, rows of each character)."""
+    path = os.path.join(FONTS_DIR, "font%d.c" % size)
+    with open(path, "r", encoding="latin-1") as f:
+        text = COMMENT.sub("", f.read())
+
+    table = TABLE.search(text)
+    font = FONT.search(text)
+    if table is None or font is None:
+        raise ValueError("%s : font table not found" % path)
+
+    width, height = int(font.group(2)), int(font.group(3))
+    data = [int(b, 16) for b in BYTE.findall(table.group(2))]
+    row_bytes = (width + 7) // 8
+    char_bytes = row_bytes * height
+    count = LAST_CHAR - FIRST_CHAR + 1
+    if len(data) < count * char_bytes:
+        raise ValueError("%s : %d bytes, %d expected" % (path, len(data), count * char_bytes))
+    if height > 24:
+        raise ValueError("%s : height %d, 24 at most" % (path, height))
+
+    chars = []
+    for c in range(count):
+        rows = []
+        for r in range(height):
+            line = 0
+            for b in data[c * char_bytes + r * row_bytes:c * char_bytes + (r + 1) * row_bytes]:
+                line = (line << 8) | b
+            rows.append(line)
+        chars.append(rows)
+    return width, height, chars
+
+
+def rotate(width, height, rows):
+    """Columns of a character, least significant bit on top, as a list of bytes."""
+    offset = 8 * ((width + 7) // 8) - width
+    col_bytes = (height + 7) // 8
+    out = []
+    for j in range(width):
+        column = 0
+        for r, line in enumerate(rows):
+            if line & (1 << (width - j + offset - 1)):
+                column |= 1 << r
+        out.extend((column >> (8 * k)) & 0xFF for k in range(col_bytes))
+    return out
+
+
+def generate(sizes):
+    lines = [BANNER]
+    lines.append("/* Private variables ---------------------------------------------------------*/")
+    for size in sizes:
+        width, height, chars = load_font(size)
+        lines.append("static const uint8_t Lcd_Font%d_Columns[] =" % size)
+        lines.append("{")
+        for c, rows in enumerate(chars):
+            data = rotate(width, height, rows)
+            lines.append("  %s /* '%s' */" % (" ".join("0x%02X," % b for b in data),
+                                              chr(FIRST_CHAR + c)))
+        lines.append("};")
+        lines.append("")
+
+    lines.append("/* Exported variables --------------------------------------------------------*/")
+    for size in sizes:
+        width, height, _ = load_font(size)
+        lines.append("const Lcd_Text_Font_t Lcd_Font%d = { Lcd_Font%d_Columns, %d, %d };" % (size, size, width, height))
+    lines.append("")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--fonts", type=int, nargs="+", default=[12], help="font sizes to convert (default 12)")
+    parser.add_argument("--output", default=OUTPUT, help="generated C file")
+    args = parser.parse_args()
+
+    try:
+        text = generate(args.fonts)
+    except (OSError, ValueError) as e:
+        print(e, file=sys.stderr)
+        return 1
+
+    with open(args.output, "w", newline="\n") as f:
+        f.write(text)
+    print("%s : fonts %s" % (args.output, ", ".join(str(s) for s in args.fonts)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
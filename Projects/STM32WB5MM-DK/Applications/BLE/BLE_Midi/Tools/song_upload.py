@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+# Copyright (c) 2023 STMicroelectronics.
+# All rights reserved.
+#
+# This software is licensed under terms that can be found in the LICENSE file
+# in the root directory of this software component.
+# If no LICENSE file comes with this software, it is provided AS-IS.
+"""
+Upload of a midi file in the external memory of the board over BLE
+(Core/Src/app_song_xfer.c, STM32_WPAN/App/song_xfer_stm.c).
+
+The START request gives the file size and its CRC-32, the board answers with
+its window. The file is written without response on the data characteristic,
+never more than the window beyond the last acknowledge of the board. The board
+programs the file in the free slot, reads it back, checks the CRC and plays the
+new song : the END report gives the status and the throughput.
+
+Needs bleak (pip install bleak).
+
+Usage:
+  song_upload.py song.mid [--address AA:BB:CC:DD:EE:FF] [--name WB]
+"""
+
+import argparse
+import asyncio
+import struct
+import sys
+import time
+import zlib
+
+from bleak import BleakClient, BleakScanner
+
+CTRL_UUID = "7a3e0002-5c2b-4e8d-9f61-2d0b8c4e51a7"
+DATA_UUID = "7a3e0003-5c2b-4e8d-9f61-2d0b8c4e51a7"
+
+REQ_START = 0x01
+REQ_ABORT = 0x02
+REPORT_ACK = 0x10
+REPORT_END = 0x11
+RESPONSE = 0x80
+
+STATUS = ["ok", "busy", "size", "protocol", "flash", "crc", "aborted"]
+
+
+def status_name(status):
+    return STATUS[status] if status < len(STATUS) else "0x%02x" % status
+
+
+class Upload:
+    def __init__(self, data):
+        self.data = data
+        self.window = 0
+        self.acked = 0
+        self.started = asyncio.Event()
+        self.progress = asyncio.Event()
+        self.end = None
+        self.start_status = None
+
+    def on_ctrl(self, _sender, value):
+        value = bytes(value)
+        if value[0] == REQ_START | RESPONSE:
+            self.start_status = value[1]
+            self.window = struct.unpack_from("<H", value, 2)[0]
+            self.started.set()
+        elif value[0] == REPORT_ACK:
+            self.acked = struct.unpack_from("<I", value, 1)[0]
+            self.progress.set()
+        elif value[0] == REPORT_END:
+            self.end = struct.unpack_from("<BIII", value, 1)
+            self.progress.set()
+
+
+async def find(args):
+    if args.address:
+        return args.address
+    device = await BleakScanner.find_device_by_name(args.name, timeout=10.0)
+    if device is None:
+        sys.exit("%s not found" % args.name)
+    return device.address
+
+
+async def upload(args):
+    with open(args.file, "rb") as f:
+        data = f.read()
+    up = Upload(data)
+
+    async with BleakClient(await find(args)) as client:
+        chunk = client.mtu_size - 3
+        await client.start_notify(CTRL_UUID, up.on_ctrl)
+        await client.write_gatt_char(CTRL_UUID,
+                                     struct.pack("<BII", REQ_START, len(data), zlib.crc32(data)),
+                                     response=True)
+        await asyncio.wait_for(up.started.wait(), 5.0)
+        if up.start_status != 0:
+            sys.exit("start refused : %s" % status_name(up.start_status))
+
+        t0 = time.monotonic()
+        sent = 0
+        try:
+            while up.end is None:
+                if sent < len(data) and sent < up.acked + up.window:
+                    size = min(chunk, len(data) - sent, up.acked + up.window - sent)
+                    await client.write_gatt_char(DATA_UUID, data[sent:sent + size], response=False)
+                    sent += size
+                    continue
+                up.progress.clear()
+                await asyncio.wait_for(up.progress.wait(), 10.0)
+                print("\r%d / %d bytes" % (up.acked, len(data)), end="", flush=True)
+        except (asyncio.TimeoutError, KeyboardInterrupt):
+            await client.write_gatt_char(CTRL_UUID, bytes([REQ_ABORT]), response=True)
+            sys.exit("\naborted")
+
+        status, programmed, duration, rate = up.end
+        print("\n%s : %d bytes in %d ms on the board, %d bytes/s (%.1f s on the PC)"
+              % (status_name(status), programmed, duration, rate, time.monotonic() - t0))
+        return 0 if status == 0 else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("file")
+    parser.add_argument("--address")
+    parser.add_argument("--name", default="WB")
+    args = parser.parse_args()
+    sys.exit(asyncio.run(upload(args)))
+
+
+if __name__ == "__main__":
+    main()
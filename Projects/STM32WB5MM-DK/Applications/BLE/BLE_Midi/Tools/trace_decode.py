@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+# Copyright (c) 2023 STMicroelectronics.
+# All rights reserved.
+#
+# This software is licensed under terms that can be found in the LICENSE file
+# in the root directory of this software component.
+# If no LICENSE file comes with this software, it is provided AS-IS.
+"""
+Decoder of the BLE_Midi binary traces (Core/Src/app_trace.c).
+
+The target records APP_TRACEn(fmt, ...) as a header word, the address of the
+format string and the raw 32 bits arguments. The format strings are only kept
+in the ELF file (.trace_fmt section), this script reads them back and prints
+the text. Text traces (APP_DBG_MSG) sent on the same UART are printed as they
+come.
+
+Usage:
+  trace_decode.py BLE_Midi.elf --port /dev/ttyACM0 [--baud 115200]
+  trace_decode.py BLE_Midi.elf --input capture.bin
+  cat /dev/ttyACM0 | trace_decode.py BLE_Midi.elf
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+TRACE_SYNC = 0xA5
+TRACE_MAX_ARGS = 4
+
+SHT_NOBITS = 8
+
+PRINTF_CONVERSION = re.compile(r"%([-+ #0]*)(\d+)?(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcsp%])")
+
+
+class Elf:
+    """Minimal ELF reader : sections and C strings at a given address."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError("%s is not an ELF file" % path)
+        is_64 = self.data[4] == 2
+        endian = "<" if self.data[5] == 1 else ">"
+        if is_64:
+            shoff, = struct.unpack_from(endian + "Q", self.data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", self.data, 0x3A)
+            sh_format = endian + "IIQQQQIIQQ"
+        else:
+            shoff, = struct.unpack_from(endian + "I", self.data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", self.data, 0x2E)
+            sh_format = endian + "IIIIIIIIII"
+
+        headers = []
+        for i in range(shnum):
+            fields = struct.unpack_from(sh_format, self.data, shoff + i * shentsize)
+            name, sh_type, _flags, addr, offset, size = fields[:6]
+            headers.append((name, sh_type, addr, offset, size))
+
+        names_offset = headers[shstrndx][3]
+        self.sections = {}
+        for name, sh_type, addr, offset, size in headers:
+            if sh_type == SHT_NOBITS or size == 0:
+                continue
+            section_name = self._cstring(names_offset + name)
+            self.sections[section_name] = (addr, offset, size)
+
+    def _cstring(self, offset):
+        end = self.data.index(b"\x00", offset)
+        return self.data[offset:end].decode("latin-1")
+
+    def string_at(self, address, section=None):
+        """C string at a target address, None if it is not in the ELF file."""
+        candidates = [section] if section else list(self.sections)
+        for name in candidates:
+            if name not in self.sections:
+                continue
+            addr, offset, size = self.sections[name]
+            if addr <= address < addr + size:
+                return self._cstring(offset + address - addr)
+        return None
+
+
+class Decoder:
+    """Splits the UART stream into text and binary records."""
+
+    def __init__(self, elf, out):
+        self.elf = elf
+        self.out = out
+        self.buffer = bytearray()
+        self.tick_high = 0
+        self.last_tick = None
+        self.formats = {}
+
+    def format_string(self, address):
+        if address not in self.formats:
+            fmt = None
+            if ".trace_fmt" in self.elf.sections:
+                fmt = self.elf.string_at(address, ".trace_fmt")
+            else:
+                fmt = self.elf.string_at(address)
+            self.formats[address] = fmt
+        return self.formats[address]
+
+    def render(self, fmt, args):
+        args = list(args)
+
+        def convert(match):
+            flags, width, precision, _length, conversion = match.groups()
+            if conversion == "%":
+                return "%"
+            value = args.pop(0) if args else 0
+            spec = "%" + flags + (width or "") + ("." + precision if precision else "")
+            if conversion in "di":
+                if value & 0x80000000:
+                    value -= 1 << 32
+                return (spec + "d") % value
+            if conversion == "u":
+                return (spec + "d") % value
+            if conversion in "oxX":
+                return (spec + conversion) % value
+            if conversion == "c":
+                return (spec + "c") % chr(value & 0xFF)
+            if conversion == "p":
+                return "0x%08x" % value
+            text = self.elf.string_at(value)
+            return (spec + "s") % (text if text is not None else "<0x%08x>" % value)
+
+        return PRINTF_CONVERSION.sub(convert, fmt)
+
+    def timestamp(self, tick):
+        """Rebuild the millisecond tick from its 16 low bits."""
+        if self.last_tick is not None and tick < self.last_tick:
+            self.tick_high += 1
+        self.last_tick = tick
+        return (self.tick_high << 16) | tick
+
+    def feed(self, data):
+        self.buffer += data
+        while self.buffer:
+            if self.buffer[0] == 0:
+                # Padding of the target ring
+                del self.buffer[0]
+                continue
+            if self.buffer[0] != TRACE_SYNC:
+                end = self.buffer.find(bytes([TRACE_SYNC]))
+                end = len(self.buffer) if end < 0 else end
+                self.out.write(bytes(self.buffer[:end]).replace(b"\x00", b"").decode("latin-1"))
+                del self.buffer[:end]
+                continue
+            if len(self.buffer) < 8:
+                return
+            header, address = struct.unpack_from("<II", self.buffer, 0)
+            nargs = (header >> 8) & 0xFF
+            fmt = self.format_string(address) if nargs <= TRACE_MAX_ARGS else None
+            if fmt is None:
+                # Not a record, keep the byte as text
+                self.out.write(chr(self.buffer[0]))
+                del self.buffer[0]
+                continue
+            length = 8 + 4 * nargs
+            if len(self.buffer) < length:
+                return
+            args = struct.unpack_from("<%dI" % nargs, self.buffer, 8)
+            tick = self.timestamp(header >> 16)
+            self.out.write("[%8.3f] %s" % (tick / 1000.0, self.render(fmt, args)))
+            del self.buffer[:length]
+        self.out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the BLE_Midi binary traces")
+    parser.add_argument("elf", help="ELF file of the running firmware")
+    parser.add_argument("--port", help="serial port of the ST-LINK virtual COM")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baudrate (default 115200)")
+    parser.add_argument("--input", help="raw capture of the UART, stdin by default")
+    options = parser.parse_args()
+
+    decoder = Decoder(Elf(options.elf), sys.stdout)
+
+    if options.port:
+        import serial  # pyserial
+        stream = serial.Serial(options.port, options.baud, timeout=0.1)
+    elif options.input:
+        stream = open(options.input, "rb")
+    else:
+        stream = sys.stdin.buffer
+
+    try:
+        while True:
+            data = stream.read(256)
+            if not data:
+                if options.port:
+                    continue
+                break
+            decoder.feed(data)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -68,6 +68,35 @@ typedef struct
   #define UTIL_SEQ_EXIT_CRITICAL_SECTION_IDLE( )     UTIL_SEQ_EXIT_CRITICAL_SECTION( )
 #endif
 
+/**
+ * @brief macro called just before a task is executed, can be redefined in utilities_conf.h
+ *        to instrument the tasks
+ */
+#ifndef UTIL_SEQ_TASK_START_HOOK
+  #define UTIL_SEQ_TASK_START_HOOK( task_idx )
+#endif
+
+/**
+ * @brief task profiling is disabled by default, it can be enabled in utilities_conf.h by setting
+ *        UTIL_SEQ_CONF_PROFILING to 1 and defining UTIL_SEQ_PROFILING_GET_CYCLES() with a free
+ *        running 32 bits cycle counter
+ */
+#ifndef UTIL_SEQ_CONF_PROFILING
+  #define UTIL_SEQ_CONF_PROFILING  (0)
+#endif
+
+/**
+ * @brief earliest deadline first scheduling within a priority is disabled by default, it can be
+ *        enabled in utilities_conf.h by setting UTIL_SEQ_CONF_EDF to 1
+ */
+#ifndef UTIL_SEQ_CONF_EDF
+  #define UTIL_SEQ_CONF_EDF  (0)
+#endif
+
+#if (UTIL_SEQ_CONF_PROFILING != 0) && !defined(UTIL_SEQ_PROFILING_GET_CYCLES)
+#error "UTIL_SEQ_PROFILING_GET_CYCLES() shall be defined when UTIL_SEQ_CONF_PROFILING is set"
+#endif
+
 /**
  * @brief define to represent no task running
  */
@@ -158,6 +187,35 @@ static void (*TaskCb[UTIL_SEQ_CONF_TASK_NBR])( void );
  */
 static volatile UTIL_SEQ_Priority_t TaskPrio[UTIL_SEQ_CONF_PRIO_NBR];
 
+#if (UTIL_SEQ_CONF_EDF != 0)
+/**
+ * @brief tasks pending with a deadline.
+ */
+static volatile UTIL_SEQ_bm_t TaskDeadlineSet = UTIL_SEQ_NO_BIT_SET;
+
+/**
+ * @brief deadline of each task pending with a deadline.
+ */
+static uint32_t TaskDeadline[UTIL_SEQ_CONF_TASK_NBR];
+#endif
+
+#if (UTIL_SEQ_CONF_PROFILING != 0)
+/**
+ * @brief task execution statistics.
+ */
+static UTIL_SEQ_TaskProfile_t TaskProfile[UTIL_SEQ_CONF_TASK_NBR];
+
+/**
+ * @brief cycle counter value when each pending task has been set.
+ */
+static uint32_t TaskSetStamp[UTIL_SEQ_CONF_TASK_NBR];
+
+/**
+ * @brief cycles spent in UTIL_SEQ_Idle().
+ */
+static uint64_t IdleCycles;
+#endif
+
 /**
  * @}
  */
@@ -167,6 +225,9 @@ static volatile UTIL_SEQ_Priority_t TaskPrio[UTIL_SEQ_CONF_PRIO_NBR];
  *  @{
  */
 uint8_t SEQ_BitPosition(uint32_t Value);
+#if (UTIL_SEQ_CONF_EDF != 0)
+static uint32_t SEQ_EarliestDeadline(UTIL_SEQ_bm_t TaskSet_bm);
+#endif
 
 /**
  * @}
@@ -185,6 +246,9 @@ void UTIL_SEQ_Init( void )
   EvtSet = UTIL_SEQ_NO_BIT_SET;
   EvtWaited = UTIL_SEQ_NO_BIT_SET;
   CurrentTaskIdx = 0U;
+#if (UTIL_SEQ_CONF_EDF != 0)
+  TaskDeadlineSet = UTIL_SEQ_NO_BIT_SET;
+#endif
   (void)UTIL_SEQ_MEMSET8((uint8_t *)TaskCb, 0, sizeof(TaskCb));
   for(uint32_t index = 0; index < UTIL_SEQ_CONF_PRIO_NBR; index++)
   {
@@ -248,37 +312,53 @@ void UTIL_SEQ_Run( UTIL_SEQ_bm_t Mask_bm )
 
     current_task_set = TaskPrio[counter].priority & local_taskmask & SuperMask;
 
+#if (UTIL_SEQ_CONF_EDF != 0)
     /*
-     * The round_robin register is a mask of allowed flags to be evaluated.
-     * The concept is to make sure that on each round on UTIL_SEQ_Run(), if two same flags are always set,
-     * the sequencer does not run always only the first one.
-     * When a task has been executed, The flag is removed from the round_robin mask.
-     * If on the next UTIL_SEQ_RUN(), the two same flags are set again, the round_robin mask will mask out the first flag
-     * so that the second one can be executed.
-     * Note that the first flag is not removed from the list of pending task but just masked by the round_robin mask
-     *
-     * In the check below, the round_robin mask is reinitialize in case all pending tasks haven been executed at least once
+     * Within a priority, the tasks set with UTIL_SEQ_SetTaskDeadline() are executed first, earliest
+     * deadline first. The round robin mechanism only applies to the tasks set without deadline.
      */
-    if ((TaskPrio[counter].round_robin & current_task_set) == 0U)
+    if ((current_task_set & TaskDeadlineSet) != 0U)
     {
-      TaskPrio[counter].round_robin = UTIL_SEQ_ALL_BIT_SET;
+      CurrentTaskIdx = SEQ_EarliestDeadline(current_task_set & TaskDeadlineSet);
+    }
+    else
+#endif
+    {
+      /*
+       * The round_robin register is a mask of allowed flags to be evaluated.
+       * The concept is to make sure that on each round on UTIL_SEQ_Run(), if two same flags are always set,
+       * the sequencer does not run always only the first one.
+       * When a task has been executed, The flag is removed from the round_robin mask.
+       * If on the next UTIL_SEQ_RUN(), the two same flags are set again, the round_robin mask will mask out the first flag
+       * so that the second one can be executed.
+       * Note that the first flag is not removed from the list of pending task but just masked by the round_robin mask
+       *
+       * In the check below, the round_robin mask is reinitialize in case all pending tasks haven been executed at least once
+       */
+      if ((TaskPrio[counter].round_robin & current_task_set) == 0U)
+      {
+        TaskPrio[counter].round_robin = UTIL_SEQ_ALL_BIT_SET;
+      }
+
+      /*
+       * Read the flag index of the task to be executed
+       * Once the index is read, the associated task will be executed even though a higher priority stack is requested
+       * before task execution.
+       */
+      CurrentTaskIdx = (SEQ_BitPosition(current_task_set & TaskPrio[counter].round_robin));
+
+      /*
+       * remove from the roun_robin mask the task that has been selected to be executed
+       */
+      TaskPrio[counter].round_robin &= ~(1U << CurrentTaskIdx);
     }
-
-  /*
-   * Read the flag index of the task to be executed
-	 * Once the index is read, the associated task will be executed even though a higher priority stack is requested
-	 * before task execution.
-	 */
-    CurrentTaskIdx = (SEQ_BitPosition(current_task_set & TaskPrio[counter].round_robin));
-
-    /*
-     * remove from the roun_robin mask the task that has been selected to be executed
-     */
-    TaskPrio[counter].round_robin &= ~(1U << CurrentTaskIdx);
 
     UTIL_SEQ_ENTER_CRITICAL_SECTION( );
     /* remove from the list or pending task the one that has been selected to be executed */
     TaskSet &= ~(1U << CurrentTaskIdx);
+#if (UTIL_SEQ_CONF_EDF != 0)
+    TaskDeadlineSet &= ~(1U << CurrentTaskIdx);
+#endif
     /* remove from all priority mask the task that has been selected to be executed */
     for (counter = UTIL_SEQ_CONF_PRIO_NBR; counter != 0U; counter--)
     {
@@ -287,7 +367,33 @@ void UTIL_SEQ_Run( UTIL_SEQ_bm_t Mask_bm )
     UTIL_SEQ_EXIT_CRITICAL_SECTION( );
 
     /* Execute the task */
+    UTIL_SEQ_TASK_START_HOOK( CurrentTaskIdx );
+#if (UTIL_SEQ_CONF_PROFILING != 0)
+    {
+      /* CurrentTaskIdx may be modified by a nested call of UTIL_SEQ_Run() */
+      uint32_t task_idx = CurrentTaskIdx;
+      uint32_t start = UTIL_SEQ_PROFILING_GET_CYCLES( );
+      uint32_t cycles = start - TaskSetStamp[task_idx];
+
+      TaskProfile[task_idx].TotalLatencyCycles += cycles;
+      if (cycles > TaskProfile[task_idx].MaxLatencyCycles)
+      {
+        TaskProfile[task_idx].MaxLatencyCycles = cycles;
+      }
+
+      TaskCb[task_idx]( );
+
+      cycles = UTIL_SEQ_PROFILING_GET_CYCLES( ) - start;
+      TaskProfile[task_idx].Count++;
+      TaskProfile[task_idx].TotalCycles += cycles;
+      if (cycles > TaskProfile[task_idx].MaxCycles)
+      {
+        TaskProfile[task_idx].MaxCycles = cycles;
+      }
+    }
+#else
     TaskCb[CurrentTaskIdx]( );
+#endif
 
     local_taskset = TaskSet;
     local_evtset = EvtSet;
@@ -307,7 +413,13 @@ void UTIL_SEQ_Run( UTIL_SEQ_bm_t Mask_bm )
   {
     if ((local_evtset & EvtWaited)== 0U)
     {
+#if (UTIL_SEQ_CONF_PROFILING != 0)
+      uint32_t idle_start = UTIL_SEQ_PROFILING_GET_CYCLES( );
       UTIL_SEQ_Idle( );
+      IdleCycles += UTIL_SEQ_PROFILING_GET_CYCLES( ) - idle_start;
+#else
+      UTIL_SEQ_Idle( );
+#endif
     }
   }
   UTIL_SEQ_EXIT_CRITICAL_SECTION_IDLE( );
@@ -336,6 +448,20 @@ void UTIL_SEQ_SetTask( UTIL_SEQ_bm_t TaskId_bm , uint32_t Task_Prio )
 {
   UTIL_SEQ_ENTER_CRITICAL_SECTION( );
 
+#if (UTIL_SEQ_CONF_PROFILING != 0)
+  {
+    /* the latency is measured from the first request of a task not yet pending */
+    UTIL_SEQ_bm_t new_task_set = TaskId_bm & ~TaskSet;
+    uint32_t now = UTIL_SEQ_PROFILING_GET_CYCLES( );
+
+    while (new_task_set != 0U)
+    {
+      uint32_t index = SEQ_BitPosition(new_task_set);
+      TaskSetStamp[index] = now;
+      new_task_set &= ~(1U << index);
+    }
+  }
+#endif
   TaskSet |= TaskId_bm;
   TaskPrio[Task_Prio].priority |= TaskId_bm;
 
@@ -344,6 +470,33 @@ void UTIL_SEQ_SetTask( UTIL_SEQ_bm_t TaskId_bm , uint32_t Task_Prio )
   return;
 }
 
+#if (UTIL_SEQ_CONF_EDF != 0)
+void UTIL_SEQ_SetTaskDeadline( UTIL_SEQ_bm_t TaskId_bm , uint32_t Task_Prio, uint32_t Deadline )
+{
+  UTIL_SEQ_bm_t task_bm = TaskId_bm;
+
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  while (task_bm != 0U)
+  {
+    uint32_t index = SEQ_BitPosition(task_bm);
+
+    /* a task already pending keeps the earliest of its deadlines */
+    if (((TaskDeadlineSet & (1U << index)) == 0U) || ((int32_t)(Deadline - TaskDeadline[index]) < 0))
+    {
+      TaskDeadline[index] = Deadline;
+    }
+    task_bm &= ~(1U << index);
+  }
+  TaskDeadlineSet |= TaskId_bm;
+  UTIL_SEQ_SetTask( TaskId_bm, Task_Prio );
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+
+  return;
+}
+#endif
+
 uint32_t UTIL_SEQ_IsSchedulableTask( UTIL_SEQ_bm_t TaskId_bm)
 {
   uint32_t _status;
@@ -472,6 +625,43 @@ UTIL_SEQ_bm_t UTIL_SEQ_IsEvtPend( void )
   return (EvtSet & local_evtwaited);
 }
 
+#if (UTIL_SEQ_CONF_PROFILING != 0)
+void UTIL_SEQ_GetTaskProfile( uint32_t TaskIdx, UTIL_SEQ_TaskProfile_t *pProfile )
+{
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  *pProfile = TaskProfile[TaskIdx];
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+
+  return;
+}
+
+uint64_t UTIL_SEQ_GetIdleCycles( void )
+{
+  uint64_t idle_cycles;
+
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  idle_cycles = IdleCycles;
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+
+  return idle_cycles;
+}
+
+void UTIL_SEQ_ResetProfile( void )
+{
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  (void)UTIL_SEQ_MEMSET8((uint8_t *)TaskProfile, 0, sizeof(TaskProfile));
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+
+  return;
+}
+#endif
+
 __WEAK void UTIL_SEQ_EvtIdle( UTIL_SEQ_bm_t TaskId_bm, UTIL_SEQ_bm_t EvtWaited_bm )
 {
   (void)EvtWaited_bm;
@@ -508,6 +698,34 @@ __WEAK void UTIL_SEQ_PostIdle( void )
  *  @{
  */
 
+#if (UTIL_SEQ_CONF_EDF != 0)
+/**
+ * @brief return the task with the earliest deadline
+ * @param TaskSet_bm tasks pending with a deadline, at least one
+ * @retval task index
+ */
+static uint32_t SEQ_EarliestDeadline(UTIL_SEQ_bm_t TaskSet_bm)
+{
+  UTIL_SEQ_bm_t task_bm = TaskSet_bm;
+  uint32_t earliest = SEQ_BitPosition(task_bm);
+
+  task_bm &= ~(1U << earliest);
+  while (task_bm != 0U)
+  {
+    uint32_t index = SEQ_BitPosition(task_bm);
+
+    /* deadlines are compared on the distance between them to handle the time wrap */
+    if ((int32_t)(TaskDeadline[index] - TaskDeadline[earliest]) < 0)
+    {
+      earliest = index;
+    }
+    task_bm &= ~(1U << index);
+  }
+
+  return earliest;
+}
+#endif
+
 #if( __CORTEX_M == 0)
 const uint8_t SEQ_clz_table_4bit[16U] = { 4U, 3U, 2U, 2U, 1U, 1U, 1U, 1U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U };
 /**
@@ -43,6 +43,19 @@ extern "C" {
 
 typedef uint32_t UTIL_SEQ_bm_t;
 
+/**
+ *  @brief  execution statistics of a task, in cycles of UTIL_SEQ_PROFILING_GET_CYCLES().
+ *  only available when UTIL_SEQ_CONF_PROFILING is set in utilities_conf.h
+ */
+typedef struct
+{
+  uint32_t Count;                 /*!< number of executions                           */
+  uint32_t MaxCycles;             /*!< longest execution                              */
+  uint64_t TotalCycles;           /*!< cumulated execution time                       */
+  uint32_t MaxLatencyCycles;      /*!< longest time from UTIL_SEQ_SetTask() to execution */
+  uint64_t TotalLatencyCycles;    /*!< cumulated time from UTIL_SEQ_SetTask() to execution */
+} UTIL_SEQ_TaskProfile_t;
+
 /**
   * @}
  */
@@ -226,6 +239,24 @@ void UTIL_SEQ_RegTask( UTIL_SEQ_bm_t TaskId_bm, uint32_t Flags, void (*Task)( vo
  */
 void UTIL_SEQ_SetTask( UTIL_SEQ_bm_t TaskId_bm , uint32_t Task_Prio );
 
+/**
+ * @brief This function requests a task to be executed before a deadline
+ *        Within the priority, the tasks set with a deadline are executed before the tasks set
+ *        without deadline, the one with the earliest deadline first.
+ *
+ * @param TaskId_bm The Id of the task
+ *        It shall be (1<<task_id) where task_id is the number assigned when the task has been registered
+ * @param Task_Prio The priority of the task, as for UTIL_SEQ_SetTask()
+ * @param Deadline Time the task is due, in a time base chosen by the application and common to all the tasks
+ *        The deadlines of the pending tasks shall be less than 2^31 apart
+ *
+ * @note   When the task is already pending, the earliest deadline is kept.
+ *         Only available when UTIL_SEQ_CONF_EDF is set in utilities_conf.h.
+ *         It may be called from an ISR
+ *
+ */
+void UTIL_SEQ_SetTaskDeadline( UTIL_SEQ_bm_t TaskId_bm , uint32_t Task_Prio, uint32_t Deadline );
+
 /**
  * @brief This function checks if a task could be scheduled.
  *
@@ -344,6 +375,40 @@ UTIL_SEQ_bm_t UTIL_SEQ_IsEvtPend( void );
  */
 void UTIL_SEQ_EvtIdle( UTIL_SEQ_bm_t TaskId_bm, UTIL_SEQ_bm_t EvtWaited_bm );
 
+/**
+ * @brief This function returns the execution statistics of a task since the last UTIL_SEQ_ResetProfile()
+ *
+ * @param TaskIdx The number assigned to the task when it has been registered
+ * @param pProfile Statistics of the task
+ *
+ * @note  The execution time of a task includes the tasks run by a nested UTIL_SEQ_Run() from
+ *        UTIL_SEQ_WaitEvt() and the interrupts.
+ *        Only available when UTIL_SEQ_CONF_PROFILING is set in utilities_conf.h.
+ *        It may be called from an ISR.
+ *
+ */
+void UTIL_SEQ_GetTaskProfile( uint32_t TaskIdx, UTIL_SEQ_TaskProfile_t *pProfile );
+
+/**
+ * @brief This function returns the cycles spent in UTIL_SEQ_Idle() since the start
+ *
+ * @note  The cycle counter does not run in the low power modes stopping the CPU clock, the cycles
+ *        of the CPU busy in a period are the cycles elapsed minus the idle cycles.
+ *        Only available when UTIL_SEQ_CONF_PROFILING is set in utilities_conf.h.
+ *        It may be called from an ISR.
+ *
+ */
+uint64_t UTIL_SEQ_GetIdleCycles( void );
+
+/**
+ * @brief This function clears the execution statistics of all the tasks
+ *
+ * @note  Only available when UTIL_SEQ_CONF_PROFILING is set in utilities_conf.h.
+ *        It may be called from an ISR.
+ *
+ */
+void UTIL_SEQ_ResetProfile( void );
+
 /**
   * @}
  */